@@ -473,6 +473,8 @@ static COMMAND_T g_commandTable[] =
 	{ { DEFACCEL, "SWS/BR: Normalize loudness of selected tracks to 0 LU" },            "BR_NORMALIZE_LOUDNESS_TRACKS_LU", NormalizeLoudness,          NULL, -2, },
 
 	{ { DEFACCEL, "SWS/BR/NF: Toggle use high precision mode for loudness analyzing" }, "BR_NF_TOGGLE_LOUDNESS_HIGH_PREC", ToggleHighPrecisionOption,  NULL, 0, IsHighPrecisionOptionEnabled},
+	{ { DEFACCEL, "SWS/BR: Toggle persistent loudness analysis cache" },                "BR_LOUDNESS_TOGGLE_CACHE",        ToggleLoudnessCache,        NULL, 0, IsLoudnessCacheEnabled},
+	{ { DEFACCEL, "SWS/BR: Purge loudness analysis cache" },                            "BR_LOUDNESS_PURGE_CACHE",         PurgeLoudnessCache,         NULL, },
 
 	/******************************************************************************
 	* MIDI editor - Item preview                                                  *
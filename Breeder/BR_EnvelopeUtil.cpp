@@ -662,109 +662,52 @@ double BR_Envelope::ValueAtPosition (double position, bool fastMode /*= false*/)
 	}
 	else
 	{
-		// No previous point?
-		if (!this->ValidateId(id))
-		{
-			int nextId = this->FindFirstPoint();
-			if (this->ValidateId(nextId))
-				return m_points[nextId].value;
-			else
-				return this->LaneCenterValue();
-		}
-
-		// No next point?
-		int nextId = (m_sorted) ? (id + 1) : this->FindNext(m_points[id].position, 0);
-		if (!this->ValidateId(nextId))
-			return m_points[id].value;
-
-		// Position at the end of transition ?
-		if (m_points[nextId].position == position)
-			return m_points[this->LastPointAtPos(nextId)].value;
-
-		// Everything else
-		double t1 = m_points[id].position;
-		double t2 = m_points[nextId].position;
-		double v1 = m_points[id].value;
-		double v2 = m_points[nextId].value;
-		if (faderMode)
-		{
-			v1 = this->NormalizedDisplayValue(v1);
-			v2 = this->NormalizedDisplayValue(v2);
-		}
+		return this->InterpolateValue(id, position, faderMode);
+	}
+}
 
-		double returnValue = 0;
-		switch (m_points[id].shape)
-		{
-			case SQUARE:
-			{
-				returnValue = v1;
-			}
-			break;
+void BR_Envelope::FillValues (double start, double step, int count, double* values)
+{
+	if (count <= 0)
+		return;
 
-			case LINEAR:
-			{
-				double t = (position - t1) / (t2 - t1);
-				returnValue = (!m_tempoMap) ? (v1 + (v2 - v1) * t) : CalculateTempoAtPosition(v1, v2, t1, t2, position);
-			}
-			break;
+	if (!m_sorted)
+	{
+		for (int i = 0; i < count; ++i)
+			values[i] = this->ValueAtPosition(start + i * step, true);
+		return;
+	}
 
-			case FAST_END:                                 // f(x) = x^3
-			{
-				double t = (position - t1) / (t2 - t1);
-				returnValue =  v1 + (v2 - v1) * pow(t, 3);
-			}
-			break;
+	const bool faderMode = IsScaledToFader();
+	const int pointCount = (int)m_points.size();
+	start -= m_takeEnvOffset;
 
-			case FAST_START:                               // f(x) = 1 - (1 - x)^3
-			{
-				double t = (position - t1) / (t2 - t1);
-				returnValue =  v1 + (v2 - v1) * (1 - pow(1-t, 3));
-			}
-			break;
+	int id = FindPrevious(start, 0);
+	int i = 0;
+	while (i < count)
+	{
+		double position = start + i * step;
+		while (id + 1 < pointCount && m_points[id + 1].position < position)
+			++id;
 
-			case SLOW_START_END:                           // f(x) = x^2 * (3-2x)
-			{
-				double t = (position - t1) / (t2 - t1);
-				returnValue =  v1 + (v2 - v1) * (pow(t, 2) * (3 - 2*t));
-			}
-			break;
+		// Segment value doesn't change (before first point, after last point or square/flat transition) so fill up to the next point in one go
+		bool constant = !this->ValidateId(id) || !this->ValidateId(id + 1);
+		if (!constant)
+			constant = m_points[id].shape == SQUARE || (m_points[id].shape != BEZIER && m_points[id].value == m_points[id + 1].value);
 
-			case BEZIER:
-			{
-				int id0 = (m_sorted) ? (id-1)     : (this->FindPrevious(t1, 0));
-				int id3 = (m_sorted) ? (nextId+1) : (this->FindNext(t2, 0));
-				double t0 = (!this->ValidateId(id0)) ? (t1) : (m_points[id0].position);
-				double v0 = (!this->ValidateId(id0)) ? (v1) : (m_points[id0].value);
-				double t3 = (!this->ValidateId(id3)) ? (t2) : (m_points[id3].position);
-				double v3 = (!this->ValidateId(id3)) ? (v2) : (m_points[id3].value);
-				if (faderMode)
-				{
-					v0 = this->NormalizedDisplayValue(v0);
-					v3 = this->NormalizedDisplayValue(v3);
-				}
+		if (constant)
+		{
+			const double value = this->InterpolateValue(id, position, faderMode);
+			const double segmentEnd = this->ValidateId(id + 1) ? m_points[id + 1].position : position + count * step;
 
-				double x1, x2, y1, y2, empty;
-				LICE_Bezier_FindCardinalCtlPts(0.25, t0, t1, t2, v0, v1, v2, &empty, &x1, &empty, &y1);
-				LICE_Bezier_FindCardinalCtlPts(0.25, t1, t2, t3, v1, v2, v3, &x2, &empty, &y2, &empty);
-
-				double tension = m_points[id].bezier;
-				x1 += tension * ((tension > 0) ? (t2-x1) : (x1-t1));
-				x2 += tension * ((tension > 0) ? (t2-x2) : (x2-t1));
-				y1 -= tension * ((tension > 0) ? (y1-v1) : (v2-y1));
-				y2 -= tension * ((tension > 0) ? (y2-v1) : (v2-y2));
-
-				x1 = SetToBounds(x1, t1, t2);
-				x2 = SetToBounds(x2, t1, t2);
-				y1 = SetToBounds(y1, this->MinValueAbs(), this->MaxValueAbs());
-				y2 = SetToBounds(y2, this->MinValueAbs(), this->MaxValueAbs());
-				returnValue = LICE_CBezier_GetY(t1, x1, x2, t2, v1, y1, y2, v2, position);
-			}
-			break;
+			values[i++] = value;
+			while (i < count && start + i * step < segmentEnd)
+				values[i++] = value;
+		}
+		else
+		{
+			values[i++] = this->InterpolateValue(id, position, faderMode);
 		}
-
-		if (faderMode)
-			returnValue = this->RealValue(returnValue);
-		return returnValue;
 	}
 }
 
@@ -1543,6 +1486,114 @@ int BR_Envelope::FindFirstPoint ()
 	}
 }
 
+double BR_Envelope::InterpolateValue (int id, double position, bool faderMode)
+{
+	/* position has to be in envelope time (take envelope offset already removed) and id has to be the previous point of the position */
+	// No previous point?
+	if (!this->ValidateId(id))
+	{
+		int nextId = this->FindFirstPoint();
+		if (this->ValidateId(nextId))
+			return m_points[nextId].value;
+		else
+			return this->LaneCenterValue();
+	}
+
+	// No next point?
+	int nextId = (m_sorted) ? (id + 1) : this->FindNext(m_points[id].position, 0);
+	if (!this->ValidateId(nextId))
+		return m_points[id].value;
+
+	// Position at the end of transition ?
+	if (m_points[nextId].position == position)
+		return m_points[this->LastPointAtPos(nextId)].value;
+
+	// Everything else
+	double t1 = m_points[id].position;
+	double t2 = m_points[nextId].position;
+	double v1 = m_points[id].value;
+	double v2 = m_points[nextId].value;
+	if (faderMode)
+	{
+		v1 = this->NormalizedDisplayValue(v1);
+		v2 = this->NormalizedDisplayValue(v2);
+	}
+
+	double returnValue = 0;
+	switch (m_points[id].shape)
+	{
+		case SQUARE:
+		{
+			returnValue = v1;
+		}
+		break;
+
+		case LINEAR:
+		{
+			double t = (position - t1) / (t2 - t1);
+			returnValue = (!m_tempoMap) ? (v1 + (v2 - v1) * t) : CalculateTempoAtPosition(v1, v2, t1, t2, position);
+		}
+		break;
+
+		case FAST_END:                                 // f(x) = x^3
+		{
+			double t = (position - t1) / (t2 - t1);
+			returnValue =  v1 + (v2 - v1) * pow(t, 3);
+		}
+		break;
+
+		case FAST_START:                               // f(x) = 1 - (1 - x)^3
+		{
+			double t = (position - t1) / (t2 - t1);
+			returnValue =  v1 + (v2 - v1) * (1 - pow(1-t, 3));
+		}
+		break;
+
+		case SLOW_START_END:                           // f(x) = x^2 * (3-2x)
+		{
+			double t = (position - t1) / (t2 - t1);
+			returnValue =  v1 + (v2 - v1) * (pow(t, 2) * (3 - 2*t));
+		}
+		break;
+
+		case BEZIER:
+		{
+			int id0 = (m_sorted) ? (id-1)     : (this->FindPrevious(t1, 0));
+			int id3 = (m_sorted) ? (nextId+1) : (this->FindNext(t2, 0));
+			double t0 = (!this->ValidateId(id0)) ? (t1) : (m_points[id0].position);
+			double v0 = (!this->ValidateId(id0)) ? (v1) : (m_points[id0].value);
+			double t3 = (!this->ValidateId(id3)) ? (t2) : (m_points[id3].position);
+			double v3 = (!this->ValidateId(id3)) ? (v2) : (m_points[id3].value);
+			if (faderMode)
+			{
+				v0 = this->NormalizedDisplayValue(v0);
+				v3 = this->NormalizedDisplayValue(v3);
+			}
+
+			double x1, x2, y1, y2, empty;
+			LICE_Bezier_FindCardinalCtlPts(0.25, t0, t1, t2, v0, v1, v2, &empty, &x1, &empty, &y1);
+			LICE_Bezier_FindCardinalCtlPts(0.25, t1, t2, t3, v1, v2, v3, &x2, &empty, &y2, &empty);
+
+			double tension = m_points[id].bezier;
+			x1 += tension * ((tension > 0) ? (t2-x1) : (x1-t1));
+			x2 += tension * ((tension > 0) ? (t2-x2) : (x2-t1));
+			y1 -= tension * ((tension > 0) ? (y1-v1) : (v2-y1));
+			y2 -= tension * ((tension > 0) ? (y2-v1) : (v2-y2));
+
+			x1 = SetToBounds(x1, t1, t2);
+			x2 = SetToBounds(x2, t1, t2);
+			y1 = SetToBounds(y1, this->MinValueAbs(), this->MaxValueAbs());
+			y2 = SetToBounds(y2, this->MinValueAbs(), this->MaxValueAbs());
+			returnValue = LICE_CBezier_GetY(t1, x1, x2, t2, v1, y1, y2, v2, position);
+		}
+		break;
+	}
+
+	if (faderMode)
+		returnValue = this->RealValue(returnValue);
+	return returnValue;
+}
+
 int BR_Envelope::LastPointAtPos (int id)
 {
 	/* no bounds checking - internal function so caller handles before calling */
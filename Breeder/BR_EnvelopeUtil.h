@@ -112,6 +112,7 @@ public:
 
 	/* Points properties */
 	double ValueAtPosition (double position, bool fastMode = false); // fastMode will not use native API which is more accurate in some cases (noticed it with bezier curves), but much slower with high point count (accuracy difference should be minimal but still important when dealing with things like mouse detection where every pixel counts!)
+	void FillValues (double start, double step, int count, double* values);   // Same as ValueAtPosition() in fastMode for count positions spaced by step, but walks points incrementally instead of searching for every position (sort points first for best performance)
 	double NormalizedDisplayValue (double value);                    // Convert point value to 0.0 - 1.0 range as displayed in arrange
 	double RealValue (double normalizedDisplayValue);                // Convert normalized display value in range 0.0 - 1.0 to real envelope value
 	double SnapValue (double value);                                 // Snaps value to current settings (only relevant for take pitch envelope)
@@ -235,6 +236,7 @@ private:
 
 	int FindFirstPoint ();
 	int LastPointAtPos (int id);
+	double InterpolateValue (int id, double position, bool faderMode); // id is previous point of position (FindPrevious()), used by ValueAtPosition() in fastMode
 	int FindNext (double position, double offset);     // used for internal stuff since position
 	int FindPrevious (double position, double offset); // offset of take envelopes has to be tracked
 	void Build (bool takeEnvelopesUseProjectTime);
@@ -35,6 +35,16 @@
 #include "../SnM/SnM.h"
 #include "../libebur128/ebur128.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define BR_LOUDNESS_SSE2
+#endif
+
 #include <WDL/localize/localize.h>
 
 /******************************************************************************
@@ -62,7 +72,16 @@ const char* const EXPORT_FORMAT_KEY    = "BR - LoudnessExportFormat";
 const char* const EXPORT_FORMAT_WND    = "BR - LoudnessExportFormat WndPos";
 const char* const EXPORT_FORMAT_RECENT = "BR - LoudnessExportFormat_Pattern_";
 
+const char* const CACHE_KEY            = "BR - LoudnessCache";
+const char* const CACHE_FILE           = "SWS_Loudness cache.txt";
+const char* const CACHE_VERSION_KEY    = "CACHE_VERSION";
+const char* const CACHE_ENTRY_KEY      = "<ENTRY";
+
 const int EXPORT_FORMAT_RECENT_MAX      = 10;
+const int CACHE_DEFAULT_SIZE_MB         = 64;
+const int CACHE_FILE_VERSION            = 2;   // 2: doubles stored as raw bits (exact round-trip)
+const int CHUNK_WARM_UP_TIME            = 6;   // in seconds, multiple of momentary/short-term/LRA intervals
+const int CHUNK_MIN_LENGTH              = 60;  // in seconds, shorter targets are not worth splitting
 const int VERSION                       = 1;
 
 // Export format wildcards
@@ -173,6 +192,58 @@ const int UPDATE_TIMER_FREQ  = 200;
 ******************************************************************************/
 #define g_pref BR_LoudnessPref::Get() // not exactly global object, but it behaves as such, heh...
 
+/******************************************************************************
+* Gain kernels (used when analyzing)                                          *
+******************************************************************************/
+static void MultiplyBuffer (double* dest, const double* src, int count)
+{
+	int i = 0;
+#ifdef BR_LOUDNESS_SSE2
+	for (; i + 2 <= count; i += 2)
+		_mm_storeu_pd(dest + i, _mm_mul_pd(_mm_loadu_pd(dest + i), _mm_loadu_pd(src + i)));
+#endif
+	for (; i < count; ++i)
+		dest[i] *= src[i];
+}
+
+static void ApplyGainCurve (double* samples, const double* gainCurve, const double* channelGain, int frames, int channels)
+{
+	// gainCurve holds one value per frame, channelGain one value per channel - samples are interleaved
+	if (channels == 1)
+	{
+		MultiplyBuffer(samples, gainCurve, frames); // pan is never applied to mono
+	}
+	else if (channels == 2)
+	{
+#ifdef BR_LOUDNESS_SSE2
+		const __m128d pan = _mm_loadu_pd(channelGain);
+		for (int i = 0; i < frames; ++i)
+			_mm_storeu_pd(samples + 2*i, _mm_mul_pd(_mm_loadu_pd(samples + 2*i), _mm_mul_pd(_mm_set1_pd(gainCurve[i]), pan)));
+#else
+		for (int i = 0; i < frames; ++i)
+		{
+			samples[2*i]   *= gainCurve[i] * channelGain[0];
+			samples[2*i+1] *= gainCurve[i] * channelGain[1];
+		}
+#endif
+	}
+	else
+	{
+		for (int i = 0; i < frames; ++i)
+		{
+			double* frame = samples + i * channels;
+			for (int channel = 0; channel < channels; ++channel)
+				frame[channel] *= gainCurve[i] * channelGain[channel];
+		}
+	}
+}
+
+static int GetHardwareThreads ()
+{
+	int cores = (int)std::thread::hardware_concurrency();
+	return (cores > 0) ? cores : 1;
+}
+
 /******************************************************************************
 * Globals                                                                     *
 ******************************************************************************/
@@ -201,7 +272,12 @@ m_integratedOnly      (false),
 m_doTruePeak          (true),
 m_truePeakAnalyzed    (false),
 m_process             (NULL),
-m_doHighPrecisionMode (true)
+m_doHighPrecisionMode (true),
+m_cacheKey            (0),
+m_cacheKeyValid       (false),
+m_maxChunks           (1),
+m_changedStart        (-1),
+m_changedEnd          (-1)
 {
 }
 
@@ -223,7 +299,12 @@ m_integratedOnly      (false),
 m_doTruePeak          (true),
 m_truePeakAnalyzed    (false),
 m_process             (NULL),
-m_doHighPrecisionMode (true)
+m_doHighPrecisionMode (true),
+m_cacheKey            (0),
+m_cacheKeyValid       (false),
+m_maxChunks           (1),
+m_changedStart        (-1),
+m_changedEnd          (-1)
 {
 	this->CheckSetAudioData();
 }
@@ -246,7 +327,12 @@ m_integratedOnly      (false),
 m_doTruePeak          (true),
 m_truePeakAnalyzed    (false),
 m_process             (NULL),
-m_doHighPrecisionMode (true)
+m_doHighPrecisionMode (true),
+m_cacheKey            (0),
+m_cacheKeyValid       (false),
+m_maxChunks           (1),
+m_changedStart        (-1),
+m_changedEnd          (-1)
 {
 	this->CheckSetAudioData();
 }
@@ -255,7 +341,11 @@ BR_LoudnessObject::~BR_LoudnessObject ()
 {
 	this->AbortAnalyze();
 	if (EnumProjects(0, NULL, 0)) // prevent destroying accessor on reaper exit (otherwise we get access violation)
+	{
 		DestroyAudioAccessor(this->GetAudioData().audio);
+		for (size_t i = 0; i < m_chunkAccessors.size(); ++i)
+			DestroyAudioAccessor(m_chunkAccessors[i]);
+	}
 }
 
 bool BR_LoudnessObject::Analyze (bool integratedOnly, bool doTruePeak, bool doHighPrecisionMode)
@@ -274,9 +364,21 @@ bool BR_LoudnessObject::Analyze (bool integratedOnly, bool doTruePeak, bool doHi
 
 		if (!analyzed)
 		{
-			this->SetRunning(true);
-			this->SetProgress(0);
-			this->SetProcess((HANDLE)_beginthreadex(NULL, 0, this->AnalyzeData, (void*)this, 0, NULL));
+			WDL_UINT64 cacheKey = 0;
+			bool cacheKeyValid = this->GetCacheKey(&cacheKey);
+			{
+				SWS_SectionLock lock(&m_mutex);
+				m_cacheKey      = cacheKey;
+				m_cacheKeyValid = cacheKeyValid;
+			}
+
+			if (!this->RestoreFromCache())
+			{
+				this->PrepareChunks();
+				this->SetRunning(true);
+				this->SetProgress(0);
+				this->SetProcess((HANDLE)_beginthreadex(NULL, 0, this->AnalyzeData, (void*)this, 0, NULL));
+			}
 		}
 		return true;
 	}
@@ -997,6 +1099,85 @@ int BR_LoudnessObject::GetItemNumber ()
 		return -1;
 }
 
+struct BR_LoudnessObject::AnalyzeChunk
+{
+	BR_LoudnessObject::AudioData data;          // chunk's own accessor and copies of envelopes (nothing here is shared between chunk threads)
+	BR_LoudnessObject::ChunkBuffers* buffers;
+	ebur128_state* state;
+	WDL_INT64 startSample, endSample;           // relative to audio start
+	WDL_INT64 warmUpSamples;                    // samples preceding startSample that get analyzed and then discarded
+	bool final;                                 // last chunk ends where audio ends (and always reads until audio end)
+	bool recordBlocks;                          // false while warming up
+	vector<double> momentaryValues, shortTermValues;
+	vector<double> gatingEnergies, shortTermEnergies, periodPeaks, periodPeakPos;
+
+	// Same for all chunks
+	std::atomic<WDL_INT64>* processedSamples;
+	WDL_INT64 totalSamples, periodSamples;
+	const double* channelGain;
+	double itemPos, effectiveEndTime;
+	int refreshRateInHz;
+	bool integratedOnly, doTruePeak, doPan, doVolEnv, doVolPreFXEnv, doShortTerm;
+};
+
+static void SpliceValues (vector<double>& values, size_t offset, const vector<double>& newValues, bool toEnd)
+{
+	// Replace values starting at offset, when new values reach the end of the target, everything after them is gone
+	if (toEnd || offset + newValues.size() > values.size())
+		values.resize(offset + newValues.size(), 0);
+	std::copy(newValues.begin(), newValues.end(), values.begin() + offset);
+}
+
+static WDL_INT64 GetPeriodSamples (int samplerate, int refreshRateInHz)
+{
+	// Chunks and reanalyzed ranges start and end on multiples of this (see AnalyzeData())
+	return (WDL_INT64)(samplerate / refreshRateInHz) * (WDL_INT64)(CHUNK_WARM_UP_TIME * refreshRateInHz);
+}
+
+static bool CanSplitAnalysis (int samplerate, int refreshRateInHz)
+{
+	// Merged per-block data only lines up with serial analysis if the period is a multiple of ebur128's loudness range block hop (10 gating
+	// blocks of (samplerate+5)/10 samples), i.e. samplerates divisible by 10 in standard mode and by 100 in high precision mode (11025 Hz fails both)
+	const WDL_INT64 periodSamples = GetPeriodSamples(samplerate, refreshRateInHz);
+	const WDL_INT64 gatingSamples = (samplerate + 5) / 10; // same as ebur128's samples_in_100ms
+	return periodSamples > 0 && periodSamples % (gatingSamples * 10) == 0;
+}
+
+static ebur128_state* InitLoudnessState (int channels, int channelMode, int samplerate, int mode)
+{
+	ebur128_state* loudnessState = ebur128_init((size_t)channels, (size_t)samplerate, mode);
+
+	// Ignore channels according to channel mode. Note: we can't partially request samples, i.e. channel mode is mono, but take is stereo...asking for
+	// 1 channel only won't work. We must always request the real channel count even though reaper interleaves active channels starting from 0
+	if (channelMode > 1)
+	{
+		// Mono channel modes
+		if (channelMode <= 66)
+		{
+			ebur128_set_channel(loudnessState, 0, EBUR128_LEFT);
+			for (int i = 1; i <= channels; ++i)
+				ebur128_set_channel(loudnessState, i, EBUR128_UNUSED);
+		}
+		// Stereo channel modes
+		else
+		{
+			ebur128_set_channel(loudnessState, 0, EBUR128_LEFT);
+			ebur128_set_channel(loudnessState, 1, EBUR128_RIGHT);
+			for (int i = 2; i <= channels; ++i)
+				ebur128_set_channel(loudnessState, i, EBUR128_UNUSED);
+		}
+	}
+	else
+	{
+		ebur128_set_channel(loudnessState, 0, EBUR128_LEFT);
+		ebur128_set_channel(loudnessState, 1, EBUR128_RIGHT);
+		ebur128_set_channel(loudnessState, 2, EBUR128_CENTER);
+		ebur128_set_channel(loudnessState, 3, EBUR128_LEFT_SURROUND);
+		ebur128_set_channel(loudnessState, 4, EBUR128_RIGHT_SURROUND);
+	}
+	return loudnessState;
+}
+
 unsigned WINAPI BR_LoudnessObject::AnalyzeData (void* loudnessObject)
 {
 	// Analyze results that get saved at the end
@@ -1012,6 +1193,7 @@ unsigned WINAPI BR_LoudnessObject::AnalyzeData (void* loudnessObject)
 	// Get take/track info
 	BR_LoudnessObject* _this = (BR_LoudnessObject*)loudnessObject;
 	BR_LoudnessObject::AudioData data = _this->GetAudioData();
+	vector<AudioAccessor*> chunkAccessors = _this->GetChunkAccessors();
 
 	const bool doPan               = data.channels > 1              && data.pan != 0; // tracks will always get false here (see CheckSetAudioData())
 	const bool doVolEnv            = data.volEnv.CountPoints()      && data.volEnv.IsActive();
@@ -1030,44 +1212,12 @@ unsigned WINAPI BR_LoudnessObject::AnalyzeData (void* loudnessObject)
 	const double itemPos = _this->m_take ?
 		GetMediaItemInfo_Value(_this->GetItem(), "D_POSITION") : 0.0;
 
-	// Prepare ebur123_state
-	ebur128_state* loudnessState = NULL;
+	// Prepare ebur123_state mode
 	int mode = integratedOnly ? EBUR128_MODE_I : EBUR128_MODE_M | EBUR128_MODE_S | EBUR128_MODE_I | EBUR128_MODE_LRA;
 	if (!integratedOnly && doTruePeak)
 		mode |= EBUR128_MODE_TRUE_PEAK;
-	loudnessState = ebur128_init((size_t)data.channels, (size_t)data.samplerate, mode);
-
-	// Ignore channels according to channel mode. Note: we can't partially request samples, i.e. channel mode is mono, but take is stereo...asking for
-	// 1 channel only won't work. We must always request the real channel count even though reaper interleaves active channels starting from 0
-	if (data.channelMode > 1)
-	{
-		// Mono channel modes
-		if (data.channelMode <= 66)
-		{
-			ebur128_set_channel(loudnessState, 0, EBUR128_LEFT);
-			for (int i = 1; i <= data.channels; ++i)
-				ebur128_set_channel(loudnessState, i, EBUR128_UNUSED);
-		}
-		// Stereo channel modes
-		else
-		{
-			ebur128_set_channel(loudnessState, 0, EBUR128_LEFT);
-			ebur128_set_channel(loudnessState, 1, EBUR128_RIGHT);
-			for (int i = 2; i <= data.channels; ++i)
-				ebur128_set_channel(loudnessState, i, EBUR128_UNUSED);
-		}
-	}
-	else
-	{
-		ebur128_set_channel(loudnessState, 0, EBUR128_LEFT);
-		ebur128_set_channel(loudnessState, 1, EBUR128_RIGHT);
-		ebur128_set_channel(loudnessState, 2, EBUR128_CENTER);
-		ebur128_set_channel(loudnessState, 3, EBUR128_LEFT_SURROUND);
-		ebur128_set_channel(loudnessState, 4, EBUR128_RIGHT_SURROUND);
-	}
 
 	bool doShortTerm = true;
-	bool doMomentary = true;
 
 	// This lets us get integrated reading even if the target is too short
 	const double effectiveEndTime = data.audioEnd;
@@ -1081,151 +1231,262 @@ unsigned WINAPI BR_LoudnessObject::AnalyzeData (void* loudnessObject)
 	// standard mode       =   5 Hz refresh rate (200 ms buffer)
 	// high precision mode = 100 Hz refresh rate ( 10 ms buffer)
 	const int refreshRateInHz = doHighPrecisionMode ? 100 : 5;
-	const double bufferTime = 1.0 / refreshRateInHz; // how many seconds in a buffer
-	const double sampleTimeLen = 1.0 / data.samplerate;
 	const double audioLength = data.audioEnd - data.audioStart;
+	const int blockSampleCount = data.samplerate / refreshRateInHz;
 
-	int sampleCount = data.samplerate / refreshRateInHz;
-	int bufSz = sampleCount * data.channels;
-	double currentTime = data.audioStart;
-	bool momentaryFilled = true;
-	int processedSamples = 0;
-	int i = 0;
-
-	while (currentTime < data.audioEnd && !_this->GetKillFlag())
+	// Volume and envelopes get rendered into a per-frame gain curve once per buffer, pan is constant per channel (takes have no pan law!)
+	vector<double> channelGain(data.channels, 1);
+	if (doPan)
 	{
-		// Make sure we always fill our buffer exactly to audio end (and skip momentary/short-term intervals if not enough new samples)
-		bool skipIntervals = false;
-		const double remainingTime = data.audioEnd - currentTime; // how many seconds until the end of the audio source
-		if (remainingTime < bufferTime + numeric_limits<double>::epsilon())
+		for (int channel = 0; channel < data.channels; ++channel)
 		{
-			sampleCount = static_cast<int>(data.samplerate * remainingTime);
-			bufSz = sampleCount * data.channels;
-			skipIntervals = true;
+			if (data.pan > 0 && channel % 2 == 0)      channelGain[channel] = 1 - data.pan;
+			else if (data.pan < 0 && channel % 2 == 1) channelGain[channel] = 1 + data.pan;
 		}
+	}
+	if (doVolEnv)      data.volEnv.Sort();
+	if (doVolPreFXEnv) data.volEnvPreFX.Sort();
+
+	// Long targets get split into chunks that are analyzed in parallel (see PrepareChunks()). Every chunk that doesn't start at the beginning of the
+	// target starts analyzing CHUNK_WARM_UP_TIME earlier so filters and momentary/short-term windows are warmed up once its own audio starts
+	// (overlap-and-discard). Chunk boundaries are kept on multiples of that period so gating blocks and momentary/short-term intervals line
+	// up with what a serial analysis would produce - per-block results of all chunks then get merged as if the whole target was analyzed in one go.
+	// Samplerates where that period doesn't line up with ebur128's blocks get analyzed serially (see CanSplitAnalysis())
+	const WDL_INT64 totalSamples  = (WDL_INT64)(audioLength * data.samplerate);
+	const WDL_INT64 periodSamples = GetPeriodSamples(data.samplerate, refreshRateInHz);
+	const bool      canSplit      = CanSplitAnalysis(data.samplerate, refreshRateInHz);
+	const WDL_INT64 gatingSamples = (data.samplerate + 5) / 10; // same as ebur128's samples_in_100ms
+
+	// When only envelopes changed since last analysis, reanalyze just the part of the target they affect (see CheckSetAudioData())
+	// and reuse per-block data of the last analysis for everything else
+	BR_LoudnessObject::BlockData blockData = _this->GetBlockData();
+	WDL_INT64 rangeStart = 0;
+	WDL_INT64 rangeEnd   = totalSamples;
+	double changedStart, changedEnd;
+	_this->GetChangedRange(&changedStart, &changedEnd);
+	if (changedStart >= 0 && canSplit &&
+	    blockData.valid && blockData.samplerate == data.samplerate && blockData.highPrecisionMode == doHighPrecisionMode &&
+	    (integratedOnly || !blockData.integratedOnly) && (!doTruePeak || integratedOnly || blockData.truePeak)
+	)
+	{
+		// Momentary/short-term windows and loudness range blocks that include changed audio need to be recalculated too
+		rangeStart = ((WDL_INT64)(changedStart * data.samplerate) / periodSamples) * periodSamples;
+		rangeEnd   = ((WDL_INT64)((changedEnd + 3) * data.samplerate) / periodSamples + 1) * periodSamples;
+		if (rangeEnd >= totalSamples || rangeStart >= rangeEnd)
+			rangeEnd = totalSamples;
+		if (rangeStart >= totalSamples)
+			rangeStart = 0;
+
+		// Splicing relies on the range starting on a period boundary and covering every 3 s window that overlaps changed audio,
+		// if that's ever not the case reanalyze everything instead of splicing misaligned blocks
+		if (rangeStart % periodSamples != 0 || (rangeEnd != totalSamples && (rangeEnd % periodSamples != 0 || rangeEnd < (WDL_INT64)((changedEnd + 3) * data.samplerate))))
+		{
+			rangeStart = 0;
+			rangeEnd   = totalSamples;
+		}
+	}
+	if (rangeStart == 0 && rangeEnd == totalSamples)
+		blockData = BR_LoudnessObject::BlockData();
 
-		// Get new 200 ms (or 10 ms in high precision mode) of samples
-		// GetAudioAccessorSamples() stops writing to the buffer once it reaches the item's end, everything from that point to sampleCount is garbage
-		std::vector<double> samples(bufSz);
-		GetAudioAccessorSamples(data.audio, data.samplerate, data.channels, currentTime, sampleCount, &samples[0]);
+	int chunkCount = (int)chunkAccessors.size() + 1;
+	WDL_INT64 chunkSamples = rangeEnd - rangeStart;
+	if (chunkCount > 1 && canSplit)
+	{
+		chunkSamples = ((rangeEnd - rangeStart) / chunkCount / periodSamples + 1) * periodSamples;
+		chunkCount   = (int)((rangeEnd - rangeStart + chunkSamples - 1) / chunkSamples);
+	}
+	else
+		chunkCount = 1;
 
-		// Correct for volume and pan/volume envelopes
-		int currentChannel = 1;
-		double sampleTime = currentTime;
+	if ((int)_this->m_chunkBuffers.size() < chunkCount)
+		_this->m_chunkBuffers.resize(chunkCount);
 
-		for (double &sample : samples)
+	auto initChunk = [&](BR_LoudnessObject::AnalyzeChunk& chunk, AudioAccessor* audio, BR_LoudnessObject::ChunkBuffers* buffers, WDL_INT64 startSample, WDL_INT64 endSample, std::atomic<WDL_INT64>* processedSamples)
+	{
+		chunk.data              = data;
+		chunk.data.audio        = audio;
+		chunk.buffers           = buffers;
+		chunk.state             = InitLoudnessState(data.channels, data.channelMode, data.samplerate, mode);
+		chunk.startSample       = startSample;
+		chunk.endSample         = endSample;
+		chunk.warmUpSamples     = (chunk.startSample == 0) ? 0 : periodSamples;
+		chunk.final             = (chunk.endSample >= totalSamples);
+		chunk.recordBlocks      = (chunk.warmUpSamples == 0);
+		chunk.processedSamples  = processedSamples;
+		chunk.periodSamples     = periodSamples;
+		chunk.channelGain       = &channelGain[0];
+		chunk.itemPos           = itemPos;
+		chunk.effectiveEndTime  = effectiveEndTime;
+		chunk.refreshRateInHz   = refreshRateInHz;
+		chunk.integratedOnly    = integratedOnly;
+		chunk.doTruePeak        = !integratedOnly && doTruePeak;
+		chunk.doPan             = doPan;
+		chunk.doVolEnv          = doVolEnv;
+		chunk.doVolPreFXEnv     = doVolPreFXEnv;
+		chunk.doShortTerm       = doShortTerm;
+
+		// Buffers are owned by the object and only grow, so once they're big enough analyzing doesn't touch the heap at all
+		chunk.buffers->samples[0].Reserve(blockSampleCount * data.channels);
+		chunk.buffers->samples[1].Reserve(blockSampleCount * data.channels);
+		chunk.buffers->gainCurve.Reserve(blockSampleCount + 1);
+		chunk.buffers->envValues.Reserve(blockSampleCount + 1);
+
+		const double chunkLength = (double)(chunk.endSample - chunk.startSample) / data.samplerate;
+		chunk.gatingEnergies.reserve((size_t)(chunkLength * 10) + 2);
+		if (!integratedOnly)
 		{
-			double adjust = 1;
-
-			// Volume envelopes
-			if (doVolPreFXEnv)
-				adjust *= data.volEnvPreFX.ValueAtPosition(sampleTime, true);
-			if (doVolEnv) 
-				adjust *= data.volEnv.ValueAtPosition(sampleTime + itemPos, true);
-
-			// Volume fader
-			adjust *= data.volume;
+			chunk.momentaryValues.reserve((size_t)(chunkLength * refreshRateInHz / 2) + 2);
+			chunk.shortTermValues.reserve((size_t)(chunkLength * refreshRateInHz / 15) + 2);
+			chunk.shortTermEnergies.reserve((size_t)chunkLength + 2);
+		}
+	};
 
-			// Pan fader (takes only)
-			if (doPan)
-			{
-				if (data.pan > 0 && (currentChannel % 2 == 1))
-					adjust *= 1 - data.pan; // takes have no pan law!
-				else if (data.pan < 0 && (currentChannel % 2 == 0))
-					adjust *= 1 + data.pan;
-			}
+	std::atomic<WDL_INT64> processedSamples(0);
+	WDL_INT64 samplesToProcess = 0;
+	vector<BR_LoudnessObject::AnalyzeChunk> chunks(chunkCount);
+	for (int i = 0; i < chunkCount; ++i)
+	{
+		const WDL_INT64 startSample = rangeStart + (WDL_INT64)i * chunkSamples;
+		initChunk(chunks[i], (i == 0) ? data.audio : chunkAccessors[i - 1], &_this->m_chunkBuffers[i], startSample, min(startSample + chunkSamples, rangeEnd), &processedSamples);
+		samplesToProcess += chunks[i].endSample - chunks[i].startSample + chunks[i].warmUpSamples;
+	}
+	for (int i = 0; i < chunkCount; ++i)
+		chunks[i].totalSamples = samplesToProcess;
 
-			sample *= adjust;
+	// First chunk gets analyzed on this thread
+	vector<std::thread> chunkThreads;
+	for (int i = 1; i < chunkCount; ++i)
+		chunkThreads.push_back(std::thread(&BR_LoudnessObject::AnalyzeChunkData, _this, &chunks[i]));
+	BR_LoudnessObject::AnalyzeChunkData(_this, &chunks[0]);
+	for (size_t i = 0; i < chunkThreads.size(); ++i)
+		chunkThreads[i].join();
 
-			if (++currentChannel > data.channels)
-				currentChannel = 1;
+	for (int i = 0; i < chunkCount; ++i)
+		ebur128_destroy(&chunks[i].state);
 
-			if (currentChannel + 1 > data.channels)
-				sampleTime = sampleTime + sampleTimeLen;
+	if (!_this->GetKillFlag())
+	{
+		// Merge chunks with per-block data of the last analysis (chunks are consecutive so they can be spliced in one after another).
+		// rangeStart is a multiple of periodSamples here, so all offsets are exact
+		const WDL_INT64 startBlock = rangeStart / blockSampleCount;
+		size_t gatingOffset    = rangeStart ? (size_t)(rangeStart / gatingSamples - 3)        : 0; // first block after warm-up ends 100 ms after chunk start, serial analysis gets the first one at 400 ms
+		size_t shortTermOffset = rangeStart ? (size_t)(rangeStart / (gatingSamples * 10) - 2) : 0; // same for loudness range blocks (3 s long, 1 s apart)
+		size_t momentaryOffset = (size_t)(startBlock / 2);
+		size_t intervalOffset  = (size_t)(startBlock / 15);
+		size_t periodOffset    = (size_t)(rangeStart / max(periodSamples, (WDL_INT64)1));
+
+		if (rangeStart == 0 && rangeEnd == totalSamples)
+		{
+			blockData = BR_LoudnessObject::BlockData();
 		}
-
-		ebur128_add_frames_double(loudnessState, &samples[0], sampleCount);
-
-		if (!integratedOnly && !skipIntervals)
+		else
 		{
-			if (!doShortTerm && doMomentary)
-			{
-				if (currentTime + bufferTime >= effectiveEndTime + numeric_limits<double>::epsilon())
-					doMomentary = false;
-			}
-
-			// Momentary buffer (400 ms) filled
-			if ((i % 2 > 0) == momentaryFilled && doMomentary)
-			{
-				double momentary;
-				ebur128_loudness_momentary(loudnessState, &momentary);
-				if (momentary == -HUGE_VAL)
-					momentary = NEGATIVE_INF;
-				if (momentary > momentaryMax)
-					momentaryMax = momentary;
-				momentaryValues.push_back(momentary);
-			}
+			_this->GetAnalyzeData(NULL, NULL, NULL, NULL, NULL, NULL, &shortTermValues, &momentaryValues);
+		}
 
-			// Short-term buffer (3000 ms) filled
-			if (i == 14 && doShortTerm)
+		const bool toEnd = chunks.back().final;
+		for (int i = 0; i < chunkCount; ++i)
+		{
+			BR_LoudnessObject::AnalyzeChunk& chunk = chunks[i];
+			SpliceValues(blockData.gatingEnergies, gatingOffset, chunk.gatingEnergies, toEnd && i == chunkCount - 1);
+			gatingOffset += chunk.gatingEnergies.size();
+			if (!integratedOnly)
 			{
-				double shortTerm;
-				ebur128_loudness_shortterm(loudnessState, &shortTerm);
-				if (shortTerm == -HUGE_VAL)
-					shortTerm = NEGATIVE_INF;
-				if (shortTerm > shortTermMax)
-					shortTermMax = shortTerm;
-				shortTermValues.push_back(shortTerm);
+				SpliceValues(blockData.shortTermEnergies, shortTermOffset, chunk.shortTermEnergies, toEnd && i == chunkCount - 1);
+				SpliceValues(momentaryValues,             momentaryOffset, chunk.momentaryValues,   toEnd && i == chunkCount - 1);
+				SpliceValues(shortTermValues,             intervalOffset,  chunk.shortTermValues,   toEnd && i == chunkCount - 1);
+				shortTermOffset += chunk.shortTermEnergies.size();
+				momentaryOffset += chunk.momentaryValues.size();
+				intervalOffset  += chunk.shortTermValues.size();
+				if (doTruePeak)
+				{
+					SpliceValues(blockData.periodPeaks,   periodOffset, chunk.periodPeaks,   toEnd && i == chunkCount - 1);
+					SpliceValues(blockData.periodPeakPos, periodOffset, chunk.periodPeakPos, toEnd && i == chunkCount - 1);
+					periodOffset += chunk.periodPeaks.size();
+				}
 			}
 		}
 
-		// This is definitely more accurate than adding 0.2 seconds every time
-		processedSamples += sampleCount;
-		currentTime = data.audioStart + ((double)processedSamples / (double)data.samplerate);
-
-		_this->SetProgress ((currentTime - data.audioStart) / audioLength * 0.95); // loudness_global and loudness_range seem rather fast and since we currently
-		if (++i == 15)                                                             // can't monitor their progress, leave last 10% of progress for them
+		// Get integrated and loudness range
+		if (blockData.gatingEnergies.size())
+			ebur128_loudness_global_energies(&blockData.gatingEnergies[0], blockData.gatingEnergies.size(), &integrated);
+		else
+			integrated = -HUGE_VAL;
+		if (!integratedOnly)
 		{
-			i = 0;
-			momentaryFilled = !momentaryFilled;
-		}
+			if (blockData.shortTermEnergies.size())
+				ebur128_loudness_range_energies(&blockData.shortTermEnergies[0], blockData.shortTermEnergies.size(), &range);
 
-		// We reached the end of the file, break without checking currentTime against endTime (rounding errors could make us go through loop one more time)
-		if (skipIntervals)
-			break;
-	}
+			for (size_t i = 0; i < momentaryValues.size(); ++i)
+				if (momentaryValues[i] > momentaryMax) momentaryMax = momentaryValues[i];
+			for (size_t i = 0; i < shortTermValues.size(); ++i)
+				if (shortTermValues[i] > shortTermMax) shortTermMax = shortTermValues[i];
 
-	// Get integrated and loudness range
-	if (!_this->GetKillFlag())
-	{
-		ebur128_loudness_global(loudnessState, &integrated);
-		if (!integratedOnly)
-		{
-			ebur128_loudness_range(loudnessState, &range);
 			if (doTruePeak)
 			{
-				for (int i = 0; i < data.channels; ++i)
+				for (size_t i = 0; i < blockData.periodPeaks.size(); ++i)
 				{
-					double channelTruePeak, channelTruePeakPos;
-					ebur128_true_peak(loudnessState, i, &channelTruePeak, &channelTruePeakPos);
-					if (channelTruePeak > truePeak)
+					if (blockData.periodPeaks[i] > truePeak)
 					{
-						truePeak    = channelTruePeak;
-						truePeakPos = channelTruePeakPos;
+						truePeak    = blockData.periodPeaks[i];
+						truePeakPos = blockData.periodPeakPos[i];
 					}
 				}
-				truePeak = VAL2DB(truePeak);
+				if (blockData.periodPeaks.size())
+					truePeak = VAL2DB(truePeak);
 				_this->SetTruePeakAnalyzed(true);
 			}
+		}
+		else
+		{
+			momentaryValues.clear();
+			shortTermValues.clear();
+		}
 
+		#ifdef _SWS_DEBUG
+		// Merged (or spliced) results have to match serial analysis of the whole target (only filter state after warm-up differs, in the last few digits)
+		if (chunkCount > 1 || rangeStart > 0 || rangeEnd < totalSamples)
+		{
+			std::atomic<WDL_INT64> serialProcessedSamples(0);
+			BR_LoudnessObject::AnalyzeChunk serial;
+			initChunk(serial, data.audio, &_this->m_chunkBuffers[0], 0, totalSamples, &serialProcessedSamples);
+			serial.totalSamples = totalSamples;
+			BR_LoudnessObject::AnalyzeChunkData(_this, &serial);
+			ebur128_destroy(&serial.state);
+
+			if (!_this->GetKillFlag())
+			{
+				double serialIntegrated = -HUGE_VAL, serialRange = 0;
+				if (serial.gatingEnergies.size())
+					ebur128_loudness_global_energies(&serial.gatingEnergies[0], serial.gatingEnergies.size(), &serialIntegrated);
+				if (!integratedOnly && serial.shortTermEnergies.size())
+					ebur128_loudness_range_energies(&serial.shortTermEnergies[0], serial.shortTermEnergies.size(), &serialRange);
+
+				const bool match = serial.gatingEnergies.size() == blockData.gatingEnergies.size() && (serialIntegrated == integrated || fabs(serialIntegrated - integrated) < 1e-6) &&
+				                   (integratedOnly || (serial.shortTermEnergies.size() == blockData.shortTermEnergies.size() && fabs(serialRange - range) < 1e-6 &&
+				                                       serial.momentaryValues.size() == momentaryValues.size() && serial.shortTermValues.size() == shortTermValues.size()));
+				if (!match)
+					dprintf("BR_LoudnessObject::AnalyzeData: %d chunks, range %lld-%lld of %lld samples @ %d Hz: I %f (serial %f), LRA %f (serial %f), blocks %d/%d (serial %d/%d)\n",
+					        chunkCount, (long long)rangeStart, (long long)rangeEnd, (long long)totalSamples, data.samplerate, integrated, serialIntegrated, range, serialRange,
+					        (int)blockData.gatingEnergies.size(), (int)blockData.shortTermEnergies.size(), (int)serial.gatingEnergies.size(), (int)serial.shortTermEnergies.size());
+			}
 		}
+		#endif
+
+		blockData.samplerate        = data.samplerate;
+		blockData.integratedOnly    = integratedOnly;
+		blockData.highPrecisionMode = doHighPrecisionMode;
+		blockData.truePeak          = !integratedOnly && doTruePeak;
+		blockData.valid             = true;
+		_this->SetBlockData(blockData);
 	}
-	ebur128_destroy(&loudnessState);
 
 	// Write analyze data
 	if (!_this->GetKillFlag())
 	{
+		_this->SetChangedRange(-1, -1);
 		_this->SetAnalyzeData(integrated, range, truePeak, truePeakPos, shortTermMax, momentaryMax, shortTermValues, momentaryValues);
+		_this->StoreToCache();
 		_this->SetProgress(1);
 		_this->SetRunning(false);
 		if (!integratedOnly)
@@ -1235,92 +1496,606 @@ unsigned WINAPI BR_LoudnessObject::AnalyzeData (void* loudnessObject)
 	return 0;
 }
 
-int BR_LoudnessObject::CheckSetAudioData ()
+void BR_LoudnessObject::AnalyzeChunkData (BR_LoudnessObject* _this, BR_LoudnessObject::AnalyzeChunk* chunk)
 {
-	SWS_SectionLock lock(&m_mutex);
-	if (!this->IsTargetValid())
-		return 0;
+	BR_LoudnessObject::AudioData& data = chunk->data;
 
-	BR_LoudnessObject::AudioData audioData = this->GetAudioData();
+	const double bufferTime       = 1.0 / chunk->refreshRateInHz; // how many seconds in a buffer
+	const double sampleTimeLen    = 1.0 / data.samplerate;
+	const int    blockSampleCount = data.samplerate / chunk->refreshRateInHz;
+	const WDL_INT64 firstSample   = chunk->startSample - chunk->warmUpSamples;
 
-	char newHash[128]; memset(newHash, 0, 128);
-	GetAudioAccessorHash(audioData.audio, newHash);
+	double* gainCurve = chunk->buffers->gainCurve.Get();
+	double* envValues = chunk->buffers->envValues.Get();
 
-	double audioStart = GetAudioAccessorStartTime(audioData.audio);
-	double audioEnd   = GetAudioAccessorEndTime(audioData.audio);
-	int channels    = (this->GetTrack()) ? ((int)GetMediaTrackInfo_Value(this->GetTrack(), "I_NCHAN")) : ((GetMediaItemTake_Source(this->GetTake()))->GetNumChannels());
-	int channelMode = (this->GetTrack()) ? (0) : (*(int*)GetSetMediaItemTakeInfo(this->GetTake(), "I_CHANMODE", NULL));
-	int samplerate = (int)(1 / parse_timestr_len("1", 0, 4)); // NF: https://forum.cockos.com/showpost.php?p=2060657&postcount=15
+	bool doMomentary = true;
+	bool momentaryFilled = true;
+	int i = 0;
 
-	BR_Envelope volEnv, volEnvPreFX;
-	double volume = 0, pan = 0;
-	if (this->GetTrack())
+	// Keep energies of all blocks so integrated and loudness range can be calculated from merged chunks (or recalculated later when only part of the target changes)
+	ebur128_set_block_callback(chunk->state, [](void* userdata, int type, double energy)
 	{
-		volume = *(double*)GetSetMediaTrackInfo(this->GetTrack(), "D_VOL", NULL);
-		pan = 0; // ignore track pan
-		volEnv = BR_Envelope(GetVolEnv(this->GetTrack()));
-		volEnvPreFX = BR_Envelope(GetVolEnvPreFX(this->GetTrack()));
-	}
-	else
+		BR_LoudnessObject::AnalyzeChunk* chunk = (BR_LoudnessObject::AnalyzeChunk*)userdata;
+		if (chunk->recordBlocks)
+		{
+			if (type == EBUR128_BLOCK_GATING) chunk->gatingEnergies.push_back(energy);
+			else                              chunk->shortTermEnergies.push_back(energy);
+		}
+	}, chunk);
+
+	// True peak is kept for every period so it can be found again without analyzing everything (peak positions are relative to state's first sample)
+	const double stateStartTime = (double)firstSample / (double)data.samplerate;
+	auto storePeriodPeak = [&]()
 	{
-		volume = (*(double*)GetSetMediaItemTakeInfo(this->GetTake(), "D_VOL", NULL)) * (*(double*)GetSetMediaItemInfo(this->GetItem(), "D_VOL", NULL));
-		pan = *(double*)GetSetMediaItemTakeInfo(this->GetTake(), "D_PAN", NULL);
-		volEnv = BR_Envelope(this->GetTake(), VOLUME);
+		double peak = 0, peakPos = stateStartTime;
+		for (int channel = 0; channel < data.channels; ++channel)
+		{
+			double channelTruePeak, channelTruePeakPos;
+			ebur128_true_peak(chunk->state, channel, &channelTruePeak, &channelTruePeakPos);
+			if (channelTruePeak > peak)
+			{
+				peak    = channelTruePeak;
+				peakPos = channelTruePeakPos + stateStartTime;
+			}
+		}
+		chunk->periodPeaks.push_back(peak);
+		chunk->periodPeakPos.push_back(peakPos);
+		ebur128_reset_peaks(chunk->state);
+	};
+
+	// Samples are read (and corrected for volume/pan) one block ahead on a separate thread while ebur128 consumes the current block
+	struct SampleBlock
+	{
+		double* samples;
+		WDL_INT64 start;
+		int sampleCount;
+		bool filled, last;
+	};
+	SampleBlock blocks[2];
+	for (int b = 0; b < 2; ++b)
+	{
+		blocks[b].samples     = chunk->buffers->samples[b].Get();
+		blocks[b].start       = 0;
+		blocks[b].sampleCount = 0;
+		blocks[b].filled      = false;
+		blocks[b].last        = false;
 	}
 
-	if (!this->GetAnalyzedStatus()                       ||
-	    AudioAccessorValidateState(audioData.audio)      ||
-	    strcmp(newHash, audioData.audioHash)             ||
-	    audioStart   != audioData.audioStart             ||
-	    audioEnd     != audioData.audioEnd               ||
-	    channels     != audioData.channels               ||
-	    channelMode  != audioData.channelMode            ||
-	    samplerate   != audioData.samplerate             ||
-	    fabs(volume - audioData.volume) >= VOLUME_DELTA  ||
-	    fabs(pan    - audioData.pan)    >= PAN_DELTA     ||
-	    volEnv       != audioData.volEnv                 ||
-	    volEnvPreFX  != audioData.volEnvPreFX
-	)
+	std::mutex pumpMutex;
+	std::condition_variable pumpCond;
+	bool readerDone  = false;
+	bool stopReading = false;
+
+	std::thread reader([&]()
 	{
-		DestroyAudioAccessor(audioData.audio);
-		audioData.audio = (this->GetTrack()) ? (CreateTrackAudioAccessor(this->GetTrack())) : (CreateTakeAudioAccessor(this->GetTake()));
-		memset(audioData.audioHash, 0, 128);
-		GetAudioAccessorHash(audioData.audio, audioData.audioHash);
+		WDL_INT64 readSamples = firstSample;
+		double readTime = data.audioStart + ((double)readSamples / (double)data.samplerate);
+		for (int b = 0; readTime < data.audioEnd && !_this->GetKillFlag(); b = !b)
+		{
+			SampleBlock& block = blocks[b];
+			{
+				std::unique_lock<std::mutex> lock(pumpMutex);
+				pumpCond.wait(lock, [&]() { return !block.filled || stopReading; });
+				if (stopReading)
+					break;
+			}
 
-		audioData.audioStart   = GetAudioAccessorStartTime(audioData.audio);
-		audioData.audioEnd     = GetAudioAccessorEndTime(audioData.audio);
-		audioData.channels     = channels;
-		audioData.channelMode  = channelMode;
-		audioData.samplerate   = samplerate;
-		audioData.volume       = volume;
-		audioData.pan          = pan;
-		audioData.volEnv       = volEnv;
-		audioData.volEnvPreFX  = volEnvPreFX;
+			int sampleCount = blockSampleCount;
+			bool last = false;
+			if (chunk->final)
+			{
+				// Make sure we always fill our buffer exactly to audio end (and skip momentary/short-term intervals if not enough new samples)
+				const double remainingTime = data.audioEnd - readTime; // how many seconds until the end of the audio source
+				if (remainingTime < bufferTime + numeric_limits<double>::epsilon())
+				{
+					sampleCount = static_cast<int>(data.samplerate * remainingTime);
+					last = true;
+				}
+			}
+			else if (readSamples + sampleCount >= chunk->endSample)
+			{
+				sampleCount = (int)(chunk->endSample - readSamples);
+				last = true;
+			}
 
-		this->SetAudioData(audioData);
+			// Get new 200 ms (or 10 ms in high precision mode) of samples
+			// GetAudioAccessorSamples() stops writing to the buffer once it reaches the item's end, everything from that point to sampleCount is garbage
+			GetAudioAccessorSamples(data.audio, data.samplerate, data.channels, readTime, sampleCount, block.samples);
 
-		this->SetAnalyzedStatus(false);
-		this->SetTruePeakAnalyzed(false);
-		return 2;
-	}
-	else
-		return 1;
-}
+			// Correct for volume and pan/volume envelopes
+			std::fill(gainCurve, gainCurve + sampleCount, data.volume);
+			if (chunk->doVolPreFXEnv)
+			{
+				data.volEnvPreFX.FillValues(readTime, sampleTimeLen, sampleCount, envValues);
+				MultiplyBuffer(gainCurve, envValues, sampleCount);
+			}
+			if (chunk->doVolEnv)
+			{
+				data.volEnv.FillValues(readTime + chunk->itemPos, sampleTimeLen, sampleCount, envValues);
+				MultiplyBuffer(gainCurve, envValues, sampleCount);
+			}
+			ApplyGainCurve(block.samples, gainCurve, chunk->channelGain, sampleCount, data.channels);
 
-void BR_LoudnessObject::SetAudioData (const BR_LoudnessObject::AudioData& audioData)
-{
-	SWS_SectionLock lock(&m_mutex);
-	m_audioData = audioData;
-}
+			{
+				std::lock_guard<std::mutex> lock(pumpMutex);
+				block.start       = readSamples;
+				block.sampleCount = sampleCount;
+				block.last        = last;
+				block.filled      = true;
+			}
+			pumpCond.notify_all();
 
-BR_LoudnessObject::AudioData BR_LoudnessObject::GetAudioData ()
-{
-	SWS_SectionLock lock(&m_mutex);
-	return m_audioData;
-}
+			// We reached the end, stop without checking readTime against endTime (rounding errors could make us go through loop one more time)
+			if (last)
+				break;
 
-void BR_LoudnessObject::SetRunning (bool running)
-{
+			// This is definitely more accurate than adding 0.2 seconds every time
+			readSamples += sampleCount;
+			readTime = data.audioStart + ((double)readSamples / (double)data.samplerate);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(pumpMutex);
+			readerDone = true;
+		}
+		pumpCond.notify_all();
+	});
+
+	for (int b = 0; !_this->GetKillFlag(); b = !b)
+	{
+		SampleBlock& block = blocks[b];
+		{
+			std::unique_lock<std::mutex> lock(pumpMutex);
+			pumpCond.wait(lock, [&]() { return block.filled || readerDone; });
+			if (!block.filled)
+				break;
+		}
+
+		const int sampleCount     = block.sampleCount;
+		const bool last           = block.last;
+		const bool skipIntervals  = last && chunk->final;
+		const bool warmingUp      = block.start < chunk->startSample;
+		const double currentTime  = data.audioStart + ((double)block.start / (double)data.samplerate);
+
+		// Warm-up is done, forget everything measured so far (filters and audio history stay)
+		if (chunk->warmUpSamples && block.start == chunk->startSample)
+		{
+			ebur128_reset_measurements(chunk->state);
+			chunk->recordBlocks = true;
+		}
+		else if (chunk->doTruePeak && block.start > chunk->startSample && (block.start - chunk->startSample) % chunk->periodSamples == 0)
+		{
+			storePeriodPeak();
+		}
+
+		ebur128_add_frames_double(chunk->state, block.samples, sampleCount);
+
+		// Release the buffer to the reader as soon as ebur128 is done with it
+		{
+			std::lock_guard<std::mutex> lock(pumpMutex);
+			block.filled = false;
+		}
+		pumpCond.notify_all();
+
+		if (!chunk->integratedOnly && !skipIntervals && !warmingUp)
+		{
+			if (!chunk->doShortTerm && doMomentary)
+			{
+				if (currentTime + bufferTime >= chunk->effectiveEndTime + numeric_limits<double>::epsilon())
+					doMomentary = false;
+			}
+
+			// Momentary buffer (400 ms) filled
+			if ((i % 2 > 0) == momentaryFilled && doMomentary)
+			{
+				double momentary;
+				ebur128_loudness_momentary(chunk->state, &momentary);
+				if (momentary == -HUGE_VAL)
+					momentary = NEGATIVE_INF;
+				chunk->momentaryValues.push_back(momentary);
+			}
+
+			// Short-term buffer (3000 ms) filled
+			if (i == 14 && chunk->doShortTerm)
+			{
+				double shortTerm;
+				ebur128_loudness_shortterm(chunk->state, &shortTerm);
+				if (shortTerm == -HUGE_VAL)
+					shortTerm = NEGATIVE_INF;
+				chunk->shortTermValues.push_back(shortTerm);
+			}
+		}
+
+		// loudness_global and loudness_range seem rather fast and since we currently can't monitor their progress, leave last 5% of progress for them
+		const WDL_INT64 processedSamples = (*chunk->processedSamples += sampleCount);
+		_this->SetProgress(min(1.0, (double)processedSamples / (double)max(chunk->totalSamples, (WDL_INT64)1)) * 0.95);
+		if (++i == 15)
+		{
+			i = 0;
+			momentaryFilled = !momentaryFilled;
+		}
+
+		if (last)
+			break;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(pumpMutex);
+		stopReading = true;
+	}
+	pumpCond.notify_all();
+	reader.join();
+
+	if (chunk->doTruePeak && chunk->recordBlocks && !_this->GetKillFlag())
+		storePeriodPeak();
+	ebur128_set_block_callback(chunk->state, NULL, NULL);
+}
+
+void BR_LoudnessObject::PrepareChunks ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	for (size_t i = 0; i < m_chunkAccessors.size(); ++i)
+		DestroyAudioAccessor(m_chunkAccessors[i]);
+	m_chunkAccessors.clear();
+
+	// Every chunk needs its own accessor (accessors can't be read from multiple threads at once and have to be created on the main thread)
+	BR_LoudnessObject::AudioData audioData = this->GetAudioData();
+	int chunks = min(m_maxChunks, (int)((audioData.audioEnd - audioData.audioStart) / CHUNK_MIN_LENGTH));
+	if (!CanSplitAnalysis(audioData.samplerate, (this->GetDoHighPrecisionMode() && !this->GetIntegratedOnly()) ? 100 : 5))
+		chunks = 0; // AnalyzeData() will analyze serially anyway
+	for (int i = 1; i < chunks; ++i)
+	{
+		if (AudioAccessor* audio = (this->GetTrack()) ? (CreateTrackAudioAccessor(this->GetTrack())) : (CreateTakeAudioAccessor(this->GetTake())))
+			m_chunkAccessors.push_back(audio);
+	}
+}
+
+vector<AudioAccessor*> BR_LoudnessObject::GetChunkAccessors ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	return m_chunkAccessors;
+}
+
+void BR_LoudnessObject::SetBlockData (const BR_LoudnessObject::BlockData& blockData)
+{
+	SWS_SectionLock lock(&m_mutex);
+	m_blockData = blockData;
+}
+
+BR_LoudnessObject::BlockData BR_LoudnessObject::GetBlockData ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	return m_blockData;
+}
+
+void BR_LoudnessObject::SetChangedRange (double start, double end)
+{
+	SWS_SectionLock lock(&m_mutex);
+	m_changedStart = start;
+	m_changedEnd   = end;
+}
+
+void BR_LoudnessObject::GetChangedRange (double* start, double* end)
+{
+	SWS_SectionLock lock(&m_mutex);
+	WritePtr(start, m_changedStart);
+	WritePtr(end,   m_changedEnd);
+}
+
+bool BR_LoudnessObject::GetCacheKey (WDL_UINT64* key)
+{
+	SWS_SectionLock lock(&m_mutex);
+	if (!BR_LoudnessCache::Get().IsEnabled() || this->GetTrack() || !this->IsTargetValid())
+		return false;
+
+	// Track audio and take FX can't be identified reliably, same goes for sections and reversed sources (offsets are not exposed)
+	// and stretch markers (slopes are not exposed)
+	MediaItem_Take* take = this->GetTake();
+	MediaItem* item      = this->GetItem();
+	PCM_source* source   = GetMediaItemTake_Source(take);
+	if (!source || source->GetSource() || TakeFX_GetCount(take) > 0 || GetTakeNumStretchMarkers(take) > 0)
+		return false;
+
+	char fileName[SNM_MAX_PATH] = "";
+	GetMediaSourceFileName(source, fileName, sizeof(fileName));
+	if (!*fileName)
+		return false;
+
+	struct stat fileStat;
+	#ifdef _WIN32
+		if (statUTF8(fileName, &fileStat))
+	#else
+		if (stat(fileName, &fileStat))
+	#endif
+			return false;
+
+	BR_LoudnessObject::AudioData data = this->GetAudioData();
+	const WDL_INT64 fileInfo[] = {(WDL_INT64)fileStat.st_size, (WDL_INT64)fileStat.st_mtime};
+	const int intInfo[]        = {data.samplerate, data.channels, data.channelMode, VERSION};
+	const double takeInfo[]    =
+	{
+		source->GetLength(),
+		GetMediaItemTakeInfo_Value(take, "D_STARTOFFS"),
+		GetMediaItemTakeInfo_Value(take, "D_PLAYRATE"),
+		GetMediaItemTakeInfo_Value(take, "D_PITCH"),
+		GetMediaItemTakeInfo_Value(take, "B_PPITCH"),
+		GetMediaItemTakeInfo_Value(take, "I_PITCHMODE"),
+		GetMediaItemInfo_Value(item, "D_LENGTH"),
+		GetMediaItemInfo_Value(item, "B_LOOPSRC"),
+		GetMediaItemInfo_Value(item, "D_FADEINLEN"),
+		GetMediaItemInfo_Value(item, "D_FADEOUTLEN"),
+		GetMediaItemInfo_Value(item, "D_FADEINLEN_AUTO"),
+		GetMediaItemInfo_Value(item, "D_FADEOUTLEN_AUTO"),
+		GetMediaItemInfo_Value(item, "C_FADEINSHAPE"),
+		GetMediaItemInfo_Value(item, "C_FADEOUTSHAPE"),
+		GetMediaItemInfo_Value(item, "D_FADEINDIR"),
+		GetMediaItemInfo_Value(item, "D_FADEOUTDIR"),
+		data.audioStart,
+		data.audioEnd,
+		data.volume,
+		data.pan
+	};
+
+	WDL_UINT64 hash = FNV64_IV;
+	hash = FNV64(hash, (const unsigned char*)fileName, (int)strlen(fileName));
+	hash = FNV64(hash, (const unsigned char*)source->GetType(), (int)strlen(source->GetType()));
+	hash = FNV64(hash, (const unsigned char*)fileInfo, sizeof(fileInfo));
+	hash = FNV64(hash, (const unsigned char*)intInfo,  sizeof(intInfo));
+	hash = FNV64(hash, (const unsigned char*)takeInfo, sizeof(takeInfo));
+
+	BR_Envelope* envelopes[] = {&data.volEnv, &data.volEnvPreFX};
+	for (size_t i = 0; i < sizeof(envelopes) / sizeof(envelopes[0]); ++i)
+	{
+		const int active = envelopes[i]->IsActive() ? 1 : 0;
+		hash = FNV64(hash, (const unsigned char*)&active, sizeof(active));
+
+		for (int j = 0; j < envelopes[i]->CountPoints(); ++j)
+		{
+			double point[4] = {0, 0, 0, 0};
+			int shape = 0;
+			envelopes[i]->GetPoint(j, &point[0], &point[1], &shape, &point[2]);
+			point[3] = shape;
+			hash = FNV64(hash, (const unsigned char*)point, sizeof(point));
+		}
+	}
+
+	WritePtr(key, hash);
+	return true;
+}
+
+bool BR_LoudnessObject::RestoreFromCache ()
+{
+	SWS_SectionLock lock(&m_mutex);
+
+	const bool integratedOnly      = this->GetIntegratedOnly();
+	const bool doTruePeak          = this->GetDoTruePeak() && !integratedOnly;
+	const bool doHighPrecisionMode = this->GetDoHighPrecisionMode() && !integratedOnly;
+
+	BR_LoudnessCache::Entry entry;
+	if (!m_cacheKeyValid || !BR_LoudnessCache::Get().Find(m_cacheKey, integratedOnly, doTruePeak, doHighPrecisionMode, &entry))
+		return false;
+
+	// Mirror what AnalyzeData() would have written (per-block data is not cached so next change means analyzing everything again)
+	m_blockData = BR_LoudnessObject::BlockData();
+	if (integratedOnly)
+	{
+		this->SetAnalyzeData(entry.integrated, 0, NEGATIVE_INF, -1, NEGATIVE_INF, NEGATIVE_INF, vector<double>(), vector<double>());
+	}
+	else
+	{
+		this->SetAnalyzeData(entry.integrated, entry.range, doTruePeak ? entry.truePeak : NEGATIVE_INF, doTruePeak ? entry.truePeakPos : -1, entry.shortTermMax, entry.momentaryMax, entry.shortTermValues, entry.momentaryValues);
+		if (doTruePeak)
+			this->SetTruePeakAnalyzed(true);
+		this->SetAnalyzedStatus(true);
+	}
+	this->SetProgress(1);
+	this->SetRunning(false);
+	return true;
+}
+
+void BR_LoudnessObject::StoreToCache ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	if (!m_cacheKeyValid)
+		return;
+
+	BR_LoudnessCache::Entry entry;
+	entry.integratedOnly    = this->GetIntegratedOnly();
+	entry.truePeakAnalyzed  = this->GetDoTruePeak() && !entry.integratedOnly;
+	entry.highPrecisionMode = this->GetDoHighPrecisionMode() && !entry.integratedOnly;
+	this->GetAnalyzeData(&entry.integrated, &entry.range, &entry.truePeak, &entry.truePeakPos, &entry.shortTermMax, &entry.momentaryMax, &entry.shortTermValues, &entry.momentaryValues);
+
+	BR_LoudnessCache::Get().Add(m_cacheKey, entry);
+}
+
+static bool IsSameEnvelopePoint (BR_Envelope& env1, int id1, BR_Envelope& env2, int id2)
+{
+	double position1, value1, bezier1, position2, value2, bezier2;
+	int shape1, shape2;
+	env1.GetPoint(id1, &position1, &value1, &shape1, &bezier1);
+	env2.GetPoint(id2, &position2, &value2, &shape2, &bezier2);
+	return position1 == position2 && value1 == value2 && shape1 == shape2 && bezier1 == bezier2;
+}
+
+static int GetEnvelopeChange (BR_Envelope& oldEnv, BR_Envelope& newEnv, double* start, double* end)
+{
+	// Returns 0 if envelopes produce the same gain, 1 if they differ only between start and end and -1 if they
+	// differ everywhere (if the first/last point changed, start/end is unbounded since its value holds to the edge)
+	const bool oldActive = oldEnv.IsActive() && oldEnv.CountPoints();
+	const bool newActive = newEnv.IsActive() && newEnv.CountPoints();
+	if (!oldActive && !newActive)
+		return 0;
+	if (oldActive != newActive)
+		return -1;
+
+	const int oldCount = oldEnv.CountPoints();
+	const int newCount = newEnv.CountPoints();
+	const int minCount = min(oldCount, newCount);
+
+	int front = 0;
+	while (front < minCount && IsSameEnvelopePoint(oldEnv, front, newEnv, front))
+		++front;
+	if (front == oldCount && front == newCount)
+		return 0;
+
+	int back = 0;
+	while (back < minCount - front && IsSameEnvelopePoint(oldEnv, oldCount - 1 - back, newEnv, newCount - 1 - back))
+		++back;
+	if (front == 0 && back == 0)
+		return -1;
+
+	// Bezier segments are shaped by the points before and after them too (id-1 and nextId+1), so go one more
+	// unchanged point out on each side - the curve before that point can't see the change
+	double position;
+	if (front > 1) oldEnv.GetPoint(front - 2, &position, NULL, NULL, NULL);
+	WritePtr(start, (front > 1) ? position : -DBL_MAX);
+	if (back > 1) oldEnv.GetPoint(oldCount - back + 1, &position, NULL, NULL, NULL);
+	WritePtr(end, (back > 1) ? position : DBL_MAX);
+	return 1;
+}
+
+int BR_LoudnessObject::CheckSetAudioData ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	if (!this->IsTargetValid())
+		return 0;
+
+	BR_LoudnessObject::AudioData audioData = this->GetAudioData();
+
+	char newHash[128]; memset(newHash, 0, 128);
+	GetAudioAccessorHash(audioData.audio, newHash);
+
+	double audioStart = GetAudioAccessorStartTime(audioData.audio);
+	double audioEnd   = GetAudioAccessorEndTime(audioData.audio);
+	int channels    = (this->GetTrack()) ? ((int)GetMediaTrackInfo_Value(this->GetTrack(), "I_NCHAN")) : ((GetMediaItemTake_Source(this->GetTake()))->GetNumChannels());
+	int channelMode = (this->GetTrack()) ? (0) : (*(int*)GetSetMediaItemTakeInfo(this->GetTake(), "I_CHANMODE", NULL));
+	int samplerate = (int)(1 / parse_timestr_len("1", 0, 4)); // NF: https://forum.cockos.com/showpost.php?p=2060657&postcount=15
+
+	BR_Envelope volEnv, volEnvPreFX;
+	double volume = 0, pan = 0;
+	if (this->GetTrack())
+	{
+		volume = *(double*)GetSetMediaTrackInfo(this->GetTrack(), "D_VOL", NULL);
+		pan = 0; // ignore track pan
+		volEnv = BR_Envelope(GetVolEnv(this->GetTrack()));
+		volEnvPreFX = BR_Envelope(GetVolEnvPreFX(this->GetTrack()));
+	}
+	else
+	{
+		volume = (*(double*)GetSetMediaItemTakeInfo(this->GetTake(), "D_VOL", NULL)) * (*(double*)GetSetMediaItemInfo(this->GetItem(), "D_VOL", NULL));
+		pan = *(double*)GetSetMediaItemTakeInfo(this->GetTake(), "D_PAN", NULL);
+		volEnv = BR_Envelope(this->GetTake(), VOLUME);
+	}
+
+	// Only envelopes changed since last analysis (or since the change that is still waiting for reanalysis) - keep the audio
+	// accessor and per-block data and mark only the part of the target that needs to be reanalyzed (see AnalyzeData())
+	const bool audioChanged = AudioAccessorValidateState(audioData.audio) ||
+	                          strcmp(newHash, audioData.audioHash)        ||
+	                          audioStart   != audioData.audioStart        ||
+	                          audioEnd     != audioData.audioEnd          ||
+	                          channels     != audioData.channels          ||
+	                          channelMode  != audioData.channelMode       ||
+	                          samplerate   != audioData.samplerate        ||
+	                          fabs(volume - audioData.volume) >= VOLUME_DELTA ||
+	                          fabs(pan    - audioData.pan)    >= PAN_DELTA;
+	const bool envChanged = volEnv != audioData.volEnv || volEnvPreFX != audioData.volEnvPreFX;
+
+	double changedStart, changedEnd;
+	this->GetChangedRange(&changedStart, &changedEnd);
+	if (!audioChanged && this->GetBlockData().valid && (this->GetAnalyzedStatus() || changedStart >= 0))
+	{
+		if (!envChanged && this->GetAnalyzedStatus())
+			return 1;
+
+		bool incremental = true;
+		if (envChanged)
+		{
+			const double audioLength = audioData.audioEnd - audioData.audioStart;
+			const double itemPos = (this->GetTake()) ? GetMediaItemInfo_Value(this->GetItem(), "D_POSITION") : 0;
+
+			double start = DBL_MAX, end = -DBL_MAX, envStart, envEnd;
+			int change;
+			if ((change = GetEnvelopeChange(audioData.volEnv, volEnv, &envStart, &envEnd)) == 1)
+			{
+				start = min(start, envStart - itemPos - audioData.audioStart);
+				end   = max(end,   envEnd   - itemPos - audioData.audioStart);
+			}
+			incremental = change != -1;
+			if (incremental && (change = GetEnvelopeChange(audioData.volEnvPreFX, volEnvPreFX, &envStart, &envEnd)) == 1)
+			{
+				start = min(start, envStart - audioData.audioStart);
+				end   = max(end,   envEnd   - audioData.audioStart);
+			}
+			incremental = incremental && change != -1 && start <= end;
+
+			if (incremental)
+			{
+				if (changedStart >= 0)
+				{
+					start = min(start, changedStart);
+					end   = max(end,   changedEnd);
+				}
+				// Changes outside of the target still end up as a short range at its edge, no need for special handling
+				changedStart = min(audioLength, max(0.0, start));
+				changedEnd   = max(changedStart, min(audioLength, end));
+				incremental = changedStart > 0 || changedEnd < audioLength;
+			}
+		}
+
+		if (incremental)
+		{
+			audioData.volEnv      = volEnv;
+			audioData.volEnvPreFX = volEnvPreFX;
+			this->SetAudioData(audioData);
+
+			this->SetChangedRange(changedStart, changedEnd);
+			this->SetAnalyzedStatus(false);
+			return 2;
+		}
+	}
+
+	if (!this->GetAnalyzedStatus() || audioChanged || envChanged)
+	{
+		DestroyAudioAccessor(audioData.audio);
+		audioData.audio = (this->GetTrack()) ? (CreateTrackAudioAccessor(this->GetTrack())) : (CreateTakeAudioAccessor(this->GetTake()));
+		memset(audioData.audioHash, 0, 128);
+		GetAudioAccessorHash(audioData.audio, audioData.audioHash);
+
+		audioData.audioStart   = GetAudioAccessorStartTime(audioData.audio);
+		audioData.audioEnd     = GetAudioAccessorEndTime(audioData.audio);
+		audioData.channels     = channels;
+		audioData.channelMode  = channelMode;
+		audioData.samplerate   = samplerate;
+		audioData.volume       = volume;
+		audioData.pan          = pan;
+		audioData.volEnv       = volEnv;
+		audioData.volEnvPreFX  = volEnvPreFX;
+
+		this->SetAudioData(audioData);
+
+		this->SetChangedRange(-1, -1);
+		this->SetAnalyzedStatus(false);
+		this->SetTruePeakAnalyzed(false);
+		return 2;
+	}
+	else
+		return 1;
+}
+
+void BR_LoudnessObject::SetAudioData (const BR_LoudnessObject::AudioData& audioData)
+{
+	SWS_SectionLock lock(&m_mutex);
+	m_audioData = audioData;
+}
+
+BR_LoudnessObject::AudioData BR_LoudnessObject::GetAudioData ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	return m_audioData;
+}
+
+void BR_LoudnessObject::SetRunning (bool running)
+{
 	SWS_SectionLock lock(&m_mutex);
 	m_running = running;
 }
@@ -1393,159 +2168,555 @@ bool BR_LoudnessObject::GetDoTruePeak ()
 	return m_doTruePeak;
 }
 
-void BR_LoudnessObject::SetDoHighPrecisionMode(bool doHighPrecionMode)
-{
-	SWS_SectionLock lock(&m_mutex);
-	m_doHighPrecisionMode = doHighPrecionMode;
+void BR_LoudnessObject::SetDoHighPrecisionMode(bool doHighPrecionMode)
+{
+	SWS_SectionLock lock(&m_mutex);
+	m_doHighPrecisionMode = doHighPrecionMode;
+}
+
+bool BR_LoudnessObject::GetDoHighPrecisionMode()
+{
+	SWS_SectionLock lock(&m_mutex);
+	return m_doHighPrecisionMode;
+}
+
+void BR_LoudnessObject::SetMaxChunks (int maxChunks)
+{
+	SWS_SectionLock lock(&m_mutex);
+	m_maxChunks = max(1, maxChunks);
+}
+
+int BR_LoudnessObject::GetMaxChunks ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	return m_maxChunks;
+}
+
+void BR_LoudnessObject::SetTruePeakAnalyzed (bool analyzed)
+{
+	SWS_SectionLock lock(&m_mutex);
+	m_truePeakAnalyzed = analyzed;
+}
+
+bool BR_LoudnessObject::GetTruePeakAnalyzeStatus ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	return m_truePeakAnalyzed;
+}
+
+void BR_LoudnessObject::SetKillFlag (bool killFlag)
+{
+	SWS_SectionLock lock(&m_mutex);
+	m_killFlag = killFlag;
+}
+
+bool BR_LoudnessObject::GetKillFlag ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	return m_killFlag;
+}
+
+void BR_LoudnessObject::SetProcess (HANDLE process)
+{
+	SWS_SectionLock lock(&m_mutex);
+	m_process = process;
+}
+
+HANDLE BR_LoudnessObject::GetProcess ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	return m_process;
+}
+
+WDL_FastString BR_LoudnessObject::GetTakeName ()
+{
+	SWS_SectionLock lock(&m_mutex);
+
+	WDL_FastString takeName;
+	if (m_track)
+	{
+		takeName.Set("-");
+	}
+	else
+	{
+		if (this->IsTargetValid())
+			takeName.Set((char*)GetSetMediaItemTakeInfo(this->GetTake(), "P_NAME", NULL));
+		else
+			takeName.Set(__LOCALIZE("--NO TAKE FOUND--", "sws_DLG_174")); // Analyze loudness window should remove invalid objects, but leave this anyway
+	}
+
+	return takeName;
+}
+
+WDL_FastString BR_LoudnessObject::GetTrackName ()
+{
+	SWS_SectionLock lock(&m_mutex);
+
+	WDL_FastString trackName;
+	if (this->GetTrack())
+	{
+		if (this->IsTargetValid())
+		{
+			if (this->GetTrack() == GetMasterTrack(NULL))
+				trackName.Set(__localizeFunc("MASTER", "track", 0));
+			else
+				trackName.Set((char*)GetSetMediaTrackInfo(this->GetTrack(), "P_NAME", NULL));
+		}
+		else
+			trackName.Set(__LOCALIZE("--NO TRACK FOUND--", "sws_DLG_174")); // Analyze loudness window should remove invalid objects, but leave this anyway
+	}
+	else
+	{
+		if (this->IsTargetValid())
+			trackName.Set((char*)GetSetMediaTrackInfo(GetMediaItemTake_Track(this->GetTake()), "P_NAME", NULL));
+		else
+			trackName.Set(__LOCALIZE("--NO TAKE FOUND--", "sws_DLG_174")); // Analyze loudness window should remove invalid objects, but leave this anyway
+	}
+
+	return trackName;
+}
+
+MediaItem* BR_LoudnessObject::GetItem ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	MediaItem_Take* take = this->GetTake();
+	if (take)
+		return GetMediaItemTake_Item(take);
+	else
+		return NULL;
+}
+
+MediaTrack* BR_LoudnessObject::GetTrack ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	return m_track;
+}
+
+MediaItem_Take* BR_LoudnessObject::GetTake ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	return m_take;
+}
+
+GUID BR_LoudnessObject::GetGuid ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	return m_guid;
+}
+
+void BR_LoudnessObject::SetTrack (MediaTrack* track)
+{
+	SWS_SectionLock lock(&m_mutex);
+	m_track = track;
+}
+
+void BR_LoudnessObject::SetTake (MediaItem_Take* take)
+{
+	SWS_SectionLock lock(&m_mutex);
+	m_take = take;
+}
+
+void BR_LoudnessObject::SetGuid (GUID guid)
+{
+	SWS_SectionLock lock(&m_mutex);
+	m_guid = guid;
+}
+
+BR_LoudnessObject::AlignedBuffer::AlignedBuffer () :
+m_size (0)
+{
+}
+
+double* BR_LoudnessObject::AlignedBuffer::Get ()
+{
+	// Alignment offset is recalculated every time so the buffer can be safely copied
+	return m_size ? (double*)(((UINT_PTR)&m_storage[0] + 31) & ~(UINT_PTR)31) : NULL;
+}
+
+void BR_LoudnessObject::AlignedBuffer::Reserve (int count)
+{
+	if (count <= m_size)
+		return;
+
+	// Over-allocate so the start can be moved to a 32-byte boundary (wide enough for any SIMD loads done on it)
+	const size_t alignment = 32 / sizeof(double);
+	m_storage.resize(count + alignment);
+	m_size = count;
+}
+
+BR_LoudnessObject::BlockData::BlockData () :
+samplerate        (0),
+integratedOnly    (false),
+highPrecisionMode (false),
+truePeak          (false),
+valid             (false)
+{
+}
+
+BR_LoudnessObject::AudioData::AudioData () :
+audio        (NULL),
+samplerate   (0),
+channels     (0),
+channelMode  (0),
+audioStart   (0),
+audioEnd     (0),
+volume       (0),
+pan          (0)
+{
+	memset(audioHash, 0, 128);
+}
+
+/******************************************************************************
+* Loudness cache                                                              *
+******************************************************************************/
+static void WriteCacheDouble (FILE* f, double value)
+{
+	WDL_UINT64 bits;
+	memcpy(&bits, &value, sizeof(bits));
+	fprintf(f, " %08X%08X", (unsigned int)(bits >> 32), (unsigned int)(bits & 0xFFFFFFFF));
+}
+
+static double ParseCacheDouble (const char* str)
+{
+	WDL_UINT64 bits = (WDL_UINT64)strtoull(str, NULL, 16);
+	double value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+BR_LoudnessCache& BR_LoudnessCache::Get ()
+{
+	static BR_LoudnessCache s_instance;
+	return s_instance;
+}
+
+bool BR_LoudnessCache::Find (WDL_UINT64 key, bool integratedOnly, bool doTruePeak, bool doHighPrecisionMode, BR_LoudnessCache::Entry* entry)
+{
+	SWS_SectionLock lock(&m_mutex);
+	if (!m_enabled)
+		return false;
+	this->Load();
+
+	std::map<WDL_UINT64, BR_LoudnessCache::Entry>::iterator it = m_entries.find(key);
+	if (it == m_entries.end())
+		return false;
+
+	// Integrated loudness is always there, everything else depends on how the entry got analyzed
+	BR_LoudnessCache::Entry& cached = it->second;
+	if (!integratedOnly)
+	{
+		if (cached.integratedOnly || cached.highPrecisionMode != doHighPrecisionMode || (doTruePeak && !cached.truePeakAnalyzed))
+			return false;
+	}
+
+	cached.lastUsed = time(NULL);
+	m_lruDirty = true;
+	WritePtr(entry, cached);
+	return true;
 }
 
-bool BR_LoudnessObject::GetDoHighPrecisionMode()
+void BR_LoudnessCache::Add (WDL_UINT64 key, const BR_LoudnessCache::Entry& entry)
 {
 	SWS_SectionLock lock(&m_mutex);
-	return m_doHighPrecisionMode;
-}
+	if (!m_enabled)
+		return;
+	this->Load();
 
-void BR_LoudnessObject::SetTruePeakAnalyzed (bool analyzed)
-{
-	SWS_SectionLock lock(&m_mutex);
-	m_truePeakAnalyzed = analyzed;
+	std::map<WDL_UINT64, BR_LoudnessCache::Entry>::iterator it = m_entries.find(key);
+	if (it != m_entries.end())
+	{
+		// Don't replace complete analysis with integrated-only one
+		if (entry.integratedOnly && !it->second.integratedOnly)
+		{
+			it->second.lastUsed = time(NULL);
+			m_lruDirty = true;
+			return;
+		}
+		m_size -= it->second.GetSize();
+	}
+
+	BR_LoudnessCache::Entry& cached = m_entries[key];
+	cached = entry;
+	cached.lastUsed = time(NULL);
+	m_size += cached.GetSize();
+
+	// Append right away so analyses survive a crash, Save() compacts duplicates and evicted entries on exit
+	this->Append(key, cached);
+	this->Evict();
 }
 
-bool BR_LoudnessObject::GetTruePeakAnalyzeStatus ()
+void BR_LoudnessCache::Purge ()
 {
 	SWS_SectionLock lock(&m_mutex);
-	return m_truePeakAnalyzed;
+	m_entries.clear();
+	m_size   = 0;
+	m_loaded   = true;
+	m_dirty    = false;
+	m_lruDirty = false;
+
+	WDL_FastString file = this->GetCacheFile();
+	if (FileOrDirExists(file.Get()))
+		SNM_DeleteFile(file.Get(), false);
 }
 
-void BR_LoudnessObject::SetKillFlag (bool killFlag)
+bool BR_LoudnessCache::IsEnabled ()
 {
 	SWS_SectionLock lock(&m_mutex);
-	m_killFlag = killFlag;
+	return m_enabled;
 }
 
-bool BR_LoudnessObject::GetKillFlag ()
+void BR_LoudnessCache::SetEnabled (bool enabled)
 {
 	SWS_SectionLock lock(&m_mutex);
-	return m_killFlag;
+	m_enabled = enabled;
 }
 
-void BR_LoudnessObject::SetProcess (HANDLE process)
+void BR_LoudnessCache::SaveGlobalPref ()
 {
-	SWS_SectionLock lock(&m_mutex);
-	m_process = process;
+	char tmp[256];
+	snprintf(tmp, sizeof(tmp), "%d %d", m_enabled ? 1 : 0, m_maxSizeMB);
+	WritePrivateProfileString("SWS", CACHE_KEY, tmp, get_ini_file());
 }
 
-HANDLE BR_LoudnessObject::GetProcess ()
+void BR_LoudnessCache::LoadGlobalPref ()
 {
-	SWS_SectionLock lock(&m_mutex);
-	return m_process;
+	char tmp[256];
+	GetPrivateProfileString("SWS", CACHE_KEY, "", tmp, sizeof(tmp), get_ini_file());
+
+	LineParser lp(false);
+	lp.parse(tmp);
+	m_enabled   = (lp.getnumtokens() > 0) ? !!lp.gettoken_int(0) : false;
+	m_maxSizeMB = (lp.getnumtokens() > 1) ? lp.gettoken_int(1)   : CACHE_DEFAULT_SIZE_MB;
+	if (m_maxSizeMB <= 0)
+		m_maxSizeMB = CACHE_DEFAULT_SIZE_MB;
 }
 
-WDL_FastString BR_LoudnessObject::GetTakeName ()
+void BR_LoudnessCache::Save ()
 {
 	SWS_SectionLock lock(&m_mutex);
+	if (!m_dirty && !m_lruDirty)
+		return;
 
-	WDL_FastString takeName;
-	if (m_track)
-	{
-		takeName.Set("-");
-	}
-	else
+	WDL_FastString file = this->GetCacheFile();
+	if (FILE* f = fopenUTF8(file.Get(), "w"))
 	{
-		if (this->IsTargetValid())
-			takeName.Set((char*)GetSetMediaItemTakeInfo(this->GetTake(), "P_NAME", NULL));
-		else
-			takeName.Set(__LOCALIZE("--NO TAKE FOUND--", "sws_DLG_174")); // Analyze loudness window should remove invalid objects, but leave this anyway
+		fprintf(f, "%s %d\n", CACHE_VERSION_KEY, CACHE_FILE_VERSION);
+		for (std::map<WDL_UINT64, BR_LoudnessCache::Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+			this->WriteEntry(f, it->first, it->second);
+		fclose(f);
+		m_dirty    = false;
+		m_lruDirty = false;
 	}
-
-	return takeName;
 }
 
-WDL_FastString BR_LoudnessObject::GetTrackName ()
+void BR_LoudnessCache::Load ()
 {
-	SWS_SectionLock lock(&m_mutex);
+	if (m_loaded)
+		return;
+	m_loaded = true;
 
-	WDL_FastString trackName;
-	if (this->GetTrack())
+	WDL_FastString file = this->GetCacheFile();
+	FILE* f = fopenUTF8(file.Get(), "r");
+	if (!f)
+		return;
+
+	WDL_UINT64 key = 0;
+	BR_LoudnessCache::Entry entry;
+	bool inEntry = false;
+	bool versionOk = false;
+	char line[512];
+	LineParser lp(false);
+	while (fgets(line, sizeof(line), f))
 	{
-		if (this->IsTargetValid())
+		if (lp.parse(line) || lp.getnumtokens() < 1)
+			continue;
+
+		if (!strcmp(lp.gettoken_str(0), CACHE_VERSION_KEY))
 		{
-			if (this->GetTrack() == GetMasterTrack(NULL))
-				trackName.Set(__localizeFunc("MASTER", "track", 0));
-			else
-				trackName.Set((char*)GetSetMediaTrackInfo(this->GetTrack(), "P_NAME", NULL));
+			versionOk = (lp.gettoken_int(1) == CACHE_FILE_VERSION);
+		}
+		else if (!versionOk)
+		{
+			break; // unknown format, file gets rewritten on next save
+		}
+		else if (!strcmp(lp.gettoken_str(0), CACHE_ENTRY_KEY) && lp.getnumtokens() > 1)
+		{
+			key = (WDL_UINT64)strtoull(lp.gettoken_str(1), NULL, 16);
+			entry = BR_LoudnessCache::Entry();
+			entry.lastUsed = (lp.getnumtokens() > 2) ? (time_t)strtoll(lp.gettoken_str(2), NULL, 10) : 0;
+			inEntry = true;
+		}
+		else if (!inEntry)
+		{
+			continue;
+		}
+		else if (!strcmp(lp.gettoken_str(0), ">"))
+		{
+			// Entries get appended as they're added so the same key can show up more than once, last one wins
+			std::map<WDL_UINT64, BR_LoudnessCache::Entry>::iterator it = m_entries.find(key);
+			if (it != m_entries.end())
+			{
+				m_size -= it->second.GetSize();
+				m_dirty = true;
+			}
+			m_entries[key] = entry;
+			m_size += entry.GetSize();
+			inEntry = false;
+		}
+		else if (!strcmp(lp.gettoken_str(0), PROJ_OBJECT_KEY_MEASUREMENTS))
+		{
+			entry.integrated   = (lp.getnumtokens() > 1) ? ParseCacheDouble(lp.gettoken_str(1)) : NEGATIVE_INF;
+			entry.range        = (lp.getnumtokens() > 2) ? ParseCacheDouble(lp.gettoken_str(2)) : 0;
+			entry.truePeak     = (lp.getnumtokens() > 3) ? ParseCacheDouble(lp.gettoken_str(3)) : NEGATIVE_INF;
+			entry.truePeakPos  = (lp.getnumtokens() > 4) ? ParseCacheDouble(lp.gettoken_str(4)) : -1;
+			entry.shortTermMax = (lp.getnumtokens() > 5) ? ParseCacheDouble(lp.gettoken_str(5)) : NEGATIVE_INF;
+			entry.momentaryMax = (lp.getnumtokens() > 6) ? ParseCacheDouble(lp.gettoken_str(6)) : NEGATIVE_INF;
+		}
+		else if (!strcmp(lp.gettoken_str(0), PROJ_OBJECT_KEY_STATUS))
+		{
+			entry.integratedOnly    = !!lp.gettoken_int(1);
+			entry.truePeakAnalyzed  = !!lp.gettoken_int(2);
+			entry.highPrecisionMode = !!lp.gettoken_int(3);
+		}
+		else if (!strcmp(lp.gettoken_str(0), PROJ_OBJECT_KEY_SHORT_TERM))
+		{
+			for (int i = 1; i < lp.getnumtokens(); ++i)
+				entry.shortTermValues.push_back(ParseCacheDouble(lp.gettoken_str(i)));
+		}
+		else if (!strcmp(lp.gettoken_str(0), PROJ_OBJECT_KEY_MOMENTARY))
+		{
+			for (int i = 1; i < lp.getnumtokens(); ++i)
+				entry.momentaryValues.push_back(ParseCacheDouble(lp.gettoken_str(i)));
 		}
-		else
-			trackName.Set(__LOCALIZE("--NO TRACK FOUND--", "sws_DLG_174")); // Analyze loudness window should remove invalid objects, but leave this anyway
-	}
-	else
-	{
-		if (this->IsTargetValid())
-			trackName.Set((char*)GetSetMediaTrackInfo(GetMediaItemTake_Track(this->GetTake()), "P_NAME", NULL));
-		else
-			trackName.Set(__LOCALIZE("--NO TAKE FOUND--", "sws_DLG_174")); // Analyze loudness window should remove invalid objects, but leave this anyway
 	}
+	fclose(f);
 
-	return trackName;
-}
+	// Old format or incomplete last entry (crashed while appending) - rewrite the file on exit
+	if (!versionOk || inEntry)
+		m_dirty = true;
 
-MediaItem* BR_LoudnessObject::GetItem ()
-{
-	SWS_SectionLock lock(&m_mutex);
-	MediaItem_Take* take = this->GetTake();
-	if (take)
-		return GetMediaItemTake_Item(take);
-	else
-		return NULL;
+	this->Evict();
 }
 
-MediaTrack* BR_LoudnessObject::GetTrack ()
+void BR_LoudnessCache::Append (WDL_UINT64 key, const BR_LoudnessCache::Entry& entry)
 {
-	SWS_SectionLock lock(&m_mutex);
-	return m_track;
+	// Rewrite from scratch if file needs compacting anyway (evicted entries, old format etc.)
+	if (m_dirty)
+	{
+		this->Save();
+		return;
+	}
+
+	WDL_FastString file = this->GetCacheFile();
+	const bool newFile = !FileOrDirExists(file.Get());
+	if (FILE* f = fopenUTF8(file.Get(), "a"))
+	{
+		if (newFile)
+			fprintf(f, "%s %d\n", CACHE_VERSION_KEY, CACHE_FILE_VERSION);
+		this->WriteEntry(f, key, entry);
+		fclose(f);
+	}
 }
 
-MediaItem_Take* BR_LoudnessObject::GetTake ()
+void BR_LoudnessCache::WriteEntry (FILE* f, WDL_UINT64 key, const BR_LoudnessCache::Entry& entry)
 {
-	SWS_SectionLock lock(&m_mutex);
-	return m_take;
+	// Doubles are written as raw bits so cached results are exactly the same as freshly analyzed ones
+	fprintf(f, "%s %08X%08X %lld\n", CACHE_ENTRY_KEY, (unsigned int)(key >> 32), (unsigned int)(key & 0xFFFFFFFF), (long long)entry.lastUsed);
+	fprintf(f, "%s", PROJ_OBJECT_KEY_MEASUREMENTS);
+	const double measurements[] = {entry.integrated, entry.range, entry.truePeak, entry.truePeakPos, entry.shortTermMax, entry.momentaryMax};
+	for (int i = 0; i < (int)(sizeof(measurements) / sizeof(measurements[0])); ++i)
+		WriteCacheDouble(f, measurements[i]);
+	fprintf(f, "\n%s %d %d %d\n", PROJ_OBJECT_KEY_STATUS, entry.integratedOnly, entry.truePeakAnalyzed, entry.highPrecisionMode);
+
+	const char* keys[]           = {PROJ_OBJECT_KEY_SHORT_TERM, PROJ_OBJECT_KEY_MOMENTARY};
+	const vector<double>* vals[] = {&entry.shortTermValues, &entry.momentaryValues};
+	for (int i = 0; i < 2; ++i)
+	{
+		for (size_t j = 0; j < vals[i]->size(); ++j)
+		{
+			if (j % 10 == 0)
+				fprintf(f, (j == 0) ? "%s" : "\n%s", keys[i]);
+			WriteCacheDouble(f, (*vals[i])[j]);
+		}
+		if (vals[i]->size())
+			fprintf(f, "\n");
+	}
+	fprintf(f, ">\n");
 }
 
-GUID BR_LoudnessObject::GetGuid ()
+void BR_LoudnessCache::Evict ()
 {
-	SWS_SectionLock lock(&m_mutex);
-	return m_guid;
+	const int maxSize = m_maxSizeMB * 1024 * 1024;
+	if (m_size <= maxSize)
+		return;
+
+	// Remove least recently used entries until there's some headroom so we don't evict on every add
+	vector<pair<time_t, WDL_UINT64> > byAge;
+	byAge.reserve(m_entries.size());
+	for (std::map<WDL_UINT64, BR_LoudnessCache::Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+		byAge.push_back(make_pair(it->second.lastUsed, it->first));
+	sort(byAge.begin(), byAge.end());
+
+	for (size_t i = 0; i < byAge.size() && m_size > maxSize / 10 * 9; ++i)
+	{
+		std::map<WDL_UINT64, BR_LoudnessCache::Entry>::iterator it = m_entries.find(byAge[i].second);
+		m_size -= it->second.GetSize();
+		m_entries.erase(it);
+	}
+	m_dirty = true;
 }
 
-void BR_LoudnessObject::SetTrack (MediaTrack* track)
+WDL_FastString BR_LoudnessCache::GetCacheFile ()
 {
-	SWS_SectionLock lock(&m_mutex);
-	m_track = track;
+	WDL_FastString file;
+	file.SetFormatted(SNM_MAX_PATH, "%s/%s", GetResourcePath(), CACHE_FILE);
+	return file;
 }
 
-void BR_LoudnessObject::SetTake (MediaItem_Take* take)
+BR_LoudnessCache::BR_LoudnessCache () :
+m_size      (0),
+m_maxSizeMB (CACHE_DEFAULT_SIZE_MB),
+m_enabled   (false),
+m_loaded    (false),
+m_dirty     (false),
+m_lruDirty  (false)
 {
-	SWS_SectionLock lock(&m_mutex);
-	m_take = take;
 }
 
-void BR_LoudnessObject::SetGuid (GUID guid)
+BR_LoudnessCache::Entry::Entry () :
+integrated        (NEGATIVE_INF),
+range             (0),
+truePeak          (NEGATIVE_INF),
+truePeakPos       (-1),
+shortTermMax      (NEGATIVE_INF),
+momentaryMax      (NEGATIVE_INF),
+integratedOnly    (false),
+truePeakAnalyzed  (false),
+highPrecisionMode (false),
+lastUsed          (0)
 {
-	SWS_SectionLock lock(&m_mutex);
-	m_guid = guid;
 }
 
-BR_LoudnessObject::AudioData::AudioData () :
-audio        (NULL),
-samplerate   (0),
-channels     (0),
-channelMode  (0),
-audioStart   (0),
-audioEnd     (0),
-volume       (0),
-pan          (0)
+int BR_LoudnessCache::Entry::GetSize () const
 {
-	memset(audioHash, 0, 128);
+	// Mirrors WriteEntry() so the size limit matches what ends up in the cache file
+	const int doubleLen = 17; // " %08X%08X"
+	char lastUsedStr[32];
+	snprintf(lastUsedStr, sizeof(lastUsedStr), "%lld", (long long)lastUsed);
+
+	int size = (int)strlen(CACHE_ENTRY_KEY) + 1 + 16 + 1 + (int)strlen(lastUsedStr) + 1;
+	size += (int)strlen(PROJ_OBJECT_KEY_MEASUREMENTS) + 6 * doubleLen;
+	size += 1 + (int)strlen(PROJ_OBJECT_KEY_STATUS) + 6 + 1;
+
+	const char* keys[]           = {PROJ_OBJECT_KEY_SHORT_TERM, PROJ_OBJECT_KEY_MOMENTARY};
+	const vector<double>* vals[] = {&shortTermValues, &momentaryValues};
+	for (int i = 0; i < 2; ++i)
+	{
+		const int count = (int)vals[i]->size();
+		const int lines = (count + 9) / 10;
+		size += count * doubleLen + lines * ((int)strlen(keys[i]) + 1);
+	}
+	return size + 2; // ">\n"
 }
 
 /******************************************************************************
@@ -2237,12 +3408,11 @@ void BR_AnalyzeLoudnessView::OnItemSortEnd ()
 ******************************************************************************/
 BR_AnalyzeLoudnessWnd::BR_AnalyzeLoudnessWnd () :
 SWS_DockWnd(IDD_BR_LOUDNESS_ANALYZER, __LOCALIZE("Loudness", "sws_DLG_174"), ""),
-m_objectsLen        (0),
-m_currentObjectId   (0),
-m_analyzeInProgress (false),
-m_list              (NULL),
-m_normalizeWnd      (NULL),
-m_exportFormatWnd   (NULL)
+m_objectsLen         (0),
+m_finishedObjectsLen (0),
+m_list               (NULL),
+m_normalizeWnd       (NULL),
+m_exportFormatWnd    (NULL)
 {
 	m_id.Set(LOUDNESS_WND);
 	Init(); // Must call SWS_DockWnd::Init() to restore parameters and open the window if necessary
@@ -2331,6 +3501,7 @@ BR_LoudnessObject* BR_AnalyzeLoudnessWnd::IsObjectInList (MediaItem_Take* take)
 void BR_AnalyzeLoudnessWnd::AbortAnalyze ()
 {
 	SetAnalyzing(false, false);
+	this->AbortRunningObjects();
 
 	// Make sure objects already in the list are NOT destroyed
 	for (int i = 0; i < m_analyzeQueue.GetSize(); ++i)
@@ -2339,17 +3510,30 @@ void BR_AnalyzeLoudnessWnd::AbortAnalyze ()
 			m_analyzeQueue.Delete(i--, false);
 	}
 	m_analyzeQueue.Empty(true);
-	m_objectsLen      = 0;
-	m_currentObjectId = 0;
+	m_objectsLen         = 0;
+	m_finishedObjectsLen = 0;
 }
 
 void BR_AnalyzeLoudnessWnd::AbortReanalyze ()
 {
 	SetAnalyzing(false, true);
+	this->AbortRunningObjects();
 
 	m_reanalyzeQueue.Empty(false);
-	m_objectsLen      = 0;
-	m_currentObjectId = 0;
+	m_objectsLen         = 0;
+	m_finishedObjectsLen = 0;
+}
+
+void BR_AnalyzeLoudnessWnd::AbortRunningObjects ()
+{
+	// Objects deleted by the user already stopped their analysis in destructor
+	for (size_t i = 0; i < m_runningObjects.size(); ++i)
+	{
+		BR_LoudnessObject* object = m_runningObjects[i].object;
+		if (m_analyzeQueue.Find(object) != -1 || m_reanalyzeQueue.Find(object) != -1)
+			object->AbortAnalyze();
+	}
+	m_runningObjects.clear();
 }
 
 void BR_AnalyzeLoudnessWnd::SetAnalyzing (const bool analyzing, const bool reanalyze)
@@ -2363,11 +3547,101 @@ void BR_AnalyzeLoudnessWnd::SetAnalyzing (const bool analyzing, const bool reana
 
 	if (analyzing)
 		SetTimer(m_hwnd, timer, ANALYZE_TIMER_FREQ, NULL);
-	else {
+	else
 		KillTimer(m_hwnd, timer);
+}
+
+void BR_AnalyzeLoudnessWnd::ProcessQueue (bool reanalyze)
+{
+	// Objects stay in the queue while running, analyze queue owns them until they enter g_analyzedObjects, reanalyze queue never does
+	WDL_PtrList_DeleteOnDestroy<BR_LoudnessObject>& queue = reanalyze ? m_reanalyzeQueue : m_analyzeQueue;
+
+	// Collect finished objects (or the ones user deleted in the meantime)
+	bool update = false;
+	for (size_t i = 0; i < m_runningObjects.size(); ++i)
+	{
+		BR_LoudnessObject* object = m_runningObjects[i].object;
+		int id = queue.Find(object);
+		if (id == -1 || !object->IsRunning())
+		{
+			if (id != -1)
+			{
+				// Sometimes the analyzed object can already be in the list (if option to clear list upon analyzing is disabled)
+				if (!reanalyze && g_analyzedObjects.Get()->Find(object) == -1)
+					g_analyzedObjects.Get()->Add(object);
+				queue.Delete(id, false);
+				update = !reanalyze;
+			}
+
+			m_finishedObjectsLen += m_runningObjects[i].length;
+			m_runningObjects.erase(m_runningObjects.begin() + i--);
+		}
+	}
+
+	// Fill free slots with objects still waiting in the queue
+	const int maxRunning = this->GetMaxRunningObjects();
+	for (int i = 0; i < queue.GetSize() && (int)m_runningObjects.size() < maxRunning; ++i)
+	{
+		BR_LoudnessObject* object = queue.Get(i);
+		if (!object)
+		{
+			queue.Delete(i--, !reanalyze);
+			continue;
+		}
 
-		m_analyzeInProgress = false;
+		bool running = false;
+		for (size_t j = 0; j < m_runningObjects.size() && !running; ++j)
+			running = (m_runningObjects[j].object == object);
+
+		if (!running)
+		{
+			// When there are fewer objects than free slots, spread remaining cores over chunks of long objects
+			RunningObject runningObject = {object, object->GetAudioLength()};
+			object->SetMaxChunks(max(1, maxRunning / queue.GetSize()));
+			object->Analyze(false, m_properties.doTruePeak, m_properties.doHighPrecisionMode);
+			m_runningObjects.push_back(runningObject);
+		}
+	}
+
+	if (update)
+		this->Update();
+
+	if (!queue.GetSize())
+	{
+		if (!reanalyze)
+		{
+			// Make sure list view isn't populated with invalid items (i.e. user could have deleted them during analysis)
+			for (int i = 0; i < g_analyzedObjects.Get()->GetSize(); ++i)
+			{
+				if (BR_LoudnessObject* object = g_analyzedObjects.Get()->Get(i))
+				{
+					if (!object->IsTargetValid())
+						g_analyzedObjects.Get()->Delete(i--, true);
+				}
+			}
+		}
+
+		m_runningObjects.clear();
+		this->Update();
+		SetAnalyzing(false, reanalyze);
+		return;
 	}
+
+	// Progress of all running objects gets rolled up into a single progress bar
+	double progress = m_finishedObjectsLen;
+	for (size_t i = 0; i < m_runningObjects.size(); ++i)
+		progress += m_runningObjects[i].length * m_runningObjects[i].object->GetProgress();
+	progress /= m_objectsLen;
+
+	SendMessage(GetDlgItem(m_hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(progress*100), 0);
+}
+
+int BR_AnalyzeLoudnessWnd::GetMaxRunningObjects ()
+{
+	if (m_properties.maxRunningObjects > 0)
+		return m_properties.maxRunningObjects;
+
+	return GetHardwareThreads();
 }
 
 void BR_AnalyzeLoudnessWnd::ClearList ()
@@ -3542,119 +4816,13 @@ void BR_AnalyzeLoudnessWnd::OnCommand (WPARAM wParam, LPARAM lParam)
 
 void BR_AnalyzeLoudnessWnd::OnTimer (WPARAM wParam)
 {
-	static BR_LoudnessObject* s_currentObject      = NULL;
-	static double             s_currentObjectLen   = 0;
-	static double             s_finishedObjectsLen = 0;
-
 	if (wParam == ANALYZE_TIMER)
 	{
-		if (!m_analyzeInProgress)
-		{
-			// New analyze task began, reset variables
-			if (m_currentObjectId == 0)
-				s_finishedObjectsLen = 0;
-
-			if (!m_analyzeQueue.GetSize())
-			{
-				// Make sure list view isn't populated with invalid items (i.e. user could have deleted them during analysis)
-				for (int i = 0; i < g_analyzedObjects.Get()->GetSize(); ++i)
-				{
-					if (BR_LoudnessObject* object = g_analyzedObjects.Get()->Get(i))
-					{
-						if (!object->IsTargetValid())
-							g_analyzedObjects.Get()->Delete(i--, true);
-					}
-				}
-
-				this->Update();
-				SetAnalyzing(false, false);
-
-				return;
-			}
-			else
-			{
-				if ((s_currentObject = m_analyzeQueue.Get(0)))
-				{
-					s_currentObjectLen = s_currentObject->GetAudioLength();
-					s_currentObject->Analyze(false, m_properties.doTruePeak, m_properties.doHighPrecisionMode);
-					m_analyzeInProgress = true;
-				}
-				else
-					m_analyzeQueue.Delete(0, true);
-				++m_currentObjectId;
-			}
-		}
-		else
-		{
-			// Make sure our object is still here
-			double progress = 1;
-			if (m_analyzeQueue.Find(s_currentObject) != -1 && s_currentObject->IsRunning())
-				progress = (s_finishedObjectsLen + s_currentObjectLen * s_currentObject->GetProgress()) / m_objectsLen;
-			else
-			{
-				if (m_analyzeQueue.Find(s_currentObject) != -1)
-				{
-					// Sometimes the analyzed object can already be in the list (if option to clear list upon analyzing is disabled)
-					if (g_analyzedObjects.Get()->Find(s_currentObject) == -1)
-						g_analyzedObjects.Get()->Add(s_currentObject);
-					m_analyzeQueue.Delete(m_analyzeQueue.Find(s_currentObject), false);
-					this->Update();
-				}
-
-				s_finishedObjectsLen += s_currentObjectLen;
-				progress = s_finishedObjectsLen / m_objectsLen;
-
-				m_analyzeInProgress = false;
-			}
-			SendMessage(GetDlgItem(m_hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(progress*100), 0);
-		}
+		this->ProcessQueue(false);
 	}
 	else if (wParam == REANALYZE_TIMER)
 	{
-		if (!m_analyzeInProgress)
-		{
-			// New analyze task began, reset variables
-			if (m_currentObjectId == 0)
-				s_finishedObjectsLen = 0;
-
-			if (!m_reanalyzeQueue.GetSize())
-			{
-				this->Update();
-				SetAnalyzing(false, true);
-				return;
-			}
-			else
-			{
-				if ((s_currentObject = m_reanalyzeQueue.Get(0)))
-				{
-					s_currentObjectLen = s_currentObject->GetAudioLength();
-					s_currentObject->Analyze(false, m_properties.doTruePeak, m_properties.doHighPrecisionMode);
-					m_analyzeInProgress = true;
-				}
-				else
-					m_reanalyzeQueue.Delete(0, false);
-				++m_currentObjectId;
-			}
-		}
-		else
-		{
-			// Make sure our object is still here (user could have deleted it)
-			if (m_reanalyzeQueue.Find(s_currentObject) != -1 && s_currentObject->IsRunning())
-			{
-				double progress = (s_finishedObjectsLen + s_currentObjectLen * s_currentObject->GetProgress()) / m_objectsLen;
-				SendMessage(GetDlgItem(m_hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(progress*100), 0);
-			}
-			else
-			{
-				if (m_reanalyzeQueue.Find(s_currentObject) != -1)
-					m_reanalyzeQueue.Delete(m_reanalyzeQueue.Find(s_currentObject), false);
-
-				s_finishedObjectsLen += s_currentObjectLen;
-				double progress = s_finishedObjectsLen / m_objectsLen;
-				SendMessage(GetDlgItem(m_hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(progress*100), 0);
-				m_analyzeInProgress = false;
-			}
-		}
+		this->ProcessQueue(true);
 	}
 	else if (wParam == UPDATE_TIMER)
 	{
@@ -3853,7 +5021,8 @@ clearEnvelope         (true),
 clearAnalyzed         (true),
 doTruePeak            (true),
 usingLU               (false),
-doHighPrecisionMode   (true)
+doHighPrecisionMode   (true),
+maxRunningObjects     (0)
 {
 }
 
@@ -3874,6 +5043,7 @@ void BR_AnalyzeLoudnessWnd::Properties::Load ()
 	doTruePeak            = (lp.getnumtokens() > 7) ? !!lp.gettoken_int(7) : false;
 	usingLU               = (lp.getnumtokens() > 8) ? !!lp.gettoken_int(8) : false;
 	doHighPrecisionMode   = (lp.getnumtokens() > 9) ? !!lp.gettoken_int(9) : false;
+	maxRunningObjects     = (lp.getnumtokens() > 10) ? lp.gettoken_int(10)  : 0;
 
 	GetPrivateProfileString("SWS", EXPORT_FORMAT_KEY, "$id - $target: $integrated, Range: $range, True peak: $truepeak", tmp, sizeof(tmp), get_ini_file());
 	exportFormat.Set(tmp);
@@ -3893,7 +5063,7 @@ void BR_AnalyzeLoudnessWnd::Properties::Save ()
 	int doHighPrecisionModeInt   = doHighPrecisionMode;
 
 	char tmp[512];
-	snprintf(tmp, sizeof(tmp), "%d %d %d %d %d %d %d %d %d %d", analyzeTracksInt, analyzeOnNormalizeInt, mirrorProjSelectionInt, doubleClickGoToTargetInt, timeSelOverMaxInt, clearEnvelopeInt, clearAnalyzedInt, doTruePeakInt, usingLUInt, doHighPrecisionModeInt);
+	snprintf(tmp, sizeof(tmp), "%d %d %d %d %d %d %d %d %d %d %d", analyzeTracksInt, analyzeOnNormalizeInt, mirrorProjSelectionInt, doubleClickGoToTargetInt, timeSelOverMaxInt, clearEnvelopeInt, clearAnalyzedInt, doTruePeakInt, usingLUInt, doHighPrecisionModeInt, maxRunningObjects);
 	WritePrivateProfileString("SWS", LOUDNESS_KEY, tmp, get_ini_file());
 
 	WritePrivateProfileString("SWS", EXPORT_FORMAT_KEY, exportFormat.Get(), get_ini_file());
@@ -3909,6 +5079,7 @@ int LoudnessInitExit (bool init)
 	if (init)
 	{
 		g_pref.LoadGlobalPref();
+		BR_LoudnessCache::Get().LoadGlobalPref();
 		g_loudnessWndManager.Init();
 		return plugin_register("projectconfig", &s_projectconfig);
 	}
@@ -3916,6 +5087,8 @@ int LoudnessInitExit (bool init)
 	{
 		g_pref.SaveGlobalPref();
 		g_loudnessWndManager.Delete();
+		BR_LoudnessCache::Get().SaveGlobalPref();
+		BR_LoudnessCache::Get().Save();
 		plugin_register("-projectconfig", &s_projectconfig);
 		return 1;
 	}
@@ -4131,6 +5304,17 @@ void ToggleHighPrecisionOption(COMMAND_T* ct)
 	RefreshToolbar(NamedCommandLookup("_BR_NF_TOGGLE_LOUDNESS_HIGH_PREC"));
 }
 
+void PurgeLoudnessCache (COMMAND_T* ct)
+{
+	BR_LoudnessCache::Get().Purge();
+}
+
+void ToggleLoudnessCache (COMMAND_T* ct)
+{
+	BR_LoudnessCache::Get().SetEnabled(!BR_LoudnessCache::Get().IsEnabled());
+	BR_LoudnessCache::Get().SaveGlobalPref();
+}
+
 /******************************************************************************
 * Toggle states                                                               *
 ******************************************************************************/
@@ -4168,6 +5352,11 @@ int IsHighPrecisionOptionEnabled(COMMAND_T* ct)
 	return isHighPrecOptEnabled;
 }
 
+int IsLoudnessCacheEnabled (COMMAND_T* ct)
+{
+	return BR_LoudnessCache::Get().IsEnabled() ? 1 : 0;
+}
+
 
 //////////////////////////////////////////////////////////////////
 //                                                              //
@@ -4359,6 +5548,7 @@ bool NFDoAnalyzeTakeLoudness_IntegratedOnly(MediaItem_Take* take, double* lufsIn
 
 		WDL_PtrList_DeleteOnDestroy<BR_LoudnessObject> objects;
 		objects.Add(new BR_LoudnessObject(take));
+		objects.Get(0)->SetMaxChunks(GetHardwareThreads()); // single take, long ones get split into chunks analyzed in parallel
 
 		bool isTargetValid = objects.Get(0)->CheckTarget(take);
 		if (isTargetValid) {
@@ -4389,6 +5579,7 @@ bool NFDoAnalyzeTakeLoudness(MediaItem_Take* take, bool analyzeTruePeak, double*
 
 		WDL_PtrList_DeleteOnDestroy<BR_LoudnessObject> objects;
 		objects.Add(new BR_LoudnessObject(take));
+		objects.Get(0)->SetMaxChunks(GetHardwareThreads()); // single take, long ones get split into chunks analyzed in parallel
 
 		bool isTargetValid = objects.Get(0)->CheckTarget(take);
 		if (isTargetValid)
@@ -4432,6 +5623,7 @@ bool NFDoAnalyzeTakeLoudness2(MediaItem_Take* take, bool analyzeTruePeak, double
 
 		WDL_PtrList_DeleteOnDestroy<BR_LoudnessObject> objects;
 		objects.Add(new BR_LoudnessObject(take));
+		objects.Get(0)->SetMaxChunks(GetHardwareThreads()); // single take, long ones get split into chunks analyzed in parallel
 
 		bool isTargetValid = objects.Get(0)->CheckTarget(take);
 		if (isTargetValid) {
@@ -84,6 +84,9 @@ public:
 	// see https://github.com/jiixyj/libebur128/issues/93#issuecomment-429043548
 	void SetDoHighPrecisionMode(bool doHighPrecisionMode);
 	bool GetDoHighPrecisionMode();
+	// Long targets can be split into chunks analyzed in parallel (1 = analyze serially)
+	void SetMaxChunks (int maxChunks);
+	int GetMaxChunks ();
 
 private:
 	struct AudioData
@@ -97,8 +100,47 @@ private:
 		AudioData();
 	};
 
+	class AlignedBuffer // reused between analyze runs, only ever grows (contents are not preserved)
+	{
+	public:
+		AlignedBuffer ();
+		double* Get ();
+		void Reserve (int count);
+	private:
+		vector<double> m_storage;
+		int m_size;
+	};
+
+	struct ChunkBuffers
+	{
+		AlignedBuffer samples[2], gainCurve, envValues;
+	};
+
+	struct AnalyzeChunk; // see AnalyzeData()
+
+	struct BlockData // per-block results of the last analysis, used to reanalyze only the part of the target that changed
+	{
+		vector<double> gatingEnergies;    // 400 ms gating blocks, 100 ms apart
+		vector<double> shortTermEnergies; // 3 s blocks, 1 s apart (loudness range)
+		vector<double> periodPeaks;       // true peak (and its position) of every CHUNK_WARM_UP_TIME seconds
+		vector<double> periodPeakPos;
+		int samplerate;
+		bool integratedOnly, highPrecisionMode, truePeak, valid;
+		BlockData ();
+	};
+
 	static unsigned WINAPI AnalyzeData (void* loudnessObject);
+	static void AnalyzeChunkData (BR_LoudnessObject* _this, AnalyzeChunk* chunk);
+	void PrepareChunks ();                         // call from the main thread only, creates additional accessors if target is long enough to be analyzed in chunks
+	vector<AudioAccessor*> GetChunkAccessors ();
+	void SetBlockData (const BlockData& blockData);
+	BlockData GetBlockData ();
+	void SetChangedRange (double start, double end); // relative to audio start, -1 means everything changed
+	void GetChangedRange (double* start, double* end);
 	int CheckSetAudioData (); // call from the main thread only, returns 0->target doesn't exist anymore, 1->old accessor still valid, 2->accessor got updated
+	bool GetCacheKey (WDL_UINT64* key); // call from the main thread only, returns false if target's audio can't be identified (tracks, take FX, non-file sources...)
+	bool RestoreFromCache ();
+	void StoreToCache ();
 	void SetAudioData (const AudioData& audioData);
 	AudioData GetAudioData ();
 	void SetRunning (bool running);
@@ -137,6 +179,62 @@ private:
 	SWS_Mutex m_mutex;
 	vector<double> m_shortTermValues;
 	vector<double> m_momentaryValues;
+	WDL_UINT64 m_cacheKey;
+	bool m_cacheKeyValid;
+	vector<ChunkBuffers> m_chunkBuffers;     // used by analyze thread only
+	vector<AudioAccessor*> m_chunkAccessors; // first chunk uses m_audioData.audio
+	int m_maxChunks;
+	BlockData m_blockData;
+	double m_changedStart, m_changedEnd;
+};
+
+/******************************************************************************
+* Loudness cache (analyze data of takes persisted across projects/sessions)   *
+******************************************************************************/
+class BR_LoudnessCache
+{
+public:
+	struct Entry
+	{
+		double integrated, range, truePeak, truePeakPos, shortTermMax, momentaryMax;
+		vector<double> shortTermValues, momentaryValues;
+		bool integratedOnly, truePeakAnalyzed, highPrecisionMode;
+		time_t lastUsed;
+		Entry ();
+		int GetSize () const; // approximate size on disk in bytes (used for eviction)
+	};
+
+	/* No constructor - singleton design */
+	static BR_LoudnessCache& Get ();
+
+	/* Thread safe (entries get added from analyze threads) */
+	bool Find (WDL_UINT64 key, bool integratedOnly, bool doTruePeak, bool doHighPrecisionMode, Entry* entry);
+	void Add (WDL_UINT64 key, const Entry& entry);
+	void Purge ();
+	bool IsEnabled ();
+	void SetEnabled (bool enabled);
+
+	/* Global state saving */
+	void SaveGlobalPref ();
+	void LoadGlobalPref ();
+	void Save ();
+
+private:
+	BR_LoudnessCache ();
+	BR_LoudnessCache (const BR_LoudnessCache&);
+	void operator=  (const BR_LoudnessCache&);
+	void Load ();   // lazy, called with mutex locked
+	void Evict ();  // called with mutex locked
+	void Append (WDL_UINT64 key, const Entry& entry); // called with mutex locked
+	void WriteEntry (FILE* f, WDL_UINT64 key, const Entry& entry);
+	WDL_FastString GetCacheFile ();
+
+	std::map<WDL_UINT64, Entry> m_entries;
+	SWS_Mutex m_mutex;
+	int m_size, m_maxSizeMB;
+	bool m_enabled, m_loaded;
+	bool m_dirty;    // file has to be rewritten (evicted or duplicate entries) - new entries get appended right away
+	bool m_lruDirty; // only last used times changed, written on exit
 };
 
 /******************************************************************************
@@ -249,7 +347,10 @@ protected:
 	BR_LoudnessObject* IsObjectInList (MediaItem_Take* take);
 	void AbortAnalyze ();
 	void AbortReanalyze ();
+	void AbortRunningObjects ();
 	void SetAnalyzing (bool, bool reanalyze);
+	void ProcessQueue (bool reanalyze);
+	int GetMaxRunningObjects ();
 	void ShowExportFormatDialog (bool show);
 	void ShowNormalizeDialog (bool show);
 	void SaveRecentFormatPattern (WDL_FastString pattern);
@@ -280,14 +381,19 @@ protected:
 		bool doTruePeak;
 		bool usingLU;
 		bool doHighPrecisionMode;
+		int maxRunningObjects; // how many objects get analyzed at once, 0 -> hardware concurrency
 		WDL_FastString exportFormat;
 		Properties ();
 		void Load ();
 		void Save ();
 	} m_properties;
-	double m_objectsLen;
-	int m_currentObjectId;
-	bool m_analyzeInProgress;
+	struct RunningObject
+	{
+		BR_LoudnessObject* object; // could be deleted by the user during analysis, so always check against the queue before dereferencing
+		double length;
+	};
+	vector<RunningObject> m_runningObjects;
+	double m_objectsLen, m_finishedObjectsLen;
 	BR_AnalyzeLoudnessView* m_list;
 	HWND m_normalizeWnd, m_exportFormatWnd;                                          // never delete objects in reanalyzeQueue when removing them from list!!
 	WDL_PtrList_DeleteOnDestroy<BR_LoudnessObject> m_analyzeQueue, m_reanalyzeQueue; // m_analyzeQueue is ok if the object didn't enter g_analyzedObjects
@@ -309,6 +415,8 @@ void NormalizeLoudness (COMMAND_T*);
 void AnalyzeLoudness (COMMAND_T*);
 void ToggleLoudnessPref (COMMAND_T*);
 void ToggleHighPrecisionOption(COMMAND_T*);
+void PurgeLoudnessCache (COMMAND_T*);
+void ToggleLoudnessCache (COMMAND_T*);
 
 // #880
 bool NFDoAnalyzeTakeLoudness_IntegratedOnly(MediaItem_Take*, double* lufsIntegrated);
@@ -323,3 +431,4 @@ int IsNormalizeLoudnessVisible (COMMAND_T*);
 int IsAnalyzeLoudnessVisible (COMMAND_T*);
 int IsLoudnessPrefVisible (COMMAND_T*);
 int IsHighPrecisionOptionEnabled(COMMAND_T*);
+int IsLoudnessCacheEnabled (COMMAND_T*);
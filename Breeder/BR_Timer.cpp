@@ -40,6 +40,8 @@ void CommandTimer (COMMAND_T* ct, int val /*= 0*/, int valhw /*= 0*/, int relmod
 		gettimeofday(&start, NULL);
 	#endif
 
+	SWS_GetStateBytes(NULL, NULL, true);
+
 	if (commandHook2)
 		ct->onAction(ct, val, valhw, relmode, hwnd);
 	else
@@ -55,6 +57,11 @@ void CommandTimer (COMMAND_T* ct, int val /*= 0*/, int valhw /*= 0*/, int relmod
 
 	WDL_FastString string;
 	string.AppendFormatted(256, "%d ms to execute: %s\n", msTime, ct->accel.desc);
+
+	WDL_INT64 fetched, used;
+	SWS_GetStateBytes(&fetched, &used, true);
+	if (fetched)
+		string.AppendFormatted(256, "    object states: %lld bytes fetched, %lld bytes used\n", (long long)fetched, (long long)used);
 	ShowConsoleMsg(string.Get());
 }
 
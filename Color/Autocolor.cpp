@@ -95,6 +95,7 @@ class AC_MarkerRegionListener : public SNM_MarkerRegionListener {
 public:
 	AC_MarkerRegionListener() : SNM_MarkerRegionListener() {}
 	void NotifyMarkerRegionUpdate(int _updateFlags) { AutoColorMarkerRegion(false, _updateFlags); }
+	void NotifyMarkerRegionChanges(const SNM_MarkerRegionChanges* _changes);
 };
 
 AC_MarkerRegionListener g_mkrRgnListener;
@@ -711,246 +712,539 @@ void OpenAutoColor(COMMAND_T*)
 	g_pACWnd->Show(true, true);
 }
 
-void ApplyColorRuleToTrack(SWS_RuleItem* rule, bool bDoColors, bool bDoIcons, bool bDoLayout, bool bForce)
-{
-	if(rule->m_type == AC_TRACK)
-	{
-		if (!bDoColors && !bDoIcons && !bDoLayout) // NF: fix #936
-			return;
+///////////////////////////////////////////////////////////////////////////////
+// Compiled track rules
+///////////////////////////////////////////////////////////////////////////////
+
+// track states tested by the "special" filters, see GetTrackRuleFlags()
+enum {
+	AC_TRFLAG_MASTER  = 0x01,
+	AC_TRFLAG_FOLDER  = 0x02,
+	AC_TRFLAG_CHILD   = 0x04,
+	AC_TRFLAG_RECEIVE = 0x08,
+	AC_TRFLAG_RECARM  = 0x10,
+	AC_TRFLAG_VCA     = 0x20,
+	AC_TRFLAG_NAMED   = 0x40
+};
 
-		PreventUIRefresh(1);
+// what a rule applies: the 1st matching rule of each kind wins
+enum { AC_KIND_COLOR=0, AC_KIND_ICON, AC_KIND_TCP_LAYOUT, AC_KIND_MCP_LAYOUT, AC_NB_KINDS };
 
-		int iCount = 0;
-		WDL_PtrList<void> gradientTracks;
+#define AC_FILTER_NAME	-1 // i.e. not one of cFilterTypes
+#define AC_FILTER_NONE	-2 // marker/region rule
 
-		if (rule->m_color == -AC_CUSTOM-1)
-			UpdateCustomColors();
+static int FoldChar(unsigned char _c) {
+	return (_c>='A' && _c<='Z') ? _c+32 : _c;
+}
 
-		// Check all tracks for matching strings/properties
-		MediaTrack* temp = NULL;
-		for (int i = 0; i <= GetNumTracks(); i++)
+// Aho-Corasick automaton over the name filters, ASCII case insensitive like stristr()
+// (byte classes keep the transition table small: only bytes used in filters get a column)
+class AC_NameMatcher
+{
+public:
+	AC_NameMatcher() : m_nbClasses(1) {}
+
+	void Build(const WDL_PtrList<const char>* _patterns)
+	{
+		memset(m_classes, 0, sizeof(m_classes));
+		m_nbClasses = 1; // class 0: bytes used in no filter
+		for (int i=0; i<_patterns->GetSize(); i++)
+			if (const unsigned char* p = (const unsigned char*)_patterns->Get(i))
+				for (; *p; p++)
+					if (!m_classes[FoldChar(*p)])
+						m_classes[FoldChar(*p)] = (unsigned char)m_nbClasses++;
+		for (int c=0; c<256; c++)
+			m_classes[c] = m_classes[FoldChar((unsigned char)c)];
+
+		// trie
+		m_goto.Resize(0, false);
+		AddNode();
+		WDL_TypedBuf<int> ownHead, ownNext; // patterns ending at each node, linked lists
+		ownHead.Resize(1, false);
+		ownHead.Get()[0] = -1;
+		ownNext.Resize(_patterns->GetSize(), false);
+		for (int i=0; i<_patterns->GetSize(); i++)
 		{
-			MediaTrack* tr = CSurf_TrackFromID(i, false);
-			bool bColor = bDoColors;
-			bool bIcon  = bDoIcons;
-			bool bLayout[2];
-			bLayout[0]=bLayout[1]=bDoLayout;
-
-			bool bFound = false;
-			SWS_RuleTrack* pACTrack = NULL;
-			for (int j = 0; j < g_pACTracks.Get()->GetSize(); j++)
+			const unsigned char* p = (const unsigned char*)_patterns->Get(i);
+			if (!p)
 			{
-				pACTrack = g_pACTracks.Get()->Get(j);
-				if (pACTrack->m_pTr == tr)
+				ownNext.Get()[i] = -1;
+				continue;
+			}
+			int node = 0;
+			for (; *p; p++)
+			{
+				const int next = node*m_nbClasses + m_classes[*p];
+				if (m_goto.Get()[next] < 0)
 				{
-					bFound = true;
-					break;
+					const int n = AddNode(); // reallocs m_goto
+					m_goto.Get()[next] = n;
+					ownHead.Add(-1);
 				}
+				node = m_goto.Get()[next];
 			}
+			ownNext.Get()[i] = ownHead.Get()[node];
+			ownHead.Get()[node] = i;
+		}
 
-			if (bFound)
+		// failure links, turning the trie into a DFA, and outputs (BFS order)
+		const int nbNodes = m_goto.GetSize() / m_nbClasses;
+		WDL_TypedBuf<int> fail, queue;
+		fail.Resize(nbNodes, false);
+		queue.Resize(nbNodes, false);
+		m_outStart.Resize(nbNodes, false);
+		m_outCount.Resize(nbNodes, false);
+		m_out.Resize(0, false);
+
+		int qHead=0, qTail=0;
+		queue.Get()[qTail++] = 0;
+		fail.Get()[0] = 0;
+		while (qHead < qTail)
+		{
+			int u = queue.Get()[qHead++];
+			int f = fail.Get()[u];
+
+			m_outStart.Get()[u] = m_out.GetSize();
+			for (int i=ownHead.Get()[u]; i>=0; i=ownNext.Get()[i])
+				m_out.Add(i);
+			if (u) // outputs of the failure node are already known (shallower)
+				for (int i=m_outStart.Get()[f]; i<m_outStart.Get()[f]+m_outCount.Get()[f]; i++)
+					m_out.Add(m_out.Get()[i]);
+			m_outCount.Get()[u] = m_out.GetSize() - m_outStart.Get()[u];
+
+			for (int c=0; c<m_nbClasses; c++)
 			{
-				// If already modified by a different rule, or ignoring the color/icon/layout ignore this track
-				if (pACTrack->m_bColored || rule->m_color == -AC_IGNORE-1)
-					bColor = false;
+				int* v = m_goto.Get() + u*m_nbClasses + c;
+				if (*v < 0)
+					*v = u ? m_goto.Get()[f*m_nbClasses + c] : 0;
+				else
+				{
+					fail.Get()[*v] = u ? m_goto.Get()[f*m_nbClasses + c] : 0;
+					queue.Get()[qTail++] = *v;
+				}
+			}
+		}
+	}
 
-				if (pACTrack->m_bIconed || !rule->m_icon.Get()[0])
-					bIcon = false;
+	// sets _hits[i] for all patterns i found in _str
+	void Match(const char* _str, char* _hits) const
+	{
+		if (!m_goto.GetSize())
+			return;
+		int node = 0;
+		Report(node, _hits); // empty patterns
+		for (const unsigned char* p = (const unsigned char*)_str; *p; p++)
+		{
+			node = m_goto.Get()[node*m_nbClasses + m_classes[*p]];
+			if (m_outCount.Get()[node])
+				Report(node, _hits);
+		}
+	}
 
-				for (int k=0; k<2; k++)
-					if (pACTrack->m_bLayouted[k] || !rule->m_layout[k].Get()[0])
-						bLayout[k] = false;
-			}
-			else
-				pACTrack = g_pACTracks.Get()->Add(new SWS_RuleTrack(tr));
+private:
+	int AddNode()
+	{
+		int n = m_goto.GetSize() / m_nbClasses;
+		int* row = m_goto.Resize((n+1)*m_nbClasses, false) + n*m_nbClasses;
+		for (int c=0; c<m_nbClasses; c++)
+			row[c] = -1;
+		return n;
+	}
+	void Report(int _node, char* _hits) const
+	{
+		const int* out = m_out.Get() + m_outStart.Get()[_node];
+		for (int i=0; i<m_outCount.Get()[_node]; i++)
+			_hits[out[i]] = 1;
+	}
 
-			// Do the track rule matching
-			if (bColor || bIcon || bLayout[0] || bLayout[1])
-			{
-				bool bMatch = false;
+	unsigned char m_classes[256];
+	int m_nbClasses;
+	WDL_TypedBuf<int> m_goto; // node*m_nbClasses+class -> node
+	WDL_TypedBuf<int> m_outStart, m_outCount, m_out; // patterns found at each node
+};
 
-				if (i) // ignore master for most things
-				{
-					// Check "special" rules first:
-					if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_FOLDER]) == 0)
-					{
-						int iType;
-						GetFolderDepth(tr, &iType, &temp);
-						if (iType == 1)
-							bMatch = true;
-					}
-					else if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_CHILDREN]) == 0)
-					{
-						temp = CSurf_TrackFromID(0, false); // JFB fix: 'temp' could be out of sync
-						if (GetFolderDepth(tr, NULL, &temp) >= 1)
-							bMatch = true;
-					}
-					else if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_RECEIVE]) == 0)
-					{
-						if (GetSetTrackSendInfo(tr, -1, 0, "P_SRCTRACK", NULL))
-							bMatch = true;
-					}
-					else if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_UNNAMED]) == 0)
-					{
-						char* cName = (char*)GetSetMediaTrackInfo(tr, "P_NAME", NULL);
-						if (!cName || !cName[0])
-							bMatch = true;
-					}
-					else if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_REC_ARM]) == 0)
-					{
-						int* ra = (int*)GetSetMediaTrackInfo(tr, "I_RECARM", NULL);
-						if (ra && *ra)
-							bMatch = true;
-					}
-					else if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_VCA_MASTER]) == 0)
-					{
-						int iVcaMaster = GetSetTrackGroupMembership(tr, "VOLUME_VCA_MASTER", 0, 0);
+// track rules of g_pACItems with pre-resolved filters, recompiled when rules change
+class AC_TrackRules
+{
+public:
+	AC_TrackRules() : m_gen(0), m_usedFlags(0), m_hasCustomColors(false) {}
 
-						// check newly added groups 33 - 64
-						int iVcaMasterHigh = GetSetTrackGroupMembershipHigh(tr, "VOLUME_VCA_MASTER", 0, 0);
+	// recompiles if needed, the generation changes if so
+	void Update(WDL_PtrList<SWS_RuleItem>* _rules)
+	{
+		// only what affects matching: filters and what rules apply
+		WDL_FastString sig;
+		for (int i=0; i<_rules->GetSize(); i++)
+		{
+			SWS_RuleItem* r = _rules->Get(i);
+			sig.AppendFormatted(32, "%d %d %d ", r->m_type, GetKinds(r), r->m_color == -AC_CUSTOM-1);
+			sig.Append(r->m_str_filter.Get());
+			sig.Append("\n");
+		}
+		if (m_gen && !strcmp(sig.Get(), m_sig.Get()))
+			return;
 
-						if (iVcaMaster || iVcaMasterHigh)
-							bMatch = true;
-					}
-					else if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_ANY]) == 0)
-					{
-						bMatch = true;
-					}
-					else // Check for name match
-					{
-						char* cName = (char*)GetSetMediaTrackInfo(tr, "P_NAME", NULL);
-						if (cName && stristr(cName, rule->m_str_filter.Get()))
-							bMatch = true;
+		m_sig.Set(sig.Get());
+		m_gen++;
+		m_usedFlags = AC_TRFLAG_MASTER|AC_TRFLAG_NAMED;
+		m_hasCustomColors = false;
+		m_rules.Resize(_rules->GetSize(), false);
+
+		WDL_PtrList<const char> patterns;
+		for (int i=0; i<_rules->GetSize(); i++)
+		{
+			SWS_RuleItem* r = _rules->Get(i);
+			Rule* cr = m_rules.Get()+i;
+			cr->kinds = 0;
+			cr->filter = AC_FILTER_NONE;
+			if (r->m_type == AC_TRACK)
+			{
+				cr->kinds = GetKinds(r);
+				cr->filter = AC_FILTER_NAME;
+				for (int j=0; j<NUM_FILTERTYPES; j++)
+					if (!strcmp(r->m_str_filter.Get(), cFilterTypes[j])) {
+						cr->filter = j;
+						break;
 					}
+				switch (cr->filter)
+				{
+					case AC_FOLDER:     m_usedFlags |= AC_TRFLAG_FOLDER; break;
+					case AC_CHILDREN:   m_usedFlags |= AC_TRFLAG_CHILD; break;
+					case AC_RECEIVE:    m_usedFlags |= AC_TRFLAG_RECEIVE; break;
+					case AC_REC_ARM:    m_usedFlags |= AC_TRFLAG_RECARM; break;
+					case AC_VCA_MASTER: m_usedFlags |= AC_TRFLAG_VCA; break;
 				}
-				else if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_MASTER]) == 0)
-				{	// Check master rule
-					bMatch = true;
-				}
+				if (r->m_color == -AC_CUSTOM-1 && (cr->kinds & (1<<AC_KIND_COLOR)))
+					m_hasCustomColors = true;
+			}
+			patterns.Add(cr->filter == AC_FILTER_NAME ? r->m_str_filter.Get() : NULL);
+		}
+		m_names.Build(&patterns);
+		m_hits.Resize(_rules->GetSize(), false);
+	}
 
-				if (bMatch)
-				{
-					// Set the color
-					if (bColor)
-					{
-						int iCurColor = *(int*)GetSetMediaTrackInfo(tr, "I_CUSTOMCOLOR", NULL);
-						if (!(iCurColor & 0x1000000))
-							iCurColor = 0;
-						int newCol = iCurColor;
-
-						if (rule->m_color == -AC_RANDOM-1)
-						{
-							// Only randomize once
-							if (!(iCurColor & 0x1000000))
-								newCol = RGB(rand() % 256, rand() % 256, rand() % 256) | 0x1000000;
-						}
-						else if (rule->m_color == -AC_CUSTOM-1)
-						{
-							if (!AllBlack())
-								while(!(newCol = g_custColors[iCount++ % 16]));
-							newCol |= 0x1000000;
-						}
-						else if (rule->m_color == -AC_GRADIENT-1)
-							gradientTracks.Add(tr);
-						else if (rule->m_color == -AC_NONE-1)
-							newCol = 0;
-						else if (rule->m_color == -AC_PARENT-1)
-						{
-							MediaTrack* parent = (MediaTrack*)GetSetMediaTrackInfo(tr, "P_PARTRACK", NULL);
-							if (parent)
-							{
-								int pcol = *(int*)GetSetMediaTrackInfo(parent, "I_CUSTOMCOLOR", NULL);
-								if (pcol & 0x1000000) // Only color like parent if the parent has color (maybe not?)
-									newCol = pcol;
-							}
-						}
-						else
-							newCol = rule->m_color | 0x1000000;
+	int GetGeneration() const { return m_gen; }
+	int GetUsedFlags() const { return m_usedFlags; }
+	bool HasCustomColors() const { return m_hasCustomColors; }
 
-						// Only set the color if the user hasn't changed the color manually (but record it as being changed)
-						if ((bForce || iCurColor == pACTrack->m_col) && newCol != iCurColor)
-						{
-							GetSetMediaTrackInfo(tr, "I_CUSTOMCOLOR", &newCol);
-						}
+	// _rulesOut[AC_KIND_*]: index of the 1st matching rule of each kind, -1 if none
+	void Match(int _flags, const char* _name, int* _rulesOut)
+	{
+		for (int k=0; k<AC_NB_KINDS; k++)
+			_rulesOut[k] = -1;
+		if (!m_rules.GetSize())
+			return;
 
-						pACTrack->m_col = newCol;
-						pACTrack->m_bColored = true;
-					}
+		memset(m_hits.Get(), 0, m_hits.GetSize());
+		if (!(_flags&AC_TRFLAG_MASTER))
+			m_names.Match(_name, m_hits.Get());
 
-					if (bIcon)
+		int found = 0;
+		for (int i=0; i<m_rules.GetSize() && found != (1<<AC_NB_KINDS)-1; i++)
+		{
+			const Rule* r = m_rules.Get()+i;
+			if ((r->kinds & ~found) && RuleMatch(r, _flags, m_hits.Get()[i]!=0))
+				for (int k=0; k<AC_NB_KINDS; k++)
+					if ((r->kinds & ~found) & (1<<k))
 					{
-						if (_stricmp(rule->m_icon.Get(), pACTrack->m_icon.Get()))
-						{
-							const char *cur = (const char*)GetSetMediaTrackInfo(tr, "P_ICON", NULL); // requires REAPER v5.15pre6+
-							cur = GetShortResourcePath("Data" WDL_DIRCHAR_STR "track_icons", cur);
-							if (cur && _stricmp(cur, rule->m_icon.Get()))
-							{
-								// Only overwrite the icon if there's no icon, or we're forcing, or we set it ourselves earlier
-								if (bForce || !_stricmp(cur, pACTrack->m_icon.Get()))
-								{
-									GetSetMediaTrackInfo(tr, "P_ICON", (void*)rule->m_icon.Get());
-								}
-							}
-							pACTrack->m_icon.Set(rule->m_icon.Get());
-						}
-						pACTrack->m_bIconed = true;
+						_rulesOut[k] = i;
+						found |= 1<<k;
 					}
+		}
+	}
+
+private:
+	struct Rule
+	{
+		int filter; // AC_ANY, etc. or AC_FILTER_NAME/AC_FILTER_NONE
+		int kinds;  // &(1<<AC_KIND_*)
+	};
 
-					// Set the layout
-					for (int k=0; k<2; k++) if (bLayout[k])
+	static int GetKinds(SWS_RuleItem* _r)
+	{
+		return (_r->m_color != -AC_IGNORE-1 ? 1<<AC_KIND_COLOR : 0) |
+			(*_r->m_icon.Get() ? 1<<AC_KIND_ICON : 0) |
+			(*_r->m_layout[0].Get() ? 1<<AC_KIND_TCP_LAYOUT : 0) |
+			(*_r->m_layout[1].Get() ? 1<<AC_KIND_MCP_LAYOUT : 0);
+	}
+
+	static bool RuleMatch(const Rule* _r, int _flags, bool _nameHit)
+	{
+		if (_flags&AC_TRFLAG_MASTER) // ignore master for most things
+			return _r->filter == AC_MASTER;
+		switch (_r->filter)
+		{
+			case AC_FILTER_NAME: return _nameHit;
+			case AC_ANY:         return true;
+			case AC_UNNAMED:     return !(_flags&AC_TRFLAG_NAMED);
+			case AC_FOLDER:      return (_flags&AC_TRFLAG_FOLDER) != 0;
+			case AC_CHILDREN:    return (_flags&AC_TRFLAG_CHILD) != 0;
+			case AC_RECEIVE:     return (_flags&AC_TRFLAG_RECEIVE) != 0;
+			case AC_REC_ARM:     return (_flags&AC_TRFLAG_RECARM) != 0;
+			case AC_VCA_MASTER:  return (_flags&AC_TRFLAG_VCA) != 0;
+		}
+		return false;
+	}
+
+	int m_gen, m_usedFlags;
+	bool m_hasCustomColors;
+	WDL_FastString m_sig;
+	WDL_TypedBuf<Rule> m_rules;
+	AC_NameMatcher m_names;
+	WDL_TypedBuf<char> m_hits; // per rule, name filter hits
+};
+
+// matched rules of a track, re-evaluated only when its name, state or the rules change
+struct AC_TrackMatch
+{
+	WDL_FastString name;
+	int flags, gen, pass;
+	int rules[AC_NB_KINDS];
+};
+
+static void DeleteTrackMatch(AC_TrackMatch* _m) { delete _m; }
+
+static AC_TrackRules g_acTrackRules;
+static WDL_PtrKeyedArray<AC_TrackMatch*> g_acTrackMatches(DeleteTrackMatch); // by MediaTrack*
+
+// only reads the states that rules test (see AC_TrackRules::GetUsedFlags())
+// _depth: folder depth, updated while walking tracks in order (vs GetFolderDepth() from the 1st track)
+static int GetTrackRuleFlags(MediaTrack* _tr, int _id, const char* _name, int _usedFlags, int* _depth)
+{
+	if (!_id)
+		return AC_TRFLAG_MASTER;
+
+	int flags = (_name && *_name) ? AC_TRFLAG_NAMED : 0;
+	if (_usedFlags & (AC_TRFLAG_FOLDER|AC_TRFLAG_CHILD))
+	{
+		int iFolder = *(int*)GetSetMediaTrackInfo(_tr, "I_FOLDERDEPTH", NULL);
+		if (iFolder == 1)
+			flags |= AC_TRFLAG_FOLDER;
+		if (*_depth >= 1) // a folder parent is counted at the previous level
+			flags |= AC_TRFLAG_CHILD;
+		*_depth += iFolder;
+	}
+	if ((_usedFlags & AC_TRFLAG_RECEIVE) && GetSetTrackSendInfo(_tr, -1, 0, "P_SRCTRACK", NULL))
+		flags |= AC_TRFLAG_RECEIVE;
+	if (_usedFlags & AC_TRFLAG_RECARM)
+	{
+		int* ra = (int*)GetSetMediaTrackInfo(_tr, "I_RECARM", NULL);
+		if (ra && *ra)
+			flags |= AC_TRFLAG_RECARM;
+	}
+	// check newly added groups 33 - 64 too
+	if ((_usedFlags & AC_TRFLAG_VCA) && 
+		(GetSetTrackGroupMembership(_tr, "VOLUME_VCA_MASTER", 0, 0) || GetSetTrackGroupMembershipHigh(_tr, "VOLUME_VCA_MASTER", 0, 0)))
+		flags |= AC_TRFLAG_VCA;
+	return flags;
+}
+
+static const int* GetTrackRuleMatch(MediaTrack* _tr, int _flags, const char* _name, int _pass)
+{
+	if (!_name)
+		_name = "";
+	AC_TrackMatch* m = g_acTrackMatches.Get((INT_PTR)_tr, NULL);
+	if (!m)
+	{
+		m = new AC_TrackMatch;
+		m->gen = -1;
+		g_acTrackMatches.Insert((INT_PTR)_tr, m);
+	}
+	if (m->gen != g_acTrackRules.GetGeneration() || m->flags != _flags || strcmp(m->name.Get(), _name))
+	{
+		m->gen = g_acTrackRules.GetGeneration();
+		m->flags = _flags;
+		m->name.Set(_name);
+		g_acTrackRules.Match(_flags, _name, m->rules);
+	}
+	m->pass = _pass;
+	return m->rules;
+}
+
+// Matches all tracks against the compiled rules and applies the 1st matching rule
+// of each kind. Gradients and custom colors are spread over the tracks colored by
+// a same rule, in track order
+static void ApplyColorRulesToTracks(bool bDoColors, bool bDoIcons, bool bDoLayout, bool bForce)
+{
+	if (!bDoColors && !bDoIcons && !bDoLayout) // NF: fix #936
+		return;
+
+	g_acTrackRules.Update(&g_pACItems);
+
+	bool hasTrackRules = false;
+	for (int i = 0; !hasTrackRules && i < g_pACItems.GetSize(); i++)
+		hasTrackRules = (g_pACItems.Get(i)->m_type == AC_TRACK);
+	if (!hasTrackRules)
+	{
+		g_acTrackMatches.DeleteAll();
+		return;
+	}
+
+	static int sPass = 0;
+	sPass++;
+
+	// 1st pass: match tracks, count gradient tracks per rule
+	const int nbTracks = GetNumTracks();
+	const int usedFlags = g_acTrackRules.GetUsedFlags();
+	WDL_TypedBuf<int> matches, gradCounts, gradIdx, custCounts;
+	matches.Resize((nbTracks+1)*AC_NB_KINDS, false);
+	memset(gradCounts.Resize(g_pACItems.GetSize(), false), 0, g_pACItems.GetSize()*sizeof(int));
+	memset(gradIdx.Resize(g_pACItems.GetSize(), false), 0, g_pACItems.GetSize()*sizeof(int));
+	memset(custCounts.Resize(g_pACItems.GetSize(), false), 0, g_pACItems.GetSize()*sizeof(int));
+
+	int depth = 0;
+	for (int i = 0; i <= nbTracks; i++)
+	{
+		MediaTrack* tr = CSurf_TrackFromID(i, false);
+		const char* name = i ? (const char*)GetSetMediaTrackInfo(tr, "P_NAME", NULL) : NULL;
+		const int* rules = GetTrackRuleMatch(tr, GetTrackRuleFlags(tr, i, name, usedFlags, &depth), name, sPass);
+		memcpy(matches.Get()+i*AC_NB_KINDS, rules, AC_NB_KINDS*sizeof(int));
+		if (bDoColors && rules[AC_KIND_COLOR] >= 0 && g_pACItems.Get(rules[AC_KIND_COLOR])->m_color == -AC_GRADIENT-1)
+			gradCounts.Get()[rules[AC_KIND_COLOR]]++;
+	}
+
+	// forget deleted tracks
+	for (int i = g_acTrackMatches.GetSize()-1; i >= 0; i--)
+	{
+		INT_PTR tr;
+		AC_TrackMatch* m = g_acTrackMatches.Enumerate(i, &tr);
+		if (m && m->pass != sPass)
+			g_acTrackMatches.Delete(tr);
+	}
+
+	if (bDoColors && g_acTrackRules.HasCustomColors())
+		UpdateCustomColors();
+
+	WDL_PtrKeyedArray<SWS_RuleTrack*> ruleTracks;
+	for (int j = 0; j < g_pACTracks.Get()->GetSize(); j++)
+		ruleTracks.Insert((INT_PTR)g_pACTracks.Get()->Get(j)->m_pTr, g_pACTracks.Get()->Get(j));
+
+	// 2nd pass: apply
+	for (int i = 0; i <= nbTracks; i++)
+	{
+		MediaTrack* tr = CSurf_TrackFromID(i, false);
+		const int* rules = matches.Get()+i*AC_NB_KINDS;
+
+		SWS_RuleTrack* pACTrack = ruleTracks.Get((INT_PTR)tr, NULL);
+		if (!pACTrack)
+		{
+			pACTrack = g_pACTracks.Get()->Add(new SWS_RuleTrack(tr));
+			ruleTracks.Insert((INT_PTR)tr, pACTrack);
+		}
+
+		// Set the color
+		if (bDoColors && rules[AC_KIND_COLOR] >= 0)
+		{
+			const int r = rules[AC_KIND_COLOR];
+			SWS_RuleItem* rule = g_pACItems.Get(r);
+
+			int iCurColor = *(int*)GetSetMediaTrackInfo(tr, "I_CUSTOMCOLOR", NULL);
+			if (!(iCurColor & 0x1000000))
+				iCurColor = 0;
+			int newCol = iCurColor;
+
+			if (rule->m_color == -AC_RANDOM-1)
+			{
+				// Only randomize once
+				if (!(iCurColor & 0x1000000))
+					newCol = RGB(rand() % 256, rand() % 256, rand() % 256) | 0x1000000;
+			}
+			else if (rule->m_color == -AC_CUSTOM-1)
+			{
+				if (!AllBlack())
+					while(!(newCol = g_custColors[custCounts.Get()[r]++ % 16]));
+				newCol |= 0x1000000;
+			}
+			else if (rule->m_color == -AC_GRADIENT-1)
+			{
+				const int idx = gradIdx.Get()[r]++;
+				newCol = g_crGradStart | 0x1000000;
+				if (idx && gradCounts.Get()[r] > 1)
+					newCol = CalcGradient(g_crGradStart, g_crGradEnd, (double)idx / (gradCounts.Get()[r]-1)) | 0x1000000;
+			}
+			else if (rule->m_color == -AC_NONE-1)
+				newCol = 0;
+			else if (rule->m_color == -AC_PARENT-1)
+			{
+				MediaTrack* parent = (MediaTrack*)GetSetMediaTrackInfo(tr, "P_PARTRACK", NULL);
+				if (parent)
+				{
+					int pcol = *(int*)GetSetMediaTrackInfo(parent, "I_CUSTOMCOLOR", NULL);
+					if (pcol & 0x1000000) // Only color like parent if the parent has color (maybe not?)
+						newCol = pcol;
+				}
+			}
+			else
+				newCol = rule->m_color | 0x1000000;
+
+			// Only set the color if the user hasn't changed the color manually (but record it as being changed)
+			// Gradients are always set
+			if ((bForce || iCurColor == pACTrack->m_col || rule->m_color == -AC_GRADIENT-1) && newCol != iCurColor)
+			{
+				GetSetMediaTrackInfo(tr, "I_CUSTOMCOLOR", &newCol);
+			}
+
+			pACTrack->m_col = newCol;
+			pACTrack->m_bColored = true;
+		}
+
+		if (bDoIcons && rules[AC_KIND_ICON] >= 0)
+		{
+			SWS_RuleItem* rule = g_pACItems.Get(rules[AC_KIND_ICON]);
+			if (_stricmp(rule->m_icon.Get(), pACTrack->m_icon.Get()))
+			{
+				const char *cur = (const char*)GetSetMediaTrackInfo(tr, "P_ICON", NULL); // requires REAPER v5.15pre6+
+				cur = GetShortResourcePath("Data" WDL_DIRCHAR_STR "track_icons", cur);
+				if (cur && _stricmp(cur, rule->m_icon.Get()))
+				{
+					// Only overwrite the icon if there's no icon, or we're forcing, or we set it ourselves earlier
+					if (bForce || !_stricmp(cur, pACTrack->m_icon.Get()))
 					{
-						// 'normal' track layout
-						if (_stricmp(rule->m_layout[k].Get(), pACTrack->m_layout[k].Get()) && _stricmp(rule->m_layout[k].Get(), "(hide)")) 
-						{
-							const char *curlayout = (const char*)GetSetMediaTrackInfo(tr, k ? "P_MCP_LAYOUT" : "P_TCP_LAYOUT", NULL);
-							if (curlayout && _stricmp(curlayout, rule->m_layout[k].Get()))
-							{
-								// Only overwrite the layout if there's no layout, or we're forcing, or we set it ourselves earlier
-								if (bForce || !_stricmp(curlayout, pACTrack->m_layout[k].Get()))
-								{
-									GetSetMediaTrackInfo(tr, k ? "P_MCP_LAYOUT" : "P_TCP_LAYOUT", (void*)rule->m_layout[k].Get());
-								}
-							}
-							pACTrack->m_layout[k].Set(rule->m_layout[k].Get());
-						}
-						// '(hide)' layout 
-						if (_stricmp(rule->m_layout[k].Get(), pACTrack->m_layout[k].Get()) && !_stricmp(rule->m_layout[k].Get(), "(hide)")) 
-						{
-							bool isTrackVisible = IsTrackVisible(tr, k ? true : false);
-
-							if (isTrackVisible && !_stricmp(rule->m_layout[k].Get(), "(hide)"))
-							{	
-								// Only hide the track if visible, or we're forcing, or we hid it ourselves earlier
-								if (bForce || isTrackVisible == IsTrackVisible(pACTrack->m_pTr, k ? true : false))
-								{
-									GetSetMediaTrackInfo(tr, k ? "B_SHOWINMIXER" : "B_SHOWINTCP", &g_i0); // hide the track
-									TrackList_AdjustWindows(k ? false : true); // https://forum.cockos.com/showthread.php?t=208275
-								}
-							}
-							pACTrack->m_layout[k].Set(rule->m_layout[k].Get());
-						}
-						pACTrack->m_bLayouted[k] = true;
+						GetSetMediaTrackInfo(tr, "P_ICON", (void*)rule->m_icon.Get());
 					}
-				} // /if (bMatch)
-			} // /Do the track rule matching
-		} // /iterate through all tracks
+				}
+				pACTrack->m_icon.Set(rule->m_icon.Get());
+			}
+			pACTrack->m_bIconed = true;
+		}
 
-		// Handle gradients
-		for (int i = 0; i < gradientTracks.GetSize(); i++)
+		// Set the layout
+		for (int k=0; k<2; k++) if (bDoLayout && rules[AC_KIND_TCP_LAYOUT+k] >= 0)
 		{
-			int newCol = g_crGradStart | 0x1000000;
-			if (i && gradientTracks.GetSize() > 1)
-				newCol = CalcGradient(g_crGradStart, g_crGradEnd, (double)i / (gradientTracks.GetSize()-1)) | 0x1000000;
-			for (int j = 0; j < g_pACTracks.Get()->GetSize(); j++)
-				if (g_pACTracks.Get()->Get(j)->m_pTr == (MediaTrack*)gradientTracks.Get(i))
+			SWS_RuleItem* rule = g_pACItems.Get(rules[AC_KIND_TCP_LAYOUT+k]);
+
+			// 'normal' track layout
+			if (_stricmp(rule->m_layout[k].Get(), pACTrack->m_layout[k].Get()) && _stricmp(rule->m_layout[k].Get(), "(hide)")) 
+			{
+				const char *curlayout = (const char*)GetSetMediaTrackInfo(tr, k ? "P_MCP_LAYOUT" : "P_TCP_LAYOUT", NULL);
+				if (curlayout && _stricmp(curlayout, rule->m_layout[k].Get()))
 				{
-					g_pACTracks.Get()->Get(j)->m_col = newCol;
-					break;
+					// Only overwrite the layout if there's no layout, or we're forcing, or we set it ourselves earlier
+					if (bForce || !_stricmp(curlayout, pACTrack->m_layout[k].Get()))
+					{
+						GetSetMediaTrackInfo(tr, k ? "P_MCP_LAYOUT" : "P_TCP_LAYOUT", (void*)rule->m_layout[k].Get());
+					}
 				}
-			GetSetMediaTrackInfo((MediaTrack*)gradientTracks.Get(i), "I_CUSTOMCOLOR", &newCol);
-		}
+				pACTrack->m_layout[k].Set(rule->m_layout[k].Get());
+			}
+			// '(hide)' layout 
+			if (_stricmp(rule->m_layout[k].Get(), pACTrack->m_layout[k].Get()) && !_stricmp(rule->m_layout[k].Get(), "(hide)")) 
+			{
+				bool isTrackVisible = IsTrackVisible(tr, k ? true : false);
 
-		PreventUIRefresh(-1);
+				if (isTrackVisible && !_stricmp(rule->m_layout[k].Get(), "(hide)"))
+				{	
+					// Only hide the track if visible, or we're forcing, or we hid it ourselves earlier
+					if (bForce || isTrackVisible == IsTrackVisible(pACTrack->m_pTr, k ? true : false))
+					{
+						GetSetMediaTrackInfo(tr, k ? "B_SHOWINMIXER" : "B_SHOWINTCP", &g_i0); // hide the track
+						TrackList_AdjustWindows(k ? false : true); // https://forum.cockos.com/showthread.php?t=208275
+					}
+				}
+				pACTrack->m_layout[k].Set(rule->m_layout[k].Get());
+			}
+			pACTrack->m_bLayouted[k] = true;
+		}
 	}
 }
 
@@ -991,8 +1285,7 @@ void AutoColorTrack(bool bForce)
 
 	PreventUIRefresh(1);
 
-	for (int i = 0; i < g_pACItems.GetSize(); i++)
-		ApplyColorRuleToTrack(g_pACItems.Get(i), bDoColors, bDoIcons, bDoLayouts, bForce);
+	ApplyColorRulesToTracks(bDoColors, bDoIcons, bDoLayouts, bForce);
 
 	// Remove colors/icons if necessary
 	for (int i = 0; i < g_pACTracks.Get()->GetSize(); i++)
@@ -1061,6 +1354,20 @@ void AutoColorTrack(bool bForce)
 	bRecurse = false;
 }
 
+static bool MarkerRegionRuleMatch(SWS_RuleItem* _rule, int _flags, bool _isRgn, const char* _name)
+{
+	return (!strcmp(cFilterTypes[AC_RGNANY], _rule->m_str_filter.Get()) ||
+		(!strcmp(cFilterTypes[AC_RGNUNNAMED], _rule->m_str_filter.Get()) && (!_name || !*_name)) ||
+		(_name && stristr(_name, _rule->m_str_filter.Get())))
+		&&
+		((_flags&AC_REGION && _isRgn && _rule->m_type==AC_REGION) ||
+		(_flags&AC_MARKER && !_isRgn && _rule->m_type==AC_MARKER));
+}
+
+static int MarkerRegionRuleColor(SWS_RuleItem* _rule, bool _isRgn, ColorTheme* _ct) {
+	return _rule->m_color==-AC_NONE-1 ? (_isRgn?_ct->marker:_ct->region) : _rule->m_color | 0x1000000;
+}
+
 void ApplyColorRuleToMarkerRegion(SWS_RuleItem* _rule, int _flags)
 {
 	ColorTheme* ct = SNM_GetColorTheme();
@@ -1077,15 +1384,8 @@ void ApplyColorRuleToMarkerRegion(SWS_RuleItem* _rule, int _flags)
 	{
 		while ((x = EnumProjectMarkers3(NULL, x, &isRgn, &pos, &end, &name, &num, &color)))
 		{
-			if ((!strcmp(cFilterTypes[AC_RGNANY], _rule->m_str_filter.Get()) ||
-				(!strcmp(cFilterTypes[AC_RGNUNNAMED], _rule->m_str_filter.Get()) && (!name || !*name)) ||
-				(name && stristr(name, _rule->m_str_filter.Get())))
-				&&
-				((_flags&AC_REGION && isRgn && _rule->m_type==AC_REGION) ||
-				(_flags&AC_MARKER && !isRgn && _rule->m_type==AC_MARKER)))
-			{
-				SetProjectMarkerByIndex(NULL, x-1, isRgn, pos, end, num, NULL, _rule->m_color==-AC_NONE-1 ? (isRgn?ct->marker:ct->region) : _rule->m_color | 0x1000000);
-			}
+			if (MarkerRegionRuleMatch(_rule, _flags, isRgn, name))
+				SetProjectMarkerByIndex(NULL, x-1, isRgn, pos, end, num, NULL, MarkerRegionRuleColor(_rule, isRgn, ct));
 		}
 	}
 	PreventUIRefresh(-1);
@@ -1119,6 +1419,42 @@ void AutoColorMarkerRegion(bool _force, int _flags)
 	bRecurse = false;
 }
 
+// incremental version of AutoColorMarkerRegion(false): only colors added/changed
+// markers/regions, with the 1st matching rule (same result as applying all rules
+// in reverse order), and only if their color differs
+void AC_MarkerRegionListener::NotifyMarkerRegionChanges(const SNM_MarkerRegionChanges* _changes)
+{
+	ColorTheme* ct = SNM_GetColorTheme();
+	int flags = (g_bACMEnabled ? AC_MARKER : 0) | (g_bACREnabled ? AC_REGION : 0);
+	if (!ct || !flags)
+		return;
+
+	bool updated = false;
+	for (int i=0; i < _changes->m_added.GetSize()+_changes->m_changed.GetSize(); i++)
+	{
+		int id = i<_changes->m_added.GetSize() ? _changes->m_added.Get()[i] : _changes->m_changed.Get()[i-_changes->m_added.GetSize()].m_id;
+		double pos, end; int num, color; bool isRgn; const char* name;
+		int idx = EnumMarkerRegionById(NULL, id, &isRgn, &pos, &end, &name, &num, &color);
+		if (idx<0)
+			continue;
+
+		for (int j=0; j<g_pACItems.GetSize(); j++)
+			if (MarkerRegionRuleMatch(g_pACItems.Get(j), flags, isRgn, name))
+			{
+				int newColor = MarkerRegionRuleColor(g_pACItems.Get(j), isRgn, ct);
+				if (newColor != color)
+				{
+					if (!updated) PreventUIRefresh(1);
+					SetProjectMarkerByIndex(NULL, idx, isRgn, pos, end, num, NULL, newColor);
+					updated = true;
+				}
+				break;
+			}
+	}
+	if (updated)
+		PreventUIRefresh(-1);
+}
+
 void EnableAutoColor(COMMAND_T* ct)
 {
 	switch((int)ct->user)
@@ -28,6 +28,7 @@
 #include "stdafx.h"
 
 #include "../SnM/SnM_Dlg.h"
+#include "../SnM/SnM_Marker.h"
 #include "MarkerListClass.h"
 #include "MarkerList.h"
 #include "MarkerListActions.h"
@@ -147,7 +148,7 @@ void SWS_MarkerListView::OnItemDblClk(SWS_ListItem* item, int iCol)
 
 int SWS_MarkerListView::OnItemSort(SWS_ListItem* item1, SWS_ListItem* item2)
 {
-	int iRet;
+	int iRet = 0;
 	MarkerItem* mi1 = (MarkerItem*)item1;
 	MarkerItem* mi2 = (MarkerItem*)item2;
 
@@ -214,14 +215,32 @@ int SWS_MarkerListView::GetItemState(SWS_ListItem* item)
 	return GetCursorPosition() == mi->GetPos() ? 1 : 0;
 }
 
+// The list view is virtual (LVS_OWNERDATA): items are pulled again only when this changes
+int SWS_MarkerListView::GetItemListGeneration()
+{
+	return g_curList ? g_curList->m_iGen : -1;
+}
+
+// Avoids rebuilding the list from REAPER on each timer tick
+class ML_MarkerRegionListener : public SNM_MarkerRegionListener
+{
+public:
+	ML_MarkerRegionListener() : SNM_MarkerRegionListener(), m_bChanged(true) {}
+	void NotifyMarkerRegionUpdate(int _updateFlags) { m_bChanged = true; }
+	bool m_bChanged;
+};
+
+static ML_MarkerRegionListener g_mkrRgnListener;
+
 SWS_MarkerListWnd::SWS_MarkerListWnd()
-:SWS_DockWnd(IDD_MARKERLIST, __LOCALIZE("Marker List","sws_DLG_102"), "SWSMarkerList"), m_dCurPos(DBL_MAX)
+:SWS_DockWnd(IDD_MARKERLIST, __LOCALIZE("Marker List","sws_DLG_102"), "SWSMarkerList"), m_dCurPos(DBL_MAX), m_iListGen(-1)
 {
 	// Must call SWS_DockWnd::Init() to restore parameters and open the window if necessary
 	Init();
 }
 
-void SWS_MarkerListWnd::Update(bool bForce)
+// bRebuild: false to skip the diff against project markers/regions (no change notified)
+void SWS_MarkerListWnd::Update(bool bForce, bool bRebuild)
 {
 	// Change the time string if the project time mode changes
 	static int prevTimeMode = -1;
@@ -244,13 +263,17 @@ void SWS_MarkerListWnd::Update(bool bForce)
 		g_curList = new MarkerList("CurrentList", true);
 		bChanged = true;
 	}
-	else if (g_curList->BuildFromReaper())
+	else if (bRebuild && g_curList->BuildFromReaper())
+		bChanged = true;
+	else if (g_curList->m_iGen != m_iListGen) // rebuilt elsewhere, e.g. export actions
 		bChanged = true;
 
-	if (m_pLists.GetSize() && bChanged)
+	SWS_ListView* lv = m_pLists.Get(0);
+	if (lv && bChanged && lv->GetEditingItem() == -1 && !lv->UpdatesDisabled()) // retried on next call otherwise
 	{
 		SWS_SectionLock lock(&g_curList->m_mutex);
-		m_pLists.Get(0)->Update();
+		m_iListGen = ++g_curList->m_iGen; // also filter, time mode, edit cursor (selection) changes
+		lv->Update();
 	}
 }
 
@@ -279,6 +302,8 @@ void SWS_MarkerListWnd::OnInitDlg()
 	
 	Update();
 
+	g_mkrRgnListener.m_bChanged = false;
+	RegisterToMarkerRegionUpdates(&g_mkrRgnListener);
 	SetTimer(m_hwnd, 1, 500, NULL);
 }
 
@@ -389,6 +414,7 @@ HMENU SWS_MarkerListWnd::OnContextMenu(int x, int y, bool* wantDefaultItems)
 void SWS_MarkerListWnd::OnDestroy()
 {
 	KillTimer(m_hwnd, 1);
+	UnregisterToMarkerRegionUpdates(&g_mkrRgnListener);
 	char cOptions[4];
 	sprintf(cOptions, "%c %c", m_bPlayOnSel ? '1' : '0', m_bScroll ? '1' : '0');
 	WritePrivateProfileString(SWS_INI, ML_OPTIONS_KEY, cOptions, get_ini_file());
@@ -397,7 +423,11 @@ void SWS_MarkerListWnd::OnDestroy()
 void SWS_MarkerListWnd::OnTimer(WPARAM wParam)
 {
 	if (ListView_GetSelectedCount(m_pLists.Get(0)->GetHWND()) <= 1 || !IsActive())
-		Update();
+	{
+		// cursor/time mode changes are still polled, markers/regions are notified
+		Update(false, g_mkrRgnListener.m_bChanged);
+		g_mkrRgnListener.m_bChanged = false;
+	}
 }
 
 int SWS_MarkerListWnd::OnKey(MSG* msg, int iKeyState)
@@ -44,6 +44,7 @@ protected:
 	int  OnItemSort(SWS_ListItem* item1, SWS_ListItem* item2);
 	void GetItemList(SWS_ListItemList* pList);
 	int  GetItemState(SWS_ListItem* item);
+	int  GetItemListGeneration();
 
 private:
 	SWS_MarkerListWnd* m_pMarkerList;
@@ -53,12 +54,13 @@ class SWS_MarkerListWnd : public SWS_DockWnd
 {
 public:
 	SWS_MarkerListWnd();
-	void Update(bool bForce = false);
+	void Update(bool bForce = false, bool bRebuild = true);
 	double m_dCurPos;
 
 	WDL_String m_filter;
 	bool m_bPlayOnSel;
 	bool m_bScroll;
+	int m_iListGen; // last g_curList->m_iGen pushed to the list view
 	
 protected:
 	void OnInitDlg();
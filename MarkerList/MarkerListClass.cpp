@@ -84,7 +84,7 @@ void MarkerItem::UpdateProject()
 	SetProjectMarker4(NULL, m_num, m_bReg, m_dPos, m_dRegEnd, GetName(), m_iColor ? m_iColor | 0x1000000 : 0, !*GetName() ? 1 : 0);
 }
 
-MarkerList::MarkerList(const char* name, bool bGetCurList)
+MarkerList::MarkerList(const char* name, bool bGetCurList) : m_iGen(0)
 {
 	if (name && strlen(name))
 	{
@@ -143,6 +143,8 @@ bool MarkerList::BuildFromReaper()
 		m_items.Delete(i, true);
 	}
 
+	if (bChanged)
+		m_iGen++;
 	return bChanged;
 }
 
@@ -200,6 +202,7 @@ void MarkerList::ClipboardToList()
 	if (OpenClipboard(g_hwndParent))
 	{
 		m_items.Empty(true);
+		m_iGen++;
 		LineParser lp(false);
 		HGLOBAL clipBoard = GetClipboardData(CF_TEXT);
 		char* data = NULL;
@@ -393,6 +396,7 @@ void MarkerList::CropToTimeSel(bool bOffset)
 		return;
 
 	// Don't crop the end of regions
+	m_iGen++;
 	for (int i = 0; i < m_items.GetSize(); i++)
 	{
 		MarkerItem* item = m_items.Get(i);
@@ -79,6 +79,7 @@ public:
 
 	char* m_name;
 	WDL_PtrList<MarkerItem> m_items;
+	int m_iGen; // bumped when m_items changes, see SWS_MarkerListView::GetItemListGeneration()
 	SWS_Mutex m_mutex;
 
 private:
@@ -30,35 +30,133 @@
 #include "Analysis.h"
 #include "../sws_waitdlg.h"
 
+#include <atomic>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define SWS_ANALYSIS_SSE2
+#endif
+
 #include <WDL/localize/localize.h>
 
 static void GetRMSOptions(double *target, double *windowSize);
 
+#define ANALYSIS_BLOCK_FRAMES 16384 // I/O block size, independent of the RMS window
+
+// Compensated (Kahan) sum, running sums over long sources would otherwise drift
+struct KahanSum
+{
+	double sum, c;
+	KahanSum() : sum(0.0), c(0.0) {}
+	void Add(double x)
+	{
+		const double y = x - c;
+		const double t = sum + y;
+		c = (t - sum) - y;
+		sum = t;
+	}
+};
+
+// Per channel maximum absolute sample value of an interleaved block
+static void GetMaxAbs(const ReaSample* samples, int frames, int nch, double* maxAbs)
+{
+	for (int chan = 0; chan < nch; chan++)
+		maxAbs[chan] = 0.0;
+
+#ifdef SWS_ANALYSIS_SSE2
+	const __m128d signMask = _mm_set1_pd(-0.0);
+	if (nch == 1)
+	{
+		__m128d m = _mm_setzero_pd();
+		int i = 0;
+		for (; i + 2 <= frames; i += 2)
+			m = _mm_max_pd(m, _mm_andnot_pd(signMask, _mm_loadu_pd(samples + i)));
+		double lanes[2];
+		_mm_storeu_pd(lanes, m);
+		maxAbs[0] = max(lanes[0], lanes[1]);
+		for (; i < frames; i++)
+			maxAbs[0] = max(maxAbs[0], fabs(samples[i]));
+		return;
+	}
+	else if (nch % 2 == 0)
+	{
+		for (int chan = 0; chan < nch; chan += 2)
+		{
+			__m128d m = _mm_setzero_pd();
+			for (int i = 0; i < frames; i++)
+				m = _mm_max_pd(m, _mm_andnot_pd(signMask, _mm_loadu_pd(samples + i*nch + chan)));
+			_mm_storeu_pd(maxAbs + chan, m);
+		}
+		return;
+	}
+#endif
+
+	for (int i = 0; i < frames; i++)
+		for (int chan = 0; chan < nch; chan++)
+		{
+			const double absamp = fabs(samples[i*nch + chan]);
+			maxAbs[chan] = (absamp > maxAbs[chan]) ? absamp : maxAbs[chan];
+		}
+}
+
+// Per channel sum of squares of an interleaved block (block sums are short, the caller accumulates them with KahanSum)
+static void GetSumSquares(const ReaSample* samples, int frames, int nch, double* sumSquares)
+{
+	for (int chan = 0; chan < nch; chan++)
+		sumSquares[chan] = 0.0;
+
+#ifdef SWS_ANALYSIS_SSE2
+	if (nch % 2 == 0)
+	{
+		for (int chan = 0; chan < nch; chan += 2)
+		{
+			__m128d sum = _mm_setzero_pd();
+			for (int i = 0; i < frames; i++)
+			{
+				const __m128d x = _mm_loadu_pd(samples + i*nch + chan);
+				sum = _mm_add_pd(sum, _mm_mul_pd(x, x));
+			}
+			_mm_storeu_pd(sumSquares + chan, sum);
+		}
+		return;
+	}
+#endif
+
+	for (int i = 0; i < frames; i++)
+		for (int chan = 0; chan < nch; chan++)
+			sumSquares[chan] += samples[i*nch + chan] * samples[i*nch + chan];
+}
+
 static bool AnalyzePCMSource(ANALYZE_PCM* a)
 {
-	// Init local transfer block "t" and sum of squares
+	// Init local transfer block "t"
 	PCM_source_transfer_t t={0,};
 	t.samplerate = a->pcm->GetSampleRate();
 	t.nch = a->pcm->GetNumChannels();
-	t.length = a->dWindowSize == 0.0 ? 16384 : (int)(a->dWindowSize * t.samplerate);
-	t.samples = new (nothrow) ReaSample[t.length * t.nch];
-
-	if(!t.samples)
-		return false;
-
-	ReaSample* prevBuf = NULL;
-	INT64 tempPeakRMSsample = 0;
-	if (a->dWindowSize != 0.0)
+	t.length = ANALYSIS_BLOCK_FRAMES;
+	const bool windowed = a->dWindowSize != 0.0;
+	const int window = windowed ? max(1, (int)(a->dWindowSize * t.samplerate)) : 0;
+
+	// In windowed mode, keep squares of the last "window" frames so the running sums can drop them without re-reading the source
+	vector<ReaSample> samples;
+	vector<double> maxAbs, blockSumSquares, history, maxWindowSum;
+	vector<KahanSum> sumSquares;
+	try
 	{
-		if((prevBuf = new (nothrow) ReaSample[t.length * t.nch]))
-			memset(prevBuf, 0, t.length * t.nch * sizeof(*prevBuf));
-		else
-			return false;
+		samples.resize(t.length * t.nch);
+		maxAbs.resize(t.nch);
+		blockSumSquares.resize(t.nch);
+		sumSquares.resize(t.nch);
+		maxWindowSum.resize(t.nch, 0.0);
+		if (windowed)
+			history.resize((size_t)window * t.nch, 0.0);
 	}
-
-	double* dSumSquares = new double[t.nch];
-	for (int i = 0; i < t.nch; i++)
-		dSumSquares[i] = 0.0;
+	catch (const std::bad_alloc&)
+	{
+		return false;
+	}
+	t.samples = &samples[0];
 
 	// Init output variables.  Note can have different channel count.
 	for (int i = 0; i < a->iChannels; i++)
@@ -75,99 +173,122 @@ static bool AnalyzePCMSource(ANALYZE_PCM* a)
 	a->dProgress = 0.0;
 	a->sampleCount = 0;
 
+	const int chanOut = min(a->iChannels, t.nch);
 	INT64 totalSamples = (INT64)(a->pcm->GetLength() * t.samplerate);
-	int iFrame = 0;
+	INT64 tempPeakRMSsample = 0;
+	double maxWindowSumAll = 0.0;
+	int historyPos = 0;
 
 	a->pcm->GetSamples(&t);
 	while (t.samples_out)
 	{
-		for (int samp = 0; samp < t.samples_out; samp++)
+		// Peaks: reduce the whole block first and search for the exact position only when the block holds a new maximum
+		GetMaxAbs(t.samples, t.samples_out, t.nch, &maxAbs[0]);
+		double blockPeak = 0.0;
+		for (int chan = 0; chan < t.nch; chan++)
+			blockPeak = max(blockPeak, maxAbs[chan]);
+
+		if (blockPeak > a->dPeakVal)
 		{
-			for (int chan = 0; chan < t.nch; chan++)
-			{
-				int i = samp*t.nch + chan;
-				dSumSquares[chan] += t.samples[i] * t.samples[i];
-				double absamp = fabs(t.samples[i]);
-				if (absamp > a->dPeakVal)
+			for (int i = 0; i < t.samples_out * t.nch; i++)
+				if (fabs(t.samples[i]) == blockPeak)
 				{
-					a->dPeakVal = absamp;
-					a->peakSample = a->sampleCount;
+					a->peakSample = a->sampleCount + i / t.nch;
+					break;
 				}
-
-				if (a->dPeakVals && chan < a->iChannels && absamp > a->dPeakVals[chan])
+			a->dPeakVal = blockPeak;
+		}
+		if (a->dPeakVals)
+		{
+			for (int chan = 0; chan < chanOut; chan++)
+				if (maxAbs[chan] > a->dPeakVals[chan])
 				{
-					a->dPeakVals[chan] = absamp;
 					if (a->peakSamples)
-						a->peakSamples[chan] = a->sampleCount;
+						for (int i = 0; i < t.samples_out; i++)
+							if (fabs(t.samples[i*t.nch + chan]) == maxAbs[chan])
+							{
+								a->peakSamples[chan] = a->sampleCount + i;
+								break;
+							}
+					a->dPeakVals[chan] = maxAbs[chan];
 				}
-				if (a->dWindowSize != 0.0)
+		}
+
+		if (!windowed)
+		{
+			GetSumSquares(t.samples, t.samples_out, t.nch, &blockSumSquares[0]);
+			for (int chan = 0; chan < t.nch; chan++)
+				sumSquares[chan].Add(blockSumSquares[chan]);
+		}
+		else
+		{
+			// Running window sums, compare squared sums against the maximum (sqrt is taken once, at the end)
+			for (int samp = 0; samp < t.samples_out; samp++)
+			{
+				const ReaSample* frame = t.samples + samp*t.nch;
+				double* oldSquares = &history[(size_t)historyPos * t.nch];
+				for (int chan = 0; chan < t.nch; chan++)
 				{
-					dSumSquares[chan] -= prevBuf[i] * prevBuf[i];
-					if (dSumSquares[chan] < 0.0) // Unlikely but possible with rounding errors
-						dSumSquares[chan] = 0.0;
-					double curRMS = sqrt(dSumSquares[chan] / t.length);
-					if (curRMS > a->dRMS) // Overall
-					{ 
-						a->dRMS = curRMS;
-						tempPeakRMSsample = a->sampleCount;
+					const double square = frame[chan] * frame[chan];
+					sumSquares[chan].Add(square);
+					sumSquares[chan].Add(-oldSquares[chan]);
+					oldSquares[chan] = square;
+
+					const double windowSum = sumSquares[chan].sum;
+					if (windowSum > maxWindowSum[chan])
+					{
+						maxWindowSum[chan] = windowSum;
+						if (a->dRMSs && a->peakRMSsamples && chan < chanOut)
+							a->peakRMSsamples[chan] = a->sampleCount + samp;
 					}
-					if (a->dRMSs && curRMS > a->dRMSs[chan]) // Single channel, if enabled
-					{ 
-						a->dRMSs[chan] = curRMS;
-						if (a->peakRMSsamples)
-							a->peakRMSsamples[chan] = a->sampleCount;
+					if (windowSum > maxWindowSumAll)
+					{
+						maxWindowSumAll = windowSum;
+						tempPeakRMSsample = a->sampleCount + samp;
 					}
-						
 				}
+				if (++historyPos == window)
+					historyPos = 0;
 			}
-			a->sampleCount++;
-		}
-		if (a->dWindowSize != 0.0)
-		{	// Swap buffers in windowed mode for history
-			ReaSample* temp = t.samples;
-			t.samples = prevBuf;
-			prevBuf = temp;
 		}
 
+		a->sampleCount += t.samples_out;
 		a->dProgress = (double)a->sampleCount / totalSamples;
 
-		iFrame++;
-		t.time_s = (double)t.length * iFrame / t.samplerate;
 		// Get next block
+		t.time_s = (double)a->sampleCount / t.samplerate;
 		t.samples_out = 0;
 		a->pcm->GetSamples(&t);
 	}
 
-	if (a->dWindowSize == 0.0)
+	if (!windowed)
 	{
 		// Non-windowed mode.  Calculate the RMS for the entire item
 		// First per channel
 		if (a->dRMSs && a->sampleCount)
-			for (int i = 0; i < a->iChannels && i < t.nch; i++)
-				a->dRMSs[i] = sqrt(dSumSquares[i] / a->sampleCount);
+			for (int i = 0; i < chanOut; i++)
+				a->dRMSs[i] = sqrt(sumSquares[i].sum / a->sampleCount);
 
 		// Then for all channels combined
-		double dSS = 0.0;
+		KahanSum dSS;
 		for (int i = 0; i < t.nch; i++)
-			dSS += dSumSquares[i];
-		a->dRMS = sqrt(dSS / (a->sampleCount * t.nch));
+			dSS.Add(sumSquares[i].sum);
+		a->dRMS = sqrt(dSS.sum / (a->sampleCount * t.nch));
 	}
-	else // calculate pos. of peak RMS samples
-	{	
-		a->peakRMSsample = tempPeakRMSsample - t.length;
+	else // calculate peak RMS values and pos. of peak RMS samples
+	{
+		a->dRMS = sqrt(maxWindowSumAll / window);
+		a->peakRMSsample = tempPeakRMSsample - window;
 
-		if (a->peakRMSsamples) {
-			for (int chan = 0; chan < t.nch; chan++) {
-				a->peakRMSsamples[chan] -= t.length;
-			}
+		for (int chan = 0; chan < chanOut; chan++)
+		{
+			if (a->dRMSs)
+				a->dRMSs[chan] = sqrt(maxWindowSum[chan] / window);
+			if (a->dRMSs && a->peakRMSsamples && a->peakRMSsamples[chan] != -666)
+				a->peakRMSsamples[chan] -= window;
 		}
-
 	}
 
-	delete[] t.samples;
-	delete[] prevBuf;
-	delete[] dSumSquares;
-
 	return true;
 }
 
@@ -179,23 +300,34 @@ unsigned int WINAPI AnalyzePCMThread(void* pAnalyze)
 	return 0;
 }
 
+// returns a zero-based copy of the item's PCM source for analysis, NULL if the item can't be analyzed
+static PCM_source* DuplicateItemSource(MediaItem* item)
+{
+	PCM_source* pcm = (PCM_source*)item;
+	if (!pcm || strcmp(pcm->GetType(), "MIDI") == 0 || strcmp(pcm->GetType(), "MIDIPOOL") == 0)
+		return NULL;
+
+	pcm = pcm->Duplicate();
+	if (!pcm || !pcm->GetNumChannels())
+	{
+		delete pcm;
+		return NULL;
+	}
+
+	double dZero = 0.0;
+	GetSetMediaItemInfo((MediaItem*)pcm, "D_POSITION", &dZero);
+	return pcm;
+}
+
 // return true for successful analysis
 // wraps AnalyzePCM to check item validity and create a wait dialog
 bool AnalyzeItem(MediaItem* item, ANALYZE_PCM* a)
 {
 	a->dProgress = 0.0;
-	a->pcm = (PCM_source*)item;
-
-	if (!a->pcm || strcmp(a->pcm->GetType(), "MIDI") == 0 || strcmp(a->pcm->GetType(), "MIDIPOOL") == 0)
-		return false;
-
-	a->pcm = a->pcm->Duplicate();
-	if (!a->pcm || !a->pcm->GetNumChannels())
+	a->pcm = DuplicateItemSource(item);
+	if (!a->pcm)
 		return false;
 
-	double dZero = 0.0;
-	GetSetMediaItemInfo((MediaItem*)a->pcm, "D_POSITION", &dZero);
-
 	const char* cName = NULL;
 	MediaItem_Take* take = GetMediaItemTake(item, -1);
 	if (take)
@@ -220,49 +352,229 @@ bool AnalyzeItem(MediaItem* item, ANALYZE_PCM* a)
 	return a->success;
 }
 
-void DoAnalyzeItem(COMMAND_T*)
+// Items render identical audio when their active takes play the same part of the same file with the same settings.
+// Anything that can't be compared cheaply (take FX, take envelopes, stretch markers, sections...) makes the item unique.
+static bool GetItemSourceKey(MediaItem* item, const ANALYZE_PCM* a, WDL_FastString* key)
 {
-	WDL_TypedBuf<MediaItem*> items;
-	SWS_GetSelectedMediaItems(&items);
-	bool bDidWork = false;
-	for (int i = 0; i < items.GetSize(); i++)
+	MediaItem_Take* take = GetActiveTake(item);
+	PCM_source* source = take ? GetMediaItemTake_Source(take) : NULL;
+	if (!source || !strcmp(source->GetType(), "SECTION") || GetMediaItemInfo_Value(item, "B_ALLTAKESPLAY") ||
+	    TakeFX_GetCount(take) || CountTakeEnvelopes(take) || GetTakeNumStretchMarkers(take))
+		return false;
+
+	char file[4096] = "";
+	GetMediaSourceFileName(source, file, sizeof(file));
+	if (!*file)
+		return false;
+
+	static const char* const takeKeys[] = {"D_STARTOFFS", "D_VOL", "D_PAN", "D_PANLAW", "D_PLAYRATE", "D_PITCH", "B_PPITCH", "I_CHANMODE", "I_PITCHMODE"};
+	static const char* const itemKeys[] = {"D_LENGTH", "D_VOL", "B_MUTE", "B_LOOPSRC", "D_FADEINLEN", "D_FADEOUTLEN", "D_FADEINLEN_AUTO", "D_FADEOUTLEN_AUTO",
+	                                       "D_FADEINDIR", "D_FADEOUTDIR", "C_FADEINSHAPE", "C_FADEOUTSHAPE"};
+
+	key->Set(file);
+	for (int i = 0; i < (int)(sizeof(takeKeys) / sizeof(takeKeys[0])); i++)
+		key->AppendFormatted(32, "|%.17g", GetMediaItemTakeInfo_Value(take, takeKeys[i]));
+	for (int i = 0; i < (int)(sizeof(itemKeys) / sizeof(itemKeys[0])); i++)
+		key->AppendFormatted(32, "|%.17g", GetMediaItemInfo_Value(item, itemKeys[i]));
+
+	// results can only be shared between analyses that ask for the same things
+	key->AppendFormatted(128, "|%.17g|%d|%d%d%d%d", a->dWindowSize, a->iChannels, a->dPeakVals != NULL, a->dRMSs != NULL, a->peakSamples != NULL, a->peakRMSsamples != NULL);
+	return true;
+}
+
+static void CopyAnalysisResults(const ANALYZE_PCM* src, ANALYZE_PCM* dest)
+{
+	for (int i = 0; i < dest->iChannels && i < src->iChannels; i++)
 	{
-		MediaItem* item = items.Get()[i];
-		int iChannels = ((PCM_source*)item)->GetNumChannels();
-		if (iChannels)
-		{
-			bDidWork = true;
-			ANALYZE_PCM a;
-			memset(&a, 0, sizeof(a));
-			a.iChannels = iChannels;
-			a.dPeakVals = new double[iChannels];
-			a.dRMSs     = new double[iChannels];
+		if (dest->dPeakVals && src->dPeakVals)           dest->dPeakVals[i]      = src->dPeakVals[i];
+		if (dest->dRMSs && src->dRMSs)                   dest->dRMSs[i]          = src->dRMSs[i];
+		if (dest->peakSamples && src->peakSamples)       dest->peakSamples[i]    = src->peakSamples[i];
+		if (dest->peakRMSsamples && src->peakRMSsamples) dest->peakRMSsamples[i] = src->peakRMSsamples[i];
+	}
+	dest->dPeakVal      = src->dPeakVal;
+	dest->dRMS          = src->dRMS;
+	dest->peakRMSsample = src->peakRMSsample;
+	dest->peakSample    = src->peakSample;
+	dest->sampleCount   = src->sampleCount;
+	dest->success       = src->success;
+	dest->dProgress     = 1.0;
+}
+
+struct ANALYZE_BATCH
+{
+	vector<ANALYZE_PCM*> jobs;
+	vector<double> weights;    // source lengths, for aggregate progress
+	std::atomic<int> nextJob;
+	std::atomic<int> doneJobs;
+	double dProgress;
+};
+
+static void AnalyzeBatchWorker(ANALYZE_BATCH* batch)
+{
+	int job;
+	while ((job = batch->nextJob++) < (int)batch->jobs.size())
+	{
+		ANALYZE_PCM* a = batch->jobs[job];
+		a->success = AnalyzePCMSource(a);
+		a->dProgress = 1.0;
+		batch->doneJobs++;
+	}
+}
+
+static unsigned int WINAPI AnalyzeBatchThread(void* pBatch)
+{
+	ANALYZE_BATCH* batch = static_cast<ANALYZE_BATCH*>(pBatch);
 
-			if (AnalyzeItem(item, &a))
+	const int jobCount = (int)batch->jobs.size();
+	const int workerCount = max(1, min(jobCount, (int)std::thread::hardware_concurrency()));
+	vector<std::thread> workers;
+	for (int i = 0; i < workerCount; i++)
+		workers.push_back(std::thread(AnalyzeBatchWorker, batch));
+
+	double totalWeight = 0.0;
+	for (size_t i = 0; i < batch->weights.size(); i++)
+		totalWeight += batch->weights[i];
+
+	while (batch->doneJobs < jobCount)
+	{
+		double progress = 0.0;
+		for (int i = 0; i < jobCount; i++)
+			progress += batch->jobs[i]->dProgress * batch->weights[i];
+		batch->dProgress = (totalWeight > 0.0) ? min(0.99, progress / totalWeight) : 0.0;
+		Sleep(20);
+	}
+
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+
+	batch->dProgress = 1.0; // closes the wait dialog
+	return 0;
+}
+
+// analyzes several items at once, see Analysis.h
+int AnalyzeItems(MediaItem* const* items, ANALYZE_PCM* analyses, int count)
+{
+	ANALYZE_BATCH batch;
+	batch.nextJob = 0;
+	batch.doneJobs = 0;
+	batch.dProgress = 0.0;
+
+	vector<double> oldWinSizes(count);
+	vector<int> sharedWith(count, -1); // index of the analysis whose results get reused
+	map<string, int> sources;
+	WDL_FastString key;
+
+	for (int i = 0; i < count; i++)
+	{
+		ANALYZE_PCM* a = &analyses[i];
+		a->success = false;
+		a->dProgress = 0.0;
+		a->pcm = NULL;
+		oldWinSizes[i] = a->dWindowSize;
+
+		if (GetItemSourceKey(items[i], a, &key))
+		{
+			map<string, int>::iterator it = sources.find(key.Get());
+			if (it != sources.end())
 			{
-				WDL_String str;
-				str.Set(__LOCALIZE("Peak level:","sws_analysis"));
-				for (int i = 0; i < iChannels; i++) {
-					str.Append(" ");
-					str.AppendFormatted(50, __LOCALIZE_VERFMT("Channel %d = %.2f dB","sws_analysis"), i+1, VAL2DB(a.dPeakVals[i]));
-				}
-				str.Append("\n");
-				str.Append(__LOCALIZE("RMS level:","sws_analysis"));
-				for (int i = 0; i < iChannels; i++) {
-					str.Append(" ");
-					str.AppendFormatted(50, __LOCALIZE_VERFMT("Channel %d = %.2f dB","sws_analysis"), i+1, VAL2DB(a.dRMSs[i]));
-				}
-				MessageBox(g_hwndParent, str.Get(), __LOCALIZE("Item analysis","sws_analysis"), MB_OK);
+				sharedWith[i] = it->second;
+				continue;
 			}
-			delete [] a.dPeakVals;
-			delete [] a.dRMSs;
+			sources[key.Get()] = i;
+		}
+
+		if ((a->pcm = DuplicateItemSource(items[i])))
+		{
+			if (a->dWindowSize > a->pcm->GetLength())
+				a->dWindowSize = 0.0;
+			batch.jobs.push_back(a);
+			batch.weights.push_back(max(a->pcm->GetLength(), 0.001));
 		}
 	}
-	if (!bDidWork)
+
+	if (batch.jobs.size())
+	{
+		HANDLE hThread = (HANDLE)_beginthreadex(NULL, 0, AnalyzeBatchThread, &batch, 0, NULL);
+
+		WDL_String title;
+		title.AppendFormatted(100, __LOCALIZE_VERFMT("Please wait, analyzing %d items...","sws_analysis"), count);
+		SWS_WaitDlg wait(title.Get(), &batch.dProgress);
+
+		CloseHandle(hThread);
+	}
+
+	int successCount = 0;
+	for (int i = 0; i < count; i++)
+	{
+		ANALYZE_PCM* a = &analyses[i];
+		if (sharedWith[i] >= 0)
+			CopyAnalysisResults(&analyses[sharedWith[i]], a);
+
+		// restore original window if it was larger than the item's length
+		a->dWindowSize = oldWinSizes[i];
+		delete a->pcm;
+		a->pcm = NULL;
+
+		if (a->success)
+			++successCount;
+	}
+	return successCount;
+}
+
+void DoAnalyzeItem(COMMAND_T*)
+{
+	WDL_TypedBuf<MediaItem*> selItems;
+	SWS_GetSelectedMediaItems(&selItems);
+
+	vector<MediaItem*> items;
+	vector<int> channels;
+	for (int i = 0; i < selItems.GetSize(); i++)
+	{
+		int iChannels = ((PCM_source*)selItems.Get()[i])->GetNumChannels();
+		if (iChannels)
+		{
+			items.push_back(selItems.Get()[i]);
+			channels.push_back(iChannels);
+		}
+	}
+	if (items.empty())
 	{
 		MessageBox(NULL, __LOCALIZE("No items selected to analyze.","sws_analysis"), __LOCALIZE("SWS - Error","sws_analysis"), MB_OK);
 		return;
 	}
+
+	vector<ANALYZE_PCM> analyses(items.size());
+	vector<vector<double> > peakVals(items.size()), RMSs(items.size());
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		peakVals[i].resize(channels[i]);
+		RMSs[i].resize(channels[i]);
+		analyses[i].iChannels = channels[i];
+		analyses[i].dPeakVals = &peakVals[i][0];
+		analyses[i].dRMSs     = &RMSs[i][0];
+	}
+	AnalyzeItems(&items[0], &analyses[0], (int)items.size());
+
+	for (size_t i = 0; i < analyses.size(); i++)
+	{
+		const ANALYZE_PCM& a = analyses[i];
+		if (a.success)
+		{
+			WDL_String str;
+			str.Set(__LOCALIZE("Peak level:","sws_analysis"));
+			for (int i = 0; i < a.iChannels; i++) {
+				str.Append(" ");
+				str.AppendFormatted(50, __LOCALIZE_VERFMT("Channel %d = %.2f dB","sws_analysis"), i+1, VAL2DB(a.dPeakVals[i]));
+			}
+			str.Append("\n");
+			str.Append(__LOCALIZE("RMS level:","sws_analysis"));
+			for (int i = 0; i < a.iChannels; i++) {
+				str.Append(" ");
+				str.AppendFormatted(50, __LOCALIZE_VERFMT("Channel %d = %.2f dB","sws_analysis"), i+1, VAL2DB(a.dRMSs[i]));
+			}
+			MessageBox(g_hwndParent, str.Get(), __LOCALIZE("Item analysis","sws_analysis"), MB_OK);
+		}
+	}
 }
 
 void FindItemPeak(COMMAND_T*)
@@ -287,24 +599,43 @@ void FindItemPeak(COMMAND_T*)
 
 void OrganizeByVol(COMMAND_T* ct)
 {
+	// Analyze items of all tracks in one batch, then arrange them track by track
+	WDL_PtrList_DeleteOnDestroy<WDL_TypedBuf<MediaItem*> > trackItems;
+	vector<MediaItem*> allItems;
 	for (int iTrack = 1; iTrack <= GetNumTracks(); iTrack++)
 	{
-		WDL_TypedBuf<MediaItem*> items;
-		SWS_GetSelectedMediaItemsOnTrack(&items, CSurf_TrackFromID(iTrack, false));
+		WDL_TypedBuf<MediaItem*>* items = trackItems.Add(new WDL_TypedBuf<MediaItem*>);
+		SWS_GetSelectedMediaItemsOnTrack(items, CSurf_TrackFromID(iTrack, false));
+		if (items->GetSize() > 1)
+			for (int i = 0; i < items->GetSize(); i++)
+				allItems.push_back(items->Get()[i]);
+	}
+	if (allItems.empty())
+		return;
+
+	vector<ANALYZE_PCM> analyses(allItems.size());
+	if (ct->user == 2)
+	{	// Windowed mode, set the window size
+		double dWindowSize;
+		GetRMSOptions(NULL, &dWindowSize);
+		for (size_t i = 0; i < analyses.size(); i++)
+			analyses[i].dWindowSize = dWindowSize;
+	}
+	AnalyzeItems(&allItems[0], &analyses[0], (int)allItems.size());
+
+	int iAnalysis = 0;
+	for (int iTrack = 1; iTrack <= GetNumTracks(); iTrack++)
+	{
+		WDL_TypedBuf<MediaItem*>& items = *trackItems.Get(iTrack-1);
 		if (items.GetSize() > 1)
 		{
 			double dStart = *(double*)GetSetMediaItemInfo(items.Get()[0], "D_POSITION", NULL);
 			double* pVol = new double[items.GetSize()];
-			ANALYZE_PCM a;
-			memset(&a, 0, sizeof(a));
-			if (ct->user == 2)
-			{	// Windowed mode, set the window size
-				GetRMSOptions(NULL, &a.dWindowSize);
-			}
-			for (int i = 0; i < items.GetSize(); i++)
+			for (int i = 0; i < items.GetSize(); i++, iAnalysis++)
 			{
+				const ANALYZE_PCM& a = analyses[iAnalysis];
 				pVol[i] = -1.0;
-				if (AnalyzeItem(items.Get()[i], &a))
+				if (a.success)
 					pVol[i] = ct->user ? a.dRMS : a.dPeakVal;
 			}
 			// Sort and arrange items from min to max RMS
@@ -331,20 +662,34 @@ void OrganizeByVol(COMMAND_T* ct)
 	}
 }
 
+// analyzes selected items with an active take in one batch
+static void AnalyzeSelectedTakes(double dWindowSize, vector<MediaItem*>* items, vector<ANALYZE_PCM>* analyses)
+{
+	WDL_TypedBuf<MediaItem*> selItems;
+	SWS_GetSelectedMediaItems(&selItems);
+	for (int i = 0; i < selItems.GetSize(); i++)
+		if (GetMediaItemTake(selItems.Get()[i], -1))
+			items->push_back(selItems.Get()[i]);
+
+	analyses->resize(items->size());
+	for (size_t i = 0; i < analyses->size(); i++)
+		(*analyses)[i].dWindowSize = dWindowSize;
+	if (items->size())
+		AnalyzeItems(&(*items)[0], &(*analyses)[0], (int)items->size());
+}
+
 void RMSNormalize(double dTargetDb, double dWindowSize)
 {
-	WDL_TypedBuf<MediaItem*> items;
-	SWS_GetSelectedMediaItems(&items);
+	vector<MediaItem*> items;
+	vector<ANALYZE_PCM> analyses;
+	AnalyzeSelectedTakes(dWindowSize, &items, &analyses);
 	bool bDidWork = false;
-	ANALYZE_PCM a;
-	memset(&a, 0, sizeof(a));
-	a.dWindowSize = dWindowSize;
 
-	for (int i = 0; i < items.GetSize(); i++)
+	for (size_t i = 0; i < items.size(); i++)
 	{
-		MediaItem* item = items.Get()[i];
-		MediaItem_Take* take = GetMediaItemTake(item, -1);
-		if (take && AnalyzeItem(item, &a) && a.dRMS != 0.0)
+		MediaItem_Take* take = GetMediaItemTake(items[i], -1);
+		const ANALYZE_PCM& a = analyses[i];
+		if (a.success && a.dRMS != 0.0)
 		{
 			bDidWork = true;
 			double dVol = *(double*)GetSetMediaItemTakeInfo(take, "D_VOL", NULL);
@@ -361,33 +706,26 @@ void RMSNormalize(double dTargetDb, double dWindowSize)
 
 void RMSNormalizeAll(double dTargetDb, double dWindowSize)
 {
-	WDL_TypedBuf<MediaItem*> items;
-	SWS_GetSelectedMediaItems(&items);
+	vector<MediaItem*> items;
+	vector<ANALYZE_PCM> analyses;
+	AnalyzeSelectedTakes(dWindowSize, &items, &analyses);
 	double dMaxRMS = -DBL_MAX;
-	ANALYZE_PCM a;
-	memset(&a, 0, sizeof(a));
-	a.dWindowSize = dWindowSize;
 
-	for (int i = 0; i < items.GetSize(); i++)
+	for (size_t i = 0; i < analyses.size(); i++)
 	{
-		MediaItem* item = items.Get()[i];
-		MediaItem_Take* take = GetMediaItemTake(item, -1);
-		if (take && AnalyzeItem(item, &a) && a.dRMS != 0.0 && a.dRMS > dMaxRMS)
+		const ANALYZE_PCM& a = analyses[i];
+		if (a.success && a.dRMS != 0.0 && a.dRMS > dMaxRMS)
 			dMaxRMS = a.dRMS;
 	}
 
 	if (dMaxRMS > -DBL_MAX)
 	{
-		for (int i = 0; i < items.GetSize(); i++)
+		for (size_t i = 0; i < items.size(); i++)
 		{
-			MediaItem* item = items.Get()[i];
-			MediaItem_Take* take = GetMediaItemTake(item, -1);
-			if (take)
-			{
-				double dVol = *(double*)GetSetMediaItemTakeInfo(take, "D_VOL", NULL);
-				dVol *= DB2VAL(dTargetDb) / dMaxRMS;
-				GetSetMediaItemTakeInfo(take, "D_VOL", &dVol);
-			}
+			MediaItem_Take* take = GetMediaItemTake(items[i], -1);
+			double dVol = *(double*)GetSetMediaItemTakeInfo(take, "D_VOL", NULL);
+			dVol *= DB2VAL(dTargetDb) / dMaxRMS;
+			GetSetMediaItemTakeInfo(take, "D_VOL", &dVol);
 		}
 		UpdateTimeline();
 		Undo_OnStateChangeEx(__LOCALIZE("Normalize items to RMS","sws_undo"), UNDO_STATE_ITEMS, -1);
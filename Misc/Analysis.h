@@ -52,6 +52,9 @@ typedef struct ANALYZE_PCM
 int AnalysisInit();
 
 bool AnalyzeItem(MediaItem* mi, ANALYZE_PCM* a);
+// Analyzes count items concurrently behind a single wait dialog, analyses[i] is set up as for AnalyzeItem() and receives
+// the results for items[i]. Items that play identical audio are analyzed only once. Returns the number of successful analyses.
+int AnalyzeItems(MediaItem* const* items, ANALYZE_PCM* analyses, int count);
 
 // #781 Export to ReaScript
 void NF_GetRMSOptions(double *targetOut, double *winSizeOut);
@@ -34,11 +34,16 @@
 // state reads and writes call SWS_CacheObjectState(true).  When done call SWS_CacheObjectState(false)
 // and any changes will be written out.
 //
-// See Snapshots for an example of use
+// States are only cached in such a block, outside of it they are read and written directly
+// (the caller owns read states, free them with SWS_FreeHeapPtr).
+//
+// See Snapshots for an example of use, or SWS_ObjectStateBatch for chunk-based actions
 
 //#define GOS_DEBUG
+//#define GOS_PROFILE // per-object read/write cost of cached states
 
-ObjectStateCache::ObjectStateCache():m_iUseCount(1)
+ObjectStateCache::ObjectStateCache()
+:m_iUseCount(1), m_entries(DeleteEntry), m_iReads(0), m_dReadTime(0.0)
 {
 }
 
@@ -47,73 +52,102 @@ ObjectStateCache::~ObjectStateCache()
 	EmptyCache();
 }
 
-void ObjectStateCache::WriteCache()
+void ObjectStateCache::DeleteEntry(Entry* e)
+{
+	if (e->orig)
+		FreeHeapPtr(e->orig);
+	delete e;
+}
+
+// Returns the number of written states, unchanged ones are skipped
+int ObjectStateCache::WriteCache()
 {
-#ifdef GOS_DEBUG
 	int iCount = 0;
-#endif
-	for (int i = 0; i < m_obj.GetSize(); i++)
+	double dStart = time_precise();
+	for (int i = 0; i < m_pending.GetSize(); i++)
 	{
-		if (m_str.Get(i)->GetLength() && m_orig.Get(i) && strcmp(m_str.Get(i)->Get(), m_orig.Get(i)))
+		Entry* e = m_entries.Get((INT_PTR)m_pending.Get(i));
+		if (e && e->str.GetLength() && e->orig && strcmp(e->str.Get(), e->orig))
 		{
-			int fxstate = SNM_PreObjectState(m_str.Get(i), false);
-			GetSetObjectState(m_obj.Get(i), m_str.Get(i)->Get());
+			int fxstate = SNM_PreObjectState(&e->str, false);
+			GetSetObjectState(m_pending.Get(i), e->str.Get());
 			SNM_PostObjectState(fxstate);
-#ifdef GOS_DEBUG
 			iCount++;
-#endif
 		}
 	}
-#ifdef GOS_DEBUG
-	dprintf("ObjectStateCache::WriteCache applied %d chunks.\n", iCount);
+#if defined(GOS_DEBUG) || defined(GOS_PROFILE)
+	double dWriteTime = (time_precise() - dStart) * 1000.0;
+	dprintf("ObjectStateCache::WriteCache applied %d chunks (%d unchanged).\n", iCount, m_pending.GetSize() - iCount);
+	dprintf("  reads: %d in %.2f ms (%.3f ms/object), writes: %d in %.2f ms (%.3f ms/object)\n",
+		m_iReads, m_dReadTime * 1000.0, m_iReads ? m_dReadTime * 1000.0 / m_iReads : 0.0,
+		iCount, dWriteTime, iCount ? dWriteTime / iCount : 0.0);
+#else
+	(void)dStart;
 #endif
 
 	EmptyCache();
+	return iCount;
 }
 
 void ObjectStateCache::EmptyCache()
 {
-	m_obj.Empty();
-	m_str.Empty(true);
-	m_orig.Empty(true, FreeHeapPtr);
+	m_pending.Empty();
+	m_entries.DeleteAll();
+	m_retired.Empty(true, FreeHeapPtr);
+}
+
+char* ObjectStateCache::ReadState(void* obj, bool wantsMinimalState)
+{
+	double dStart = time_precise();
+	int fxstate = SNM_PreObjectState(NULL, wantsMinimalState);
+	char* p = GetSetObjectState(obj, NULL);
+	SNM_PostObjectState(fxstate);
+	m_dReadTime += time_precise() - dStart;
+	m_iReads++;
+	return p;
 }
 
 const char* ObjectStateCache::GetSetObjState(void* obj, const char* str, bool wantsMinimalState)
 {
-	int i = m_obj.Find(obj);
-	if (i < 0)
+	bool bSet = str && str[0];
+	Entry* e = m_entries.Get((INT_PTR)obj);
+	if (!e)
 	{
-		i = m_obj.GetSize();
-		m_obj.Add(obj);
-		m_str.Add(new WDL_FastString);
-		if (str && str[0])
-			m_orig.Add(NULL);
-		else
-		{
-			int fxstate = SNM_PreObjectState(NULL, wantsMinimalState);
-			char* p = GetSetObjectState(obj, NULL);
-			SNM_PostObjectState(fxstate);
-			m_orig.Add(p);
-		}
+		e = new Entry;
+		e->orig = bSet ? NULL : ReadState(obj, wantsMinimalState);
+		e->minimal = !bSet && wantsMinimalState;
+		m_entries.Insert((INT_PTR)obj, e);
 	}
-	if (str && str[0])
+	// Cached minimal state but the full one is wanted now, or about to be set (compared to the full one)
+	// Note: minimal states must not be set back, see SNM_ChunkParserPatcher::Commit()
+	else if (e->minimal && (bSet || (!wantsMinimalState && !e->str.GetLength())))
 	{
-		m_str.Get(i)->Set(str);
+		if (e->orig)
+			m_retired.Add(e->orig);
+		e->orig = ReadState(obj, false);
+		e->minimal = false;
+	}
+
+	if (bSet)
+	{
+		if (!e->str.GetLength())
+			m_pending.Add(obj);
+		e->str.Set(str);
 		return NULL;
 	}
 
-	if (m_str.Get(i)->GetLength())
-		return m_str.Get(i)->Get();
+	if (e->str.GetLength())
+		return e->str.Get();
 	else
-		return m_orig.Get(i);
+		return e->orig;
 }
 
-ObjectStateCache* g_objStateCache = NULL;
+static ObjectStateCache* g_objStateCache = NULL;
 
 const char* SWS_GetSetObjectState(void* obj, WDL_FastString* str, bool wantsMinimalState)
 {
 	const char* ret;
-	
+
 	if (g_objStateCache)
 		ret = g_objStateCache->GetSetObjState(obj, str ? str->Get() : NULL, wantsMinimalState);
 	else
@@ -133,9 +167,26 @@ const char* SWS_GetSetObjectState(void* obj, WDL_FastString* str, bool wantsMini
 }
 
 
+static WDL_INT64 g_stateBytesFetched = 0;
+static WDL_INT64 g_stateBytesUsed = 0;
+
+void SWS_AddStateBytes(int fetched, int used)
+{
+	g_stateBytesFetched += fetched;
+	g_stateBytesUsed += used;
+}
+
+void SWS_GetStateBytes(WDL_INT64* fetched, WDL_INT64* used, bool reset)
+{
+	if (fetched) *fetched = g_stateBytesFetched;
+	if (used) *used = g_stateBytesUsed;
+	if (reset)
+		g_stateBytesFetched = g_stateBytesUsed = 0;
+}
+
 void SWS_FreeHeapPtr(void* ptr)
 {
-	// Ignore frees on cached object states, 
+	// Ignore frees on cached object states, see SWS_CacheObjectState()
 	if (!g_objStateCache)
 		FreeHeapPtr(ptr);
 }
@@ -145,7 +196,8 @@ void SWS_FreeHeapPtr(const char* ptr)
 	SWS_FreeHeapPtr((void*)ptr);
 }
 
-void SWS_CacheObjectState(bool bStart)
+// Returns the number of states written back when the cache is released (0 otherwise)
+int SWS_CacheObjectState(bool bStart)
 {
 	static SWS_Mutex mutex;
 	if (bStart)
@@ -164,12 +216,55 @@ void SWS_CacheObjectState(bool bStart)
 			ObjectStateCache* cache = g_objStateCache;
 			g_objStateCache = NULL;
 			lock.Unlock(); // Don't maintain the lock when writing the cache
-			cache->WriteCache();
+			int iCount = cache->WriteCache();
 			delete cache;
+			return iCount;
 		}
 		else
 			g_objStateCache->m_iUseCount--;
 	}
+	return 0;
+}
+
+SWS_ObjectStateBatch::SWS_ObjectStateBatch(const char* undoDesc, int undoFlags)
+:m_undoDesc(undoDesc), m_iUndoFlags(undoFlags), m_bUpdated(false), m_bDone(false)
+{
+	SWS_CacheObjectState(true);
+}
+
+SWS_ObjectStateBatch::~SWS_ObjectStateBatch()
+{
+	Commit();
+}
+
+// Reads and caches the state of obj now (e.g. to gather all states before patching)
+void SWS_ObjectStateBatch::Prefetch(void* obj)
+{
+	if (!m_bDone && obj)
+		SWS_FreeHeapPtr(SWS_GetSetObjectState(obj, NULL));
+}
+
+int SWS_ObjectStateBatch::Commit()
+{
+	if (m_bDone)
+		return 0;
+	m_bDone = true;
+
+	// Nested in another cache: states are written (and undo point added) by its owner
+	bool bOwner = !g_objStateCache || g_objStateCache->m_iUseCount <= 1;
+	if (!bOwner)
+	{
+		SWS_CacheObjectState(false);
+		return 0;
+	}
+
+	PreventUIRefresh(1);
+	int iCount = SWS_CacheObjectState(false);
+	PreventUIRefresh(-1);
+
+	if (iCount || m_bUpdated)
+		Undo_OnStateChangeEx2(NULL, m_undoDesc.Get(), m_iUndoFlags, -1);
+	return iCount;
 }
 
 // Helper function for parsing object "chunks" into more useful lines
@@ -33,20 +33,58 @@ class ObjectStateCache
 public:
 	ObjectStateCache();
 	~ObjectStateCache();
-	void WriteCache();
+	int WriteCache();
 	void EmptyCache();
 	const char* GetSetObjState(void* obj, const char* str, bool wantsMinimalState = false);
 	int m_iUseCount;
 private:
-	WDL_PtrList<void> m_obj;
-	WDL_PtrList<WDL_FastString> m_str;
-	WDL_PtrList<char> m_orig;
+	struct Entry
+	{
+		char* orig;         // state read from REAPER
+		WDL_FastString str; // pending state, written by WriteCache()
+		bool minimal;       // orig is a minimal state (no FX data)
+	};
+	static void DeleteEntry(Entry* e);
+	char* ReadState(void* obj, bool wantsMinimalState);
+
+	WDL_PtrKeyedArray<Entry*> m_entries;
+	WDL_PtrList<void> m_pending; // objects with pending states, in set order
+	WDL_PtrList<char> m_retired; // replaced minimal states, callers may still use them until the cache is emptied
+	// Timing, see GOS_PROFILE
+	int m_iReads;
+	double m_dReadTime;
 };
 
 const char* SWS_GetSetObjectState(void* obj, WDL_FastString* str, bool wantsMinimalState = false);
 void SWS_FreeHeapPtr(void* ptr);
 void SWS_FreeHeapPtr(const char* ptr);
-void SWS_CacheObjectState(bool bStart);
+int SWS_CacheObjectState(bool bStart);
+
+// Object state bytes fetched vs. bytes actually used (i.e. not skipped) by chunk parsers
+// Reported per action by CommandTimer(), see BR_DEBUG_PERFORMANCE_ACTIONS
+void SWS_AddStateBytes(int fetched, int used);
+void SWS_GetStateBytes(WDL_INT64* fetched, WDL_INT64* used, bool reset);
+
+// Transaction for chunk-based actions that patch many objects (tracks, items..)
+// Object states are read once (optionally all up front with Prefetch()), patched
+// in the cache, and only the changed ones are written back on Commit(), all in a row
+// with a single UI refresh and a single undo point.
+// Note: do "non-chunk" changes (GetSetMediaTrackInfo, etc) *before* states are read,
+// they would be overwritten by the cached states otherwise.
+class SWS_ObjectStateBatch
+{
+public:
+	SWS_ObjectStateBatch(const char* undoDesc, int undoFlags = UNDO_STATE_ALL);
+	~SWS_ObjectStateBatch(); // commits if not done yet
+	void Prefetch(void* obj);
+	void SetUpdated() { m_bUpdated = true; } // for non-chunk changes that need the undo point too
+	int Commit(); // returns the number of written states
+private:
+	WDL_FastString m_undoDesc;
+	int m_iUndoFlags;
+	bool m_bUpdated;
+	bool m_bDone;
+};
 
 bool GetChunkLine(const char* chunk, char* line, int iLineMax, int* pos, bool bNewLine);
 void AppendChunkLine(WDL_FastString* chunk, const char* line);
@@ -252,10 +252,11 @@ static void DisplayStoreSendEnvError(MediaTrack* tr, EnvTypes envType, const env
 	MessageBox(g_hwndParent, ss.str().c_str(), __LOCALIZE("SWS Snapshots - Error", "sws_mbox"), MB_OK);
 }
 
-void TrackSends::Build(MediaTrack* tr)
+void TrackSends::Build(MediaTrack* tr, bool wantsMinimalState)
 {
 	// Get the HW sends from the track object string
-	const char* trackStr = SWS_GetSetObjectState(tr, NULL);
+	// Read-only: minimal states (no FX data) are enough, unless full states are cached anyway
+	const char* trackStr = SWS_GetSetObjectState(tr, NULL, wantsMinimalState);
 	char line[4096];
 	int pos = 0;
 	while (GetChunkLine(trackStr, line, 4096, &pos, false))
@@ -285,7 +286,7 @@ void TrackSends::Build(MediaTrack* tr)
 			continue;
 
 		// We haven't parsed yet!
-		trackStr = SWS_GetSetObjectState(pDest, NULL);
+		trackStr = SWS_GetSetObjectState(pDest, NULL, wantsMinimalState);
 		pos = 0;
 
 		// count receive occurence for getting correct receive env. chunk
@@ -347,6 +348,113 @@ void TrackSends::Build(MediaTrack* tr)
 	}
 }
 
+// Recalls send levels through the send API, without patching any track state.
+// Returns false (and changes nothing) if the sends differ structurally from the
+// stored ones (added/removed sends, channels, envelopes...): UpdateReaper() is needed then.
+bool TrackSends::UpdateReaperLevels(MediaTrack* tr)
+{
+	// HW outputs aren't exposed in the API the same way, only check they didn't change
+	const char* trackStr = SWS_GetSetObjectState(tr, NULL, true);
+	char line[4096];
+	int pos = 0, iHW = 0;
+	bool bSame = true;
+	while (bSame && GetChunkLine(trackStr, line, 4096, &pos, false))
+		if (strncmp(line, "HWOUT", 5) == 0)
+			bSame = iHW < m_hwSends.GetSize() && strcmp(line, m_hwSends.Get(iHW++)->Get()) == 0;
+	SWS_FreeHeapPtr(trackStr);
+	if (!bSame || iHW != m_hwSends.GetSize())
+		return false;
+
+	// Missing destination tracks are resolved by UpdateReaper()
+	for (int i = 0; i < m_sends.GetSize(); i++)
+		if (!GuidToTrack(m_sends.Get(i)->GetGuid()))
+			return false;
+
+	struct SendLevel { MediaTrack* dest; int idx; TrackSend* send; bool envs[3]; };
+	std::vector<SendLevel> levels;
+	static const char* envNames[3] = { "<VOLENV", "<PANENV", "<MUTEENV" };
+
+	GUID* trGuid = (GUID*)GetSetMediaTrackInfo(tr, "GUID", NULL);
+	LineParser lp(false);
+	for (int i = 1; i <= GetNumTracks(); i++)
+	{
+		MediaTrack* pDest = CSurf_TrackFromID(i, false);
+		GUID* guid = (GUID*)GetSetMediaTrackInfo(pDest, "GUID", NULL);
+		if (GuidsEqual(guid, trGuid))
+			continue;
+
+		// Stored sends and current receives from tr must match one for one, in order
+		int idx = 0, iSend = 0;
+		MediaTrack* pSrc;
+		while ((pSrc = (MediaTrack*)GetSetTrackSendInfo(pDest, -1, idx++, "P_SRCTRACK", NULL)))
+		{
+			if (pSrc != tr)
+				continue;
+			TrackSend* send = NULL;
+			while (iSend < m_sends.GetSize() && !send)
+			{
+				if (GuidsEqual(guid, m_sends.Get(iSend)->GetGuid()))
+					send = m_sends.Get(iSend);
+				iSend++;
+			}
+			if (!send)
+				return false;
+
+			// mode vol pan mute mono phase srcchan dstchan panlaw midiflags automode
+			WDL_FastString str;
+			send->AuxRecvString(tr, &str);
+			if (lp.parse(str.Get()) || lp.getnumtokens() < 13 ||
+				lp.gettoken_int(2)  != *(int*)GetSetTrackSendInfo(pDest, -1, idx - 1, "I_SENDMODE", NULL) ||
+				lp.gettoken_int(8)  != *(int*)GetSetTrackSendInfo(pDest, -1, idx - 1, "I_SRCCHAN", NULL) ||
+				lp.gettoken_int(9)  != *(int*)GetSetTrackSendInfo(pDest, -1, idx - 1, "I_DSTCHAN", NULL) ||
+				lp.gettoken_int(11) != *(int*)GetSetTrackSendInfo(pDest, -1, idx - 1, "I_MIDIFLAGS", NULL))
+				return false;
+
+			SendLevel level = { pDest, idx - 1, send, { false, false, false } };
+			const WDL_FastString envStrs[3] = { send->GetAuxvolstr(), send->GetAuxpanstr(), send->GetAuxmutestr() };
+			for (int j = 0; j < 3; j++)
+			{
+				TrackEnvelope* env = (TrackEnvelope*)GetSetTrackSendInfo(pDest, -1, idx - 1, "P_ENV", (void*)envNames[j]);
+				if (!env != !envStrs[j].GetLength())
+					return false;
+				if (env)
+				{
+					try { level.envs[j] = strcmp(envelope::GetEnvelopeStateChunkBig(env).c_str(), envStrs[j].Get()) != 0; }
+					catch (const envelope::bad_get_env_chunk_big&) { return false; }
+				}
+			}
+			levels.push_back(level);
+		}
+
+		// Remaining stored sends to that track would have to be added
+		for (; iSend < m_sends.GetSize(); iSend++)
+			if (GuidsEqual(guid, m_sends.Get(iSend)->GetGuid()))
+				return false;
+	}
+
+	for (const SendLevel& level : levels)
+	{
+		WDL_FastString str;
+		lp.parse(level.send->AuxRecvString(tr, &str)->Get());
+		double dVol = lp.gettoken_float(3), dPan = lp.gettoken_float(4), dPanLaw = lp.gettoken_float(10);
+		bool bMute = lp.gettoken_int(5) ? true : false, bMono = lp.gettoken_int(6) ? true : false, bPhase = lp.gettoken_int(7) ? true : false;
+		int iAutoMode = lp.gettoken_int(12);
+		GetSetTrackSendInfo(level.dest, -1, level.idx, "D_VOL", &dVol);
+		GetSetTrackSendInfo(level.dest, -1, level.idx, "D_PAN", &dPan);
+		GetSetTrackSendInfo(level.dest, -1, level.idx, "B_MUTE", &bMute);
+		GetSetTrackSendInfo(level.dest, -1, level.idx, "B_MONO", &bMono);
+		GetSetTrackSendInfo(level.dest, -1, level.idx, "B_PHASE", &bPhase);
+		GetSetTrackSendInfo(level.dest, -1, level.idx, "D_PANLAW", &dPanLaw);
+		GetSetTrackSendInfo(level.dest, -1, level.idx, "I_AUTOMODE", &iAutoMode);
+
+		const WDL_FastString envStrs[3] = { level.send->GetAuxvolstr(), level.send->GetAuxpanstr(), level.send->GetAuxmutestr() };
+		for (int j = 0; j < 3; j++)
+			if (level.envs[j])
+				SetEnvelopeStateChunk((TrackEnvelope*)GetSetTrackSendInfo(level.dest, -1, level.idx, "P_ENV", (void*)envNames[j]), envStrs[j].Get(), false);
+	}
+	return true;
+}
+
 void TrackSends::UpdateReaper(MediaTrack* tr, WDL_PtrList<TrackSendFix>* pFix)
 {
 	// First replace all the hw sends with the stored
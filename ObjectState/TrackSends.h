@@ -62,7 +62,7 @@ public:
 	TrackSends() { }
 	TrackSends(TrackSends& ts);
 	~TrackSends();
-	void Build(MediaTrack* tr);
+	void Build(MediaTrack* tr, bool wantsMinimalState = true);
 	void UpdateReaper(MediaTrack* tr, WDL_PtrList<TrackSendFix>* pFix);
 	void GetChunk(WDL_FastString* chunk);
 
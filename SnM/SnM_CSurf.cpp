@@ -29,7 +29,9 @@
 
 #include "SnM.h"
 #include "SnM_CSurf.h"
+#include "SnM_Find.h"
 #include "SnM_LiveConfigs.h"
+#include "SnM_Marker.h"
 #include "SnM_Misc.h"
 #include "SnM_Notes.h"
 #include "SnM_RegionPlaylist.h"
@@ -56,6 +58,7 @@ void SNM_CSurfRun()
 	sRecurseCheck = true;
 
 	PlaylistRun();
+	LiveConfigSwitchRun(); // before ScheduledJob::Run(), see ApplyLiveConfigJob::Perform()
 	ScheduledJob::Run();
 	StopTrackPreviewsRun();
 	UpdateMarkerRegionRun();
@@ -66,12 +69,14 @@ void SNM_CSurfRun()
 
 void SNM_CSurfSetTrackTitle() {
 	NotesSetTrackTitle();
+	FindSetTrackTitle();
 	LiveConfigsSetTrackTitle();
 }
 
 void SNM_CSurfSetTrackListChange()
 {
 	NotesSetTrackListChange();
+	FindSetTrackListChange();
 	LiveConfigsTrackListChange();
 	RegionPlaylistSetTrackListChange();
 	ResourcesTrackListChange();
@@ -106,6 +111,8 @@ int SNM_CSurfExtended(int _call, void* _parm1, void* _parm2, void* _parm3)
 //	snprintf(dbg, sizeof(dbg), "SNM_CSurfExtended() - Call: %d, prm1: %p, prm2: %p prm3: %p\n", _call, _parm1, _parm2, _parm3);
 //	OutputDebugString(dbg);
 #endif
+	if (_call == CSURF_EXT_SETPROJECTMARKERCHANGE)
+		InvalidateMarkerRegionIndex();
 	return 0; // i.e. unsupported
 }
 
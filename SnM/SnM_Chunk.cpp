@@ -546,6 +546,10 @@ WDL_FastString* SNM_TakeParserPatcher::GetChunk()
 // GetChunk() comments. Also see important comments for SNM_ChunkParserPatcher::Commit()
 bool SNM_TakeParserPatcher::Commit(bool _force)
 {
+	if (m_minimalState) // read-only, see SetWantsMinimalState()
+		return false;
+	ApplySplices();
+	InvalidateIndex(); // the fake take is removed below
 	if (m_reaObject && (m_updates || _force) && m_chunk->GetLength() && !(GetPlayStateEx(NULL) & 4))
 	{
 // SNM_ChunkParserPatcher::Commit() mod ----->
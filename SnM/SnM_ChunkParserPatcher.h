@@ -1,5 +1,5 @@
 /******************************************************************************
-/ SnM_ChunkParserPatcher.h - v1.34
+/ SnM_ChunkParserPatcher.h - v1.35
 /
 / Copyright (c) 2008 and later Jeffos
 /
@@ -111,6 +111,215 @@ static int RemoveAllIds(WDL_FastString* _chunk) {
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// SNM_ChunkIndex
+// Line index of a chunk, built in one pass. Lines are views into the chunk
+// (no copy) with their keyword, depth, parent and sub-chunk extents, exactly
+// as seen by ParsePatchCore(): same skipped data, same line trimming and
+// LineParser tokenization (lines it rejects are not processed), same
+// depth/parent rules. Keyword lookups are binary searches.
+// Note: the indexed chunk must not be altered while the index is in use,
+//       see SNM_ChunkParserPatcher::GetIndex()
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef _SWS_DEBUG
+#include <assert.h> // index lookups are cross-checked with ParsePatchCore()
+#endif
+
+class SNM_ChunkIndex
+{
+public:
+
+struct Line {
+	int pos, len;       // raw line (w/o EOL)
+	int start;          // where ParsePatchCore() parses the line from (> pos when the line ends data skipped from a previous line)
+	int kw, kwLen;      // keyword (1st token, in m_keywords), kwLen == 0 for lines ParsePatchCore() does not process
+	int depth;          // as in ParsePatchCore(): "<KEYWORD" lines are at the depth of the sub-chunk they open, ">" lines at the depth of its parent
+	int parent;         // id of the line that opened the current parent, -1 at depth 0
+	int end;            // "<KEYWORD" lines: id of the matching ">" line, the line itself otherwise
+	bool hidden;        // part of data skipped by ParsePatchCore() (base64, in-project MIDI, freeze)
+};
+
+SNM_ChunkIndex(const char* _chunk, int _length, bool _processBase64, bool _processInProjectMIDI, bool _processFreeze)
+	: m_chunk(_chunk), m_length(_length), m_processBase64(_processBase64), m_processInProjectMIDI(_processInProjectMIDI), m_processFreeze(_processFreeze)
+{
+	Build();
+}
+
+bool IsBuiltWith(bool _processBase64, bool _processInProjectMIDI, bool _processFreeze) const {
+	return m_processBase64 == _processBase64 && m_processInProjectMIDI == _processInProjectMIDI && m_processFreeze == _processFreeze;
+}
+
+// cheap staleness check, edits that go through SNM_ChunkParserPatcher invalidate the index anyway
+bool IsBuiltOn(const char* _chunk, int _length) const {
+	return m_chunk == _chunk && m_length == _length;
+}
+
+const char* GetChunk() const { return m_chunk; }
+int GetSize() const { return (int)m_lines.size(); }
+int GetParsedBytes() const { return m_parsedBytes; } // i.e. not skipped
+const Line& GetLine(int _id) const { return m_lines[_id]; }
+const char* GetKeyword(int _id) const { return &m_keywords[m_lines[_id].kw]; }
+
+// length of the line as ParsePatchCore() copies it (trimmed if too long)
+int GetParsedLength(int _id) const {
+	const Line& l = m_lines[_id];
+	const int len = l.pos + l.len - l.start;
+	return len >= SNM_MAX_CHUNK_LINE_LENGTH ? SNM_MAX_CHUNK_LINE_LENGTH-1 : len;
+}
+
+// position of _keyword in the line as returned by ParsePatchCore() (i.e. strstr() from the parsed part of the line), -1 if not found
+int GetKeywordPos(int _id, const char* _keyword) const {
+	const char* p = strstr(m_chunk+m_lines[_id].start, _keyword);
+	return p ? (int)(p-m_chunk) : -1;
+}
+
+bool IsKeyword(int _id, const char* _keyword) const {
+	return m_lines[_id].kwLen && !strcmp(GetKeyword(_id), _keyword);
+}
+
+// same check as IsMatchingParsedLine(), strict match (i.e. depth and parent must be provided)
+bool IsMatch(int _id, int _depth, const char* _parent) const
+{
+	const Line& l = m_lines[_id];
+	if (!l.depth || _depth == -1 || l.depth != _depth || !_parent)
+		return false;
+	return !strcmp(GetKeyword(l.parent)+1, _parent); // +1 to zap '<'
+}
+
+// ids of the lines beginning with _keyword, in chunk order
+void GetKeywordLines(const char* _keyword, const int** _ids, int* _count) const
+{
+	const vector<int>::const_iterator first = lower_bound(m_byKeyword.begin(), m_byKeyword.end(), _keyword, 
+		[this](int _id, const char* _kw) { return strcmp(GetKeyword(_id), _kw) < 0; });
+	vector<int>::const_iterator last = first;
+	while (last != m_byKeyword.end() && !strcmp(GetKeyword(*last), _keyword))
+		++last;
+	*_ids = (first != last) ? &(*first) : NULL;
+	*_count = (int)(last - first);
+}
+
+private:
+
+void Build()
+{
+	LineParser lp(false);
+	char curLine[SNM_MAX_CHUNK_LINE_LENGTH] = "";
+	vector<int> parents;
+	bool isParsingSource = false;
+	const char* skipEnd = NULL; // end of the data skipped from a previous line
+	const char* eol;
+	for (const char* p = m_chunk; (eol = strchr(p, '\n')) != NULL; p = eol+1)
+	{
+		Line l = {(int)(p-m_chunk), (int)(eol-p), (int)(p-m_chunk), 0, 0, (int)parents.size(), parents.size() ? parents.back() : -1, (int)m_lines.size(), false};
+		const char* start = p;
+
+		// mirrors the optional optimizations of ParsePatchCore()
+		if (skipEnd) {
+			if (skipEnd > eol) {
+				l.hidden = true;
+				m_lines.push_back(l);
+				continue;
+			}
+			start = skipEnd;
+			skipEnd = NULL;
+		}
+		else
+		{
+			const char* skip = NULL;
+			if (!m_processBase64 && l.len>2 && *(eol-1)=='=' && *(eol-2)=='=')
+				skip = strstr(p, ">\n");
+			else if (!m_processInProjectMIDI && isParsingSource && (
+				(l.len>2 && !_strnicmp(p, "E ", 2)) || (l.len>3 && !_strnicmp(p, "Em ", 3))))
+				skip = strstr(p, "GUID {");
+			else if (!m_processFreeze && parents.size()==1 && l.len>8 && !strncmp(p, "<FREEZE ", 8))
+			{
+				int skippedLen = FindEndOfSubChunk(p, 0);
+				while (skippedLen >= 0) {
+					skip = p+skippedLen;
+					skippedLen = strncmp(skip, "<FREEZE ", 8) ? -1 : FindEndOfSubChunk(p, skippedLen);
+				}
+			}
+
+			if (skip) {
+				if (skip > eol) {
+					skipEnd = skip;
+					l.hidden = true;
+					m_lines.push_back(l);
+					continue;
+				}
+				start = skip;
+			}
+		}
+		l.start = (int)(start-m_chunk);
+
+		// same trimmed copy and tokenization as ParsePatchCore()
+		const int curLineLen = (int)(eol-start);
+		const int len = curLineLen >= SNM_MAX_CHUNK_LINE_LENGTH ? SNM_MAX_CHUNK_LINE_LENGTH-1 : curLineLen;
+		memcpy(curLine, start, len);
+		curLine[len] = '\0';
+		if (lp.parse(curLine) || !lp.getnumtokens() || !*lp.gettoken_str(0)) {
+			m_lines.push_back(l);
+			continue;
+		}
+
+		const char* keyword = lp.gettoken_str(0);
+		l.kw = (int)m_keywords.size();
+		l.kwLen = (int)strlen(keyword);
+		m_keywords.insert(m_keywords.end(), keyword, keyword+l.kwLen+1);
+
+		if (*keyword == '<')
+		{
+			isParsingSource |= (lp.getnumtokens()==2 && curLineLen>9 && !strcmp(keyword+1, "SOURCE"));
+			parents.push_back((int)m_lines.size());
+			l.depth++;
+			l.parent = parents.back();
+		}
+		else if (*keyword == '>')
+		{
+			if (isParsingSource && parents.size())
+				isParsingSource = !IsKeyword(parents.back(), "<SOURCE");
+			if (parents.size()) {
+				m_lines[parents.back()].end = (int)m_lines.size();
+				parents.pop_back();
+			}
+			l.depth = (int)parents.size();
+			l.parent = parents.size() ? parents.back() : -1;
+		}
+		m_lines.push_back(l);
+	}
+
+	m_parsedBytes = 0;
+	m_byKeyword.reserve(m_lines.size());
+	for (int i=0; i < (int)m_lines.size(); i++)
+	{
+		if (!m_lines[i].hidden)
+			m_parsedBytes += m_lines[i].len+1;
+		if (m_lines[i].kwLen)
+			m_byKeyword.push_back(i);
+	}
+	stable_sort(m_byKeyword.begin(), m_byKeyword.end(), [this](int _id1, int _id2) {
+		return strcmp(GetKeyword(_id1), GetKeyword(_id2)) < 0;
+	});
+}
+
+const char* m_chunk;
+int m_length;
+bool m_processBase64, m_processInProjectMIDI, m_processFreeze;
+vector<Line> m_lines;
+vector<char> m_keywords; // keywords of all processed lines, '\0' separated
+vector<int> m_byKeyword; // line ids sorted by keyword, then by position
+int m_parsedBytes;
+};
+
+// a pending patch: replaces len chars at pos (in the indexed chunk) with str
+struct SNM_ChunkSplice {
+	int pos, len;
+	WDL_FastString str;
+	SNM_ChunkSplice(int _pos, int _len, const char* _str) : pos(_pos), len(_len), str(_str) {}
+};
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // SNM_ChunkParserPatcher
 ///////////////////////////////////////////////////////////////////////////////
@@ -137,6 +346,9 @@ SNM_ChunkParserPatcher(void* _reaObject, bool _autoCommit=true,
 	m_processInProjectMIDI = _processInProjectMIDI;
 	m_processFreeze = _processFreeze;
 	m_minimalState = false;
+	m_index = NULL;
+	m_keepIndex = false;
+	m_fetchedBytes = m_usedBytes = 0;
 }
 
 // when attached to a WDL_FastString* (simple text chunk parser/patcher)
@@ -157,6 +369,9 @@ SNM_ChunkParserPatcher(WDL_FastString* _chunk, bool _autoCommit=true,
 	m_processInProjectMIDI = _processInProjectMIDI;
 	m_processFreeze = _processFreeze;
 	m_minimalState = false;
+	m_index = NULL;
+	m_keepIndex = false;
+	m_fetchedBytes = m_usedBytes = 0;
 }
 
 virtual ~SNM_ChunkParserPatcher() 
@@ -164,6 +379,8 @@ virtual ~SNM_ChunkParserPatcher()
 	if (m_autoCommit)
 		Commit(); // no-op if no updates
 
+	FlushStateBytes();
+	InvalidateIndex();
 	if (m_chunk) {
 		delete m_chunk;
 		m_chunk = NULL;
@@ -206,6 +423,7 @@ void* GetObject() {
 
 // get and cache the RPP chunk
 // note: this method *always* returns a valid value (non NULL)
+// note: pending patches are applied first, see ReplaceSubChunk()
 virtual WDL_FastString* GetChunk() 
 {
 	if (!m_chunk->GetLength())
@@ -214,11 +432,18 @@ virtual WDL_FastString* GetChunk()
 			if (const char* cData = (m_reaObject ? SNM_GetSetObjectState(m_reaObject, NULL) : NULL)) {
 				m_chunk->Set(cData);
 				SNM_FreeHeapPtr((void*)cData);
+				FlushStateBytes();
+				m_fetchedBytes = m_chunk->GetLength();
 			}
 		}
 		else if (m_originalChunk)
 			m_chunk->Set(m_originalChunk);
 	}
+	ApplySplices();
+	if (!m_keepIndex) {
+		InvalidateIndex(); // the caller can alter the returned chunk
+		m_usedBytes = m_chunk->GetLength(); // .. or use all of it
+	}
 	return m_chunk;
 }
 
@@ -231,6 +456,7 @@ virtual WDL_FastString* GetChunk()
 // clearing the cache is allowed
 void SetChunk(const char* _newChunk, int _updates=1) {
 	m_updates = _updates;
+	m_splices.Empty(true);
 	GetChunk()->Set(_newChunk ? _newChunk : "");
 }
 
@@ -254,6 +480,8 @@ int SetUpdates(int _updates) {
 // - remove all ids before patching, see SNM_GetSetObjectState()
 virtual bool Commit(bool _force = false)
 {
+	if (m_minimalState) // read-only, see SetWantsMinimalState()
+		return false;
 	if ((m_updates || _force) && GetChunk()->GetLength())
 	{
 		if (m_reaObject) {
@@ -272,7 +500,7 @@ virtual bool Commit(bool _force = false)
 }
 
 const char* GetInfo() {
-	return "SNM_ChunkParserPatcher - v1.34";
+	return "SNM_ChunkParserPatcher - v1.35";
 }
 
 void SetProcessBase64(bool _enable) {
@@ -287,6 +515,9 @@ void SetProcessFreeze(bool _enable) {
 	m_processFreeze = _enable;
 }
 
+// read-only mode for getters/parsers that do not need FX states: REAPER 
+// returns lighter chunks (w/o FX data) that are *never* committed
+// note: must be set before the chunk is cached
 void SetWantsMinimalState(bool _enable) {
 	m_minimalState = _enable;
 }
@@ -299,6 +530,14 @@ void CancelUpdates() {
 	SetChunk("", 0);
 }
 
+// Helpers below use the chunk index (built once per cached chunk, see
+// SNM_ChunkIndex) rather than parsing the whole chunk on each call.
+// Replace/remove/insert helpers only record patches (splices), applied in one
+// pass when the chunk is needed, e.g. in Commit() or by the next lookup (which
+// then re-indexes the patched chunk).
+// Matches, positions and copied sub-chunks are the ones ParsePatchCore() gives
+// (checked against it in _SWS_DEBUG builds).
+
 // returns the start position of the sub-chunk or -1 if not found
 // _depth: _keyword's depth
 // _chunk: optional output prm, the searched sub-chunk if found
@@ -311,12 +550,49 @@ int GetSubChunk(const char* _keyword, int _depth, int _occurence, WDL_FastString
 		if (_chunk) _chunk->Set("");
 		WDL_FastString startToken;
 		startToken.SetFormatted((int)strlen(_keyword)+2, "<%s", _keyword);
-		pos = Parse(SNM_GET_SUBCHUNK_OR_LINE, _depth, _keyword, startToken.Get(), _occurence, -1, (void*)_chunk, NULL, _breakKeyword);
-		if (pos <= 0) {
-			if (_chunk) _chunk->Set("");
-			pos = -1; // force negative return value if 0 (not found)
+
+		const SNM_ChunkIndex* index = GetIndex();
+		WDL_TypedBuf<int> ids;
+		FindLines(index, _keyword, startToken.Get(), _depth, _occurence, _breakKeyword, false, &ids);
+		if (ids.GetSize())
+		{
+			const int id = ids.Get()[0];
+			const SNM_ChunkIndex::Line& l = index->GetLine(id);
+			if (!_chunk)
+				pos = index->GetKeywordPos(id, startToken.Get());
+			else if (l.end != id) // sub-chunk must be closed
+			{
+				pos = index->GetKeywordPos(id, startToken.Get());
+				// copied as ParsePatchCore() does: skipped data as it is, processed lines trimmed, 
+				// lines it does not process are dropped, the closing line becomes ">"
+				for (int i=id; pos >= 0 && i <= l.end; i++)
+				{
+					const SNM_ChunkIndex::Line& line = index->GetLine(i);
+					if (line.hidden) {
+						_chunk->Append(index->GetChunk()+line.pos, line.len);
+						_chunk->Append("\n", 1);
+						continue;
+					}
+					if (i != id && line.start > line.pos)
+						_chunk->Append(index->GetChunk()+line.pos, line.start-line.pos);
+					if (i == l.end)
+						_chunk->Append(">\n", 2);
+					else if (line.kwLen) {
+						_chunk->Append(index->GetChunk()+line.start, index->GetParsedLength(i));
+						_chunk->Append("\n", 1);
+					}
+				}
+				if (pos < 0)
+					_chunk->Set("");
+			}
 		}
-		else pos--; // see ParsePatchCore()
+#ifdef _SWS_DEBUG
+		WDL_FastString parsed;
+		int parsedPos = Parse(SNM_GET_SUBCHUNK_OR_LINE, _depth, _keyword, startToken.Get(), _occurence, -1, _chunk ? (void*)&parsed : NULL, NULL, _breakKeyword);
+		if (parsedPos <= 0) parsed.Set("");
+		parsedPos = parsedPos > 0 ? parsedPos-1 : -1;
+		assert(parsedPos == pos && (!_chunk || !strcmp(parsed.Get(), _chunk->Get())));
+#endif
 	}
 	return pos;
 }
@@ -331,7 +607,7 @@ bool ReplaceSubChunk(const char* _keyword, int _depth, int _occurence, const cha
 	{
 		WDL_FastString startToken;
 		startToken.SetFormatted((int)strlen(_keyword)+2, "<%s", _keyword);
-		return (ParsePatch(SNM_REPLACE_SUBCHUNK_OR_LINE, _depth, _keyword, startToken.Get(), _occurence, 0, (void*)_newSubChunk, NULL, _breakKeyword) > 0);
+		return PatchLines(_keyword, startToken.Get(), _depth, _occurence, _newSubChunk, _breakKeyword);
 	}
 	return false;
 }
@@ -366,7 +642,7 @@ bool ReplaceLine(int _pos, const char* _str = NULL)
 bool ReplaceLine(const char* _parent, const char* _keyword, int _depth, int _occurence, const char* _newSubChunk = "", const char* _breakKeyword = NULL)
 {
 	if (_keyword && _depth >= 0) // can be 0, e.g. .rfxchain file
-		return (ParsePatch(SNM_REPLACE_SUBCHUNK_OR_LINE, _depth, _parent, _keyword, _occurence, 0, (void*)_newSubChunk, NULL, _breakKeyword) > 0);
+		return PatchLines(_parent, _keyword, _depth, _occurence, _newSubChunk ? _newSubChunk : "", _breakKeyword);
 	return false;
 }
 
@@ -395,11 +671,8 @@ bool InsertAfterBefore(int _dir, const char* _str, const char* _parent, const ch
 	if (_str && *_str && _keyword)
 	{
 		int pos = GetLinePos(_dir, _parent, _keyword, _depth, _occurence, _breakKeyword);
-		if (pos >= 0) {
-			m_chunk->Insert(_str, pos);
-			m_updates++;
-			return true;
-		}
+		if (pos >= 0)
+			return AddSplice(pos, 0, _str);
 	}
 	return false;
 }
@@ -408,23 +681,14 @@ bool InsertAfterBefore(int _dir, const char* _str, const char* _parent, const ch
 // _dir: -1 previous line, 0 current line, +1 next line
 int GetLinePos(int _dir, const char* _parent, const char* _keyword, int _depth, int _occurence, const char* _breakKeyword = NULL)
 {
-	int pos = Parse(SNM_GET_CHUNK_CHAR, _depth, _parent, _keyword, _occurence, 0, NULL, NULL, _breakKeyword);
-	if (pos > 0)
-	{
-		pos--; // See ParsePatchCore()
-		if (_dir == -1 || _dir == 1)
-		{
-			const char* pChunk = m_chunk->Get();
-			if (_dir == -1 && pos >= 2)
-				pos-=2; // zap the previous '\n'
-			while (pChunk[pos] && pChunk[pos] != '\n') pos += _dir;
-			if (pChunk[pos] && pChunk[pos+1])
-				return pos+1;
-		}
-		else
-			return pos;
-	}
-	return -1;
+	if (!_keyword)
+		return -1;
+	int pos = FindLinePos(GetIndex(), _dir, _parent, _keyword, _depth, _occurence, _breakKeyword);
+#ifdef _SWS_DEBUG
+	int parsedPos = Parse(SNM_GET_CHUNK_CHAR, _depth, _parent, _keyword, _occurence, 0, NULL, NULL, _breakKeyword);
+	assert(pos == (parsedPos > 0 ? WalkLines(m_chunk->Get(), parsedPos-1, _dir) : -1));
+#endif
+	return pos;
 }
 
 const char* GetParent(WDL_PtrList<WDL_FastString>* _parents, int _ancestor=1) {
@@ -467,6 +731,239 @@ protected:
 	// can be enabled to break parsing (+ bulk recopy when patching)
 	bool m_breakParsePatch;
 
+	// index of the cached chunk (NULL if not built yet or outdated) and pending patches
+	SNM_ChunkIndex* m_index;
+	WDL_PtrList_DeleteOnDestroy<SNM_ChunkSplice> m_splices;
+	bool m_keepIndex;
+
+	// bytes of the object state fetched from REAPER vs. bytes actually parsed (i.e. not skipped)
+	int m_fetchedBytes, m_usedBytes;
+
+
+void FlushStateBytes()
+{
+#ifdef _SWS_EXTENSION
+	if (m_fetchedBytes)
+		SWS_AddStateBytes(m_fetchedBytes, min(m_usedBytes, m_fetchedBytes));
+#endif
+	m_fetchedBytes = m_usedBytes = 0;
+}
+
+
+// applies pending patches in one pass
+// note: to be called by inherited classes that access m_chunk without GetChunk()
+void ApplySplices()
+{
+	if (!m_splices.GetSize())
+		return;
+
+	WDL_FastString* newChunk = new WDL_FastString(SNM_HEAPBUF_GRANUL);
+	int pos = 0;
+	for (int i=0; i < m_splices.GetSize(); i++)
+	{
+		SNM_ChunkSplice* splice = m_splices.Get(i);
+		newChunk->Append(m_chunk->Get()+pos, splice->pos-pos);
+		newChunk->Append(splice->str.Get(), splice->str.GetLength());
+		pos = splice->pos + splice->len;
+	}
+	newChunk->Append(m_chunk->Get()+pos);
+
+	m_splices.Empty(true);
+	InvalidateIndex();
+	WDL_FastString* oldChunk = m_chunk;
+	m_chunk = newChunk;
+	delete oldChunk;
+}
+
+void InvalidateIndex()
+{
+	if (m_index) {
+		delete m_index;
+		m_index = NULL;
+	}
+}
+
+// returns the index of the cached chunk (pending patches are applied first, so
+// an index never coexists with pending patches, see AddSplice())
+const SNM_ChunkIndex* GetIndex()
+{
+	m_keepIndex = true;
+	WDL_FastString* chunk = GetChunk(); // virtual: inherited classes can alter the chunk when caching it
+	m_keepIndex = false;
+
+	if (m_index && (!m_index->IsBuiltWith(m_processBase64, m_processInProjectMIDI, m_processFreeze) || !m_index->IsBuiltOn(chunk->Get(), chunk->GetLength())))
+		InvalidateIndex();
+	if (!m_index) {
+		m_index = new SNM_ChunkIndex(chunk->Get(), chunk->GetLength(), m_processBase64, m_processInProjectMIDI, m_processFreeze);
+		m_usedBytes = max(m_usedBytes, m_index->GetParsedBytes());
+	}
+	return m_index;
+}
+
+// returns the insertion index of a patch or -1 if it overlaps a pending one
+int GetSpliceIdx(int _pos, int _len)
+{
+	int i = m_splices.GetSize();
+	while (i > 0 && m_splices.Get(i-1)->pos > _pos) i--; // same position: keep call order
+	if ((i > 0 && m_splices.Get(i-1)->pos + m_splices.Get(i-1)->len > _pos) ||
+		(i < m_splices.GetSize() && _pos + _len > m_splices.Get(i)->pos))
+		return -1;
+	return i;
+}
+
+bool CanSplice(int _pos, int _len) {
+	return GetSpliceIdx(_pos, _len) >= 0;
+}
+
+// records a patch, returns false if it overlaps a pending one
+bool AddSplice(int _pos, int _len, const char* _str)
+{
+	const int i = GetSpliceIdx(_pos, _len);
+	if (i < 0)
+		return false;
+
+	m_splices.Insert(i, new SNM_ChunkSplice(_pos, _len, _str));
+	m_updates++;
+	InvalidateIndex(); // next lookup applies pending patches and re-indexes
+	return true;
+}
+
+// index-based equivalent of ParsePatchCore() strict matching: gets the ids of the
+// _occurence-th matching line or, if _occurence == -1, of the first one (_all == false)
+// or of all of them (_all == true, _breakKeyword lines inside matched sub-chunks are 
+// then ignored as ParsePatchCore() does when processing them)
+void FindLines(const SNM_ChunkIndex* _index, const char* _parent, const char* _keyword, int _depth, int _occurence, const char* _breakKeyword, bool _all, WDL_TypedBuf<int>* _ids)
+{
+	const int* kwIds, *breakIds = NULL;
+	int kwCount, breakCount = 0;
+	_index->GetKeywordLines(_keyword, &kwIds, &kwCount);
+	if (_breakKeyword)
+		_index->GetKeywordLines(_breakKeyword, &breakIds, &breakCount);
+	const bool breakIsKeyword = _breakKeyword && !strcmp(_breakKeyword, _keyword);
+
+	int occurence = 0, insideEnd = -1, k = 0, b = 0;
+	for (;;)
+	{
+		while (k < kwCount && !_index->IsMatch(kwIds[k], _depth, _parent))
+			k++;
+		while (b < breakCount && (breakIds[b] <= insideEnd || !_index->GetLine(breakIds[b]).depth || 
+			(breakIsKeyword && _index->IsMatch(breakIds[b], _depth, _parent))))
+			b++;
+
+		if (k >= kwCount || (b < breakCount && breakIds[b] < kwIds[k]))
+			break;
+
+		if (_occurence == occurence || _occurence == -1)
+		{
+			_ids->Add(kwIds[k]);
+			if (_occurence != -1 || !_all)
+				break;
+			insideEnd = _index->GetLine(kwIds[k]).end;
+		}
+		occurence++;
+		k++;
+	}
+}
+
+// see GetLinePos()
+int FindLinePos(const SNM_ChunkIndex* _index, int _dir, const char* _parent, const char* _keyword, int _depth, int _occurence, const char* _breakKeyword)
+{
+	WDL_TypedBuf<int> ids;
+	FindLines(_index, _parent, _keyword, _depth, _occurence, _breakKeyword, false, &ids);
+	if (!ids.GetSize())
+		return -1;
+
+	const int pos = _index->GetKeywordPos(ids.Get()[0], _keyword);
+	return pos >= 0 ? WalkLines(_index->GetChunk(), pos, _dir) : -1;
+}
+
+// from the keyword position _pos: line start position as GetLinePos() always computed it
+// note: on indented lines, _dir == -1 gives the start of the current line
+static int WalkLines(const char* _chunk, int _pos, int _dir)
+{
+	if (_dir != -1 && _dir != 1)
+		return _pos;
+	if (_dir == -1 && _pos >= 2)
+		_pos-=2; // zap the previous '\n'
+	while (_pos >= 0 && _chunk[_pos] && _chunk[_pos] != '\n') _pos += _dir;
+	return (_pos >= 0 && _chunk[_pos] && _chunk[_pos+1]) ? _pos+1 : -1;
+}
+
+// replaces matching lines (whole sub-chunks for "<KEYWORD" lines) with _newStr, see FindLines()
+// note: data skipped from a previous line is kept, as ParsePatchCore() does
+bool PatchLines(const char* _parent, const char* _keyword, int _depth, int _occurence, const char* _newStr, const char* _breakKeyword)
+{
+	const SNM_ChunkIndex* index = GetIndex();
+	WDL_TypedBuf<int> ids;
+	FindLines(index, _parent, _keyword, _depth, _occurence, _breakKeyword, true, &ids);
+
+	// sub-chunks must be closed
+	WDL_TypedBuf<int> ranges;
+	for (int i=0; i < ids.GetSize(); i++)
+	{
+		const SNM_ChunkIndex::Line& l = index->GetLine(ids.Get()[i]);
+		if (*_keyword != '<' || l.end != ids.Get()[i]) {
+			const SNM_ChunkIndex::Line& last = index->GetLine(l.end);
+			ranges.Add(l.start);
+			ranges.Add(last.pos + last.len + 1 - l.start);
+		}
+	}
+
+#ifdef _SWS_DEBUG
+	// same result as ParsePatchCore(), which also drops the lines it does not process and trims long ones everywhere
+	// in the chunk: compare both outputs normalized that way (unclosed sub-chunks are not patched here while
+	// ParsePatchCore() drops the rest of the chunk, and it does not empty chunks: not compared)
+	if (ranges.GetSize() == ids.GetSize()*2 && !(ranges.GetSize() == 2 && !ranges.Get()[0] && ranges.Get()[1] == m_chunk->GetLength() && !*_newStr))
+	{
+		WDL_FastString expected(m_chunk), patched;
+		SNM_ChunkParserPatcher p(&expected, true, m_processBase64, m_processInProjectMIDI, m_processFreeze);
+		const bool parsed = (p.ParsePatch(SNM_REPLACE_SUBCHUNK_OR_LINE, _depth, _parent, _keyword, _occurence, 0, (void*)_newStr, NULL, _breakKeyword) > 0);
+		p.Commit();
+		int pos = 0;
+		for (int i=0; i < ranges.GetSize(); i+=2) {
+			patched.Append(m_chunk->Get()+pos, ranges.Get()[i]-pos);
+			patched.Append(_newStr);
+			pos = ranges.Get()[i] + ranges.Get()[i+1];
+		}
+		patched.Append(m_chunk->Get()+pos);
+		assert(parsed == (ranges.GetSize() > 0) && (!parsed || IsSameParsedChunk(&expected, &patched)));
+	}
+#endif
+
+	if (!ranges.GetSize())
+		return false;
+	for (int i=0; i < ranges.GetSize(); i+=2)
+		AddSplice(ranges.Get()[i], ranges.Get()[i+1], _newStr);
+	return true;
+}
+
+#ifdef _SWS_DEBUG
+// chunks as ParsePatchCore() would rewrite them (skipped data as it is, processed lines trimmed, other lines dropped)
+bool IsSameParsedChunk(WDL_FastString* _chunk1, WDL_FastString* _chunk2)
+{
+	WDL_FastString parsed[2];
+	WDL_FastString* chunks[2] = {_chunk1, _chunk2};
+	for (int c=0; c < 2; c++)
+	{
+		SNM_ChunkIndex index(chunks[c]->Get(), chunks[c]->GetLength(), m_processBase64, m_processInProjectMIDI, m_processFreeze);
+		for (int i=0; i < index.GetSize(); i++)
+		{
+			const SNM_ChunkIndex::Line& l = index.GetLine(i);
+			if (l.hidden) {
+				parsed[c].Append(index.GetChunk()+l.pos, l.len+1);
+				continue;
+			}
+			parsed[c].Append(index.GetChunk()+l.pos, l.start-l.pos);
+			if (l.kwLen) {
+				parsed[c].Append(index.GetChunk()+l.start, index.GetParsedLength(i));
+				parsed[c].Append("\n", 1);
+			}
+		}
+	}
+	return !strcmp(parsed[0].Get(), parsed[1].Get());
+}
+#endif
+
 
 const char* SNM_GetSetObjectState(void* _obj, WDL_FastString* _str)
 {
@@ -634,7 +1131,9 @@ int ParsePatchCore(
 #endif
 
 	// get/cache the chunk
+	m_keepIndex = true;
 	const char* cData = GetChunk() ? GetChunk()->Get() : NULL;
+	m_keepIndex = false;
 	if (!cData)
 		return -1;
 
@@ -646,9 +1145,15 @@ int ParsePatchCore(
 	int updates = 0, occurence = 0, posStartOfSubchunk = -1, linePos, curLineLen;
 	WDL_FastString* subChunkKeyword = NULL;
 	WDL_PtrList_DeleteOnDestroy<WDL_FastString> parents;
-	const char* pEOL = cData-1, *keyword, *pLine, *pEOSkippedChunk;
+	const char* pEOL = cData-1, *keyword, *pLine = cData, *pEOSkippedChunk;
 	bool alter, tolerantMatch, strictMatch;
 
+	// bytes parsed by this pass (whatever the return point), see FlushStateBytes()
+	struct ParsedBytes {
+		int& used; const char* const& pos; const char* start; int skipped;
+		~ParsedBytes() { used = max(used, (int)(pos-start) - skipped); }
+	} parsedBytes = { m_usedBytes, pLine, cData, 0 };
+
 	m_isParsingSource = false;
 	for(;;)
 	{
@@ -703,6 +1208,7 @@ int ParsePatchCore(
 		
 		if (pEOSkippedChunk) 
 		{
+			parsedBytes.skipped += (int)(pEOSkippedChunk-pLine);
 			bool alter = NotifySkippedSubChunk(_mode, pLine, (int)(pEOSkippedChunk-pLine), (int)(pLine-cData), &parents, newChunk, updates);
 			alter |= (subChunkKeyword && _mode == SNM_REPLACE_SUBCHUNK_OR_LINE);
 			if (_write && !alter)
@@ -945,6 +1451,7 @@ int ParsePatchCore(
 			m_updates += updates;
 
 			// avoids buffer re-copy
+			InvalidateIndex();
 			WDL_FastString* oldChunk = m_chunk;
 			m_chunk = newChunk;
 			delete oldChunk;
@@ -98,80 +98,73 @@ int CopyTakeFXChain(WDL_FastString* _fxChain, int _startSelItem)
 
 void PasteTakeFXChain(const char* _title, WDL_FastString* _chain, bool _activeOnly)
 {
-	bool updated = false;
 	if (_chain && _chain->GetLength())
 	{
-		for (int i = 1; i <= GetNumTracks(); i++) // skip master
+		// item states are read once, and only changed ones are written back (in one go)
+		SWS_ObjectStateBatch batch(_title);
+		WDL_PtrList<MediaItem> items;
+		SNM_GetSelectedItems(NULL, &items);
+		for (int i=0; i < items.GetSize(); i++)
+			batch.Prefetch(items.Get(i));
+
+		for (int i=0; i < items.GetSize(); i++)
 		{
-			MediaTrack* tr = CSurf_TrackFromID(i, false);
-			for (int j = 0; tr && j < GetTrackNumMediaItems(tr); j++)
+			MediaItem* item = items.Get(i);
+			SNM_TakeParserPatcher p(item, CountTakes(item));
+			int tkIdx = (_activeOnly ? *(int*)GetSetMediaItemInfo(item, "I_CURTAKE", NULL) : 0);
+			bool done = false;
+			while (!done && tkIdx >= 0)
 			{
-				MediaItem* item = GetTrackMediaItem(tr,j);
-				if (item && *(bool*)GetSetMediaItemInfo(item,"B_UISEL",NULL))
+				WDL_FastString takeChunk;
+				int tkPos, tklen;
+				if (p.GetTakeChunk(tkIdx, &takeChunk, &tkPos, &tklen)) 
 				{
-					SNM_TakeParserPatcher p(item, CountTakes(item));
-					int tkIdx = (_activeOnly ? *(int*)GetSetMediaItemInfo(item, "I_CURTAKE", NULL) : 0);
-					bool done = false;
-					while (!done && tkIdx >= 0)
+					SNM_ChunkParserPatcher ptk(&takeChunk, false);
+
+					// fx chain exists for this take?
+					// note: eolTakeFx is '\n' position + 1
+					int eolTkFx = ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE_EOL, 1, "TAKEFX", "<TAKEFX", 0);
+
+					// paste fx chain (just before the end of the current TAKEFX)
+					if (eolTkFx > 0) {
+						ptk.GetChunk()->Insert(_chain->Get(), eolTkFx-2); //-2: before ">\n"
+					}
+					// set/create fx chain (after SOURCE)
+					else 
 					{
-						WDL_FastString takeChunk;
-						int tkPos, tklen;
-						if (p.GetTakeChunk(tkIdx, &takeChunk, &tkPos, &tklen)) 
-						{
-							SNM_ChunkParserPatcher ptk(&takeChunk, false);
-
-							// fx chain exists for this take?
-							// note: eolTakeFx is '\n' position + 1
-							int eolTkFx = ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE_EOL, 1, "TAKEFX", "<TAKEFX", 0);
-
-							// paste fx chain (just before the end of the current TAKEFX)
-							if (eolTkFx > 0) {
-								ptk.GetChunk()->Insert(_chain->Get(), eolTkFx-2); //-2: before ">\n"
-							}
-							// set/create fx chain (after SOURCE)
-							else 
-							{
-								int eolSrc = ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE_EOL, 1, "SOURCE", "<SOURCE", 0);
-								if (eolSrc > 0) {
-									WDL_FastString newTakeFx;
-									MakeChunkTakeFX(&newTakeFx, _chain);
-									ptk.GetChunk()->Insert(newTakeFx.Get(), eolSrc);
-								}
-							}
-							updated = p.ReplaceTake(tkPos, tklen, ptk.GetChunk());
+						int eolSrc = ptk.Parse(SNM_GET_SUBCHUNK_OR_LINE_EOL, 1, "SOURCE", "<SOURCE", 0);
+						if (eolSrc > 0) {
+							WDL_FastString newTakeFx;
+							MakeChunkTakeFX(&newTakeFx, _chain);
+							ptk.GetChunk()->Insert(newTakeFx.Get(), eolSrc);
 						}
-						else done = true;
-
-						if (_activeOnly) done = true;
-						else tkIdx++;
 					}
+					p.ReplaceTake(tkPos, tklen, ptk.GetChunk());
 				}
+				else done = true;
+
+				if (_activeOnly) done = true;
+				else tkIdx++;
 			}
 		}
 	}
-	if (updated)
-		Undo_OnStateChangeEx2(NULL, _title, UNDO_STATE_ALL, -1);
 }
 
 // _chain: NULL clears the FX chain
 void SetTakeFXChain(const char* _title, WDL_FastString* _chain, bool _activeOnly)
 {
-	bool updated = false;
-	for (int i = 1; i <= GetNumTracks(); i++) // skip master
+	// item states are read once, and only changed ones are written back (in one go)
+	SWS_ObjectStateBatch batch(_title);
+	WDL_PtrList<MediaItem> items;
+	SNM_GetSelectedItems(NULL, &items);
+	for (int i=0; i < items.GetSize(); i++)
+		batch.Prefetch(items.Get(i));
+
+	for (int i=0; i < items.GetSize(); i++)
 	{
-		MediaTrack* tr = CSurf_TrackFromID(i, false);
-		for (int j = 0; tr && j < GetTrackNumMediaItems(tr); j++)
-		{
-			MediaItem* item = GetTrackMediaItem(tr,j);
-			if (item && *(bool*)GetSetMediaItemInfo(item,"B_UISEL",NULL))
-			{
-				SNM_FXChainTakePatcher p(item);
-				updated |= p.SetFXChain(_chain, _activeOnly);
-			}
-		}
+		SNM_FXChainTakePatcher p(items.Get(i));
+		p.SetFXChain(_chain, _activeOnly);
 	}
-	if (updated)
-		Undo_OnStateChangeEx2(NULL, _title, UNDO_STATE_ALL, -1);
 }
 
 
@@ -200,64 +193,69 @@ bool SetTrackChannelsForFXChain(MediaTrack* _tr, WDL_FastString* _chain)
 	return false;
 }
 
+// gets selected tracks (incl. master) and reads their states up front
+// note: track channels are set first, they would be overwritten by cached states otherwise
+static void GetSelectedTracksForFXChain(WDL_PtrList<MediaTrack>* _tracks, WDL_FastString* _chain, SWS_ObjectStateBatch* _batch)
+{
+	for (int i=0; i <= GetNumTracks(); i++) // incl. master
+	{
+		MediaTrack* tr = CSurf_TrackFromID(i, false);
+		if (tr && *(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
+		{
+			// (try to) set track channels
+			if (SetTrackChannelsForFXChain(tr, _chain))
+				_batch->SetUpdated();
+			_tracks->Add(tr);
+		}
+	}
+	for (int i=0; i < _tracks->GetSize(); i++)
+		_batch->Prefetch(_tracks->Get(i));
+}
+
 void PasteTrackFXChain(const char* _title, WDL_FastString* _chain, bool _inputFX)
 {
-	bool updated = false;
 	if (_chain && _chain->GetLength())
 	{
-		for (int i=0; i <= GetNumTracks(); i++) // incl. master
-		{
-			MediaTrack* tr = CSurf_TrackFromID(i, false);
-			if (tr && *(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
-			{
-				// (try to) set track channels
-				updated |= SetTrackChannelsForFXChain(tr, _chain);
+		// track states are read once, and only changed ones are written back (in one go)
+		SWS_ObjectStateBatch batch(_title);
+		WDL_PtrList<MediaTrack> tracks;
+		GetSelectedTracksForFXChain(&tracks, _chain, &batch);
 
-				// the meat
-				bool patch = false;
-				SNM_FXChainTrackPatcher p(tr);
-				WDL_FastString currentFXChain;
-				int pos = p.GetSubChunk(_inputFX ? "FXCHAIN_REC" : "FXCHAIN", 2, 0, &currentFXChain, "<ITEM");
+		for (int i=0; i < tracks.GetSize(); i++)
+		{
+			MediaTrack* tr = tracks.Get(i);
 
-				// paste (well.. insert at the end of the current FX chain)
-				if (pos >= 0) 
-				{
-					patch = true;
-					p.GetChunk()->Insert(_chain->Get(), pos + currentFXChain.GetLength() - 2); // -2: before ">\n"
-					p.IncUpdates();
-				}
-				// create fx chain
-				else 
-					patch = p.SetFXChain(_chain, _inputFX);
+			// the meat
+			SNM_FXChainTrackPatcher p(tr);
+			WDL_FastString currentFXChain;
+			int pos = p.GetSubChunk(_inputFX ? "FXCHAIN_REC" : "FXCHAIN", 2, 0, &currentFXChain, "<ITEM");
 
-				updated |= patch;
+			// paste (well.. insert at the end of the current FX chain)
+			if (pos >= 0) 
+			{
+				p.GetChunk()->Insert(_chain->Get(), pos + currentFXChain.GetLength() - 2); // -2: before ">\n"
+				p.IncUpdates();
 			}
+			// create fx chain
+			else 
+				p.SetFXChain(_chain, _inputFX);
 		}
 	}
-	if (updated)
-		Undo_OnStateChangeEx2(NULL, _title, UNDO_STATE_ALL, -1);
 }
 
 // _chain: NULL to clear
 void SetTrackFXChain(const char* _title, WDL_FastString* _chain, bool _inputFX)
 {
-	bool updated = false;
-	for (int i=0; i <= GetNumTracks(); i++) // incl. master
-	{
-		MediaTrack* tr = CSurf_TrackFromID(i, false);
-		if (tr && *(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
-		{
-			// (try to) set track channels
-			updated |= SetTrackChannelsForFXChain(tr, _chain);
+	// track states are read once, and only changed ones are written back (in one go)
+	SWS_ObjectStateBatch batch(_title);
+	WDL_PtrList<MediaTrack> tracks;
+	GetSelectedTracksForFXChain(&tracks, _chain, &batch);
 
-			// the meat
-			SNM_FXChainTrackPatcher p(tr);
-			bool patch = p.SetFXChain(_chain, _inputFX);
-			updated |= patch;
-		}
+	for (int i=0; i < tracks.GetSize(); i++)
+	{
+		SNM_FXChainTrackPatcher p(tracks.Get(i));
+		p.SetFXChain(_chain, _inputFX);
 	}
-	if (updated)
-		Undo_OnStateChangeEx2(NULL, _title, UNDO_STATE_ALL, -1);
 }
 
 // returns the first copied track idx (1-based, 0 = master)
@@ -44,6 +44,7 @@
 #define FIND_WND_ID				"SnMFind"
 #define FIND_INI_SEC			"Find"
 #define MAX_SEARCH_STR_LEN		128
+#define FIND_INDEX_REFRESH_FREQ	1000 // ms, see FindIndex::Sync()
 
 enum {
   TXTID_SCOPE=0xF000,
@@ -72,59 +73,419 @@ bool g_notFound=false;
 
 
 ///////////////////////////////////////////////////////////////////////////////
+// FindIndex: searched texts of one search type + trigram index of them
+// - built lazily, on the first search
+// - synced incrementally: objects are re-read on project changes (or on
+//   timer as some API edits do not change the project state) but only those
+//   whose text changed are re-indexed
+// - results are sorted by time (track order for tracks) and cached until
+//   the next change: find next/previous are binary searches in there
+///////////////////////////////////////////////////////////////////////////////
+
+struct FindKey
+{
+	double pos;
+	int trIdx, itemIdx;
+};
+
+struct FindDoc
+{
+	INT_PTR key; // MediaItem*, MediaTrack* or marker/region enum index
+	FindKey k;
+	bool seen;
+	WDL_FastString text; // all takes: one line per take
+};
 
-bool TakeNameMatch(MediaItem_Take* _tk, const char* _searchStr)
+static int CompareFindKeys(const FindKey* _a, const FindKey* _b)
 {
-	char* takeName = _tk ? (char*)GetSetMediaItemTakeInfo(_tk, "P_NAME", NULL) : NULL;
-	return (takeName && stristr(takeName, _searchStr));
+	if (_a->pos != _b->pos) return _a->pos < _b->pos ? -1 : 1;
+	if (_a->trIdx != _b->trIdx) return _a->trIdx < _b->trIdx ? -1 : 1;
+	if (_a->itemIdx != _b->itemIdx) return _a->itemIdx < _b->itemIdx ? -1 : 1;
+	return 0;
+}
+
+static int FoldChar(unsigned char _c) {
+	return (_c>='A' && _c<='Z') ? _c+32 : _c;
 }
 
-bool TakeFilenameMatch(MediaItem_Take* _tk, const char* _searchStr)
+// sorted unique trigrams of _text, ASCII case folded
+// _asciiOnly: skip trigrams with non-ASCII chars (stristr() may fold them
+// depending on the locale), for queries: it only reduces the filtering
+static void GetTrigrams(const char* _text, WDL_TypedBuf<int>* _out, bool _asciiOnly)
 {
-	bool match = false;
-	PCM_source* src = _tk ? (PCM_source*)GetSetMediaItemTakeInfo(_tk, "P_SOURCE", NULL) : NULL;
-	if (src) 
+	_out->Resize(0, false);
+	const unsigned char* p = (const unsigned char*)_text;
+	for (int i=0; p[i] && p[i+1] && p[i+2]; i++)
 	{
-		const char* takeFilename = src->GetFileName();
-		match = (takeFilename && strstr(takeFilename, _searchStr)); // no stristr: osx + utf-8
+		if (_asciiOnly && (p[i]>=0x80 || p[i+1]>=0x80 || p[i+2]>=0x80))
+			continue;
+		_out->Add((FoldChar(p[i])<<16) | (FoldChar(p[i+1])<<8) | FoldChar(p[i+2]));
 	}
-	return match;
+	int* t = _out->Get();
+	std::sort(t, t+_out->GetSize());
+	_out->Resize((int)(std::unique(t, t+_out->GetSize()) - t), false);
 }
 
-bool ItemNotesMatch(MediaItem* _item, const char* _searchStr)
+static FindKey GetItemFindKey(MediaItem* _item)
 {
-	bool match = false;
-	if (_item)
-	{
-		SNM_ChunkParserPatcher p(_item);
-		WDL_FastString notes;
-		if (p.GetSubChunk("NOTES", 2, 0, &notes, "VOLPAN") >= 0) // rmk: we use VOLPAN as it also exists for empty items
-			//JFB TODO? we compare a formated string with a normal one here, oh well..
-			match = (stristr(notes.Get(), _searchStr) != NULL);
-	}
-	return match;
+	FindKey k = {
+		*(double*)GetSetMediaItemInfo(_item, "D_POSITION", NULL),
+		CSurf_TrackToID(GetMediaItem_Track(_item), false),
+		(int)GetMediaItemInfo_Value(_item, "IP_ITEMNUMBER")
+	};
+	return k;
 }
 
-bool TrackNameMatch(MediaTrack* _tr, const char* _searchStr) {
-	char* name = _tr ? (char*)GetSetMediaTrackInfo(_tr, "P_NAME", NULL) : NULL;
-	return (name && stristr(name, _searchStr));
+class FindIndex
+{
+public:
+	FindIndex(int _type) : m_type(_type), m_proj(NULL), m_stateCount(-1), m_refreshTime(0), 
+		m_dirty(true), m_changed(false), m_gen(0), m_resGen(-1), m_postings(DeletePosting) {}
+	~FindIndex() { m_docs.Empty(true); }
+
+	int GetType() const { return m_type; }
+	void Invalidate() { m_dirty = true; m_resGen = -1; }
+	// our own edits (selection changes, edit cursor moves) do not require a sync
+	void Stamp() { if (m_proj) m_stateCount = GetProjectStateChangeCount(m_proj); }
+
+	const WDL_TypedBuf<int>* Search(const char* _str);
+	bool CheckResults(const WDL_TypedBuf<int>* _res, int _first, int _last);
+	const FindDoc* GetDoc(int _slot) { return m_docs.Get(_slot); }
+	int GetNext(const WDL_TypedBuf<int>* _res, const FindKey* _from, int _dir);
+
+private:
+	void Sync();
+	const WDL_TypedBuf<int>* GetResults(const char* _str);
+	void Update(INT_PTR _key, const FindKey* _k, const char* _text);
+	void Remove(int _slot);
+	void Index(int _slot, bool _add);
+	void GetItemText(MediaItem* _item, WDL_FastString* _text);
+	void GetTrackText(MediaTrack* _tr, WDL_FastString* _text);
+	bool Match(const char* _text, const char* _str) const;
+	static void DeletePosting(WDL_TypedBuf<int>* _p) { delete _p; }
+
+	int m_type;
+	ReaProject* m_proj;
+	int m_stateCount;
+	DWORD m_refreshTime;
+	bool m_dirty, m_changed;
+	int m_gen, m_resGen;
+	WDL_PtrList<FindDoc> m_docs; // NULL: free slot, see m_free
+	WDL_TypedBuf<int> m_free;
+	WDL_PtrKeyedArray<int> m_slots; // doc key -> slot
+	WDL_IntKeyedArray<WDL_TypedBuf<int>*> m_postings; // trigram -> sorted slots
+	WDL_FastString m_resStr;
+	WDL_TypedBuf<int> m_results; // slots, sorted by FindKey
+};
+
+WDL_PtrList_DOD<FindIndex> g_findIndexes; // one per search type, lazy init
+
+static FindIndex* GetFindIndex(int _type)
+{
+	for (int i=0; i<g_findIndexes.GetSize(); i++)
+		if (g_findIndexes.Get(i)->GetType() == _type)
+			return g_findIndexes.Get(i);
+	return g_findIndexes.Add(new FindIndex(_type));
 }
 
-bool TrackNotesMatch(MediaTrack* _tr, const char* _searchStr) 
+void FindIndex::Sync()
 {
-	bool match = false;
-	if (_tr)
+	ReaProject* proj = EnumProjects(-1, NULL, 0);
+	int stateCount = GetProjectStateChangeCount(proj);
+	if (!m_dirty && proj == m_proj && stateCount == m_stateCount && GetTickCount() <= m_refreshTime)
+		return;
+
+	// project tab switch: everything is new
+	if (proj != m_proj)
 	{
-		for (int i=0; i < g_SNM_TrackNotes.Get()->GetSize(); i++)
+		m_docs.Empty(true);
+		m_free.Resize(0, false);
+		m_slots.DeleteAll();
+		m_postings.DeleteAll();
+		m_changed = true;
+	}
+	m_proj = proj;
+	m_stateCount = stateCount;
+	m_refreshTime = GetTickCount() + FIND_INDEX_REFRESH_FREQ;
+	m_dirty = false;
+
+	for (int i=0; i<m_docs.GetSize(); i++)
+		if (FindDoc* d = m_docs.Get(i))
+			d->seen = false;
+
+	WDL_FastString text;
+	switch (m_type)
+	{
+		case TYPE_TRACK_NAME:
+		case TYPE_TRACK_NOTES:
+			for (int i=0; i <= CountTracks(NULL); i++) // incl. master
+				if (MediaTrack* tr = CSurf_TrackFromID(i, false))
+				{
+					FindKey k = { 0.0, i, 0 };
+					GetTrackText(tr, &text);
+					Update((INT_PTR)tr, &k, text.Get());
+				}
+			break;
+		case TYPE_MARKER_REGION:
 		{
-			if (g_SNM_TrackNotes.Get()->Get(i)->GetTrack() == _tr)
+			int x=0, id;
+			bool isRgn;
+			double pos, end;
+			const char* name;
+			while ((x=EnumProjectMarkers2(NULL, x, &isRgn, &pos, &end, &name, &id)))
 			{
-				match = stristr(g_SNM_TrackNotes.Get()->Get(i)->GetNotes(), _searchStr) != NULL;
-				break;
+				FindKey k = { pos, 0, x-1 };
+				Update(x-1, &k, name ? name : "");
+			}
+			break;
+		}
+		default:
+			for (int i=1; i <= CountTracks(NULL); i++)
+			{
+				MediaTrack* tr = CSurf_TrackFromID(i, false);
+				int nbItems = GetTrackNumMediaItems(tr);
+				for (int j=0; j < nbItems; j++)
+					if (MediaItem* item = GetTrackMediaItem(tr, j))
+					{
+						FindKey k = { *(double*)GetSetMediaItemInfo(item, "D_POSITION", NULL), i, j };
+						GetItemText(item, &text);
+						Update((INT_PTR)item, &k, text.Get());
+					}
 			}
+			break;
+	}
+
+	for (int i=0; i<m_docs.GetSize(); i++)
+		if (FindDoc* d = m_docs.Get(i))
+			if (!d->seen)
+				Remove(i);
+
+	if (m_changed)
+	{
+		m_changed = false;
+		m_gen++;
+	}
+}
+
+void FindIndex::Update(INT_PTR _key, const FindKey* _k, const char* _text)
+{
+	int slot = m_slots.Get(_key, -1);
+	FindDoc* d = slot>=0 ? m_docs.Get(slot) : NULL;
+	if (!d)
+	{
+		d = new FindDoc;
+		d->key = _key;
+		d->k = *_k;
+		d->text.Set(_text);
+		if (m_free.GetSize())
+		{
+			slot = m_free.Get()[m_free.GetSize()-1];
+			m_free.Resize(m_free.GetSize()-1, false);
+			m_docs.Set(slot, d);
+		}
+		else
+		{
+			slot = m_docs.GetSize();
+			m_docs.Add(d);
+		}
+		m_slots.Insert(_key, slot);
+		Index(slot, true);
+		m_changed = true;
+	}
+	else
+	{
+		if (CompareFindKeys(&d->k, _k))
+		{
+			d->k = *_k;
+			m_changed = true;
+		}
+		if (strcmp(d->text.Get(), _text))
+		{
+			Index(slot, false);
+			d->text.Set(_text);
+			Index(slot, true);
+			m_changed = true;
+		}
+	}
+	d->seen = true;
+}
+
+void FindIndex::Remove(int _slot)
+{
+	if (FindDoc* d = m_docs.Get(_slot))
+	{
+		Index(_slot, false);
+		m_slots.Delete(d->key);
+		m_docs.Set(_slot, NULL);
+		m_free.Add(_slot);
+		delete d;
+		m_changed = true;
+	}
+}
+
+// adds/removes a doc to/from the posting lists of its trigrams
+void FindIndex::Index(int _slot, bool _add)
+{
+	static WDL_TypedBuf<int> sTrigrams;
+	GetTrigrams(m_docs.Get(_slot)->text.Get(), &sTrigrams, false);
+	for (int i=0; i<sTrigrams.GetSize(); i++)
+	{
+		int t = sTrigrams.Get()[i];
+		WDL_TypedBuf<int>* p = m_postings.Get(t, NULL);
+		if (!p)
+		{
+			if (!_add) continue;
+			p = new WDL_TypedBuf<int>;
+			m_postings.Insert(t, p);
+		}
+
+		int* slots = p->Get();
+		int n = p->GetSize();
+		int k = (int)(std::lower_bound(slots, slots+n, _slot) - slots); // == n most of the time
+		if (_add)
+		{
+			if (k==n || slots[k]!=_slot)
+				p->Insert(_slot, k);
+		}
+		else if (k<n && slots[k]==_slot)
+		{
+			p->Delete(k);
+			if (!p->GetSize())
+				m_postings.Delete(t);
+		}
+	}
+}
+
+void FindIndex::GetItemText(MediaItem* _item, WDL_FastString* _text)
+{
+	_text->Set("");
+	if (m_type == TYPE_ITEM_NOTES)
+	{
+		if (const char* notes = (const char*)GetSetMediaItemInfo(_item, "P_NOTES", NULL))
+			_text->Set(notes);
+		return;
+	}
+
+	bool allTakes = (m_type == TYPE_ITEM_NAME_ALL_TAKES || m_type == TYPE_ITEM_FILENAME_ALL_TAKES);
+	int nbTakes = allTakes ? GetMediaItemNumTakes(_item) : 1;
+	for (int i=0; i < nbTakes; i++)
+	{
+		MediaItem_Take* tk = allTakes ? GetMediaItemTake(_item, i) : GetActiveTake(_item);
+		if (!tk)
+			continue;
+
+		const char* str = NULL;
+		if (m_type == TYPE_ITEM_NAME || m_type == TYPE_ITEM_NAME_ALL_TAKES)
+			str = (const char*)GetSetMediaItemTakeInfo(tk, "P_NAME", NULL);
+		else if (PCM_source* src = (PCM_source*)GetSetMediaItemTakeInfo(tk, "P_SOURCE", NULL))
+			str = src->GetFileName();
+
+		if (str && *str)
+		{
+			if (_text->GetLength())
+				_text->Append("\n"); // search strings are single line
+			_text->Append(str);
+		}
+	}
+}
+
+void FindIndex::GetTrackText(MediaTrack* _tr, WDL_FastString* _text)
+{
+	_text->Set("");
+	if (m_type == TYPE_TRACK_NOTES)
+	{
+		if (SNM_TrackNotes* tn = g_SNM_TrackNotes.Get()->Find(_tr))
+			_text->Set(tn->GetNotes());
+	}
+	else if (const char* name = (const char*)GetSetMediaTrackInfo(_tr, "P_NAME", NULL))
+		_text->Set(name);
+}
+
+bool FindIndex::Match(const char* _text, const char* _str) const
+{
+	if (m_type == TYPE_ITEM_FILENAME || m_type == TYPE_ITEM_FILENAME_ALL_TAKES)
+		return strstr(_text, _str) != NULL; // no stristr: osx + utf-8
+	return stristr(_text, _str) != NULL;
+}
+
+// returns the slots of the docs matching _str, sorted by FindKey
+// the index is synced on project changes or on timer only, so items/tracks can have
+// been deleted meanwhile: check the results that are used with CheckResults()
+const WDL_TypedBuf<int>* FindIndex::Search(const char* _str)
+{
+	Sync();
+	return GetResults(_str);
+}
+
+// true if the objects of the results _first to _last still exist
+// (otherwise: Invalidate() and search again)
+bool FindIndex::CheckResults(const WDL_TypedBuf<int>* _res, int _first, int _last)
+{
+	if (m_type == TYPE_MARKER_REGION)
+		return true; // keys are enum indexes, not pointers
+	const char* ptrType = (m_type == TYPE_TRACK_NAME || m_type == TYPE_TRACK_NOTES) ? "MediaTrack*" : "MediaItem*";
+	for (int i=(_first<0 ? 0 : _first); i <= _last && i < _res->GetSize(); i++)
+		if (!ValidatePtr2(NULL, (void*)m_docs.Get(_res->Get()[i])->key, ptrType))
+			return false;
+	return true;
+}
+
+const WDL_TypedBuf<int>* FindIndex::GetResults(const char* _str)
+{
+	if (m_resGen == m_gen && !strcmp(m_resStr.Get(), _str))
+		return &m_results;
+
+	m_resGen = m_gen;
+	m_resStr.Set(_str);
+	m_results.Resize(0, false);
+
+	// candidates: docs of the shortest posting list, all docs for short queries
+	static WDL_TypedBuf<int> sTrigrams;
+	GetTrigrams(_str, &sTrigrams, true);
+	WDL_TypedBuf<int>* candidates = NULL;
+	for (int i=0; i<sTrigrams.GetSize(); i++)
+	{
+		WDL_TypedBuf<int>* p = m_postings.Get(sTrigrams.Get()[i], NULL);
+		if (!p)
+			return &m_results; // no doc has that trigram
+		if (!candidates || p->GetSize() < candidates->GetSize())
+			candidates = p;
+	}
+
+	int nb = candidates ? candidates->GetSize() : m_docs.GetSize();
+	for (int i=0; i < nb; i++)
+	{
+		int slot = candidates ? candidates->Get()[i] : i;
+		if (FindDoc* d = m_docs.Get(slot))
+			if (Match(d->text.Get(), _str))
+				m_results.Add(slot);
+	}
+
+	std::sort(m_results.Get(), m_results.Get()+m_results.GetSize(), [this](int _a, int _b) {
+		return CompareFindKeys(&m_docs.Get(_a)->k, &m_docs.Get(_b)->k) < 0;
+	});
+	return &m_results;
+}
+
+// returns the index in _res of the 1st result after _from (_dir>0), 
+// or of the last one before _from (_dir<0), -1 if none
+// _from==NULL: 1st/last result
+int FindIndex::GetNext(const WDL_TypedBuf<int>* _res, const FindKey* _from, int _dir)
+{
+	int i = _dir>0 ? 0 : _res->GetSize()-1;
+	if (_from)
+	{
+		int lo=0, hi=_res->GetSize();
+		while (lo < hi)
+		{
+			int mid = (lo+hi)/2;
+			int cmp = CompareFindKeys(&m_docs.Get(_res->Get()[mid])->k, _from);
+			if (cmp < 0 || (cmp == 0 && _dir > 0)) lo = mid+1;
+			else hi = mid;
 		}
+		i = _dir>0 ? lo : lo-1;
 	}
-	return match;
+	return (i>=0 && i<_res->GetSize()) ? i : -1;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -356,25 +717,15 @@ bool FindWnd::Find(int _mode)
 	switch(m_type)
 	{
 		case TYPE_ITEM_NAME:
-			update = FindMediaItem(_mode, false, TakeNameMatch);
-		break;
 		case TYPE_ITEM_NAME_ALL_TAKES:
-			update = FindMediaItem(_mode, true, TakeNameMatch);
-		break;
 		case TYPE_ITEM_FILENAME:
-			update = FindMediaItem(_mode, false, TakeFilenameMatch);
-		break;
 		case TYPE_ITEM_FILENAME_ALL_TAKES:
-			update = FindMediaItem(_mode, true, TakeFilenameMatch);
-		break;
 		case TYPE_ITEM_NOTES:
-			update = FindMediaItem(_mode, false, NULL, ItemNotesMatch);
+			update = FindMediaItem(_mode);
 		break;
 		case TYPE_TRACK_NAME:
-			update = FindTrack(_mode, TrackNameMatch);
-		break;
 		case TYPE_TRACK_NOTES:
-			update = FindTrack(_mode, TrackNotesMatch);
+			update = FindTrack(_mode);
 		break;
 		case TYPE_MARKER_REGION:
 			update = FindMarkerRegion(_mode);
@@ -382,132 +733,74 @@ bool FindWnd::Find(int _mode)
 	return update;
 }
 
-MediaItem* FindWnd::FindPrevNextItem(int _dir, MediaItem* _item)
-{
-	if (!_dir)
-		return NULL;
-
-	MediaItem* previous = NULL;
-	int startTrIdx = (_dir == -1 ? CountTracks(NULL) : 1);
-	if (_item)
-		if (MediaTrack* trItem = GetMediaItem_Track(_item))
-			startTrIdx = CSurf_TrackToID(trItem, false);
-
-	if (startTrIdx>=0)
-	{
-		bool found = (_item == NULL);
-		for (int i = startTrIdx; !previous && i <= CountTracks(NULL) && i >= 1; i+=_dir)
-		{
-			MediaTrack* tr = CSurf_TrackFromID(i, false); 
-			int nbItems = GetTrackNumMediaItems(tr);
-			for (int j = (_dir > 0 ? 0 : (nbItems-1)); j < nbItems && j >= 0; j+=_dir)
-			{
-				MediaItem* item = GetTrackMediaItem(tr,j);
-				if (found && item) {
-					previous = item;
-					break;
-				}
-				if (_item && item == _item)
-					found = true;
-			}
-		}
-	}
-	return previous;
-}
-
-// param _allTakes only makes sense if jobTake() is used
-bool FindWnd::FindMediaItem(int _dir, bool _allTakes, bool (*jobTake)(MediaItem_Take*,const char*), bool (*jobItem)(MediaItem*,const char*))
+// _dir==0: select all matching items
+// otherwise: select the next/previous one, in time order, relative to the
+// first/last selected item
+bool FindWnd::FindMediaItem(int _dir)
 {
-	bool update = false, found = false, sel = true;
+	bool update = false, found = false;
+	FindIndex* idx = GetFindIndex(m_type);
 	if (*g_searchStr)
 	{
-		PreventUIRefresh(1);
+		const WDL_TypedBuf<int>* res = idx->Search(g_searchStr);
 
-		MediaItem* startItem = NULL;
-		bool clearCurrentSelection = false;
+		int first = 0, last = res->GetSize()-1;
 		if (_dir)
 		{
 			WDL_PtrList<MediaItem> items;
 			SNM_GetSelectedItems(NULL, &items);
-			if (items.GetSize())
+
+			FindKey from, k;
+			for (int i=0; i < items.GetSize(); i++)
+			{
+				k = GetItemFindKey(items.Get(i));
+				if (!i || (_dir > 0 ? CompareFindKeys(&k, &from) < 0 : CompareFindKeys(&k, &from) > 0))
+					from = k;
+			}
+			first = last = idx->GetNext(res, items.GetSize() ? &from : NULL, _dir);
+
+			// the candidate can have been deleted or moved since the last sync: re-sync and search again
+			if (first >= 0)
 			{
-				startItem = FindPrevNextItem(_dir, items.Get(_dir > 0 ? 0 : items.GetSize()-1));
-				clearCurrentSelection = (startItem != NULL); 
+				bool stale = !idx->CheckResults(res, first, last);
+				if (!stale)
+				{
+					const FindDoc* d = idx->GetDoc(res->Get()[first]);
+					FindKey cur = GetItemFindKey((MediaItem*)d->key);
+					stale = CompareFindKeys(&cur, &d->k) != 0;
+				}
+				if (stale)
+				{
+					idx->Invalidate();
+					res = idx->Search(g_searchStr);
+					first = last = idx->GetNext(res, items.GetSize() ? &from : NULL, _dir);
+				}
 			}
-			else
-				startItem = FindPrevNextItem(_dir, NULL);
 		}
-		else
+		else if (!idx->CheckResults(res, first, last))
 		{
-			startItem = FindPrevNextItem(1, NULL);
-			clearCurrentSelection = (startItem != NULL); 
+			idx->Invalidate();
+			res = idx->Search(g_searchStr);
+			last = res->GetSize()-1;
 		}
+		found = (first >= 0 && first <= last);
 
-		if (clearCurrentSelection)
+		PreventUIRefresh(1);
+
+		MediaItem* item = NULL;
+		if (found || !_dir)
 		{
 			Undo_BeginBlock2(NULL);
 			Main_OnCommand(40289,0); // unselect all items
 			update = true;
-		}
-
-		MediaItem* item = NULL;
-		MediaTrack* startTr = startItem ? GetMediaItem_Track(startItem) : NULL;
-		int startTrIdx = startTr ? CSurf_TrackToID(startTr, false) : -1;
-		if (startTr && startItem && startTrIdx>=0)
-		{
-			// find startItem idx
-			int startItemIdx=-1;
-			while (item != startItem) 
-				item = GetTrackMediaItem(startTr,++startItemIdx);
 
-			bool firstItem=true, breakSelection=false;
-			for (int i=startTrIdx; !breakSelection && i <= CountTracks(NULL) && i>=1; i += (!_dir ? 1 : _dir))
+			for (int i=first; found && i <= last; i++)
 			{
-				MediaTrack* tr = CSurf_TrackFromID(i, false); 
-				int nbItems = GetTrackNumMediaItems(tr);
-				for (int j = (firstItem ? startItemIdx : (_dir >= 0 ? 0 : (nbItems-1))); 
-					 tr && !breakSelection && j < nbItems && j >= 0; 
-					 j += (!_dir ? 1 : _dir))
-				{
-					item = GetTrackMediaItem(tr,j);
-					firstItem = false;
-
-					// search at item level 
-					if (jobItem)
-					{
-						if (jobItem(item, g_searchStr))
-						{
-							if (!update) Undo_BeginBlock2(NULL);
-							update = found = true;
-							GetSetMediaItemInfo(item, "B_UISEL", &sel);
-							if (_dir) breakSelection = true;
-						}
-					}
-					// search at take level 
-					else if (jobTake)
-					{
-						int nbTakes = GetMediaItemNumTakes(item);
-						for (int k=0; item && k < nbTakes; k++)
-						{
-							MediaItem_Take* tk = GetMediaItemTake(item, k);
-							if (tk && (_allTakes || (!_allTakes && tk == GetActiveTake(item))))
-							{
-								if (jobTake(tk, g_searchStr))
-								{
-									if (!update) Undo_BeginBlock2(NULL);
-									update = found = true;
-									GetSetMediaItemInfo(item, "B_UISEL", &sel);
-									if (_dir) {
-										breakSelection = true;
-										break;
-									}
-								}
-							}
-						}
-					}
-				}
+				item = (MediaItem*)idx->GetDoc(res->Get()[i])->key;
+				GetSetMediaItemInfo(item, "B_UISEL", &g_bTrue);
 			}
 		}
+
 		UpdateNotFoundMsg(found);
 		if (found && m_zoomSrollItems) {
 			if (!_dir) ZoomToSelItems();
@@ -521,63 +814,51 @@ bool FindWnd::FindMediaItem(int _dir, bool _allTakes, bool (*jobTake)(MediaItem_
 	{
 		UpdateTimeline();
 		Undo_EndBlock2(NULL, __LOCALIZE("Find: change media item selection","sws_undo"), UNDO_STATE_ALL);
+		idx->Stamp();
 	}
 	return update;
 }
 
-bool FindWnd::FindTrack(int _dir, bool (*job)(MediaTrack*,const char*))
+// _dir==0: select all matching tracks
+// otherwise: select the next/previous one relative to the first/last selected track
+bool FindWnd::FindTrack(int _dir)
 {
 	bool update = false, found = false;
+	FindIndex* idx = GetFindIndex(m_type);
 	if (*g_searchStr)
 	{
-		int startTrIdx = -1;
-		bool clearCurrentSelection = false;
-		if (_dir)
+		const WDL_TypedBuf<int>* res = NULL;
+		int first, last;
+
+		// the tracks to be selected can have been deleted since the last sync: re-sync and search again
+		for (int pass=0; pass<2; pass++)
 		{
-			if (const int selTracksCount = SNM_CountSelectedTracks(NULL, true))
+			if (pass)
+				idx->Invalidate();
+			res = idx->Search(g_searchStr);
+
+			first = 0, last = res->GetSize()-1;
+			if (_dir)
 			{
-				if (MediaTrack* startTr = SNM_GetSelectedTrack(NULL, _dir > 0 ? 0 : selTracksCount-1, true))
-				{
-					int id = CSurf_TrackToID(startTr, false);
-					if ((_dir > 0 && id < CountTracks(NULL)) || (_dir < 0 && id >0))
-					{
-						startTrIdx = id + _dir;
-						clearCurrentSelection = true;
-					}
-				}
+				FindKey from = { 0.0, 0, 0 };
+				const int selTracksCount = SNM_CountSelectedTracks(NULL, true);
+				if (MediaTrack* selTr = selTracksCount ? SNM_GetSelectedTrack(NULL, _dir > 0 ? 0 : selTracksCount-1, true) : NULL)
+					from.trIdx = CSurf_TrackToID(selTr, false);
+				first = last = idx->GetNext(res, selTracksCount ? &from : NULL, _dir);
 			}
-			else
-				startTrIdx = (_dir > 0 ? 0 : CountTracks(NULL));
-		}
-		else
-		{
-			startTrIdx = 0;
-			clearCurrentSelection = true;
+			if (idx->CheckResults(res, first, last))
+				break;
 		}
+		found = (first >= 0 && first <= last);
 
-		if (clearCurrentSelection)
+		if (found || !_dir)
 		{
 			Undo_BeginBlock2(NULL);
 			Main_OnCommand(40297,0); // unselect all tracks
 			update = true;
-		}
 
-		if (startTrIdx >= 0)
-		{
-			for (int i = startTrIdx; i <= CountTracks(NULL) && i>=0; i += (!_dir ? 1 : _dir))
-			{
-				MediaTrack* tr = CSurf_TrackFromID(i, false); 
-				if (tr && job(tr, g_searchStr))
-				{
-					if (!update)
-						Undo_BeginBlock2(NULL);
-
-					update = found = true;
-					GetSetMediaTrackInfo(tr, "I_SELECTED", &g_i1);
-					if (_dir) 
-						break;
-				}
-			}
+			for (int i=first; found && i <= last; i++)
+				GetSetMediaTrackInfo((MediaTrack*)idx->GetDoc(res->Get()[i])->key, "I_SELECTED", &g_i1);
 		}
 
 		UpdateNotFoundMsg(found);	
@@ -586,8 +867,10 @@ bool FindWnd::FindTrack(int _dir, bool (*job)(MediaTrack*,const char*))
 	}
 
 	if (update)
+	{
 		Undo_EndBlock2(NULL, __LOCALIZE("Find: change track selection","sws_undo"), UNDO_STATE_ALL);
-
+		idx->Stamp();
+	}
 	return update;
 }
 
@@ -597,36 +880,27 @@ bool FindWnd::FindMarkerRegion(int _dir)
 		return false;
 
 	bool update = false, found = false;
+	FindIndex* idx = GetFindIndex(m_type);
 	if (*g_searchStr)
 	{
-		double startPos = GetCursorPositionEx(NULL);
-		int id, x = 0;
-		bool bR;
-		double dPos, dRend, dMinMaxPos = _dir < 0 ? -DBL_MAX : DBL_MAX;
-		const char *cName;
-		while ((x=EnumProjectMarkers2(NULL, x, &bR, &dPos, &dRend, &cName, &id)))
-		{
-			if (_dir == 1 && dPos > startPos) {
-				if (stristr(cName, g_searchStr)) {
-					found = true;
-					dMinMaxPos = min(dPos, dMinMaxPos);
-				}
-			}
-			else if (_dir == -1 && dPos < startPos) {
-				if (stristr(cName, g_searchStr)) {
-					found = true;
-					dMinMaxPos = max(dPos, dMinMaxPos);
-				}
-			}
-		}
+		const WDL_TypedBuf<int>* res = idx->Search(g_searchStr);
+
+		// strictly after/before the edit cursor (marker keys: trIdx==0)
+		FindKey from = { GetCursorPositionEx(NULL), _dir > 0 ? 1 : -1, 0 };
+		int i = idx->GetNext(res, &from, _dir);
+		found = (i >= 0);
+
 		UpdateNotFoundMsg(found);	
 		if (found) {
-			SetEditCurPos2(NULL, dMinMaxPos, true, false);
+			SetEditCurPos2(NULL, idx->GetDoc(res->Get()[i])->k.pos, true, false);
 			update = true;
 		}
 	}
 	if (update)
+	{
 		Undo_OnStateChangeEx2(NULL, __LOCALIZE("Find: change edit cursor position","sws_undo"), UNDO_STATE_ALL, -1); // in case the pref "undo pt for edit cursor positions" is enabled..
+		idx->Stamp();
+	}
 	return update;
 }
 
@@ -648,6 +922,20 @@ int FindInit()
 
 void FindExit() {
 	g_findWndMgr.Delete();
+	g_findIndexes.Empty(true);
+}
+
+void FindSetTrackListChange()
+{
+	for (int i=0; i<g_findIndexes.GetSize(); i++)
+		g_findIndexes.Get(i)->Invalidate();
+}
+
+void FindSetTrackTitle()
+{
+	for (int i=0; i<g_findIndexes.GetSize(); i++)
+		if (g_findIndexes.Get(i)->GetType() == TYPE_TRACK_NAME)
+			g_findIndexes.Get(i)->Invalidate();
 }
 
 void OpenFind(COMMAND_T*)
@@ -40,9 +40,8 @@ public:
 	void OnCommand(WPARAM wParam, LPARAM lParam);
 	void GetMinSize(int* _w, int* _h) { *_w=297; *_h=100; }
 	bool Find(int _mode);
-	MediaItem* FindPrevNextItem(int _dir, MediaItem* _item);
-	bool FindMediaItem(int _dir, bool _allTakes, bool (*jobTake)(MediaItem_Take*,const char*), bool (*jobItem)(MediaItem*,const char*) = NULL);
-	bool FindTrack(int _dir, bool (*job)(MediaTrack*,const char*));
+	bool FindMediaItem(int _dir);
+	bool FindTrack(int _dir);
 	bool FindMarkerRegion(int _dir);
 	void UpdateNotFoundMsg(bool _found);
 protected:
@@ -65,5 +64,7 @@ void FindExit();
 void OpenFind(COMMAND_T*);
 int IsFindDisplayed(COMMAND_T*);
 void FindNextPrev(COMMAND_T*);
+void FindSetTrackListChange();
+void FindSetTrackTitle();
 
 #endif
@@ -472,7 +472,8 @@ void CopyCutTakes(COMMAND_T* _ct)
 
 void PasteTakes(COMMAND_T* _ct)
 {
-	bool updated = false;
+	// item states are read once, and only changed ones are written back (in one go)
+	SWS_ObjectStateBatch batch(SWS_CMD_SHORTNAME(_ct));
 	int idxClipboard = 0;
 	for (int i=1; i <= GetNumTracks(); i++) // skip master
 		if (MediaTrack* tr = CSurf_TrackFromID(i, false))
@@ -482,10 +483,8 @@ void PasteTakes(COMMAND_T* _ct)
 					{
 						SNM_TakeParserPatcher p(item, CountTakes(item));
 						int activeTake = *(int*)GetSetMediaItemInfo(item, "I_CURTAKE", NULL) + (int)_ct->user;
-						updated |= (p.InsertTake(activeTake, g_takesClipoard.Get(idxClipboard++)) >= 0);
+						p.InsertTake(activeTake, g_takesClipoard.Get(idxClipboard++));
 					}
-	if (updated)
-		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
 }
 
 
@@ -1145,6 +1144,10 @@ bool PatchTakeEnvelopeActVis(MediaItem* _item, int _takeIdx, const char* _envKey
 bool PatchTakeEnvelopeActVis(const char* _undoTitle, const char* _envKeyword, const char* _vis, const WDL_FastString* _defaultPoint, bool _reset, bool patchVisibilityOnly) 
 {
 	bool updated = false;
+
+	// item states are read once, and only changed ones are written back (in one go)
+	SWS_CacheObjectState(true);
+	PreventUIRefresh(1);
 	for (int i = 1; i <= GetNumTracks(); i++) // skip master
 	{
 		MediaTrack* tr = CSurf_TrackFromID(i, false);
@@ -1155,6 +1158,8 @@ bool PatchTakeEnvelopeActVis(const char* _undoTitle, const char* _envKeyword, co
 				updated |= PatchTakeEnvelopeActVis(item, *(int*)GetSetMediaItemInfo(item,"I_CURTAKE",NULL), _envKeyword, _vis, _defaultPoint, _reset, patchVisibilityOnly);
 		}
 	}
+	SWS_CacheObjectState(false);
+	PreventUIRefresh(-1);
 
 	if (updated)
 	{
@@ -152,6 +152,25 @@ int g_configId = 0; // the current *displayed/edited* config id
 char g_lcBigFontName[64] = SNM_DYN_FONT_NAME;
 int* g_reaPref_fadeLen = NULL;
 
+// config switch in progress, see LiveConfigSwitchRun()
+enum {
+  LIVECFG_SWITCH_IDLE=0,
+  LIVECFG_SWITCH_FADING
+};
+
+struct LiveConfigSwitch {
+	int m_state;
+	bool m_apply, m_preloaded;
+	int m_cfgId, m_val, m_lastVal; // m_lastVal can be <0
+	int m_fade; // tiny fade length pref. (mutefadems10) while switching
+	ReaProject* m_proj;
+	LiveConfig* m_lc; // config of m_proj, valid as long as m_proj is open
+	double m_startTime, m_fadeEndTime; // time_precise()
+};
+
+static LiveConfigSwitch g_lcSwitch = { LIVECFG_SWITCH_IDLE, false, false, -1, -1, -1, 0, NULL, NULL, 0.0, 0.0 };
+static WDL_PtrList<MediaTrack> g_lcSelTracks; // selected tracks, restored after switches
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Presets helpers
@@ -304,20 +323,6 @@ void UpgradePresetConfV1toV2(MediaTrack* _tr, const char* _confV1, WDL_FastStrin
 	}
 }
 
-// trigger several track fx presets
-bool TriggerFXPresets(MediaTrack* _tr, WDL_FastString* _presetConf)
-{
-	bool updated = false;
-	if (int nbFx = ((_tr && _presetConf && _presetConf->GetLength()) ? TrackFX_GetCount(_tr) : 0))
-	{
-		WDL_FastString presetName;
-		for (int i=0; i < nbFx; i++)
-			if (ParsePresetConf(i, _presetConf->Get(), &presetName))
-				updated |= TrackFX_SetPreset(_tr, i, presetName.Get());
-	}
-	return updated;
-}
-
 
 ///////////////////////////////////////////////////////////////////////////////
 // LiveConfigItem
@@ -433,6 +438,79 @@ void LiveConfigItem::GetInfo(WDL_FastString* _info)
 		_info->Set(__LOCALIZE("<EMPTY>","sws_DLG_169"));
 }
 
+// (re)compiles the stale parts of the plan, returns true if something was updated
+// _checkFiles: false to only check the config (no disk access, i.e. fast enough for switches)
+bool LiveConfigItem::CompilePlan(bool _checkFiles)
+{
+	bool updated = false;
+	LiveConfigPlan* p = &m_plan;
+
+	if (p->m_track != m_track)
+	{
+		p->m_track = m_track;
+		updated = true;
+	}
+
+	// actions (retry unknown ones: scripts, etc. can be registered later)
+	if (strcmp(p->m_onAction.Get(), m_onAction.Get()) || (!p->m_onCmd && m_onAction.GetLength()))
+	{
+		p->m_onAction.Set(&m_onAction);
+		p->m_onCmd = m_onAction.GetLength() ? NamedCommandLookup(m_onAction.Get()) : 0;
+		updated = true;
+	}
+	if (strcmp(p->m_offAction.Get(), m_offAction.Get()) || (!p->m_offCmd && m_offAction.GetLength()))
+	{
+		p->m_offAction.Set(&m_offAction);
+		p->m_offCmd = m_offAction.GetLength() ? NamedCommandLookup(m_offAction.Get()) : 0;
+		updated = true;
+	}
+
+	// fx presets, see ParsePresetConf()
+	if (strcmp(p->m_presetConf.Get(), m_presets.Get()))
+	{
+		p->m_presetConf.Set(&m_presets);
+		p->m_presets.Empty(true);
+		LineParser lp(false);
+		if (m_presets.GetLength() && !lp.parse(m_presets.Get()))
+			for (int i=0; i < lp.getnumtokens()-1; i+=2)
+			{
+				const char* fx = lp.gettoken_str(i);
+				const char* preset = lp.gettoken_str(i+1);
+				if (*preset && !strncmp(fx, "FX", 2) && atoi(fx+2)>0)
+					p->m_presets.Add(new PresetMsg(atoi(fx+2)-1, preset));
+			}
+		updated = true;
+	}
+
+	// track template or fx chain (exclusive, the template wins)
+	if (strcmp(p->m_trTemplate.Get(), m_trTemplate.Get()) || strcmp(p->m_fxChain.Get(), m_fxChain.Get()) || _checkFiles)
+	{
+		char fn[SNM_MAX_PATH] = "";
+		if (m_trTemplate.GetLength())
+			GetFullResourcePath("TrackTemplates", m_trTemplate.Get(), fn, sizeof(fn));
+		else if (m_fxChain.GetLength())
+			GetFullResourcePath("FXChains", m_fxChain.Get(), fn, sizeof(fn));
+
+		time_t t = *fn ? GetFileModTime(fn) : 0;
+		if (strcmp(p->m_trTemplate.Get(), m_trTemplate.Get()) || strcmp(p->m_fxChain.Get(), m_fxChain.Get()) || t != p->m_chunkTime)
+		{
+			p->m_trTemplate.Set(&m_trTemplate);
+			p->m_fxChain.Set(&m_fxChain);
+			p->m_chunkTime = t;
+			p->m_chunk.Set("");
+
+			WDL_FastString chunk;
+			if (*fn && LoadChunk(fn, &chunk) && chunk.GetLength())
+			{
+				if (m_trTemplate.GetLength()) MakeSingleTrackTemplateChunk(&chunk, &p->m_chunk, true, true, false);
+				else p->m_chunk.Set(&chunk);
+			}
+			updated = true;
+		}
+	}
+	return updated;
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // LiveConfig
@@ -446,6 +524,7 @@ LiveConfig::LiveConfig()
 	m_options = 8|32|64;
 	memcpy(&m_inputTr, &GUID_NULL, sizeof(GUID));
 	m_activeMidiVal = m_preloadMidiVal = m_curMidiVal = m_curPreloadMidiVal = -1;
+	m_lastSwitchTime = -1.0;
 	m_osc = NULL;
 	for (int j=0; j<SNM_LIVECFG_NB_ROWS; j++)
 		m_ccConfs.Add(new LiveConfigItem(j, "", NULL, "", "", "", "", ""));
@@ -517,6 +596,25 @@ int LiveConfig::SetInputTrack(MediaTrack* _newInputTr, bool _updateSends)
 	return nbSends;
 }
 
+// compiles config rows into ready-to-run plans, done when editing/preloading
+// configs (and checked again, cheaply, when switching)
+void LiveConfig::CompilePlans(bool _checkFiles)
+{
+	bool updated = false;
+	for (int i=0; i < m_ccConfs.GetSize(); i++)
+		if (LiveConfigItem* cfg = m_ccConfs.Get(i))
+			updated |= cfg->CompilePlan(_checkFiles);
+
+	if (updated)
+	{
+		m_planTracks.Empty();
+		for (int i=0; i < m_ccConfs.GetSize(); i++)
+			if (LiveConfigItem* cfg = m_ccConfs.Get(i))
+				if (cfg->m_track && m_planTracks.Find(cfg->m_track)<0)
+					m_planTracks.Add(cfg->m_track);
+	}
+}
+
 int LiveConfig::CountTrackConfigs(MediaTrack* _tr)
 {
 	int cnt = 0;
@@ -574,35 +672,21 @@ void LiveConfig::cfg_Mute(MediaTrack* _tr)
 	}
 }
 
-void LiveConfig::cfg_WaitForMuteSendCC123(MediaTrack* inputTr)
+// returns the time_precise() at which tiny fades triggered by mutes are done, 0 if none
+// note: must be called while the tiny fade length pref. is set for this config
+double LiveConfig::cfg_GetFadeEndTime()
+{
+	if (m_cfg_last_mute_time>0.0 && g_reaPref_fadeLen && *g_reaPref_fadeLen>0)
+		return m_cfg_last_mute_time + (*g_reaPref_fadeLen)/10000.0; // /pref/10, /1000 (ms->s)
+	return 0.0;
+}
+
+// tiny fades are done at this point, see LiveConfigSwitchRun()
+void LiveConfig::cfg_MuteSendCC123(MediaTrack* inputTr)
 {
 	if (m_cfg_done) return;
 
-	// wait for tiny fades
-	if (m_cfg_last_mute_time>0.0)
-	{
-		double fadelen = 0.0;
-		if (g_reaPref_fadeLen) fadelen = (*g_reaPref_fadeLen)/10000.0; // /pref/10, /1000 (ms->s)
-    
-		int sleeps = 0;
-		if (fadelen>0.0) while ((time_precise() - m_cfg_last_mute_time) < fadelen)
-		{
-			if (sleeps > 1000) break; // timeout safety ~1s
-			Sleep(1);
-#ifdef _WIN32
-			// keep the UI updating
-			MSG msg;
-			while (PeekMessage(&msg, 0, 0, 0, PM_REMOVE)) DispatchMessage(&msg);
-#endif
-			sleeps++;
-		}
-#ifdef _SNM_DEBUG
-		char dbg[256] = "";
-		snprintf(dbg, sizeof(dbg), "cfg_WaitForMuteSendCC123() - Approx wait time: %f ms\n", (time_precise() - m_muteTime)*1000.0);
-		OutputDebugString(dbg);
-#endif
-		m_cfg_last_mute_time = 0.0;
-	}
+	m_cfg_last_mute_time = 0.0;
 
 	// to prevent stuck notes, and since we're in the main thread,
 	// we need to mute sends of the input track too, then we can safely push cc123 events
@@ -623,7 +707,7 @@ void LiveConfig::cfg_RestoreMuteStates(MediaTrack* activeTr, MediaTrack* inputTr
 	{
 		if (MediaTrack* tr = (MediaTrack*)m_cfg_tracks.Get(i))
 		{
-			// mute sends from the input track, except sends to the new active track, see WaitForMuteAndSendCC123()
+			// mute sends from the input track, except sends to the new active track, see cfg_MuteSendCC123()
 			MuteSends(inputTr, tr, tr != activeTr); // no-op if NULL, loopback, already muted, etc
 
 			if (bool* mute = ((tr==activeTr || tr==inputTr) ? &g_bFalse : m_cfg_tracks_states.Get(i)))
@@ -633,6 +717,18 @@ void LiveConfig::cfg_RestoreMuteStates(MediaTrack* activeTr, MediaTrack* inputTr
 	}
 }
 
+// tracks can be deleted while waiting for tiny fades
+// _proj: project of the tracks when it's not the current one
+void LiveConfig::cfg_RemoveDeletedTracks(ReaProject* _proj)
+{
+	for (int i=m_cfg_tracks.GetSize()-1; i>=0; i--)
+		if (_proj ? !ValidatePtr2(_proj, m_cfg_tracks.Get(i), "MediaTrack*") : CSurf_TrackToID((MediaTrack*)m_cfg_tracks.Get(i), false) <= 0)
+		{
+			m_cfg_tracks.Delete(i, false);
+			m_cfg_tracks_states.Delete(i, false);
+		}
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // LiveConfigView
@@ -943,6 +1039,7 @@ void LiveConfigsWnd::Update()
 	if (LiveConfig* lc = g_liveConfigs.Get()->Get(g_configId)) {
 		m_vwndCC.SetValue(lc->m_ccDelay);
 		m_vwndFade.SetValue(lc->m_fade);
+		lc->CompilePlans(true); // config edited, most likely
 	}
 	m_parentVwnd.RequestRedraw(NULL);
 }
@@ -2063,8 +2160,14 @@ static void SaveExtensionConfig(ProjectStateContext *ctx, bool isUndo, struct pr
 	}
 }
 
+static void AbortLiveConfigSwitch();
+
 static void BeginLoadProjectState(bool isUndo, struct project_config_extension_t *reg)
 {
+	// drop any switch in progress: configs/tracks are about to be replaced
+	if (g_lcSwitch.m_state != LIVECFG_SWITCH_IDLE)
+		AbortLiveConfigSwitch();
+
 	g_liveConfigs.Cleanup();
 
 	while (g_liveConfigs.Get()->GetSize() < SNM_LIVECFG_NB_CONFIGS)
@@ -2091,6 +2194,9 @@ void LiveConfigsSetTrackTitle() {
 // ScheduledJob because of multi-notifs
 void LiveConfigsTrackListChange()
 {
+	// end any switch in progress before config tracks get cleared below
+	LiveConfigSwitchRun(true);
+
 	// check consistency of all live configs
 	for (int i=0; i<g_liveConfigs.Get()->GetSize(); i++)
 	{
@@ -2102,6 +2208,7 @@ void LiveConfigsTrackListChange()
 						item->Clear(true);
 
 			lc->SetInputTrack(lc->GetInputTrack(), !!(lc->m_options&32)); // lc->GetInputTrack() can be NULL when deleted, etc..
+			lc->CompilePlans(false); // also done here on project load
 		}
 	}
 
@@ -2153,35 +2260,48 @@ int IsLiveConfigDisplayed(COMMAND_T*) {
 ///////////////////////////////////////////////////////////////////////////////
 // Apply/preload configs
 // THE MEAT! HANDLE WITH CARE!
+//
+// Config switches do not block the main thread while waiting for tiny fades:
+// 1) ApplyPreloadLiveConfigMute() mutes things, which triggers tiny fades
+// 2) LiveConfigSwitchRun() (polled via SNM_CSurfRun) waits for those fades
+//    and then calls ApplyPreloadLiveConfigReconfigure() that reconfigures and
+//    unmutes things
+// One switch at a time: apply/preload jobs are re-scheduled meanwhile.
 ///////////////////////////////////////////////////////////////////////////////
 
-void ApplyPreloadLiveConfig(bool _apply, int _cfgId, int _val, LiveConfigItem* _lastCfg)
+// returns the previous tiny fade length pref.
+static int SetFadeLengthPref(int _fade)
 {
-	LiveConfig* lc = g_liveConfigs.Get()->Get(_cfgId);
-	if (!lc) return;
-
-	LiveConfigItem* cfg = lc->m_ccConfs.Get(_val);
-	if (!cfg) return;
+	int oldfade=50; // i.e. REAPER default, just in case
+	if (g_reaPref_fadeLen)
+	{
+		oldfade=*g_reaPref_fadeLen;
+		*g_reaPref_fadeLen=_fade;
+	}
+	return oldfade;
+}
 
-	static bool s_reent;
-	if (s_reent) return;
-	s_reent=true;
+static bool IsLiveConfigSwitching() {
+	return g_lcSwitch.m_state != LIVECFG_SWITCH_IDLE;
+}
 
+// 1st step of a config switch: mute things
+static void ApplyPreloadLiveConfigMute(bool _apply, LiveConfig* lc, LiveConfigItem* cfg, LiveConfigItem* _lastCfg)
+{
 	// save selected tracks
-	static WDL_PtrList<MediaTrack> selTracks;
+	WDL_PtrList<MediaTrack>& selTracks = g_lcSelTracks;
 	SNM_GetSelectedTracks(NULL, &selTracks, true);
 
 	// run desactivate action of the previous config *when it has no track*
 	// we ensure that no track is selected when performing the action
-	if (_apply && _lastCfg && !_lastCfg->m_track && _lastCfg->m_offAction.GetLength())
-		if (int cmd = NamedCommandLookup(_lastCfg->m_offAction.Get()))
+	if (_apply && _lastCfg && !_lastCfg->m_track)
+		if (int cmd = _lastCfg->m_plan.m_offCmd)
 		{
 			SNM_SetSelectedTrack(NULL, NULL, true, true);
 			Main_OnCommand(cmd, 0);
 			SNM_GetSelectedTracks(NULL, &selTracks, true); // selection may have changed
 		}
 
-	bool preloaded = (_apply && lc->m_preloadMidiVal>=0 && lc->m_preloadMidiVal==_val);
 	if (cfg->m_track)
 	{
 		MediaTrack* inputTr = lc->GetInputTrack();
@@ -2211,17 +2331,16 @@ void ApplyPreloadLiveConfig(bool _apply, int _cfgId, int _val, LiveConfigItem* _
 
 			// mute (and later unmute) tracks to be set offline - optional
 			if (lc->m_options&2) // option "offline all but active"
-				for (int i=0; i<lc->m_ccConfs.GetSize(); i++)
-					if (LiveConfigItem* item = lc->m_ccConfs.Get(i))
-						if (item->m_track && item->m_track != cfg->m_track && (!inputTr || item->m_track != inputTr))
-							lc->cfg_SaveMuteStateAndMuteIfNeeded(item->m_track); 
+				for (int i=0; i<lc->m_planTracks.GetSize(); i++)
+					if (MediaTrack* tr = lc->m_planTracks.Get(i))
+						if (tr != cfg->m_track && (!inputTr || tr != inputTr))
+							lc->cfg_SaveMuteStateAndMuteIfNeeded(tr); 
 
 			// first activation: cleanup *everything* as we do not know the initial state
 			if (!_lastCfg)
 			{
-				for (int i=0; i<lc->m_ccConfs.GetSize(); i++)
-					if (LiveConfigItem* item = lc->m_ccConfs.Get(i))
-						lc->cfg_SaveMuteStateAndMuteIfNeeded(item->m_track, true);
+				for (int i=0; i<lc->m_planTracks.GetSize(); i++)
+					lc->cfg_SaveMuteStateAndMuteIfNeeded(lc->m_planTracks.Get(i), true);
 			}
 			else
 			{
@@ -2229,9 +2348,8 @@ void ApplyPreloadLiveConfig(bool _apply, int _cfgId, int _val, LiveConfigItem* _
 				{
 					if (inputTr && _lastCfg->m_track == inputTr) // conner case fix
 					{
-						for (int i=0; i<lc->m_ccConfs.GetSize(); i++)
-							if (LiveConfigItem* item = lc->m_ccConfs.Get(i))
-								lc->cfg_SaveMuteStateAndMuteIfNeeded(item->m_track, true);
+						for (int i=0; i<lc->m_planTracks.GetSize(); i++)
+							lc->cfg_SaveMuteStateAndMuteIfNeeded(lc->m_planTracks.Get(i), true);
 					}
 					else
 					{
@@ -2242,11 +2360,21 @@ void ApplyPreloadLiveConfig(bool _apply, int _cfgId, int _val, LiveConfigItem* _
 
 			// end with mute states that will not be restored (option "mute all but active")
 			if ((lc->m_options&1) && (!inputTr || cfg->m_track != inputTr))
-				for (int i=0; i<lc->m_ccConfs.GetSize(); i++)
-					if (LiveConfigItem* item = lc->m_ccConfs.Get(i))
-						if (item->m_track && item->m_track != cfg->m_track && (!inputTr || item->m_track != inputTr))
-							lc->cfg_Mute(item->m_track);
+				for (int i=0; i<lc->m_planTracks.GetSize(); i++)
+					if (MediaTrack* tr = lc->m_planTracks.Get(i))
+						if (tr != cfg->m_track && (!inputTr || tr != inputTr))
+							lc->cfg_Mute(tr);
 		}
+	}
+}
+
+// 2nd step of a config switch, once tiny fades are done: reconfigure and unmute things
+static void ApplyPreloadLiveConfigReconfigure(bool _apply, LiveConfig* lc, LiveConfigItem* cfg, LiveConfigItem* _lastCfg, bool preloaded)
+{
+	WDL_PtrList<MediaTrack>& selTracks = g_lcSelTracks;
+	if (cfg->m_track)
+	{
+		MediaTrack* inputTr = lc->GetInputTrack();
 
 		// --------------------------------------------------------------------
 		// 2) reconfiguration
@@ -2254,10 +2382,10 @@ void ApplyPreloadLiveConfig(bool _apply, int _cfgId, int _val, LiveConfigItem* _
 
 		// run desactivate action of the deactivated config if it has a track
 		// when performing the action, we ensure that the only selected track is the deactivated track
-		if (_apply && _lastCfg && _lastCfg->m_track && _lastCfg->m_offAction.GetLength())
-			if (int cmd = NamedCommandLookup(_lastCfg->m_offAction.Get()))
+		if (_apply && _lastCfg && _lastCfg->m_track)
+			if (int cmd = _lastCfg->m_plan.m_offCmd)
 			{
-				lc->cfg_WaitForMuteSendCC123(inputTr);
+				lc->cfg_MuteSendCC123(inputTr);
 
 				SNM_SetSelectedTrack(NULL, _lastCfg->m_track, true, true);
 				Main_OnCommand(cmd, 0);
@@ -2266,51 +2394,37 @@ void ApplyPreloadLiveConfig(bool _apply, int _cfgId, int _val, LiveConfigItem* _
 
 
 		// reconfiguration via state updates
-		if (!preloaded)
+		// note: template/fx chain chunks are loaded when compiling plans
+		if (!preloaded && cfg->m_plan.m_chunk.GetLength())
 		{
-			static WDL_FastString chunk; // static for alloc savings (big states, potentially)
-
 			// apply tr template (preserves routings, folder states, etc..)
 			// if the altered track has sends, it'll be glitch free too as me mute this source track
 			if (cfg->m_trTemplate.GetLength()) 
 			{
-				char fn[SNM_MAX_PATH] = "";
-				GetFullResourcePath("TrackTemplates", cfg->m_trTemplate.Get(), fn, sizeof(fn));
-
-				static WDL_FastString tmplt; 
-				if (LoadChunk(fn, &tmplt) && tmplt.GetLength())
+				SNM_SendPatcher p(cfg->m_track); // auto-commit on destroy
+				
+				if (ApplyTrackTemplate(cfg->m_track, &cfg->m_plan.m_chunk, false, false, &p))
 				{
-					SNM_SendPatcher p(cfg->m_track); // auto-commit on destroy
-					
-					MakeSingleTrackTemplateChunk(&tmplt, &chunk, true, true, false);
-					if (ApplyTrackTemplate(cfg->m_track, &chunk, false, false, &p))
-					{
-						// make sure the track will be restored with its current name 
-						WDL_FastString trNameEsc;
-						if (char* name = (char*)GetSetMediaTrackInfo(cfg->m_track, "P_NAME", NULL))
-							makeEscapedConfigString(name, &trNameEsc);
-						p.ParsePatch(SNM_SET_CHUNK_CHAR,1,"TRACK","NAME",0,1,(void*)trNameEsc.Get());
-
-						// make sure the track will be restored with proper mute state
-						char onoff[2];
-						strcpy(onoff, *(bool*)GetSetMediaTrackInfo(cfg->m_track, "B_MUTE", NULL) ? "1" : "0");
-						p.ParsePatch(SNM_SET_CHUNK_CHAR,1,"TRACK","MUTESOLO",0,1,onoff);
-
-						lc->cfg_WaitForMuteSendCC123(inputTr);
-					}
-				} // auto-commit
-			}
+					// make sure the track will be restored with its current name 
+					WDL_FastString trNameEsc;
+					if (char* name = (char*)GetSetMediaTrackInfo(cfg->m_track, "P_NAME", NULL))
+						makeEscapedConfigString(name, &trNameEsc);
+					p.ParsePatch(SNM_SET_CHUNK_CHAR,1,"TRACK","NAME",0,1,(void*)trNameEsc.Get());
+
+					// make sure the track will be restored with proper mute state
+					char onoff[2];
+					strcpy(onoff, *(bool*)GetSetMediaTrackInfo(cfg->m_track, "B_MUTE", NULL) ? "1" : "0");
+					p.ParsePatch(SNM_SET_CHUNK_CHAR,1,"TRACK","MUTESOLO",0,1,onoff);
+
+					lc->cfg_MuteSendCC123(inputTr);
+				}
+			} // auto-commit
 			// fx chain reconfiguration via state chunk update
 			else if (cfg->m_fxChain.GetLength())
 			{
-				char fn[SNM_MAX_PATH]="";
-				GetFullResourcePath("FXChains", cfg->m_fxChain.Get(), fn, sizeof(fn));
-				if (LoadChunk(fn, &chunk) && chunk.GetLength())
-				{
-					SNM_FXChainTrackPatcher p(cfg->m_track); // auto-commit on destroy
-					if (p.SetFXChain(&chunk))
-						lc->cfg_WaitForMuteSendCC123(inputTr);
-				}
+				SNM_FXChainTrackPatcher p(cfg->m_track); // auto-commit on destroy
+				if (p.SetFXChain(&cfg->m_plan.m_chunk))
+					lc->cfg_MuteSendCC123(inputTr);
 			} // auto-commit
 
 		} // if (!preloaded)
@@ -2330,7 +2444,7 @@ void ApplyPreloadLiveConfig(bool _apply, int _cfgId, int _val, LiveConfigItem* _
 				char zero[2] = "0";
 				if (!p.Parse(SNM_GETALL_CHUNK_CHAR_EXCEPT, 2, "FXCHAIN", "BYPASS", 0xFFFF, 2, zero))
 				{
-					lc->cfg_WaitForMuteSendCC123(inputTr);
+					lc->cfg_MuteSendCC123(inputTr);
 					SNM_SetSelectedTrack(NULL, cfg->m_track, true, true);
 					Main_OnCommand(40536, 0); // online
 				}
@@ -2348,17 +2462,16 @@ void ApplyPreloadLiveConfig(bool _apply, int _cfgId, int _val, LiveConfigItem* _
 
 			// select tracks to be set offline (already muted above)
 			SNM_SetSelectedTrack(NULL, NULL, true, true);
-			for (int i=0; i<lc->m_ccConfs.GetSize(); i++)
-				if (LiveConfigItem* item = lc->m_ccConfs.Get(i))
-					if (item->m_track && 
-						item->m_track != cfg->m_track && // excl. the activated track
-						(!inputTr || item->m_track != inputTr) && // excl. the input track
-						(!preloadTr || preloadTr != item->m_track)) // excl. the preloaded track
+			for (int i=0; i<lc->m_planTracks.GetSize(); i++)
+				if (MediaTrack* tr = lc->m_planTracks.Get(i))
+					if (tr != cfg->m_track && // excl. the activated track
+						(!inputTr || tr != inputTr) && // excl. the input track
+						(!preloadTr || preloadTr != tr)) // excl. the preloaded track
 					{
-						GetSetMediaTrackInfo(item->m_track, "I_SELECTED", &g_i1);
+						GetSetMediaTrackInfo(tr, "I_SELECTED", &g_i1);
 					}
 		
-			lc->cfg_WaitForMuteSendCC123(inputTr);
+			lc->cfg_MuteSendCC123(inputTr);
 
 			// set all fx offline for sel tracks, no-op if already offline
 			// macro-ish but better than using a SNM_ChunkParserPatcher for each track..
@@ -2369,30 +2482,33 @@ void ApplyPreloadLiveConfig(bool _apply, int _cfgId, int _val, LiveConfigItem* _
 
 		// track reconfiguration: fx presets
 		// note: exclusive vs template/fx chain but done here because fx may have been set online just above
-		if (!preloaded && cfg->m_presets.GetLength())
+		if (!preloaded && cfg->m_plan.m_presets.GetSize())
 		{
-			lc->cfg_WaitForMuteSendCC123(inputTr);
-			TriggerFXPresets(cfg->m_track, &(cfg->m_presets));
+			lc->cfg_MuteSendCC123(inputTr);
+			int nbFx = TrackFX_GetCount(cfg->m_track);
+			for (int i=0; i<cfg->m_plan.m_presets.GetSize(); i++)
+				if (PresetMsg* preset = cfg->m_plan.m_presets.Get(i))
+					if (preset->m_fx < nbFx)
+						TrackFX_SetPreset(cfg->m_track, preset->m_fx, preset->m_preset.Get());
 		}
 
 		// disarm all but active track
 		if (_apply && (lc->m_options&4) && !inputTr)
-			for (int i=0; i<lc->m_ccConfs.GetSize(); i++)
-				if (LiveConfigItem* item = lc->m_ccConfs.Get(i))
-					if (item->m_track)
-					{
-						int* p = item->m_track==cfg->m_track ? &g_i1 : &g_i0;
-						if (*(int*)GetSetMediaTrackInfo(item->m_track, "I_RECMON", NULL) != *p)
-							GetSetMediaTrackInfo(item->m_track, "I_RECMON", p);
-						if (*(int*)GetSetMediaTrackInfo(item->m_track, "I_RECARM", NULL) != *p)
-							GetSetMediaTrackInfo(item->m_track, "I_RECARM", p);
-					}
+			for (int i=0; i<lc->m_planTracks.GetSize(); i++)
+				if (MediaTrack* tr = lc->m_planTracks.Get(i))
+				{
+					int* p = tr==cfg->m_track ? &g_i1 : &g_i0;
+					if (*(int*)GetSetMediaTrackInfo(tr, "I_RECMON", NULL) != *p)
+						GetSetMediaTrackInfo(tr, "I_RECMON", p);
+					if (*(int*)GetSetMediaTrackInfo(tr, "I_RECARM", NULL) != *p)
+						GetSetMediaTrackInfo(tr, "I_RECARM", p);
+				}
 
 		// perform activate action
-		if (_apply && cfg->m_onAction.GetLength())
-			if (int cmd = NamedCommandLookup(cfg->m_onAction.Get()))
+		if (_apply)
+			if (int cmd = cfg->m_plan.m_onCmd)
 			{
-				lc->cfg_WaitForMuteSendCC123(inputTr);
+				lc->cfg_MuteSendCC123(inputTr);
 				SNM_SetSelectedTrack(NULL, cfg->m_track, true, true);
 				Main_OnCommand(cmd, 0);
 				SNM_GetSelectedTracks(NULL, &selTracks, true); // selection may have changed
@@ -2403,7 +2519,7 @@ void ApplyPreloadLiveConfig(bool _apply, int _cfgId, int _val, LiveConfigItem* _
 		// 3) unmute things
 		// --------------------------------------------------------------------
 
-		lc->cfg_WaitForMuteSendCC123(inputTr);
+		lc->cfg_MuteSendCC123(inputTr);
 
 		if (!_apply)
 		{
@@ -2426,9 +2542,9 @@ void ApplyPreloadLiveConfig(bool _apply, int _cfgId, int _val, LiveConfigItem* _
 	else
 	{
 		// perform activate action
-		if (_apply && cfg->m_onAction.GetLength())
+		if (_apply)
 		{
-			if (int cmd = NamedCommandLookup(cfg->m_onAction.Get()))
+			if (int cmd = cfg->m_plan.m_onCmd)
 			{
 				SNM_SetSelectedTrack(NULL, NULL, true, true);
 				Main_OnCommand(cmd, 0);
@@ -2439,8 +2555,126 @@ void ApplyPreloadLiveConfig(bool _apply, int _cfgId, int _val, LiveConfigItem* _
 
 	// restore selected tracks
 	SNM_SetSelectedTracks(NULL, &selTracks, true, true);
+}
+
+static void ApplyLiveConfigDone(int _cfgId, int _val, bool _switched);
+static void PreloadLiveConfigDone(int _cfgId, int _val, bool _switched);
+
+// ends the switch in progress without reconfiguring things, when it can't be finished
+// (project switched or reloaded meanwhile): restores the mute states saved in its project,
+// and closes the undo block opened by StartLiveConfigSwitch() - i.e. the job is ignored
+static void AbortLiveConfigSwitch()
+{
+	LiveConfigSwitch sw = g_lcSwitch;
+	g_lcSwitch.m_state = LIVECFG_SWITCH_IDLE;
+
+	ReaProject* proj = NULL;
+	for (int i=0; (proj = EnumProjects(i, NULL, 0)) && proj != sw.m_proj; i++);
+	if (!proj || !sw.m_lc)
+		return; // project closed, its configs are gone
+
+	sw.m_lc->cfg_RemoveDeletedTracks(proj);
+	sw.m_lc->cfg_RestoreMuteStates(NULL, NULL); // NULL to restore the previous mute states
+	if (sw.m_apply) sw.m_lc->m_curMidiVal = sw.m_lc->m_activeMidiVal;
+	else sw.m_lc->m_curPreloadMidiVal = sw.m_lc->m_preloadMidiVal;
+
+	char buf[SNM_MAX_ACTION_NAME_LEN]="";
+	if (sw.m_apply) snprintf(buf, sizeof(buf), __LOCALIZE_VERFMT("Apply Live Config %d, value %d","sws_undo"), sw.m_cfgId+1, sw.m_val);
+	else snprintf(buf, sizeof(buf), __LOCALIZE_VERFMT("Preload Live Config %d, value: %d","sws_undo"), sw.m_cfgId+1, sw.m_val);
+	Undo_EndBlock2(proj, buf, UNDO_STATE_ALL);
+}
+
+// reconfigure & unmute things (i.e. end the switch), also closes the undo block
+static void FinishLiveConfigSwitch()
+{
+	// project switched meanwhile? configs are per project, just undo the mute step
+	LiveConfig* lc = g_lcSwitch.m_proj == EnumProjects(-1, NULL, 0) ? g_liveConfigs.Get()->Get(g_lcSwitch.m_cfgId) : NULL;
+	LiveConfigItem* cfg = lc ? lc->m_ccConfs.Get(g_lcSwitch.m_val) : NULL;
+	if (!cfg)
+	{
+		AbortLiveConfigSwitch();
+		return;
+	}
+
+	LiveConfigSwitch sw = g_lcSwitch;
+	g_lcSwitch.m_state = LIVECFG_SWITCH_IDLE;
+
+	lc->cfg_RemoveDeletedTracks();
+	for (int i=g_lcSelTracks.GetSize()-1; i>=0; i--)
+		if (CSurf_TrackToID(g_lcSelTracks.Get(i), false) <= 0)
+			g_lcSelTracks.Delete(i, false);
+
+	// config tracks deleted meanwhile? just restore mute states
+	LiveConfigItem* lastCfg = lc->m_ccConfs.Get(sw.m_lastVal); // can be <0
+	if ((cfg->m_track && CSurf_TrackToID(cfg->m_track, false) <= 0) ||
+		(lastCfg && lastCfg->m_track && CSurf_TrackToID(lastCfg->m_track, false) <= 0))
+	{
+		lc->cfg_RestoreMuteStates(NULL, lc->GetInputTrack());
+		SNM_SetSelectedTracks(NULL, &g_lcSelTracks, true, true);
+	}
+	else
+	{
+		int oldfade = SetFadeLengthPref(sw.m_fade); // for unmute fades
+		PreventUIRefresh(1);
+		ApplyPreloadLiveConfigReconfigure(sw.m_apply, lc, cfg, lastCfg, sw.m_preloaded);
+		PreventUIRefresh(-1);
+		SetFadeLengthPref(oldfade);
+	}
 
-	s_reent=false;
+	lc->m_lastSwitchTime = (time_precise() - sw.m_startTime) * 1000.0;
+#ifdef _SNM_DEBUG
+	char dbg[256] = "";
+	snprintf(dbg, sizeof(dbg), "FinishLiveConfigSwitch() - Switch time: %f ms\n", lc->m_lastSwitchTime);
+	OutputDebugString(dbg);
+#endif
+
+	if (sw.m_apply) ApplyLiveConfigDone(sw.m_cfgId, sw.m_val, true);
+	else PreloadLiveConfigDone(sw.m_cfgId, sw.m_val, true);
+}
+
+// mutes things and waits for tiny fades, if any (the switch is ended right away otherwise)
+// also opens the undo block, closed when the switch ends
+// _startTime: time_precise() when the switch was requested (switch time monitoring)
+static void StartLiveConfigSwitch(bool _apply, int _cfgId, int _val, int _lastVal, double _startTime)
+{
+	LiveConfig* lc = g_liveConfigs.Get()->Get(_cfgId);
+	LiveConfigItem* cfg = lc ? lc->m_ccConfs.Get(_val) : NULL;
+	if (!cfg) return;
+
+	g_lcSwitch.m_state = LIVECFG_SWITCH_FADING;
+	g_lcSwitch.m_apply = _apply;
+	g_lcSwitch.m_preloaded = (_apply && lc->m_preloadMidiVal>=0 && lc->m_preloadMidiVal==_val);
+	g_lcSwitch.m_cfgId = _cfgId;
+	g_lcSwitch.m_val = _val;
+	g_lcSwitch.m_lastVal = _lastVal;
+	g_lcSwitch.m_fade = lc->m_fade*10;
+	g_lcSwitch.m_proj = EnumProjects(-1, NULL, 0);
+	g_lcSwitch.m_lc = lc;
+	g_lcSwitch.m_startTime = _startTime;
+
+	Undo_BeginBlock2(NULL);
+
+	// no-op unless the config was edited in some way we were not notified of
+	lc->CompilePlans(false);
+
+	int oldfade = SetFadeLengthPref(g_lcSwitch.m_fade);
+	PreventUIRefresh(1);
+	ApplyPreloadLiveConfigMute(_apply, lc, cfg, lc->m_ccConfs.Get(_lastVal));
+	PreventUIRefresh(-1);
+	g_lcSwitch.m_fadeEndTime = cfg->m_track ? lc->cfg_GetFadeEndTime() : 0.0;
+	SetFadeLengthPref(oldfade);
+
+	if (g_lcSwitch.m_fadeEndTime <= time_precise())
+		FinishLiveConfigSwitch();
+}
+
+// polled via SNM_CSurfRun(), so the latency of a switch is the tiny fade
+// length + at most 1 timer period (vs a Sleep() loop in the main thread)
+// _force: end the current switch now, even if tiny fades are not done yet
+void LiveConfigSwitchRun(bool _force)
+{
+	if (g_lcSwitch.m_state == LIVECFG_SWITCH_FADING && (_force || time_precise() >= g_lcSwitch.m_fadeEndTime))
+		FinishLiveConfigSwitch();
 }
 
 
@@ -2481,11 +2715,14 @@ void ApplyLiveConfigJob::Perform()
 	LiveConfig* lc = g_liveConfigs.Get()->Get(m_cfgId);
 	if (!lc) return;
 
-	Undo_BeginBlock2(NULL);
-
-	// swap preload/current configs?
 	int absval = GetIntValue();
-	bool preloaded = (lc->m_preloadMidiVal>=0 && lc->m_preloadMidiVal==absval);
+
+	// another switch in progress? retry asap (absolute value: relative moves already applied)
+	if (IsLiveConfigSwitching())
+	{
+		ScheduledJob::Schedule(new ApplyLiveConfigJob(m_cfgId, 1, absval, -1, 0));
+		return;
+	}
 
 	LiveConfigItem* cfg = lc->m_ccConfs.Get(absval);
 	if (cfg && lc->m_enable && absval!=lc->m_activeMidiVal && (!(lc->m_options&16) || !cfg->IsDefault(true))) // ignore empty configs
@@ -2493,47 +2730,55 @@ void ApplyLiveConfigJob::Perform()
 		LiveConfigItem* lastCfg = lc->m_ccConfs.Get(lc->m_activeMidiVal); // can be <0
 		if (!lastCfg || !lastCfg->Equals(cfg, true))
 		{
-			int oldfade=50; // i.e. REAPER default, just in case
-			if (g_reaPref_fadeLen)
-			{
-				oldfade=*g_reaPref_fadeLen;
-				*g_reaPref_fadeLen=lc->m_fade*10;
-			}
+			StartLiveConfigSwitch(true, m_cfgId, absval, lc->m_activeMidiVal, time_precise());
+			return; // => ApplyLiveConfigDone() once the switch is done
+		}
+		Undo_BeginBlock2(NULL);
+		ApplyLiveConfigDone(m_cfgId, absval, true);
+	}
+	else
+	{
+		Undo_BeginBlock2(NULL);
+		ApplyLiveConfigDone(m_cfgId, absval, false);
+	}
+}
 
-			PreventUIRefresh(1);
-			ApplyPreloadLiveConfig(true, m_cfgId, absval, lastCfg);
-			PreventUIRefresh(-1);
+// end of an "apply" job, closes the undo block
+// _switched: false if the job was ignored
+static void ApplyLiveConfigDone(int _cfgId, int _val, bool _switched)
+{
+	LiveConfig* lc = g_liveConfigs.Get()->Get(_cfgId);
+	if (!lc) return;
 
-			if (g_reaPref_fadeLen)
-			{
-				*g_reaPref_fadeLen=oldfade;
-			}
-		} 
+	// swap preload/current configs?
+	bool preloaded = (lc->m_preloadMidiVal>=0 && lc->m_preloadMidiVal==_val);
 
-		// done
+	// done
+	if (_switched)
+	{
 		if (preloaded) {
 			lc->m_preloadMidiVal = lc->m_curPreloadMidiVal = lc->m_activeMidiVal;
-			lc->m_activeMidiVal = lc->m_curMidiVal = absval;
+			lc->m_activeMidiVal = lc->m_curMidiVal = _val;
 		}
 		else
-			lc->m_activeMidiVal = absval;
+			lc->m_activeMidiVal = _val;
 	}
 
 	{
 		char buf[SNM_MAX_ACTION_NAME_LEN]="";
-		snprintf(buf, sizeof(buf), __LOCALIZE_VERFMT("Apply Live Config %d, value %d","sws_undo"), m_cfgId+1, absval);
+		snprintf(buf, sizeof(buf), __LOCALIZE_VERFMT("Apply Live Config %d, value %d","sws_undo"), _cfgId+1, _val);
 		Undo_EndBlock2(NULL, buf, UNDO_STATE_ALL);
 	}
 
 	// update GUIs in any case, e.g. tweaking (gray cc value) to same value (=> black)
 	if (LiveConfigsWnd* w = g_lcWndMgr.Get()) {
 		w->Update();
-//		w->SelectByCCValue(m_cfgId, lc->m_activeMidiVal);
+//		w->SelectByCCValue(_cfgId, lc->m_activeMidiVal);
 	}
 
 	// swap preload/current configs => update both preload & current panels
 	UpdateMonitoring(
-		m_cfgId,
+		_cfgId,
 		APPLY_MASK | (preloaded ? PRELOAD_MASK : 0), 
 		APPLY_MASK | (preloaded ? PRELOAD_MASK : 0));
 }
@@ -2579,9 +2824,18 @@ void PreloadLiveConfigJob::Perform()
 	LiveConfig* lc = g_liveConfigs.Get()->Get(m_cfgId);
 	if (!lc) return;
 
-	Undo_BeginBlock2(NULL);
-
 	int absval = GetIntValue();
+
+	// another switch in progress? retry asap (absolute value: relative moves already applied)
+	if (IsLiveConfigSwitching())
+	{
+		ScheduledJob::Schedule(new PreloadLiveConfigJob(m_cfgId, 1, absval, -1, 0));
+		return;
+	}
+
+	// get ready for the next switch (e.g. pick up template/fx chain files updated on disk)
+	lc->CompilePlans(true);
+
 	MediaTrack* inputTr = lc->GetInputTrack();
 	LiveConfigItem* cfg = lc->m_ccConfs.Get(absval);
 	LiveConfigItem* lastCfg = lc->m_ccConfs.Get(lc->m_activeMidiVal); // can be <0
@@ -2598,39 +2852,42 @@ void PreloadLiveConfigJob::Perform()
 			(!lastCfg || !lastCfg->Equals(cfg, true)) &&
 			(!lastPreloadCfg || !lastPreloadCfg->Equals(cfg, true)))
 		{
-			int oldfade=50; // i.e. REAPER default, just in case
-			if (g_reaPref_fadeLen)
-			{
-				oldfade=*g_reaPref_fadeLen;
-				*g_reaPref_fadeLen=lc->m_fade*10;
-			}
-      
-			PreventUIRefresh(1);
-			ApplyPreloadLiveConfig(false, m_cfgId, absval, lastCfg);
-			PreventUIRefresh(-1);
-      
-			if (g_reaPref_fadeLen)
-			{
-				*g_reaPref_fadeLen=oldfade;
-			}
+			StartLiveConfigSwitch(false, m_cfgId, absval, lc->m_activeMidiVal, time_precise());
+			return; // => PreloadLiveConfigDone() once the switch is done
 		}
-
-		// done
-		lc->m_preloadMidiVal = absval;
+		Undo_BeginBlock2(NULL);
+		PreloadLiveConfigDone(m_cfgId, absval, true);
 	}
+	else
+	{
+		Undo_BeginBlock2(NULL);
+		PreloadLiveConfigDone(m_cfgId, absval, false);
+	}
+}
+
+// end of a "preload" job, closes the undo block
+// _switched: false if the job was ignored
+static void PreloadLiveConfigDone(int _cfgId, int _val, bool _switched)
+{
+	LiveConfig* lc = g_liveConfigs.Get()->Get(_cfgId);
+	if (!lc) return;
+
+	// done
+	if (_switched)
+		lc->m_preloadMidiVal = _val;
 
 	{
 		char buf[SNM_MAX_ACTION_NAME_LEN]="";
-		snprintf(buf, sizeof(buf), __LOCALIZE_VERFMT("Preload Live Config %d, value: %d","sws_undo"), m_cfgId+1, absval);
+		snprintf(buf, sizeof(buf), __LOCALIZE_VERFMT("Preload Live Config %d, value: %d","sws_undo"), _cfgId+1, _val);
 		Undo_EndBlock2(NULL, buf, UNDO_STATE_ALL);
 	}
 
 	// update GUIs/OSC in any case
 	if (LiveConfigsWnd* w = g_lcWndMgr.Get()) {
 		w->Update();
-//		w->SelectByCCValue(m_cfgId, lc->m_preloadMidiVal);
+//		w->SelectByCCValue(_cfgId, lc->m_preloadMidiVal);
 	}
-	UpdateMonitoring(m_cfgId, PRELOAD_MASK, PRELOAD_MASK);
+	UpdateMonitoring(_cfgId, PRELOAD_MASK, PRELOAD_MASK);
 }
 
 double PreloadLiveConfigJob::GetCurrentValue() {
@@ -2715,6 +2972,9 @@ void UpdateMonitoring(int _cfgId, int _whatFlags, int _commitFlags, int _flags)
 	if (!lc || (!lc->m_osc && !monWnd))
 		return;
 
+	if (_flags&1 && monWnd && (_commitFlags&(APPLY_MASK|PRELOAD_MASK)))
+		monWnd->UpdateTitles();
+
 	if (lc->m_enable)
 	{
 		if (_whatFlags & APPLY_MASK)
@@ -2794,18 +3054,17 @@ void LiveConfigMonitorWnd::OnInitDlg()
 	m_mons.SetRows(1);
 	m_parentVwnd.AddChild(&m_mons);
 
-	{
-		char buf[64]="";
-		snprintf(buf, sizeof(buf), __LOCALIZE_VERFMT("Live Config #%d","sws_DLG_169"), m_cfgId+1);
-		m_mons.SetTitles(__LOCALIZE("CURRENT","sws_DLG_169"), buf, __LOCALIZE("PRELOAD","sws_DLG_169"), " "); // " " trick to get a lane
-		m_mons.SetFontName(g_lcBigFontName);
+	UpdateTitles();
+	m_mons.SetFontName(g_lcBigFontName);
 
 #ifdef _SNM_MISC
+	{
 		// big fonts with alpha doesn't work well ATM (on OS X at least), such overlapped texts look a bit clunky anyway...
+		char buf[64]="";
 		snprintf(buf, sizeof(buf), "#%d", m_cfgId+1);
 		m_mons.SetText(0, buf, 0, 16);
-#endif
 	}
+#endif
 	
 	UpdateMonitoring(
 		m_cfgId,
@@ -2814,6 +3073,18 @@ void LiveConfigMonitorWnd::OnInitDlg()
 		1); // ui only
 }
 
+// titles + duration of the last config switch (tiny fades included)
+void LiveConfigMonitorWnd::UpdateTitles()
+{
+	char buf[128]="";
+	LiveConfig* lc = g_liveConfigs.Get()->Get(m_cfgId);
+	if (lc && lc->m_lastSwitchTime>=0.0)
+		snprintf(buf, sizeof(buf), __LOCALIZE_VERFMT("Live Config #%d - Last switch: %.1f ms","sws_DLG_169"), m_cfgId+1, lc->m_lastSwitchTime);
+	else
+		snprintf(buf, sizeof(buf), __LOCALIZE_VERFMT("Live Config #%d","sws_DLG_169"), m_cfgId+1);
+	m_mons.SetTitles(__LOCALIZE("CURRENT","sws_DLG_169"), buf, __LOCALIZE("PRELOAD","sws_DLG_169"), " "); // " " trick to get a lane
+}
+
 void LiveConfigMonitorWnd::OnDestroy() {
 	m_mons.RemoveAllChildren(false);
 	m_mons.SetRealParent(NULL);
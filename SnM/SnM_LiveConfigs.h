@@ -42,6 +42,21 @@ public:
 };
 
 
+// ready-to-run data of a config row (resolved actions, loaded chunks, parsed presets)
+// so that switches do not look up, load or parse anything, see LiveConfigItem::CompilePlan()
+class LiveConfigPlan {
+public:
+	LiveConfigPlan() : m_onCmd(0), m_offCmd(0), m_track(NULL), m_chunkTime(0) {}
+	int m_onCmd, m_offCmd; // 0 if none or not found
+	WDL_FastString m_chunk; // track template (single track, no items/envs) or fx chain
+	WDL_PtrList_DeleteOnDestroy<PresetMsg> m_presets; // PresetMsg::m_fx: 0-based
+	// compiled from:
+	MediaTrack* m_track;
+	WDL_FastString m_trTemplate, m_fxChain, m_presetConf, m_onAction, m_offAction;
+	time_t m_chunkTime; // template or fx chain file time
+};
+
+
 class LiveConfigItem {
 public:
 	LiveConfigItem(int _cc, const char* _desc="", MediaTrack* _track=NULL, 
@@ -53,9 +68,11 @@ public:
 	void Clear(bool _trDataOnly = false);
 	bool Equals(LiveConfigItem* _item, bool _ignoreComment);
 	void GetInfo(WDL_FastString* _info);
+	bool CompilePlan(bool _checkFiles);
 	int m_cc;
 	MediaTrack* m_track; //JFB!! TODO: GUID instead (to handle track deletion + undo, etc)
 	WDL_FastString m_desc, m_trTemplate, m_fxChain, m_presets, m_onAction, m_offAction;
+	LiveConfigPlan m_plan; // not copied/pasted, recompiled as needed
 };
 
 
@@ -66,6 +83,7 @@ public:
 
 	bool IsDefault(bool _ignoreComment);
 	int CountTrackConfigs(MediaTrack* _tr);
+	void CompilePlans(bool _checkFiles);
 
 	// GUID_NULL means "no track" here not "the master track", see GuidToTrack()
 	MediaTrack* GetInputTrack() { return !GuidsEqual(&m_inputTr, &GUID_NULL) ? GuidToTrack(&m_inputTr) : NULL; }
@@ -82,8 +100,10 @@ public:
 	}  
 	void cfg_SaveMuteStateAndMuteIfNeeded(MediaTrack* _tr, bool _force = false);
 	void cfg_Mute(MediaTrack* _tr);
-	void cfg_WaitForMuteSendCC123(MediaTrack* inputTr);
+	double cfg_GetFadeEndTime();
+	void cfg_MuteSendCC123(MediaTrack* inputTr);
 	void cfg_RestoreMuteStates(MediaTrack* activeTr, MediaTrack* inputTr);
+	void cfg_RemoveDeletedTracks(ReaProject* _proj = NULL);
 
 	WDL_PtrList<LiveConfigItem> m_ccConfs;
 	int m_options; // &1=mute all but active track
@@ -95,6 +115,8 @@ public:
 	               // &64=scroll to track on list view click
 	int m_ccDelay, m_fade, m_enable;
 	int m_activeMidiVal, m_curMidiVal, m_preloadMidiVal, m_curPreloadMidiVal;
+	double m_lastSwitchTime; // in ms, from the job to the end of reconfiguration (<0 if none yet)
+	WDL_PtrList<MediaTrack> m_planTracks; // distinct config tracks, see CompilePlans()
 	SNM_OscCSurf* m_osc;
 
 private:
@@ -163,6 +185,7 @@ public:
 	virtual ~LiveConfigMonitorWnd();
 
 	SNM_FiveMonitors* GetMonitors() { return &m_mons; }
+	void UpdateTitles();
 protected:
 	void OnInitDlg();
 	void OnDestroy();
@@ -226,6 +249,7 @@ int IsLiveConfigDisplayed(COMMAND_T*);
 
 void ApplyLiveConfig(int _cfgId, int _val, bool _immediate, int _valhw = -1, int _relmode = 0);
 void PreloadLiveConfig(int _cfgId, int _val, bool _immediate, int _valhw = -1, int _relmode = 0);
+void LiveConfigSwitchRun(bool _force = false);
 
 void OpenLiveConfigMonitorWnd(int _idx);
 void OpenLiveConfigMonitorWnd(COMMAND_T*);
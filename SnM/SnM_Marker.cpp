@@ -37,7 +37,6 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 DWORD g_mkrRgnNotifyTime = 0; // really approx (updated on timer)
-WDL_PtrList<MarkerRegion> g_mkrRgnCache;
 WDL_PtrList<SNM_MarkerRegionListener> g_mkrRgnListeners;
 
 void RegisterToMarkerRegionUpdates(SNM_MarkerRegionListener* _listener)
@@ -53,41 +52,338 @@ void UnregisterToMarkerRegionUpdates(SNM_MarkerRegionListener* _listener)
 		g_mkrRgnListeners.Delete(idx, false);
 }
 
+
+///////////////////////////////////////////////////////////////////////////////
+// Marker/region cache: plain entries in project order, names interned in a pool
+///////////////////////////////////////////////////////////////////////////////
+
+struct SNM_MarkerRegionEntry {
+	int id; // see MakeMarkerRegionId()
+	bool isRgn;
+	double pos, end;
+	int num, color;
+	int name; // offset in SNM_MarkerRegionNames
+};
+
+class SNM_MarkerRegionNames
+{
+public:
+	SNM_MarkerRegionNames() : m_hashes(NULL), m_count(0) {}
+	const char* Get(int _ofs) { return m_pool.Get() + _ofs; }
+	int Add(const char* _name)
+	{
+		if (!_name) _name = "";
+		unsigned int h = Hash(_name);
+		int ofs = m_hashes.Get(h, -1);
+		if (ofs >= 0 && !strcmp(Get(ofs), _name))
+			return ofs;
+		// a colliding name is just stored again, not shared
+		ofs = m_pool.GetSize();
+		int len = (int)strlen(_name) + 1;
+		memcpy(m_pool.Resize(ofs + len, false) + ofs, _name, len);
+		m_count++;
+		if (m_hashes.Get(h, -1) < 0)
+			m_hashes.Insert(h, ofs);
+		return ofs;
+	}
+	// drops unreferenced names once the pool has grown enough
+	void Compact(WDL_TypedBuf<SNM_MarkerRegionEntry>* _entries)
+	{
+		if (m_count < 2*_entries->GetSize() + 64)
+			return;
+		WDL_TypedBuf<char> old;
+		old.Resize(m_pool.GetSize(), false);
+		memcpy(old.Get(), m_pool.Get(), m_pool.GetSize());
+		m_pool.Resize(0, false);
+		m_hashes.DeleteAll();
+		m_count = 0;
+		for (int i=0; i<_entries->GetSize(); i++)
+			_entries->Get()[i].name = Add(old.Get() + _entries->Get()[i].name);
+	}
+private:
+	static unsigned int Hash(const char* _s) {
+		unsigned int h = 2166136261u; // FNV-1a
+		while (*_s) h = (h ^ (unsigned char)*_s++) * 16777619u;
+		return h;
+	}
+	WDL_TypedBuf<char> m_pool;
+	WDL_IntKeyedArray<int> m_hashes; // name hash -> offset in m_pool
+	int m_count; // number of names in m_pool, including unreferenced ones
+};
+
+WDL_TypedBuf<SNM_MarkerRegionEntry> g_mkrRgnCache;
+SNM_MarkerRegionNames g_mkrRgnNames;
+
+// diffs the cache against the project, markers/regions being matched by id (not by
+// position) so that an insertion doesn't flag all the following ones as changed
 // return a bitmask: &SNM_MARKER_MASK: marker update, &SNM_REGION_MASK: region update
-int UpdateMarkerRegionCache()
+int UpdateMarkerRegionCache(SNM_MarkerRegionChanges* _changes)
 {
-	int updateFlags=0;
-	int i=0, x=0, num, col; double pos, rgnend; const char* name; bool isRgn;
+	static WDL_TypedBuf<SNM_MarkerRegionEntry> sNewCache;
+	static WDL_TypedBuf<bool> sMatched;
+	WDL_IntKeyedArray<int> oldIdx; // id -> old cache index, lazily built on 1st mismatch
+	bool oldIdxBuilt = false;
 
-	// added/updated markers/regions?
+	const int oldSz = g_mkrRgnCache.GetSize();
+	SNM_MarkerRegionEntry* old = g_mkrRgnCache.Get();
+	memset(sMatched.Resize(oldSz, false), 0, oldSz*sizeof(bool));
+	sNewCache.Resize(0, false);
+
+	int updateFlags=0, i=0, x=0, num, col; double pos, rgnend; const char* name; bool isRgn;
 	while ((x = EnumProjectMarkers3(NULL, x, &isRgn, &pos, &rgnend, &name, &num, &col)))
 	{
-		MarkerRegion* m = g_mkrRgnCache.Get(i);
-		if (!m || (m && !m->Compare(isRgn, pos, rgnend, name, num, col)))
+		SNM_MarkerRegionEntry e = { MakeMarkerRegionId(num, isRgn), isRgn, pos, isRgn ? rgnend : pos, num, col, -1 };
+
+		// same position in the project? (most common case)
+		int j = (i<oldSz && old[i].id==e.id && !sMatched.Get()[i]) ? i : -1;
+		if (j<0)
 		{
-			if (m) g_mkrRgnCache.Delete(i, true);
-			g_mkrRgnCache.Insert(i, new MarkerRegion(isRgn, pos, rgnend, name, num, col));
+			if (!oldIdxBuilt)
+			{
+				for (int k=oldSz-1; k>=0; k--) // 1st one wins in case of duplicate ids
+					oldIdx.Insert(old[k].id, k);
+				oldIdxBuilt = true;
+			}
+			j = oldIdx.Get(e.id, -1);
+			if (j>=0 && sMatched.Get()[j]) // duplicate id, rare
+			{
+				j = -1;
+				for (int k=0; k<oldSz && j<0; k++)
+					if (old[k].id==e.id && !sMatched.Get()[k]) j = k;
+			}
+		}
+
+		if (j<0)
+		{
+			e.name = g_mkrRgnNames.Add(name);
+			_changes->m_added.Add(e.id);
 			updateFlags |= (isRgn ? SNM_REGION_MASK : SNM_MARKER_MASK);
 		}
+		else
+		{
+			sMatched.Get()[j] = true;
+			int what = 0;
+			if (old[j].pos!=e.pos || old[j].end!=e.end) what |= SNM_MKRRGN_POS;
+			if (old[j].color!=e.color) what |= SNM_MKRRGN_COLOR;
+			if (strcmp(g_mkrRgnNames.Get(old[j].name), name ? name : "")) {
+				what |= SNM_MKRRGN_NAME;
+				e.name = g_mkrRgnNames.Add(name);
+			}
+			else
+				e.name = old[j].name;
+			if (what)
+			{
+				SNM_MarkerRegionChanges::Change c = { e.id, what };
+				_changes->m_changed.Add(c);
+				updateFlags |= (isRgn ? SNM_REGION_MASK : SNM_MARKER_MASK);
+			}
+		}
+		sNewCache.Add(e);
 		i++;
 	}
+
 	// removed markers/regions?
-	for (int j=g_mkrRgnCache.GetSize()-1; j>=i; j--) {
-		if (MarkerRegion* m = g_mkrRgnCache.Get(j))
-			updateFlags |= (m->IsRegion() ? SNM_REGION_MASK : SNM_MARKER_MASK);
-		g_mkrRgnCache.Delete(j, true);
-	}
+	for (int j=0; j<oldSz; j++)
+		if (!sMatched.Get()[j]) {
+			_changes->m_removed.Add(old[j].id);
+			updateFlags |= (old[j].isRgn ? SNM_REGION_MASK : SNM_MARKER_MASK);
+		}
+
+	// swap caches (no reallocation in steady state)
+	g_mkrRgnCache.Resize(sNewCache.GetSize(), false);
+	memcpy(g_mkrRgnCache.Get(), sNewCache.Get(), sNewCache.GetSize()*sizeof(SNM_MarkerRegionEntry));
+	g_mkrRgnNames.Compact(&g_mkrRgnCache);
+
 	// project time mode update?
 	static int sPrevTimemode = *ConfigVar<int>("projtimemode");
-	if (updateFlags != (SNM_MARKER_MASK|SNM_REGION_MASK))
-		if (const ConfigVar<int> timemode = "projtimemode")
-			if (*timemode != sPrevTimemode) {
-				sPrevTimemode = *timemode;
-				return SNM_MARKER_MASK|SNM_REGION_MASK;
-			}
+	if (const ConfigVar<int> timemode = "projtimemode")
+		if (*timemode != sPrevTimemode) {
+			sPrevTimemode = *timemode;
+			_changes->m_timeMode = true;
+			updateFlags = SNM_MARKER_MASK|SNM_REGION_MASK;
+		}
+	_changes->m_flags |= updateFlags;
 	return updateFlags;
 }
 
+
+///////////////////////////////////////////////////////////////////////////////
+// Position-sorted index of g_mkrRgnCache, for lookups while playing
+// (rebuilt only when UpdateMarkerRegionCache() reports changes)
+///////////////////////////////////////////////////////////////////////////////
+
+class SNM_MarkerRegionIndex
+{
+public:
+	SNM_MarkerRegionIndex() : m_proj(NULL), m_stateCount(-1), m_refreshTime(0), m_leaves(0) {}
+
+	// returns the cache update flags, see UpdateMarkerRegionCache()
+	int Refresh(SNM_MarkerRegionChanges* _changes)
+	{
+		m_proj = EnumProjects(-1, NULL, 0);
+		m_stateCount = GetProjectStateChangeCount(m_proj);
+		m_refreshTime = GetTickCount() + SNM_MKR_RGN_UPDATE_FREQ;
+		int updateFlags = UpdateMarkerRegionCache(_changes);
+		if (updateFlags)
+			Build();
+		return updateFlags;
+	}
+
+	// true if the index can serve lookups in _proj, refreshes it if needed:
+	// on project changes (state change count), or on timer like listeners
+	// as some API edits don't change the project state
+	bool Check(ReaProject* _proj, SNM_MarkerRegionChanges* _changes)
+	{
+		ReaProject* cur = EnumProjects(-1, NULL, 0);
+		if (_proj && _proj != cur)
+			return false;
+		if (cur != m_proj || GetProjectStateChangeCount(cur) != m_stateCount || GetTickCount() > m_refreshTime)
+			Refresh(_changes);
+		return true;
+	}
+
+	// forces a refresh on next Check(), e.g. when REAPER notifies marker changes
+	void Invalidate() { m_stateCount = -1; }
+
+	// same result as the enumeration in FindMarkerRegion(), in O(log n)
+	// the result is checked against the project, the index is resynced on mismatch
+	int Find(double _pos, int _flags, int* _idOut, SNM_MarkerRegionChanges* _changes)
+	{
+		int found = Lookup(_pos, _flags);
+		if (!Validate(found))
+		{
+			Refresh(_changes);
+			found = Lookup(_pos, _flags);
+		}
+		if (_idOut)
+			*_idOut = found>=0 ? g_mkrRgnCache.Get()[found].id : -1;
+		return found;
+	}
+
+	// returns the cache index (== project index) of the marker/region _id, or -1
+	int GetIndex(int _id, SNM_MarkerRegionChanges* _changes)
+	{
+		int idx = m_ids.Get(_id, -1);
+		if (!Validate(idx))
+		{
+			Refresh(_changes);
+			idx = m_ids.Get(_id, -1);
+		}
+		return idx;
+	}
+
+private:
+	int Lookup(double _pos, int _flags)
+	{
+		int found = -1;
+		if (_flags&SNM_MARKER_MASK)
+		{
+			// last marker starting before _pos
+			int k = UpperBound(m_markers.Get(), m_markers.GetSize(), _pos);
+			if (k>0) found = m_markers.Get()[k-1];
+		}
+		if (_flags&SNM_REGION_MASK)
+		{
+			// last region starting before _pos and ending after it
+			int k = UpperBound(m_regions.Get(), m_regions.GetSize(), _pos);
+			int j = k>0 ? LastEndingAfter(1, 0, m_leaves-1, k-1, _pos) : -1;
+			if (j>=0 && m_regions.Get()[j] > found) found = m_regions.Get()[j];
+		}
+		return found;
+	}
+
+	// true if the cached entry _idx (if any) and the next one still match the project's,
+	// as well as the number of markers/regions: the index can be stale until the next
+	// timed refresh otherwise (API edits that don't change the project state)
+	bool Validate(int _idx)
+	{
+		const int sz = g_mkrRgnCache.GetSize();
+		int nbMarkers, nbRegions;
+		if (CountProjectMarkers(m_proj, &nbMarkers, &nbRegions) != sz)
+			return false;
+		for (int i=(_idx<0 ? 0 : _idx); i<=_idx+1 && i<sz; i++)
+		{
+			const SNM_MarkerRegionEntry& e = g_mkrRgnCache.Get()[i];
+			bool isRgn; double pos, end; int num, col;
+			if (!EnumProjectMarkers3(m_proj, i, &isRgn, &pos, &end, NULL, &num, &col) ||
+				isRgn!=e.isRgn || num!=e.num || pos!=e.pos || (isRgn && end!=e.end) || col!=e.color)
+				return false;
+		}
+		return true;
+	}
+
+	void Build()
+	{
+		const SNM_MarkerRegionEntry* cache = g_mkrRgnCache.Get();
+		m_markers.Resize(0, false);
+		m_regions.Resize(0, false);
+		m_ids.DeleteAll();
+		for (int i=0; i<g_mkrRgnCache.GetSize(); i++)
+		{
+			if (cache[i].isRgn) m_regions.Add(i);
+			else m_markers.Add(i);
+			if (cache[i].id>0 && m_ids.Get(cache[i].id, -1)<0) // 1st one wins, like EnumMarkerRegionById()
+				m_ids.Insert(cache[i].id, i);
+		}
+
+		// regions interval tree: max region end per node, leaves in start order
+		m_leaves = 1;
+		while (m_leaves < m_regions.GetSize()) m_leaves <<= 1;
+		double* ends = m_maxEnds.Resize(2*m_leaves, false);
+		for (int i=0; i<m_leaves; i++)
+			ends[m_leaves+i] = i<m_regions.GetSize() ? cache[m_regions.Get()[i]].end : -DBL_MAX;
+		for (int i=m_leaves-1; i>0; i--)
+			ends[i] = ends[2*i]>ends[2*i+1] ? ends[2*i] : ends[2*i+1];
+	}
+
+	// number of items (cache indexes, sorted by position) starting at or before _pos
+	static int UpperBound(const int* _items, int _sz, double _pos)
+	{
+		int lo=0, hi=_sz;
+		while (lo<hi)
+		{
+			int mid = (lo+hi)/2;
+			if (g_mkrRgnCache.Get()[_items[mid]].pos <= _pos) lo = mid+1;
+			else hi = mid;
+		}
+		return lo;
+	}
+
+	// last region in [0,_last] that ends at or after _pos, or -1
+	int LastEndingAfter(int _node, int _lo, int _hi, int _last, double _pos)
+	{
+		if (_lo>_last || m_maxEnds.Get()[_node] < _pos)
+			return -1;
+		if (_lo==_hi)
+			return _lo;
+		int mid = (_lo+_hi)/2;
+		int j = LastEndingAfter(2*_node+1, mid+1, _hi, _last, _pos);
+		return j>=0 ? j : LastEndingAfter(2*_node, _lo, mid, _last, _pos);
+	}
+
+	ReaProject* m_proj;
+	int m_stateCount;
+	DWORD m_refreshTime;
+	int m_leaves;
+	WDL_TypedBuf<int> m_markers, m_regions;
+	WDL_TypedBuf<double> m_maxEnds;
+	WDL_IntKeyedArray<int> m_ids;
+};
+
+SNM_MarkerRegionIndex g_mkrRgnIndex;
+SNM_MarkerRegionChanges g_mkrRgnPendingChanges; // found by lookups or polling, not notified yet
+
+// returns true if lookups in _proj can be served by g_mkrRgnIndex
+bool CheckMarkerRegionIndex(ReaProject* _proj) {
+	return g_mkrRgnIndex.Check(_proj, &g_mkrRgnPendingChanges);
+}
+
+// project markers/regions changed, notified via SNM_CSurfExtended()
+// (catches the edits that Validate() can't see, e.g. a region extended over a looked up position)
+void InvalidateMarkerRegionIndex() {
+	g_mkrRgnIndex.Invalidate();
+}
+
 // notify marker/region listeners?
 // polled via SNM_CSurfRun()
 void UpdateMarkerRegionRun()
@@ -96,10 +392,24 @@ void UpdateMarkerRegionRun()
 	{
 		g_mkrRgnNotifyTime = GetTickCount() + SNM_MKR_RGN_UPDATE_FREQ;
 		
-		if (int sz=g_mkrRgnListeners.GetSize())
-			if (int updateFlags = UpdateMarkerRegionCache())
-				for (int i=sz-1; i>=0; i--)
-					g_mkrRgnListeners.Get(i)->NotifyMarkerRegionUpdate(updateFlags);
+		if (!g_mkrRgnListeners.GetSize())
+		{
+			g_mkrRgnPendingChanges.Clear();
+			return;
+		}
+
+		// listeners get a copy: they can edit or look up markers/regions, which reports new changes
+		// to g_mkrRgnPendingChanges (e.g. auto-coloring), those are notified in the next pass
+		static SNM_MarkerRegionChanges sNotified;
+		g_mkrRgnIndex.Refresh(&g_mkrRgnPendingChanges);
+		for (int pass=0; pass<3 && g_mkrRgnPendingChanges.m_flags; pass++)
+		{
+			sNotified.TakeFrom(&g_mkrRgnPendingChanges);
+			for (int i=g_mkrRgnListeners.GetSize()-1; i>=0; i--)
+				g_mkrRgnListeners.Get(i)->NotifyMarkerRegionChanges(&sNotified);
+			g_mkrRgnIndex.Refresh(&g_mkrRgnPendingChanges);
+		}
+		// still changing? left pending until next run
 	}
 }
 
@@ -113,6 +423,9 @@ void UpdateMarkerRegionRun()
 // _flags: &SNM_MARKER_MASK=marker, &SNM_REGION_MASK=region
 int FindMarkerRegion(ReaProject* _proj, double _pos, int _flags, int* _idOut)
 {
+	if (CheckMarkerRegionIndex(_proj))
+		return g_mkrRgnIndex.Find(_pos, _flags, _idOut, &g_mkrRgnPendingChanges);
+
 	bool isrgn;
 	double dPos, dEnd;
 	int x=0, lastx=0, num, foundId=-1, foundx=-1;
@@ -161,6 +474,9 @@ int GetMarkerRegionIdFromIndex(ReaProject* _proj, int _idx)
 
 int GetMarkerRegionIndexFromId(ReaProject* _proj, int _id) 
 {
+	if (_id > 0 && CheckMarkerRegionIndex(_proj))
+		return g_mkrRgnIndex.GetIndex(_id, &g_mkrRgnPendingChanges);
+
 	if (_id > 0)
 	{
 		int x=0, lastx=0, num=(_id&0x3FFFFFFF), num2; 
@@ -184,6 +500,22 @@ bool IsRegion(int _id) {
 
 int EnumMarkerRegionById(ReaProject* _proj, int _id, bool* _isrgn, double* _pos, double* _end, const char** _name, int* _num, int* _color)
 {
+	if (_id > 0 && CheckMarkerRegionIndex(_proj))
+	{
+		int idx = g_mkrRgnIndex.GetIndex(_id, &g_mkrRgnPendingChanges);
+		if (idx>=0)
+		{
+			const SNM_MarkerRegionEntry& m = g_mkrRgnCache.Get()[idx];
+			if (_isrgn)	*_isrgn = m.isRgn;
+			if (_pos)	*_pos = m.pos;
+			if (_end)	*_end = m.end;
+			if (_name)	EnumProjectMarkers3(_proj, idx, NULL, NULL, NULL, _name, NULL, NULL); // REAPER's, outlives the cache
+			if (_num)	*_num = m.num;
+			if (_color)	*_color = m.color;
+		}
+		return idx;
+	}
+
 	if (_id > 0)
 	{
 		const char* name2;
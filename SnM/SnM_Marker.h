@@ -33,6 +33,36 @@
 #include "../MarkerList/MarkerListClass.h"
 
 
+// marker/region changes, see UpdateMarkerRegionCache()
+#define SNM_MKRRGN_POS		0x1 // position or region end
+#define SNM_MKRRGN_NAME		0x2
+#define SNM_MKRRGN_COLOR	0x4
+
+class SNM_MarkerRegionChanges {
+public:
+	struct Change { int m_id; int m_what; }; // m_what: &SNM_MKRRGN_POS, etc..
+	SNM_MarkerRegionChanges() : m_flags(0), m_timeMode(false) {}
+	void Clear() { m_added.Resize(0,false); m_removed.Resize(0,false); m_changed.Resize(0,false); m_flags=0; m_timeMode=false; }
+	// moves _from's changes to this one (no reallocation in steady state)
+	void TakeFrom(SNM_MarkerRegionChanges* _from) {
+		m_added.Resize(_from->m_added.GetSize(),false); memcpy(m_added.Get(), _from->m_added.Get(), m_added.GetSize()*sizeof(int));
+		m_removed.Resize(_from->m_removed.GetSize(),false); memcpy(m_removed.Get(), _from->m_removed.Get(), m_removed.GetSize()*sizeof(int));
+		m_changed.Resize(_from->m_changed.GetSize(),false); memcpy(m_changed.Get(), _from->m_changed.Get(), m_changed.GetSize()*sizeof(Change));
+		m_flags = _from->m_flags; m_timeMode = _from->m_timeMode;
+		_from->Clear();
+	}
+	// true if all changes are about _what only (e.g. colors)
+	bool Only(int _what) const {
+		if (m_timeMode || m_added.GetSize() || m_removed.GetSize()) return false;
+		for (int i=0; i<m_changed.GetSize(); i++) if (m_changed.Get()[i].m_what & ~_what) return false;
+		return true;
+	}
+	WDL_TypedBuf<int> m_added, m_removed; // marker/region ids, see MakeMarkerRegionId()
+	WDL_TypedBuf<Change> m_changed;
+	int m_flags; // &SNM_MARKER_MASK: marker update, &SNM_REGION_MASK: region update
+	bool m_timeMode; // project time mode update (all markers/regions flagged in m_flags)
+};
+
 // register/unregister to marker/region changes
 class SNM_MarkerRegionListener {
 public:
@@ -40,11 +70,14 @@ public:
 	virtual ~SNM_MarkerRegionListener() {}
 	// _updateFlags: &1 marker update, &2 region update
 	virtual void NotifyMarkerRegionUpdate(int _updateFlags) {}
+	// precise changes, for incremental updates (defaults to the above)
+	virtual void NotifyMarkerRegionChanges(const SNM_MarkerRegionChanges* _changes) { NotifyMarkerRegionUpdate(_changes->m_flags); }
 };
 
 void RegisterToMarkerRegionUpdates(SNM_MarkerRegionListener* _sub);
 void UnregisterToMarkerRegionUpdates(SNM_MarkerRegionListener* _sub) ;
 void UpdateMarkerRegionRun();
+void InvalidateMarkerRegionIndex();
 
 int FindMarkerRegion(ReaProject* _proj, double _pos, int _flags, int* _idOut = NULL);
 int MakeMarkerRegionId(int _num, bool _isRgn);
@@ -89,7 +89,7 @@ enum {
 
 SNM_WindowManager<NotesWnd> g_notesWndMgr(NOTES_WND_ID);
 
-SWSProjConfig<WDL_PtrList_DOD<SNM_TrackNotes> > g_SNM_TrackNotes;
+SWSProjConfig<SNM_TrackNotesStore> g_SNM_TrackNotes;
 SWSProjConfig<WDL_PtrList_DOD<SNM_RegionSubtitle> > g_pRegionSubs; // for markers too..
 SWSProjConfig<WDL_FastString> g_prjNotes; // extra project notes
 // global notes #647, saved in <REAPER Resource Path>/SWS_GlobalNotes.txt 
@@ -127,6 +127,80 @@ MediaTrack* g_trNote = NULL;
 bool g_internalMkrRgnChange = false;
 
 
+///////////////////////////////////////////////////////////////////////////////
+// SNM_TrackNotesStore
+///////////////////////////////////////////////////////////////////////////////
+
+SNM_TrackNotes* SNM_TrackNotesStore::Find(MediaTrack* _tr)
+{
+	if (!_tr)
+		return NULL;
+
+	// cached tracks are dropped on track list changes (deleted tracks, project tab switches),
+	// so a hit is a valid track: only check its GUID didn't change meanwhile
+	SNM_TrackNotes* tn = m_byTrack.Get((INT_PTR)_tr, NULL);
+	if (tn)
+	{
+		const GUID* g = (const GUID*)GetSetMediaTrackInfo(_tr, "GUID", NULL);
+		if (g && GuidsEqual(tn->GetGUID(), g))
+			return tn;
+	}
+
+	const GUID* g = TrackToGuid(_tr); // NULL if _tr is not a track of the current project
+	if (!g)
+		return NULL;
+
+	if ((tn = Find(g)))
+		m_byTrack.Insert((INT_PTR)_tr, tn);
+	return tn;
+}
+
+SNM_TrackNotes* SNM_TrackNotesStore::Find(const GUID* _g)
+{
+	char key[64] = "";
+	guidToString((GUID*)_g, key);
+	return m_byGuid.Get(key, NULL);
+}
+
+// replaces the notes if that GUID is already known (i.e. no duplicates)
+SNM_TrackNotes* SNM_TrackNotesStore::Add(ReaProject* _proj, const GUID* _g, const char* _notes)
+{
+	if (!_g)
+		return NULL;
+
+	if (SNM_TrackNotes* tn = Find(_g))
+	{
+		tn->SetNotes(_notes);
+		return tn;
+	}
+
+	SNM_TrackNotes* tn = m_notes.Add(new SNM_TrackNotes(_proj, _g, _notes));
+	char key[64] = "";
+	guidToString((GUID*)_g, key);
+	m_byGuid.Insert(key, tn);
+	return tn;
+}
+
+void SNM_TrackNotesStore::Delete(int _i)
+{
+	if (SNM_TrackNotes* tn = m_notes.Get(_i))
+	{
+		char key[64] = "";
+		guidToString((GUID*)tn->GetGUID(), key);
+		m_byGuid.Delete(key);
+		m_byTrack.DeleteAll();
+		m_notes.Delete(_i, true);
+	}
+}
+
+void SNM_TrackNotesStore::Empty()
+{
+	m_byTrack.DeleteAll();
+	m_byGuid.DeleteAll();
+	m_notes.Empty(true);
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // NotesWnd
 ///////////////////////////////////////////////////////////////////////////////
@@ -747,18 +821,10 @@ void NotesWnd::SaveCurrentTrackNotes(bool _wantUndo)
 	if (g_trNote && CSurf_TrackToID(g_trNote, false) >= 0)
 	{
 		GetWindowText(m_edit, g_lastText, sizeof(g_lastText));
-		bool found = false;
-		for (int i=0; i < g_SNM_TrackNotes.Get()->GetSize(); i++) 
-		{
-			if (g_SNM_TrackNotes.Get()->Get(i)->GetTrack() == g_trNote)
-			{
-				g_SNM_TrackNotes.Get()->Get(i)->SetNotes(g_lastText); // CRLF removed only when saving the project..
-				found = true;
-				break;
-			}
-		}
-		if (!found)
-			g_SNM_TrackNotes.Get()->Add(new SNM_TrackNotes(nullptr, TrackToGuid(g_trNote), g_lastText));
+		if (SNM_TrackNotes* tn = g_SNM_TrackNotes.Get()->Find(g_trNote))
+			tn->SetNotes(g_lastText); // CRLF removed only when saving the project..
+		else
+			g_SNM_TrackNotes.Get()->Add(nullptr, TrackToGuid(g_trNote), g_lastText);
 		if (_wantUndo)
 			Undo_OnStateChangeEx2(NULL, __LOCALIZE("Edit track notes","sws_undo"), UNDO_STATE_MISCCFG, -1); //JFB TODO? -1 to replace?
 		else
@@ -985,13 +1051,12 @@ int NotesWnd::UpdateTrackNotes()
 		{
 			g_trNote = selTr;
 
-			for (int i=0; i < g_SNM_TrackNotes.Get()->GetSize(); i++)
-				if (g_SNM_TrackNotes.Get()->Get(i)->GetTrack() == g_trNote) {
-					SetText(g_SNM_TrackNotes.Get()->Get(i)->GetNotes());
-					return REQUEST_REFRESH;
-				}
+			if (SNM_TrackNotes* tn = g_SNM_TrackNotes.Get()->Find(g_trNote)) {
+				SetText(tn->GetNotes());
+				return REQUEST_REFRESH;
+			}
 
-			g_SNM_TrackNotes.Get()->Add(new SNM_TrackNotes(nullptr, TrackToGuid(g_trNote), ""));
+			g_SNM_TrackNotes.Get()->Add(nullptr, TrackToGuid(g_trNote), "");
 			SetText("");
 			refreshType = REQUEST_REFRESH;
 		} 
@@ -1254,6 +1319,13 @@ void NotesMarkerRegionListener::NotifyMarkerRegionUpdate(int _updateFlags)
 	}
 }
 
+// marker/region colors are not displayed: no refresh for color-only changes
+void NotesMarkerRegionListener::NotifyMarkerRegionChanges(const SNM_MarkerRegionChanges* _changes)
+{
+	if (!_changes->Only(SNM_MKRRGN_COLOR))
+		NotifyMarkerRegionUpdate(_changes->m_flags);
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -1462,7 +1534,7 @@ static bool ProcessExtensionLine(const char *line, ProjectStateContext *ctx, boo
 		{
 			GUID g;
 			stringToGuid(lp.gettoken_str(1), &g);
-			g_SNM_TrackNotes.Get()->Add(new SNM_TrackNotes(p, &g, buf));
+			g_SNM_TrackNotes.Get()->Add(p, &g, buf);
 		}
 		return true;
 	}
@@ -1510,7 +1582,7 @@ static void SaveExtensionConfig(ProjectStateContext *ctx, bool isUndo, struct pr
 						StringToExtensionConfig(&formatedNotes, ctx);
 			}
 			else
-				g_SNM_TrackNotes.Get()->Delete(i--, true);
+				g_SNM_TrackNotes.Get()->Delete(i--);
 		}
 	}
 
@@ -1546,7 +1618,7 @@ static void BeginLoadProjectState(bool isUndo, struct project_config_extension_t
 	g_prjNotes.Get()->Set("");
 
 	g_SNM_TrackNotes.Cleanup();
-	g_SNM_TrackNotes.Get()->Empty(true);
+	g_SNM_TrackNotes.Get()->Empty();
 
 	g_pRegionSubs.Cleanup();
 	g_pRegionSubs.Get()->Empty(true);
@@ -1571,6 +1643,9 @@ void NotesSetTrackTitle()
 // this is our only notification of active project tab change, so update everything
 // (ScheduledJob because of multi-notifs)
 void NotesSetTrackListChange() {
+	// drop cached track pointers (deleted tracks)
+	for (int i=0; i<g_SNM_TrackNotes.GetNumProj(); i++)
+		g_SNM_TrackNotes.Get(i)->ClearTrackCache();
 	ScheduledJob::Schedule(new NotesUpdateJob(SNM_SCHEDJOB_ASYNC_DELAY_OPT));
 }
 
@@ -1668,12 +1743,8 @@ int IsNotesLocked(COMMAND_T*) {
 ******************************************************************************/
 const char* NFDoGetSWSTrackNotes(MediaTrack* track)
 {
-	for (int i = 0; i < g_SNM_TrackNotes.Get()->GetSize(); i++) {
-		if (g_SNM_TrackNotes.Get()->Get(i)->GetTrack() == track) {
-			return g_SNM_TrackNotes.Get()->Get(i)->GetNotes();
-			break;
-		}
-	}
+	if (SNM_TrackNotes* tn = g_SNM_TrackNotes.Get()->Find(track))
+		return tn->GetNotes();
 
 	return "";
 }
@@ -1683,23 +1754,20 @@ void NFDoSetSWSTrackNotes(MediaTrack* track, const char* buf)
 	if (MarkProjectDirty)
 		MarkProjectDirty(NULL);
 
-	for (int i = 0; i < g_SNM_TrackNotes.Get()->GetSize(); i++) {
-
-		if (g_SNM_TrackNotes.Get()->Get(i)->GetTrack() == track) {
-			g_SNM_TrackNotes.Get()->Get(i)->SetNotes(buf);
+	if (SNM_TrackNotes* tn = g_SNM_TrackNotes.Get()->Find(track)) {
+		tn->SetNotes(buf);
 
-			// update displayed text if Notes window is visible and notes for set track are displayed
-			if (NotesWnd* w = g_notesWndMgr.Get()) {
-				if (w->IsWndVisible() && g_notesType == SNM_NOTES_TRACK && g_trNote == track) {
-					w->SetText(buf);
-				}
+		// update displayed text if Notes window is visible and notes for set track are displayed
+		if (NotesWnd* w = g_notesWndMgr.Get()) {
+			if (w->IsWndVisible() && g_notesType == SNM_NOTES_TRACK && g_trNote == track) {
+				w->SetText(buf);
 			}
-			return;
-		}		
+		}
+		return;
 	}
 
 	// tracknote for the track doesn't exist yet, add new one 
-	g_SNM_TrackNotes.Get()->Add(new SNM_TrackNotes(nullptr, TrackToGuid(track), buf));
+	g_SNM_TrackNotes.Get()->Add(nullptr, TrackToGuid(track), buf);
 }
 
 const char* NFDoGetSWSMarkerRegionSub(int mkrRgnIdxNumberIn)
@@ -77,6 +77,26 @@ private:
 	WDL_FastString m_notes;
 };
 
+// track notes of a project, hashed by track GUID
+// lookups by track go through a MediaTrack* -> notes cache, validated against
+// the track's current GUID (pointers can be recycled, GUIDs changed via chunks)
+class SNM_TrackNotesStore {
+public:
+	SNM_TrackNotes* Find(MediaTrack* _tr);
+	SNM_TrackNotes* Find(const GUID* _g);
+	SNM_TrackNotes* Add(ReaProject* _proj, const GUID* _g, const char* _notes);
+	int GetSize() const { return m_notes.GetSize(); }
+	SNM_TrackNotes* Get(int _i) const { return m_notes.Get(_i); }
+	void Delete(int _i);
+	void Empty();
+	void ClearTrackCache() { m_byTrack.DeleteAll(); }
+
+private:
+	WDL_PtrList_DOD<SNM_TrackNotes> m_notes; // owner, creation order (= saving order)
+	WDL_StringKeyedArray<SNM_TrackNotes*> m_byGuid;
+	WDL_PtrKeyedArray<SNM_TrackNotes*> m_byTrack;
+};
+
 class SNM_RegionSubtitle {
 public:
 	SNM_RegionSubtitle(ReaProject* project, const int id, const char* notes)
@@ -118,6 +138,7 @@ class NotesMarkerRegionListener : public SNM_MarkerRegionListener {
 public:
 	NotesMarkerRegionListener() : SNM_MarkerRegionListener() {}
 	void NotifyMarkerRegionUpdate(int _updateFlags);
+	void NotifyMarkerRegionChanges(const SNM_MarkerRegionChanges* _changes);
 };
 
 class NotesWnd : public SWS_DockWnd
@@ -188,7 +209,7 @@ bool GetStringFromNotesChunk(WDL_FastString* _notes, char* _buf, int _bufMaxSize
 bool GetNotesChunkFromString(const char* _buf, WDL_FastString* _notes, const char* _startLine = NULL);
 
 
-extern SWSProjConfig<WDL_PtrList_DOD<SNM_TrackNotes> > g_SNM_TrackNotes;
+extern SWSProjConfig<SNM_TrackNotesStore> g_SNM_TrackNotes;
 
 
 void NotesSetTrackTitle();
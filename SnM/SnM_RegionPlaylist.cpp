@@ -2066,6 +2066,15 @@ void PlaylistMarkerRegionListener::NotifyMarkerRegionUpdate(int _updateFlags) {
 	ScheduledJob::Schedule(new PlaylistUpdateJob(SNM_SCHEDJOB_ASYNC_DELAY_OPT));
 }
 
+// names/colors only: no need to resync playback, just refresh the view
+void PlaylistMarkerRegionListener::NotifyMarkerRegionChanges(const SNM_MarkerRegionChanges* _changes)
+{
+	if (_changes->Only(SNM_MKRRGN_NAME|SNM_MKRRGN_COLOR))
+		ScheduledJob::Schedule(new PlaylistUpdateJob(SNM_SCHEDJOB_ASYNC_DELAY_OPT));
+	else
+		NotifyMarkerRegionUpdate(_changes->m_flags);
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // project_config_extension_t
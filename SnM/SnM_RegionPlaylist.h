@@ -38,6 +38,7 @@ class PlaylistMarkerRegionListener : public SNM_MarkerRegionListener {
 public:
 	PlaylistMarkerRegionListener() : SNM_MarkerRegionListener() {}
 	void NotifyMarkerRegionUpdate(int _updateFlags);
+	void NotifyMarkerRegionChanges(const SNM_MarkerRegionChanges* _changes);
 };
 
 // no other attributes (like a comment) because of the "auto-compacting" feature..
@@ -212,27 +212,30 @@ void CopyRoutings(COMMAND_T* _ct)
 
 void CutRoutings(COMMAND_T* _ct)
 {
-	bool updated = false;
 	WDL_PtrList<MediaTrack> trs;
 	SNM_GetSelectedTracks(NULL, &trs, false);
 	if (trs.GetSize())
 	{
-		WDL_PtrList<SNM_ChunkParserPatcher> ps;
 		CopySendsReceives(false, &trs, &g_sndClipboard, &g_rcvClipboard);
-		updated |= RemoveSends(&trs, &ps);
-		updated |= RemoveReceives(&trs, &ps);
-		ps.Empty(true); // auto-commit, if needed
+
+		// track states are read once, and only changed ones are written back (in one go)
+		SWS_ObjectStateBatch batch(SWS_CMD_SHORTNAME(_ct));
+		WDL_PtrList<SNM_ChunkParserPatcher> ps;
+		RemoveSends(&trs, &ps);
+		RemoveReceives(&trs, &ps);
+		ps.Empty(true); // auto-commit (in the batch), if needed
 	}
-	if (updated)
-		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
 }
 
 void PasteRoutings(COMMAND_T* _ct)
 {
 	WDL_PtrList<MediaTrack> trs;
 	SNM_GetSelectedTracks(NULL, &trs, false);
-	if (trs.GetSize() && PasteSendsReceives(&trs, &g_sndClipboard, &g_rcvClipboard, NULL))
-		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
+	if (trs.GetSize())
+	{
+		SWS_ObjectStateBatch batch(SWS_CMD_SHORTNAME(_ct));
+		PasteSendsReceives(&trs, &g_sndClipboard, &g_rcvClipboard, NULL);
+	}
 }
 
 // sends cut copy/paste
@@ -246,23 +249,23 @@ void CopySends(COMMAND_T* _ct)
 
 void CutSends(COMMAND_T* _ct)
 {
-	bool updated = false;
 	WDL_PtrList<MediaTrack> trs;
 	SNM_GetSelectedTracks(NULL, &trs, false);
 	if (trs.GetSize()) {
 		CopySendsReceives(false, &trs, &g_sndClipboard, NULL);
-		updated |= RemoveSends(&trs, NULL);
+		SWS_ObjectStateBatch batch(SWS_CMD_SHORTNAME(_ct));
+		RemoveSends(&trs, NULL);
 	}
-	if (updated)
-		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
 }
 
 void PasteSends(COMMAND_T* _ct)
 {
 	WDL_PtrList<MediaTrack> trs;
 	SNM_GetSelectedTracks(NULL, &trs, false);
-	if (trs.GetSize() && PasteSendsReceives(&trs, &g_sndClipboard, NULL, NULL))
-		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
+	if (trs.GetSize()) {
+		SWS_ObjectStateBatch batch(SWS_CMD_SHORTNAME(_ct));
+		PasteSendsReceives(&trs, &g_sndClipboard, NULL, NULL);
+	}
 }
 
 // receives cut copy/paste
@@ -276,23 +279,23 @@ void CopyReceives(COMMAND_T* _ct)
 
 void CutReceives(COMMAND_T* _ct)
 {
-	bool updated = false;
 	WDL_PtrList<MediaTrack> trs;
 	SNM_GetSelectedTracks(NULL, &trs, false);
 	if (trs.GetSize()) {
 		CopySendsReceives(false, &trs, NULL, &g_rcvClipboard);
-		updated |= RemoveReceives(&trs, NULL);
+		SWS_ObjectStateBatch batch(SWS_CMD_SHORTNAME(_ct));
+		RemoveReceives(&trs, NULL);
 	}
-	if (updated)
-		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
 }
 
 void PasteReceives(COMMAND_T* _ct)
 {
 	WDL_PtrList<MediaTrack> trs;
 	SNM_GetSelectedTracks(NULL, &trs, false);
-	if (trs.GetSize() && PasteSendsReceives(&trs, NULL, &g_rcvClipboard, NULL))
-		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
+	if (trs.GetSize()) {
+		SWS_ObjectStateBatch batch(SWS_CMD_SHORTNAME(_ct));
+		PasteSendsReceives(&trs, NULL, &g_rcvClipboard, NULL);
+	}
 }
 
 
@@ -325,13 +328,14 @@ bool RemoveSends(WDL_PtrList<MediaTrack>* _trs, WDL_PtrList<SNM_ChunkParserPatch
 
 void RemoveSends(COMMAND_T* _ct)
 {
-	bool updated = false;
 	WDL_PtrList<MediaTrack> trs;
 	SNM_GetSelectedTracks(NULL, &trs, false);
 	if (trs.GetSize())
-		updated = RemoveSends(&trs, NULL);
-	if (updated)
-		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
+	{
+		// track states are read once, and only changed ones are written back (in one go)
+		SWS_ObjectStateBatch batch(SWS_CMD_SHORTNAME(_ct));
+		RemoveSends(&trs, NULL);
+	}
 }
 
 // primitive
@@ -355,29 +359,27 @@ bool RemoveReceives(WDL_PtrList<MediaTrack>* _trs, WDL_PtrList<SNM_ChunkParserPa
 
 void RemoveReceives(COMMAND_T* _ct)
 {
-	bool updated = false;
 	WDL_PtrList<MediaTrack> trs;
 	SNM_GetSelectedTracks(NULL, &trs, false);
 	if (trs.GetSize())
-		updated = RemoveReceives(&trs, NULL);
-	if (updated)
-		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
+	{
+		SWS_ObjectStateBatch batch(SWS_CMD_SHORTNAME(_ct));
+		RemoveReceives(&trs, NULL);
+	}
 }
 
 void RemoveRoutings(COMMAND_T* _ct)
 {
-	bool updated = false;
 	WDL_PtrList<MediaTrack> trs;
 	SNM_GetSelectedTracks(NULL, &trs, false);
 	if (trs.GetSize())
 	{
+		SWS_ObjectStateBatch batch(SWS_CMD_SHORTNAME(_ct));
 		WDL_PtrList<SNM_ChunkParserPatcher> ps;
-		updated |= RemoveSends(&trs, &ps);
-		updated |= RemoveReceives(&trs, &ps);
-		ps.Empty(true); // auto-commit, if needed
+		RemoveSends(&trs, &ps);
+		RemoveReceives(&trs, &ps);
+		ps.Empty(true); // auto-commit (in the batch), if needed
 	}
-	if (updated)
-		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1); 
 }
 
 
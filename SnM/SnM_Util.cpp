@@ -137,6 +137,22 @@ bool FileOrDirExists(const char* _fn)
 	return false;
 }
 
+// returns 0 if the file does not exist
+time_t GetFileModTime(const char* _fn)
+{
+	if (_fn && *_fn)
+	{
+		struct stat s;
+#ifdef _WIN32
+		if (statUTF8(_fn, &s) == 0)
+#else
+		if (stat(_fn, &s) == 0)
+#endif
+			return s.st_mtime;
+	}
+	return 0;
+}
+
 // FileOrDirExists() and FileOrDirExistsErrMsg() are intentionally not merged
 // (would impact other project members' code...)
 bool FileOrDirExistsErrMsg(const char* _fn, bool _errMsg)
@@ -1153,14 +1169,6 @@ bool IsTakePolarityFlipped(MediaItem_Take* take)
 // Other util funcs
 ///////////////////////////////////////////////////////////////////////////////
 
-#ifdef _SNM_MISC
-
-#ifdef _WIN32
-#define FNV64_IV ((WDL_UINT64)(0xCBF29CE484222325i64))
-#else
-#define FNV64_IV ((WDL_UINT64)(0xCBF29CE484222325LL))
-#endif
-
 WDL_UINT64 FNV64(WDL_UINT64 h, const unsigned char* data, int sz)
 {
 	int i;
@@ -1201,5 +1209,3 @@ bool FNV64(const char* _strIn, char* _strOut)
 	return (snprintfStrict(_strOut, 65, "%08X%08X",(int)(h>>32),(int)(h&0xffffffff)) > 0);
 }
 
-#endif
-
@@ -40,6 +40,7 @@ bool Filenamize(char* _fnInOut, bool _checkOnly = false);
 bool IsValidFilenameErrMsg(const char* _fn, bool _errMsg);
 bool FileOrDirExists(const char* _fn);
 bool FileOrDirExistsErrMsg(const char* _fn, bool _errMsg = true);
+time_t GetFileModTime(const char* _fn);
 bool SNM_DeleteFile(const char* _filename, bool _recycleBin);
 bool SNM_DeletePeakFile(const char* _fn, bool _recycleBin);
 bool SNM_CopyFile(const char* _destFn, const char* _srcFn);
@@ -96,10 +97,14 @@ bool GetSectionURL(bool _alr, KbdSectionInfo* _section, char* _sectionURL, int _
 // Get/SetMediaItemTakeInfo_Value(*,"D_VOL") uses negative value (sign flip) if take polarity is flipped
 bool IsTakePolarityFlipped(MediaItem_Take* take);
 
-#ifdef _SNM_MISC
+#ifdef _WIN32
+#define FNV64_IV ((WDL_UINT64)(0xCBF29CE484222325i64))
+#else
+#define FNV64_IV ((WDL_UINT64)(0xCBF29CE484222325LL))
+#endif
+
 WDL_UINT64 FNV64(WDL_UINT64 h, const unsigned char* data, int sz);
 bool FNV64(const char* _strIn, char* _strOut);
-#endif
 
 
 #endif
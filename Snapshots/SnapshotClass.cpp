@@ -29,12 +29,15 @@
 #include "stdafx.h"
 
 #include "../Utility/Base64.h"
+#include "../SnM/SnM_Util.h"
 #include "SnapshotClass.h"
 #include "Snapshots.h"
 
 #include <WDL/projectcontext.h>
 #include <WDL/localize/localize.h>
 
+//#define SNAP_PROFILE // recall latency of the API and chunk passes of Snapshot::UpdateReaper()
+
 FXSnapshot::FXSnapshot(MediaTrack* tr, int fx)
 {
 	m_iCurParam = 0;
@@ -160,7 +163,52 @@ bool FXSnapshot::Exists(MediaTrack* tr)
 	return fx < num;
 }
 
+// Signature of the track's FX chain read through the FX API, FX states aren't serialized:
+// FX instances, names, presets, offline states, parameter values and parameter envelopes.
+// FX bypass states are left out, RecallFXChain() sets them.
+static WDL_UINT64 GetFXChainSig(MediaTrack* tr)
+{
+	WDL_UINT64 h = FNV64_IV;
+	char buf[256];
+	const int num = TrackFX_GetCount(tr);
+	h = FNV64(h, (const unsigned char*)&num, sizeof(num));
+	for (int fx = 0; fx < num; fx++)
+	{
+		if (GUID* g = TrackFX_GetFXGUID(tr, fx))
+			h = FNV64(h, (const unsigned char*)g, sizeof(GUID));
+		TrackFX_GetFXName(tr, fx, buf, sizeof(buf));
+		h = FNV64(h, (const unsigned char*)buf, (int)strlen(buf));
+		buf[0] = 0;
+		TrackFX_GetPreset(tr, fx, buf, sizeof(buf));
+		h = FNV64(h, (const unsigned char*)buf, (int)strlen(buf));
+
+		const int info[] = { TrackFX_GetOffline(tr, fx) ? 1 : 0, TrackFX_GetNumParams(tr, fx) };
+		h = FNV64(h, (const unsigned char*)info, sizeof(info));
+		for (int i = 0; i < info[1]; i++)
+		{
+			double d[4];
+			d[0] = TrackFX_GetParam(tr, fx, i, &d[1], &d[2]);
+			h = FNV64(h, (const unsigned char*)d, sizeof(double));
+			if (TrackEnvelope* env = GetFXEnvelope(tr, fx, i, false))
+			{
+				const int pts = CountEnvelopePoints(env);
+				h = FNV64(h, (const unsigned char*)&i, sizeof(i));
+				h = FNV64(h, (const unsigned char*)&pts, sizeof(pts));
+				for (int pt = 0; pt < pts; pt++)
+				{
+					int shape = 0;
+					GetEnvelopePoint(env, pt, &d[0], &d[1], &shape, &d[2], NULL);
+					d[3] = shape;
+					h = FNV64(h, (const unsigned char*)d, sizeof(d));
+				}
+			}
+		}
+	}
+	return h ? h : 1; // 0 is "unknown"
+}
+
 TrackSnapshot::TrackSnapshot(MediaTrack* tr, int mask)
+:m_fxChainSig(0), m_bFXChainChunk(true), m_bSendsChunk(true)
 {
 	m_iTrackNum = CSurf_TrackToID(tr, false);
 	char* cName = (char*)GetSetMediaTrackInfo(tr, "P_NAME", NULL);
@@ -188,8 +236,9 @@ TrackSnapshot::TrackSnapshot(MediaTrack* tr, int mask)
 	m_dPlayOffset     = GetMediaTrackInfo_Value(tr, "D_PLAY_OFFSET");
 
 	// Don't bother storing the sends if it's masked
+	// (full track states are read below when FX chains are stored)
 	if (mask & SENDS_MASK)
-		m_sends.Build(tr);
+		m_sends.Build(tr, !(mask & FXCHAIN_MASK));
 
 	// Same for the fx
 	// DEPRECATED
@@ -199,7 +248,10 @@ TrackSnapshot::TrackSnapshot(MediaTrack* tr, int mask)
 
 	// and the full FX chain
 	if (mask & FXCHAIN_MASK)
+	{
 		GetFXChain(tr, &m_sFXChain);
+		m_fxChainSig = GetFXChainSig(tr);
+	}
 	
 	// Get the "std" envelopes
 	// JFB note: localized env names are retrieved in GetSetEnvelope()
@@ -220,7 +272,7 @@ TrackSnapshot::TrackSnapshot(MediaTrack* tr, int mask)
 }
 
 // "Copy" constructor with mask large items don't get copied too
-TrackSnapshot::TrackSnapshot(TrackSnapshot& ts):m_sends(ts.m_sends)
+TrackSnapshot::TrackSnapshot(TrackSnapshot& ts):m_sends(ts.m_sends),m_fxChainSig(ts.m_fxChainSig),m_bFXChainChunk(true),m_bSendsChunk(true)
 {
 	m_guid            = ts.m_guid;
 	m_dVol            = ts.m_dVol;
@@ -250,6 +302,7 @@ TrackSnapshot::TrackSnapshot(TrackSnapshot& ts):m_sends(ts.m_sends)
 }
 
 TrackSnapshot::TrackSnapshot(LineParser* lp)
+:m_fxChainSig(0), m_bFXChainChunk(true), m_bSendsChunk(true)
 {
 	stringToGuid(lp->gettoken_str(1), &m_guid);
 	m_dVol            = lp->gettoken_float(2);
@@ -287,17 +340,71 @@ TrackSnapshot::~TrackSnapshot()
 	m_fx.Empty(true);
 }
 
+// Recalls the FX chain through the FX API when the track's FX chain is still the one the
+// signature was taken from (i.e. when the snapshot was saved or last recalled as a chunk),
+// except FX bypass states, so that FX aren't re-instantiated for nothing.
+// Returns false if the FX chain chunk has to be set
+bool TrackSnapshot::RecallFXChain(MediaTrack* tr)
+{
+	if (!m_fxChainSig || m_fxChainSig != GetFXChainSig(tr))
+		return false;
+
+	// Bypass states of the stored chain, "BYPASS <bypass> <offline> ..." lines
+	WDL_TypedBuf<bool> bypass;
+	char line[4096];
+	int pos = 0, depth = 0;
+	while (m_sFXChain.GetSize() && GetChunkLine(m_sFXChain.Get(), line, 4096, &pos, false))
+	{
+		if (depth == 1 && !strncmp(line, "BYPASS ", 7))
+			bypass.Add(line[7] != '0');
+		if (line[0] == '<')
+			depth++;
+		else if (line[0] == '>')
+			depth--;
+	}
+	if (bypass.GetSize() != TrackFX_GetCount(tr))
+		return false;
+
+	for (int fx = 0; fx < bypass.GetSize(); fx++)
+		if (TrackFX_GetEnabled(tr, fx) == bypass.Get()[fx])
+			TrackFX_SetEnabled(tr, fx, !bypass.Get()[fx]);
+	return true;
+}
+
+// FX chains that were just set as chunks are the stored ones now
+void TrackSnapshot::UpdateFXChainSig()
+{
+	MediaTrack* tr = GuidToTrack(&m_guid);
+	if (tr && m_bFXChainChunk)
+		m_fxChainSig = GetFXChainSig(tr);
+}
+
 // Returns true if cannot find the track to update!
+// Called twice on recall: first with wantChunk == false, where everything that can be
+// is recalled through the API, then with wantChunk == true (in a cached ObjectState
+// bracket) to patch the track states that differ structurally from the snapshot.
 bool TrackSnapshot::UpdateReaper(int mask, bool bSelOnly, int* fxErr, bool wantChunk, WDL_PtrList<TrackSendFix>* pFix)
 {
 	MediaTrack* tr = GuidToTrack(&m_guid);
 	if (!tr)
 		return true;
 
+	if (!wantChunk)
+		m_bFXChainChunk = m_bSendsChunk = false;
+
 	int iSel = *(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL);
 	if (bSelOnly && !iSel)
 		return false; // Ignore if the track isn't selected
 
+	if (wantChunk)
+	{
+		if ((mask & FXCHAIN_MASK) && m_bFXChainChunk)
+			SetFXChain(tr, m_sFXChain.Get());
+		if ((mask & SENDS_MASK) && m_bSendsChunk)
+			m_sends.UpdateReaper(tr, pFix);
+		return false;
+	}
+
 	PreventUIRefresh(1);
 
 	if (mask & VOL_MASK)
@@ -355,11 +462,11 @@ bool TrackSnapshot::UpdateReaper(int mask, bool bSelOnly, int* fxErr, bool wantC
 	if (mask & FXCHAIN_MASK)
 	{
 		GetSetMediaTrackInfo(tr, "I_FXEN", &m_iFXEn);
-		if (wantChunk) SetFXChain(tr, m_sFXChain.Get());
+		m_bFXChainChunk = !RecallFXChain(tr);
 	}
 	if (mask & SENDS_MASK)
 	{
-		if (wantChunk) m_sends.UpdateReaper(tr, pFix);
+		m_bSendsChunk = !m_sends.UpdateReaperLevels(tr);
 	}
 	if (mask & PHASE_MASK)
 	{
@@ -569,7 +676,7 @@ void TrackSnapshot::GetDetails(WDL_FastString* details, int iMask)
 			char line[4096];
 			int pos = 0;
 			LineParser lp(false);
-			while (GetChunkLine(m_sFXChain.Get(), line, 4096, &pos, false))
+			while (m_sFXChain.GetSize() && GetChunkLine(m_sFXChain.Get(), line, 4096, &pos, false))
 			{
 				if (!lp.parse(line) && lp.getnumtokens() >= 2)
 				{
@@ -678,7 +785,14 @@ void TrackSnapshot::GetSetEnvelope(MediaTrack* tr, WDL_FastString* str, const ch
 	else if (str->GetLength())
 	{	// Set envelope
 		if (te)
-			GetSetEnvelopeState(te, (char*)str->Get(), 0);
+		{
+			// Skip unchanged envelopes, a longer current state gets truncated and differs too
+			WDL_TypedBuf<char> cur;
+			cur.Resize(str->GetLength() + 2);
+			cur.Get()[0] = 0;
+			if (!GetSetEnvelopeState(te, cur.Get(), cur.GetSize()) || strcmp(cur.Get(), str->Get()))
+				GetSetEnvelopeState(te, (char*)str->Get(), 0);
+		}
 		else
 		{
 			WDL_FastString state;
@@ -898,17 +1012,38 @@ bool Snapshot::UpdateReaper(int mask, bool bSelOnly, bool bHideNewVis)
 	WDL_PtrList<TrackSendFix> sendFixes;
 
 	PreventUIRefresh(1);
+#ifdef SNAP_PROFILE
+	double dStart = time_precise();
+#endif
 
-	// Do "non-chunk" stuff first
+	// Do "non-chunk" stuff first, FX bypass states and send levels included when possible
 	for (int i = 0; i < m_tracks.GetSize(); i++)
 		m_tracks.Get(i)->UpdateReaper(mask & m_iMask, bSelOnly, &fxErr, false, &sendFixes);
 
+#ifdef SNAP_PROFILE
+	double dAPI = time_precise();
+	int iFXChainChunks = 0;
+	for (int i = 0; i < m_tracks.GetSize(); i++)
+		if ((mask & m_iMask & FXCHAIN_MASK) && m_tracks.Get(i)->m_bFXChainChunk)
+			iFXChainChunks++;
+#endif
 	// Then cache all ObjectState changes for the chunk updating
 	SWS_CacheObjectState(true);
 	for (int i = 0; i < m_tracks.GetSize(); i++)
 		if (m_tracks.Get(i)->UpdateReaper(mask & m_iMask, bSelOnly, &fxErr, true, &sendFixes))
 			trackErr++;
+#ifdef SNAP_PROFILE
+	int iWritten = SWS_CacheObjectState(false);
+	double dEnd = time_precise();
+	dprintf("Snapshot::UpdateReaper \"%s\": %d tracks, API pass %.2f ms, chunk pass %.2f ms (%d FX chain chunks, %d track states written)\n",
+		m_cName, m_tracks.GetSize(), (dAPI - dStart) * 1000.0, (dEnd - dAPI) * 1000.0, iFXChainChunks, iWritten);
+#else
 	SWS_CacheObjectState(false);
+#endif
+
+	if (mask & m_iMask & FXCHAIN_MASK)
+		for (int i = 0; i < m_tracks.GetSize(); i++)
+			m_tracks.Get(i)->UpdateFXChainSig();
 
 	if (mask & m_iMask & VIS_MASK)
 	{
@@ -58,6 +58,8 @@ public:
     ~TrackSnapshot();
 
 	bool UpdateReaper(int mask, bool bSelOnly, int* fxErr, bool wantChunk, WDL_PtrList<TrackSendFix>* pFix);
+	bool RecallFXChain(MediaTrack* tr);
+	void UpdateFXChainSig();
 	bool Cleanup();
 	void GetChunk(WDL_FastString* chunk);
 	void GetDetails(WDL_FastString* details, int iMask);
@@ -98,6 +100,12 @@ public:
 	WDL_FastString m_sWidthEnv;
 	WDL_FastString m_sWidthEnv2;
 	WDL_FastString m_sMuteEnv;
+
+	WDL_UINT64 m_fxChainSig; // see GetFXChainSig(), 0 until the FX chain is stored or recalled as a chunk
+
+	// Set by the API pass of UpdateReaper() when the chunk pass has to patch the track
+	bool m_bFXChainChunk;
+	bool m_bSendsChunk;
 };
 
 // Mask:
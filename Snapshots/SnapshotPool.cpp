@@ -0,0 +1,276 @@
+/******************************************************************************
+/ SnapshotPool.cpp
+/
+/ Copyright (c) 2026 SWS contributors
+/
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/ 
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/ 
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#include "stdafx.h"
+
+#include "SnapshotPool.h"
+
+#define POOL_MIN_BLOB_SIZE	64 // smaller sub-chunks are kept inline, a POOLREF line isn't much shorter
+
+static void DeleteString(WDL_FastString* s) { delete s; }
+
+// Chunk walking helpers, lines are handled in place as [p, next[
+static const char* NextLine(const char* p)
+{
+	while (*p && *p != '\n')
+		p++;
+	return *p ? p + 1 : p;
+}
+
+static char FirstChar(const char* p, const char* next)
+{
+	while (p < next && (*p == ' ' || *p == '\t'))
+		p++;
+	return p < next ? *p : 0;
+}
+
+// Gets the nth space separated token of a line (no quote handling, only used for ids and GUIDs)
+static bool GetToken(const char* p, const char* next, int n, WDL_FastString* tok)
+{
+	for (int i = 0; i <= n; i++)
+	{
+		while (p < next && (*p == ' ' || *p == '\t'))
+			p++;
+		const char* start = p;
+		while (p < next && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+			p++;
+		if (p == start)
+			return false;
+		if (i == n)
+			tok->Set(start, (int)(p - start));
+	}
+	return true;
+}
+
+static bool IsKeyword(const char* p, const char* next, const char* key)
+{
+	WDL_FastString tok;
+	return GetToken(p, next, 0, &tok) && !strcmp(tok.Get(), key);
+}
+
+static void AddTrack(WDL_StringKeyedArray<WDL_FastString*>* tracks, const char* guid, const char* chunk, int len)
+{
+	// A GUID appearing twice can't be referenced: keep an empty chunk that never matches
+	if (WDL_FastString* prev = tracks->Get(guid))
+		prev->Set("");
+	else
+		tracks->Insert(guid, new WDL_FastString(chunk, len));
+}
+
+SnapshotPool::SnapshotPool() : m_blobs(true, DeleteString), m_base(true, DeleteString)
+{
+}
+
+void SnapshotPool::Empty()
+{
+	m_blobs.DeleteAll();
+	m_base.DeleteAll();
+}
+
+// Takes ownership of the track chunks
+void SnapshotPool::SetBase(WDL_StringKeyedArray<WDL_FastString*>* tracks)
+{
+	m_base.DeleteAll();
+	const char* guid;
+	for (int i = 0; i < tracks->GetSize(); i++)
+	{
+		WDL_FastString* track = tracks->Enumerate(i, &guid);
+		m_base.Insert(guid, track);
+	}
+	tracks->DeleteAll();
+}
+
+void SnapshotPool::AddBlob(const char* blob, int len, char* id, int idSz)
+{
+	// FNV-1a
+	WDL_UINT64 h = 0xcbf29ce484222325ULL;
+	for (int i = 0; i < len; i++)
+		h = (h ^ (unsigned char)blob[i]) * 0x100000001b3ULL;
+
+	snprintf(id, idSz, "%08x%08x", (unsigned int)(h >> 32), (unsigned int)(h & 0xFFFFFFFF));
+
+	// Resolve (unlikely) collisions with a suffix, ids only have to be unique in a project
+	int suffix = 0;
+	while (WDL_FastString* s = m_blobs.Get(id))
+	{
+		if (s->GetLength() == len && !memcmp(s->Get(), blob, len))
+			return;
+		snprintf(id, idSz, "%08x%08x_%d", (unsigned int)(h >> 32), (unsigned int)(h & 0xFFFFFFFF), ++suffix);
+	}
+	m_blobs.Insert(id, new WDL_FastString(blob, len));
+}
+
+void SnapshotPool::Compact(const char* chunk, WDL_FastString* out)
+{
+	WDL_StringKeyedArray<WDL_FastString*> tracks;
+	WDL_FastString track, guid;
+	const char* trackStart = NULL;
+	const char* subStart = NULL;
+	int depth = 0;
+
+	out->Set("");
+	for (const char* p = chunk; *p; )
+	{
+		const char* next = NextLine(p);
+		const char c = FirstChar(p, next);
+		if (c == '<')
+			depth++;
+
+		if (depth == 2 && c == '<' && !trackStart) // <TRACK
+		{
+			trackStart = p;
+			track.Set(p, (int)(next - p));
+			if (!GetToken(p, next, 1, &guid))
+				guid.Set("");
+		}
+		else if (depth == 3 && c == '<' && !subStart)
+			subStart = p;
+		else if (!subStart && depth == 2 && trackStart)
+			track.Append(p, (int)(next - p));
+		else if (!trackStart)
+			out->Append(p, (int)(next - p));
+
+		if (c == '>')
+		{
+			depth--;
+			if (depth == 2 && subStart)
+			{
+				const int len = (int)(next - subStart);
+				if (len >= POOL_MIN_BLOB_SIZE)
+				{
+					char id[64];
+					AddBlob(subStart, len, id, sizeof(id));
+					track.AppendFormatted(128, "POOLREF %s\n", id);
+				}
+				else
+					track.Append(subStart, len);
+				subStart = NULL;
+			}
+			else if (depth == 1 && trackStart)
+			{
+				const int len = (int)(next - trackStart);
+				WDL_FastString* base = guid.GetLength() ? m_base.Get(guid.Get()) : NULL;
+				if (base && base->GetLength() == len && !memcmp(base->Get(), trackStart, len))
+					out->AppendFormatted(128, "TRACKREF %s\n", guid.Get());
+				else
+					out->Append(&track);
+				if (guid.GetLength())
+					AddTrack(&tracks, guid.Get(), trackStart, len);
+				trackStart = NULL;
+			}
+		}
+		p = next;
+	}
+	SetBase(&tracks);
+}
+
+void SnapshotPool::GetChunk(WDL_FastString* chunk)
+{
+	chunk->Set("");
+	if (!m_blobs.GetSize())
+		return;
+
+	chunk->Append("<SWSSNAPPOOL\n");
+	const char* id;
+	for (int i = 0; i < m_blobs.GetSize(); i++)
+	{
+		WDL_FastString* blob = m_blobs.Enumerate(i, &id);
+		chunk->AppendFormatted(128, "<BLOB %s\n", id);
+		chunk->Append(blob);
+		chunk->Append(">\n");
+	}
+	chunk->Append(">\n");
+}
+
+void SnapshotPool::LoadChunk(const char* chunk)
+{
+	WDL_FastString id;
+	const char* blobStart = NULL;
+	int depth = 0;
+
+	for (const char* p = chunk; *p; )
+	{
+		const char* next = NextLine(p);
+		const char c = FirstChar(p, next);
+		if (c == '<' && ++depth == 2 && IsKeyword(p, next, "<BLOB") && GetToken(p, next, 1, &id))
+			blobStart = next;
+		else if (c == '>' && --depth == 1 && blobStart)
+		{
+			if (!m_blobs.Get(id.Get()))
+				m_blobs.Insert(id.Get(), new WDL_FastString(blobStart, (int)(p - blobStart)));
+			blobStart = NULL;
+		}
+		p = next;
+	}
+}
+
+void SnapshotPool::Expand(const char* chunk, WDL_FastString* out)
+{
+	WDL_StringKeyedArray<WDL_FastString*> tracks;
+	WDL_FastString tok, guid;
+	int trackStart = -1;
+	int depth = 0;
+
+	out->Set("");
+	for (const char* p = chunk; *p; )
+	{
+		const char* next = NextLine(p);
+		const char c = FirstChar(p, next);
+		if (c == '<' && ++depth == 2)
+		{
+			trackStart = out->GetLength();
+			if (!GetToken(p, next, 1, &guid))
+				guid.Set("");
+		}
+
+		if (depth == 1 && c != '>' && IsKeyword(p, next, "TRACKREF") && GetToken(p, next, 1, &tok))
+		{
+			// Unknown references are dropped, the track is then missing from the snapshot
+			if (WDL_FastString* base = m_base.Get(tok.Get()))
+			{
+				out->Append(base);
+				AddTrack(&tracks, tok.Get(), base->Get(), base->GetLength());
+			}
+		}
+		else if (depth == 2 && c != '<' && c != '>' && IsKeyword(p, next, "POOLREF") && GetToken(p, next, 1, &tok))
+		{
+			if (WDL_FastString* blob = m_blobs.Get(tok.Get()))
+				out->Append(blob);
+		}
+		else
+			out->Append(p, (int)(next - p));
+
+		if (c == '>' && --depth == 1 && trackStart >= 0)
+		{
+			if (guid.GetLength())
+				AddTrack(&tracks, guid.Get(), out->Get() + trackStart, out->GetLength() - trackStart);
+			trackStart = -1;
+		}
+		p = next;
+	}
+	SetBase(&tracks);
+}
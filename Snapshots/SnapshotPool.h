@@ -0,0 +1,73 @@
+/******************************************************************************
+/ SnapshotPool.h
+/
+/ Copyright (c) 2026 SWS contributors
+/
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/ 
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/ 
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#pragma once
+
+// Compact project storage for snapshots.
+// Track sub-chunks (FX chains, envelopes...) are stored once in a content-addressed
+// pool shared by all the snapshots of a project, and tracks that did not change since
+// the previous snapshot are stored as a reference to it:
+//
+// <SWSSNAPPOOL
+// <BLOB 3f2a9c0d1e7b5a64      (id = hash of the sub-chunk)
+// <FXCHAIN
+// ...
+// >
+// >
+// <SWSSNAPSHOT "name" 1 559 1234567890 ""
+// <TRACK {guid} ...
+// NAME "name" 1
+// POOLREF 3f2a9c0d1e7b5a64    (replaced by the pooled sub-chunk)
+// >
+// TRACKREF {guid}             (same track chunk as in the previous snapshot)
+// >
+//
+// Expanding a compacted snapshot gives back its plain text chunk, so
+// Snapshot(const char*) only ever has to parse the plain format.
+class SnapshotPool
+{
+public:
+	SnapshotPool();
+	~SnapshotPool() {}
+	void Empty();
+
+	// Saving: compact all the snapshots in order, then write GetChunk() before them
+	void Compact(const char* chunk, WDL_FastString* out);
+	void GetChunk(WDL_FastString* chunk);
+
+	// Loading: feed the pool and snapshot chunks in project order.
+	// Plain chunks are copied as-is, so the old format still loads.
+	void LoadChunk(const char* chunk);
+	void Expand(const char* chunk, WDL_FastString* out);
+
+private:
+	void AddBlob(const char* blob, int len, char* id, int idSz);
+	void SetBase(WDL_StringKeyedArray<WDL_FastString*>* tracks);
+
+	WDL_StringKeyedArray<WDL_FastString*> m_blobs; // id -> pooled sub-chunk
+	WDL_StringKeyedArray<WDL_FastString*> m_base;  // GUID -> plain track chunk of the previous snapshot
+};
@@ -30,6 +30,7 @@
 #include "SnapshotClass.h"
 #include "Snapshots.h"
 #include "SnapshotMerge.h"
+#include "SnapshotPool.h"
 #include "../Prompt.h"
 #include "SnM/SnM.h" // dynamic actions
 
@@ -37,6 +38,7 @@
 #include <WDL/localize/localize.h>
 
 #define SNAP_OPTIONS_KEY "Snapshot Options"
+#define SNAP_COMPACT_KEY "SnapshotsCompactStorage"
 #define RENAME_MSG	0x10001
 #define DELETE_MSG	0x10002
 #define SAVE_MSG	0x10003
@@ -87,6 +89,7 @@ static bool g_bPromptOnNew = false;
 static bool g_bHideOptions = false;
 static bool g_bShowSelOnly = false;
 static bool g_bPromptOnDeleted = true;
+static bool g_bCompactStorage = false; // see SnapshotPool.h
 
 void UpdateSnapshotsDialog(bool bSelChange)
 {
@@ -1046,6 +1049,11 @@ void ToggleSelOnlySave(COMMAND_T*)	{ g_bSelOnly_OnSave = !g_bSelOnly_OnSave; Upd
 void ToggleSelOnlyRecall(COMMAND_T*){ g_bSelOnly_OnRecall = !g_bSelOnly_OnRecall; UpdateSnapshotsDialog(); }
 void ToggleShowForSelTracks(COMMAND_T*){ g_bShowSelOnly = !g_bShowSelOnly; UpdateSnapshotsDialog(); }
 void ToggleAppToRec(COMMAND_T*)	 { g_bApplyFilterOnRecall = !g_bApplyFilterOnRecall; UpdateSnapshotsDialog(); }
+void ToggleCompactStorage(COMMAND_T*)
+{
+	g_bCompactStorage = !g_bCompactStorage;
+	WritePrivateProfileString(SWS_INI, SNAP_COMPACT_KEY, g_bCompactStorage ? "1" : "0", get_ini_file());
+}
 void ClearFilter(COMMAND_T*)	 { g_pSSWnd->SetFilterType(2); g_iMask = 0; UpdateSnapshotsDialog(); }
 void SaveFilter(COMMAND_T*)		 { g_iSavedMask = g_iMask; g_iSavedType = g_pSSWnd->GetFilterType(); }
 void RestoreFilter(COMMAND_T*)	 { g_pSSWnd->SetFilterType(g_iSavedType); g_iMask = g_iSavedMask; UpdateSnapshotsDialog(); }
@@ -1062,6 +1070,8 @@ int IsSnapParamEn(COMMAND_T* ct)
 		return g_bShowSelOnly;
 	else if (ct->doCommand == ToggleAppToRec)
 		return g_bApplyFilterOnRecall;
+	else if (ct->doCommand == ToggleCompactStorage)
+		return g_bCompactStorage;
 	return false;
 }
 
@@ -1203,6 +1213,7 @@ static COMMAND_T g_commandTable[] =
 	{ { DEFACCEL, "SWS: Toggle snapshot selected only on recall" },			"SWSSNAPSHOT_SELONLYRECALL",ToggleSelOnlyRecall,	NULL, 0,			IsSnapParamEn },
 	{ { DEFACCEL, "SWS: Toggle snapshot apply filter to recall" },			"SWSSNAPSHOT_APPLYLOAD",	ToggleAppToRec,			NULL, 0,			IsSnapParamEn },
 	{ { DEFACCEL, "SWS: Toggle snapshot show only for selected tracks" },	"SWSSNAPSHOT_SHOWONLYSEL",	ToggleShowForSelTracks, NULL, 0,			IsSnapParamEn },
+	{ { DEFACCEL, "SWS: Toggle compact snapshot storage in projects" },		"SWSSNAPSHOT_COMPACT",		ToggleCompactStorage,	NULL, 0,			IsSnapParamEn },
 
 	{ { DEFACCEL, "SWS: Clear all snapshot filter options" },				"SWSSNAPSHOT_CLEARFILT", ClearFilter,    NULL, },
 	{ { DEFACCEL, "SWS: Save current snapshot filter options" },			"SWSSNAPSHOT_SAVEFILT",  SaveFilter,     NULL, },
@@ -1211,36 +1222,76 @@ static COMMAND_T g_commandTable[] =
 };
 //!WANT_LOCALIZE_SWS_CMD_TABLE_END
 
+// Pool of the project being loaded, snapshots saved in compact form reference it
+static SnapshotPool g_loadPool;
+
+// Single call timer armed via ProcessExtensionLine(): the load is over, the pool isn't needed anymore
+static void EmptyLoadPoolTimer()
+{
+	plugin_register("-timer", (void*)EmptyLoadPoolTimer);
+	g_loadPool.Empty();
+}
+
 static bool ProcessExtensionLine(const char *line, ProjectStateContext *ctx, bool isUndo, struct project_config_extension_t *reg)
 {
 	WDL_TypedBuf<char> buf;
+	if (GetChunkFromProjectState("<SWSSNAPPOOL", &buf, line, ctx))
+	{
+		g_loadPool.LoadChunk(buf.Get());
+		plugin_register("timer", (void*)EmptyLoadPoolTimer);
+		return true;
+	}
 	if (GetChunkFromProjectState("<SWSSNAPSHOT", &buf, line, ctx))
 	{
-		g_ss.Get()->m_snapshots.Add(new Snapshot(buf.Get()));
+		WDL_FastString chunk;
+		g_loadPool.Expand(buf.Get(), &chunk);
+		g_ss.Get()->m_snapshots.Add(new Snapshot(chunk.Get()));
 		g_pSSWnd->Update();
 		return true;
 	}
 	return false;
 }
 
+static void AddChunkLines(ProjectStateContext *ctx, const char* chunk)
+{
+	char line[4096];
+	int iPos = 0;
+	while(GetChunkLine(chunk, line, 4096, &iPos, false))
+		ctx->AddLine("%s",line);
+}
+
 static void SaveExtensionConfig(ProjectStateContext *ctx, bool isUndo, struct project_config_extension_t *reg)
 {
 	WDL_FastString chunk;
-	char line[4096];
+	if (!g_bCompactStorage)
+	{
+		for (int i = 0; i < g_ss.Get()->m_snapshots.GetSize(); i++)
+		{
+			g_ss.Get()->m_snapshots.Get(i)->GetChunk(&chunk);
+			AddChunkLines(ctx, chunk.Get());
+		}
+		return;
+	}
+
+	// The pool has to be written first, so compact all snapshots before writing anything
+	SnapshotPool pool;
+	WDL_PtrList_DeleteOnDestroy<WDL_FastString> compacted;
 	for (int i = 0; i < g_ss.Get()->m_snapshots.GetSize(); i++)
 	{
-		Snapshot* ss = g_ss.Get()->m_snapshots.Get(i);
-		ss->GetChunk(&chunk);
-		int iPos = 0;
-		while(GetChunkLine(chunk.Get(), line, 4096, &iPos, false))
-			ctx->AddLine("%s",line);
+		g_ss.Get()->m_snapshots.Get(i)->GetChunk(&chunk);
+		pool.Compact(chunk.Get(), compacted.Add(new WDL_FastString));
 	}
+	pool.GetChunk(&chunk);
+	AddChunkLines(ctx, chunk.Get());
+	for (int i = 0; i < compacted.GetSize(); i++)
+		AddChunkLines(ctx, compacted.Get(i)->Get());
 }
 
 static void BeginLoadProjectState(bool isUndo, struct project_config_extension_t *reg)
 {
 	DeleteAllSnapshots();
 	g_ss.Cleanup();
+	g_loadPool.Empty();
 	UpdateSnapshotsDialog();
 }
 
@@ -1271,6 +1322,8 @@ int SnapshotsInit()
 	if (nbrecall >= 0)
 		FindDynamicAction(GetSnapshot)->count = nbrecall;
 
+	g_bCompactStorage = GetPrivateProfileInt(SWS_INI, SNAP_COMPACT_KEY, 0, get_ini_file()) ? true : false;
+
 	g_pSSWnd = new SWS_SnapshotsWnd;
 
 	// disable features unavailable in the running version of REAPER
@@ -1298,6 +1351,7 @@ void SnapshotsExit()
 {
 	plugin_register("-projectconfig",&g_projectconfig);
 	plugin_register("-hookcustommenu", (void*)menuhook);
+	plugin_register("-timer", (void*)EmptyLoadPoolTimer);
 
 	// deletes the old setting key (see SnapshotsInit)
 	WritePrivateProfileString(SWS_INI, "DefaultNbSnapsRecall", nullptr, get_ini_file());
@@ -198,8 +198,14 @@ int SWS_TrackListView::GetItemState(SWS_ListItem* item)
 	return *(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL);
 }
 
+// The list view is virtual (LVS_OWNERDATA): tracks are pulled again only when this changes
+int SWS_TrackListView::GetItemListGeneration()
+{
+	return m_pTrackListWnd->GetListGeneration();
+}
+
 SWS_TrackListWnd::SWS_TrackListWnd()
-:SWS_DockWnd(IDD_TRACKLIST, __LOCALIZE("Track List","sws_DLG_108"), "SWSTrackList"),m_bUpdate(false),
+:SWS_DockWnd(IDD_TRACKLIST, __LOCALIZE("Track List","sws_DLG_108"), "SWSTrackList"),m_bUpdate(false),m_iListGen(0),
 m_trLastTouched(NULL),m_bHideFiltered(false),m_bLink(false),m_cOptionsKey("Track List Options")
 {
 	// Restore state
@@ -220,6 +226,11 @@ void SWS_TrackListWnd::Update()
 	static bool bRecurseCheck = false;
 	if (!IsValidWindow() || bRecurseCheck || !m_pLists.GetSize() || m_pLists.Get(0)->UpdatesDisabled())
 		return;
+	if (m_pLists.Get(0)->GetEditingItem() != -1)
+	{
+		m_bUpdate = true; // retry when done
+		return;
+	}
 	bRecurseCheck = true;
 	
 	//Update the check boxes
@@ -231,14 +242,73 @@ void SWS_TrackListWnd::Update()
 	if (strcmp(filter, m_filter.Get()->GetFilter()))
 		SetDlgItemText(m_hwnd, IDC_FILTER, m_filter.Get()->GetFilter());
 
-	m_filter.Get()->GetFilteredTracks();
+	m_filter.Get()->UpdateFilteredTracks();
 	m_filter.Get()->UpdateReaper(m_bHideFiltered);
 
+	m_iListGen++;
+	m_dirtyTracks.Empty();
 	m_pLists.Get(0)->Update();
 
 	bRecurseCheck = false;
 }
 
+// Called on track changes notified by REAPER, see TracklistSetTrackState()
+// bTitle: the track has been renamed
+void SWS_TrackListWnd::ScheduleTrackUpdate(MediaTrack* tr, bool bTitle)
+{
+	if (m_bUpdate)
+		return;
+
+	// rows are sorted by the changed column or too many changes: rebuild
+	int iSortCol = m_pLists.GetSize() ? abs(m_pLists.Get(0)->GetSortColumn()) - 1 : COL_NUM;
+	if (bTitle ? (iSortCol == COL_NAME) : (iSortCol != COL_NUM && iSortCol != COL_NAME))
+		m_bUpdate = true;
+	else if (m_dirtyTracks.GetSize() >= 64)
+		m_bUpdate = true;
+	else if (m_dirtyTracks.Find(tr) < 0)
+		m_dirtyTracks.Add(tr);
+}
+
+// Refreshes rows of m_dirtyTracks only, unless the set of filtered tracks has changed
+void SWS_TrackListWnd::UpdateTracks()
+{
+	SWS_ListView* lv = m_pLists.Get(0);
+	if (!IsValidWindow() || !lv || lv->UpdatesDisabled() || lv->GetEditingItem() != -1)
+		return;
+
+	for (int i = 0; i < m_dirtyTracks.GetSize(); i++)
+	{
+		MediaTrack* tr = m_dirtyTracks.Get(i);
+		if (CSurf_TrackToID(tr, false) <= 0) // master track, or deleted track (a rebuild is pending then)
+		{
+			m_dirtyTracks.Delete(i--);
+			continue;
+		}
+		// renamed track entering or leaving the filter?
+		if (m_filter.Get()->MatchesFilter(tr) != (lv->FindListItem((SWS_ListItem*)tr) >= 0))
+		{
+			Update();
+			return;
+		}
+	}
+
+	lv->DisableUpdates(true);
+	HWND hList = lv->GetHWND();
+	for (int i = 0; i < m_dirtyTracks.GetSize(); i++)
+	{
+		MediaTrack* tr = m_dirtyTracks.Get(i);
+		int iRow = lv->FindListItem((SWS_ListItem*)tr);
+		if (iRow < 0)
+			continue;
+		int iSel = *(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL) ? LVIS_SELECTED : 0;
+		if ((ListView_GetItemState(hList, iRow, LVIS_SELECTED) & LVIS_SELECTED) != iSel)
+			ListView_SetItemState(hList, iRow, iSel, LVIS_SELECTED);
+		ListView_RedrawItems(hList, iRow, iRow);
+	}
+	lv->DisableUpdates(false);
+	m_dirtyTracks.Empty();
+}
+
 void SWS_TrackListWnd::ClearFilter()
 {
 	if (IsValidWindow())
@@ -375,9 +445,11 @@ void SWS_TrackListWnd::OnTimer(WPARAM wParam)
 {
 	if (m_bUpdate)
 	{
-		Update();
 		m_bUpdate = false;
+		Update();
 	}
+	else if (m_dirtyTracks.GetSize())
+		UpdateTracks();
 }
 
 int SWS_TrackListWnd::OnKey(MSG* msg, int iKeyState)
@@ -437,12 +509,9 @@ int SWS_TrackListWnd::OnKey(MSG* msg, int iKeyState)
 			else
 			{
 				// Find the focused track, and un-focus it
-				for (int i = 0; i < m_pLists.Get(0)->GetListItemCount(); i++)
-					if (m_pLists.Get(0)->GetListItem(i) == (SWS_ListItem*)m_trLastTouched)
-					{
-						ListView_SetItemState(m_pLists.Get(0)->GetHWND(), i, 0, LVIS_FOCUSED);
-						break;
-					}
+				int i = m_pLists.Get(0)->FindListItem((SWS_ListItem*)m_trLastTouched);
+				if (i >= 0)
+					ListView_SetItemState(m_pLists.Get(0)->GetHWND(), i, 0, LVIS_FOCUSED);
 			}
 
 			m_pLists.Get(0)->DisableUpdates(true);
@@ -484,12 +553,9 @@ int SWS_TrackListWnd::OnKey(MSG* msg, int iKeyState)
 			Update();
 			
 			// Update the focus
-			for (int i = 0; i < m_pLists.Get(0)->GetListItemCount(); i++)
-				if (m_pLists.Get(0)->GetListItem(i) == (SWS_ListItem*)m_trLastTouched)
-				{
-					ListView_SetItemState(m_pLists.Get(0)->GetHWND(), i, LVIS_FOCUSED, LVIS_FOCUSED);
-					break;
-				}
+			int i = m_pLists.Get(0)->FindListItem((SWS_ListItem*)m_trLastTouched);
+			if (i >= 0)
+				ListView_SetItemState(m_pLists.Get(0)->GetHWND(), i, LVIS_FOCUSED, LVIS_FOCUSED);
 			return 1;
 		}
 		else if (iKeyState == LVKF_SHIFT && msg->wParam == VK_UP)
@@ -500,10 +566,26 @@ int SWS_TrackListWnd::OnKey(MSG* msg, int iKeyState)
 	return 0;
 }
 
-void ScheduleTracklistUpdate()
+// Control surface notifications, see SWSTimeSlice in sws_extension.cpp
+
+// Tracks may have been deleted: rows are not displayed until the next update
+void TracklistSetTrackListChange()
+{
+	if (g_pList)
+		g_pList->InvalidateTrackList();
+}
+
+void TracklistSetTrackTitle(MediaTrack* tr)
+{
+	if (g_pList)
+		g_pList->ScheduleTrackUpdate(tr, true);
+}
+
+// Selection, mute, solo, rec arm
+void TracklistSetTrackState(MediaTrack* tr)
 {
 	if (g_pList)
-		g_pList->ScheduleUpdate();
+		g_pList->ScheduleTrackUpdate(tr, false);
 }
 
 void OpenTrackList(COMMAND_T*)
@@ -40,6 +40,7 @@ protected:
 	void GetItemText(SWS_ListItem* item, int iCol, char* str, int iStrMax);
 	void GetItemList(SWS_ListItemList* pList);
 	int  GetItemState(SWS_ListItem* item);
+	int  GetItemListGeneration();
 	void OnItemBtnClk(SWS_ListItem* item, int iCol, int iKeyState);
 	void OnItemDblClk(SWS_ListItem* item, int iCol);
 	void OnItemSelChanged(SWS_ListItem* item, int iState);
@@ -55,6 +56,9 @@ public:
 	void Update();
 	void ClearFilter();
 	void ScheduleUpdate() { m_bUpdate = true; }
+	void ScheduleTrackUpdate(MediaTrack* tr, bool bTitle);
+	void InvalidateTrackList() { m_iListGen++; m_bUpdate = true; }
+	int GetListGeneration() { return m_iListGen; }
 	bool HideFiltered() { return m_bHideFiltered; }
 	bool Linked() { return m_bLink; }
 	SWSProjConfig<FilteredVisState>* GetFilter() { return &m_filter; }
@@ -69,7 +73,11 @@ protected:
 	int OnKey(MSG* msg, int iKeyState);
 
 private:
+	void UpdateTracks();
+
 	bool m_bUpdate;
+	int m_iListGen; // bumped when rows must be pulled again, see SWS_TrackListView::GetItemListGeneration()
+	WDL_PtrList<MediaTrack> m_dirtyTracks; // rows to refresh on the next timer tick, see UpdateTracks()
 	SWSProjConfig<FilteredVisState> m_filter;
 	bool m_bHideFiltered;
 	bool m_bLink;
@@ -78,4 +86,6 @@ private:
 
 int TrackListInit();
 void TrackListExit();
-void ScheduleTracklistUpdate();
+void TracklistSetTrackListChange();
+void TracklistSetTrackTitle(MediaTrack* tr);
+void TracklistSetTrackState(MediaTrack* tr);
@@ -41,6 +41,7 @@ void FilteredVisState::SetFilter(const char* cFilter)
 	for (int i = 0; i < sLCFilter.GetLength(); i++)
 		sLCFilter.Get()[i] = tolower(sLCFilter.Get()[i]);
 	m_parsedFilter->parse(sLCFilter.Get());
+	m_matches.DeleteAll();
 }
 
 void FilteredVisState::Init(LineParser* lp)
@@ -84,18 +85,44 @@ char* FilteredVisState::ItemString(char* str, int maxLen, bool* bDone)
 	return str;
 }
 
-WDL_PtrList<void>* FilteredVisState::GetFilteredTracks()
+// Rebuilds the list returned by GetFilteredTracks(), returns true if it has changed
+bool FilteredVisState::UpdateFilteredTracks()
 {
-	static WDL_PtrList<void> tracks;
-	tracks.Empty();
-	
-	for (int i = 1; i <= GetNumTracks(); i++)
+	const int nbTracks = GetNumTracks();
+
+	// drop matches of deleted tracks once in a while
+	if (m_matches.GetSize() > 2*nbTracks + 64)
+		m_matches.DeleteAll();
+
+	bool bChanged = false;
+	int n = 0;
+	for (int i = 1; i <= nbTracks; i++)
 	{
 		MediaTrack* tr = CSurf_TrackFromID(i, false);
 		if (MatchesFilter(tr))
-			tracks.Add(tr);
+		{
+			if (n < m_filtered.GetSize())
+			{
+				if (m_filtered.Get(n) != tr)
+				{
+					m_filtered.Set(n, tr);
+					bChanged = true;
+				}
+			}
+			else
+			{
+				m_filtered.Add(tr);
+				bChanged = true;
+			}
+			n++;
+		}
+	}
+	while (m_filtered.GetSize() > n)
+	{
+		m_filtered.Delete(m_filtered.GetSize()-1);
+		bChanged = true;
 	}
-	return &tracks;
+	return bChanged;
 }
 
 bool FilteredVisState::UpdateReaper(bool bHideFiltered)
@@ -107,6 +134,15 @@ bool FilteredVisState::UpdateReaper(bool bHideFiltered)
 		if (CSurf_TrackToID(m_filteredOut.Get(i)->tr, false) <= 0)
 			m_filteredOut.Delete(i--, true);
 
+	// Nothing hidden, nothing to hide
+	if (!bHideFiltered && !m_filteredOut.GetSize())
+		return false;
+
+	WDL_PtrKeyedArray<TrackVisState*> filteredOut;
+	for (int i = 0; i < m_filteredOut.GetSize(); i++)
+		filteredOut.AddUnsorted(m_filteredOut.Get(i)->tr, m_filteredOut.Get(i));
+	filteredOut.Resort();
+
 	for (int i = 1; i <= GetNumTracks(); i++)
 	{
 		MediaTrack* tr = CSurf_TrackFromID(i, false);
@@ -115,17 +151,12 @@ bool FilteredVisState::UpdateReaper(bool bHideFiltered)
 		bool bShow = !bHideFiltered || MatchesFilter(tr);
 
 		// Is this track in the filteredOut list?
-		int j;
-		for (j = 0; j < m_filteredOut.GetSize(); j++)
-			if (m_filteredOut.Get(j)->tr == tr)
-				break;
-		
-		if (j < m_filteredOut.GetSize())
+		if (TrackVisState* tvs = filteredOut.Get(tr, NULL))
 		{
 			if (bShow)
 			{
-				iNewVis = m_filteredOut.Get(j)->iVis;
-				m_filteredOut.Delete(j, true);
+				iNewVis = tvs->iVis;
+				m_filteredOut.Delete(m_filteredOut.Find(tvs), true);
 			}
 			else
 				iNewVis = 0;
@@ -154,18 +185,35 @@ bool FilteredVisState::UpdateReaper(bool bHideFiltered)
 	return bChanged;
 }
 
+// Tracks are matched again only when their name has changed
 bool FilteredVisState::MatchesFilter(MediaTrack* tr)
 {
 	static WDL_String sTrackName;
 	if (!m_parsedFilter->getnumtokens())
 		return true;
-	sTrackName.Set((char*)GetSetMediaTrackInfo(tr, "P_NAME", NULL));
-	if (!sTrackName.GetLength())
-		return false;
+	const char* name = (const char*)GetSetMediaTrackInfo(tr, "P_NAME", NULL);
+	if (!name)
+		name = "";
+
+	TrackFilterMatch* m = m_matches.Get(tr, NULL);
+	if (m && !strcmp(m->name.Get(), name))
+		return m->match;
+	if (!m)
+	{
+		m = new TrackFilterMatch;
+		m_matches.Insert(tr, m);
+	}
+	m->name.Set(name);
+	m->match = false;
+
+	sTrackName.Set(name);
 	for (int i = 0; i < sTrackName.GetLength(); i++)
 		sTrackName.Get()[i] = tolower(sTrackName.Get()[i]);
-	for (int j = 0; j < m_parsedFilter->getnumtokens(); j++)
+	for (int j = 0; sTrackName.GetLength() && j < m_parsedFilter->getnumtokens(); j++)
 		if (strstr(sTrackName.Get(), m_parsedFilter->gettoken_str(j)))
-			return true;
-	return false;
+		{
+			m->match = true;
+			break;
+		}
+	return m->match;
 }
@@ -34,21 +34,32 @@ typedef struct TrackVisState
 	int iVis;
 } TrackVisState;
 
+// Cached filter match of a track, recomputed when the track name changes
+typedef struct TrackFilterMatch
+{
+	WDL_FastString name;
+	bool match;
+} TrackFilterMatch;
+
 class FilteredVisState
 {
 public:
-	FilteredVisState() { m_parsedFilter = new LineParser(false); }
+	FilteredVisState() : m_matches(DeleteMatch) { m_parsedFilter = new LineParser(false); }
 	~FilteredVisState() { m_filteredOut.Empty(true); delete m_parsedFilter; }
 	void SetFilter(const char* cFilter);
 	const char* GetFilter() { return m_sFilter.Get(); }
 	void Init(LineParser* lp);
 	char* ItemString(char* str, int maxLen, bool* bDone);
-	WDL_PtrList<void>* GetFilteredTracks();
+	bool UpdateFilteredTracks();
+	WDL_PtrList<void>* GetFilteredTracks() { return &m_filtered; }
+	bool MatchesFilter(MediaTrack* tr);
 	bool UpdateReaper(bool bHideFiltered);
 
 private:
-	bool MatchesFilter(MediaTrack* tr);
+	static void DeleteMatch(TrackFilterMatch* m) { delete m; }
 	WDL_String m_sFilter;
 	LineParser* m_parsedFilter;
 	WDL_PtrList<TrackVisState> m_filteredOut;
+	WDL_PtrList<void> m_filtered; // see UpdateFilteredTracks()
+	WDL_PtrKeyedArray<TrackFilterMatch*> m_matches;
 };
@@ -88,6 +88,10 @@ struct ebur128_state_internal {
   ReaSample* resampler_buffer_input;
   ReaSample* resampler_buffer_output;
   size_t     resampler_buffer_output_frames;
+
+  /** SWS: block energy callback */
+  ebur128_block_callback block_callback;
+  void* block_callback_data;
 };
 
 static double relative_gate = -10.0;
@@ -337,6 +341,8 @@ ebur128_state* ebur128_init(unsigned int channels,
   SLIST_INIT(&st->d->block_list);
   SLIST_INIT(&st->d->short_term_block_list);
   st->d->short_term_frame_counter = 0;
+  st->d->block_callback = NULL;
+  st->d->block_callback_data = NULL;
 
   result = ebur128_init_resampler(st);
   CHECK_ERROR(result, 0, free_short_term_block_energy_histogram)
@@ -417,31 +423,6 @@ static int ebur128_use_resampler(ebur128_state* st) {
   return ((st->mode & EBUR128_MODE_TRUE_PEAK) == EBUR128_MODE_TRUE_PEAK);
 }
 
-static void ebur128_check_true_peak(ebur128_state* st, size_t frames) {
-
-  size_t out_len = st->d->resampler->ResampleOut(st->d->resampler_buffer_output,
-                                                 frames,
-                                                 st->d->resampler_buffer_output_frames,
-                                                 st->channels);
-  for (size_t c = 0; c < st->channels; ++c) {
-    for (size_t i = 0; i < out_len; ++i) {
-      if (st->d->resampler_buffer_output[i * st->channels + c] >
-                                                         st->d->true_peak[c]) {
-        st->d->true_peak[c] =
-            st->d->resampler_buffer_output[i * st->channels + c];
-        st->d->true_peak_frame[c] = st->d->true_peak_frame_count + i;
-      } else if (-st->d->resampler_buffer_output[i * st->channels + c] >
-                                                         st->d->true_peak[c]) {
-        st->d->true_peak[c] =
-           -st->d->resampler_buffer_output[i * st->channels + c];
-        st->d->true_peak_frame[c] = st->d->true_peak_frame_count + i;
-      }
-
-    }
-  }
-  st->d->true_peak_frame_count += out_len;
-}
-
 #ifdef __SSE2_MATH__
 #include <xmmintrin.h>
 #define TURN_ON_FTZ \
@@ -460,6 +441,310 @@ static void ebur128_check_true_peak(ebur128_state* st, size_t frames) {
     st->d->v[ci][1] = fabs(st->d->v[ci][1]) < DBL_MIN ? 0.0 : st->d->v[ci][1];
 #endif
 
+/* SWS: SIMD paths for the K-weighting filter and true peak search. Filter runs
+ * adjacent channels in parallel lanes doing the same operations in the same
+ * order as the scalar filter below. That makes results bit-exact only as long
+ * as the compiler doesn't contract the scalar code into FMA, so this file has
+ * to be built with -ffp-contract=off (see CMakeLists.txt, MSVC doesn't contract
+ * unless asked to with /fp:contract). libebur128/test compares both paths.
+ * AVX (4 lanes) is picked at runtime, SSE2 and NEON (2 lanes) at compile time.
+ * Scalar code is kept for everything lanes can't handle (odd channel counts,
+ * unused or duplicate channel mappings, non-double input). */
+static int ebur128_simd = 1;
+
+void ebur128_set_simd(int enable) {
+  ebur128_simd = enable;
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EBUR128_SSE2
+#include <emmintrin.h>
+#define EBUR128_AVX
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define EBUR128_TARGET_AVX
+#else
+#define EBUR128_TARGET_AVX __attribute__((target("avx")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define EBUR128_NEON
+#include <arm_neon.h>
+#endif
+
+#ifdef EBUR128_AVX
+static int ebur128_cpu_has_avx(void) {
+  static int has_avx = -1; /* racing threads all write the same value */
+  if (has_avx < 0) {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    /* AVX and OSXSAVE bits, then make sure OS saves YMM state */
+    has_avx = ((info[2] & (1 << 27)) && (info[2] & (1 << 28)) &&
+               (_xgetbv(0) & 6) == 6) ? 1 : 0;
+#else
+    __builtin_cpu_init();
+    has_avx = __builtin_cpu_supports("avx") ? 1 : 0;
+#endif
+  }
+  return has_avx;
+}
+
+EBUR128_TARGET_AVX
+static void ebur128_filter_lanes_avx(ebur128_state* st, const double* src,
+                                     double* audio_data, size_t frames,
+                                     double scaling_factor, size_t c,
+                                     const int* ci) {
+  double (*v)[5] = st->d->v;
+  const size_t channels = st->channels;
+  const __m256d scale = _mm256_set1_pd(scaling_factor);
+  const __m256d a1 = _mm256_set1_pd(st->d->a[1]), a2 = _mm256_set1_pd(st->d->a[2]);
+  const __m256d a3 = _mm256_set1_pd(st->d->a[3]), a4 = _mm256_set1_pd(st->d->a[4]);
+  const __m256d b0 = _mm256_set1_pd(st->d->b[0]), b1 = _mm256_set1_pd(st->d->b[1]);
+  const __m256d b2 = _mm256_set1_pd(st->d->b[2]), b3 = _mm256_set1_pd(st->d->b[3]);
+  const __m256d b4 = _mm256_set1_pd(st->d->b[4]);
+  __m256d v1 = _mm256_set_pd(v[ci[3]][1], v[ci[2]][1], v[ci[1]][1], v[ci[0]][1]);
+  __m256d v2 = _mm256_set_pd(v[ci[3]][2], v[ci[2]][2], v[ci[1]][2], v[ci[0]][2]);
+  __m256d v3 = _mm256_set_pd(v[ci[3]][3], v[ci[2]][3], v[ci[1]][3], v[ci[0]][3]);
+  __m256d v4 = _mm256_set_pd(v[ci[3]][4], v[ci[2]][4], v[ci[1]][4], v[ci[0]][4]);
+  __m256d v0 = v1;
+  size_t i;
+  int k;
+  double tmp[5][4];
+
+  for (i = 0; i < frames; ++i) {
+    __m256d x = _mm256_div_pd(_mm256_loadu_pd(src + i * channels + c), scale);
+    v0 = _mm256_sub_pd(_mm256_sub_pd(_mm256_sub_pd(_mm256_sub_pd(x,
+                       _mm256_mul_pd(a1, v1)), _mm256_mul_pd(a2, v2)),
+                       _mm256_mul_pd(a3, v3)), _mm256_mul_pd(a4, v4));
+    _mm256_storeu_pd(audio_data + i * channels + c,
+        _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_add_pd(
+                      _mm256_mul_pd(b0, v0), _mm256_mul_pd(b1, v1)),
+                      _mm256_mul_pd(b2, v2)), _mm256_mul_pd(b3, v3)),
+                      _mm256_mul_pd(b4, v4)));
+    v4 = v3;
+    v3 = v2;
+    v2 = v1;
+    v1 = v0;
+  }
+
+  _mm256_storeu_pd(tmp[0], v0);
+  _mm256_storeu_pd(tmp[1], v1);
+  _mm256_storeu_pd(tmp[2], v2);
+  _mm256_storeu_pd(tmp[3], v3);
+  _mm256_storeu_pd(tmp[4], v4);
+  for (k = 0; k < 4; ++k) {
+    v[ci[k]][0] = tmp[0][k];
+    v[ci[k]][1] = tmp[1][k];
+    v[ci[k]][2] = tmp[2][k];
+    v[ci[k]][3] = tmp[3][k];
+    v[ci[k]][4] = tmp[4][k];
+  }
+  _mm256_zeroupper();
+}
+#endif
+
+#if defined(EBUR128_SSE2) || defined(EBUR128_NEON)
+#ifdef EBUR128_SSE2
+#define EBUR128_V2                    __m128d
+#define EBUR128_V2_SET1(x)            _mm_set1_pd(x)
+#define EBUR128_V2_SET(lo, hi)        _mm_set_pd(hi, lo)
+#define EBUR128_V2_LOAD(p)            _mm_loadu_pd(p)
+#define EBUR128_V2_STORE(p, x)        _mm_storeu_pd(p, x)
+#define EBUR128_V2_ADD(x, y)          _mm_add_pd(x, y)
+#define EBUR128_V2_SUB(x, y)          _mm_sub_pd(x, y)
+#define EBUR128_V2_MUL(x, y)          _mm_mul_pd(x, y)
+#define EBUR128_V2_DIV(x, y)          _mm_div_pd(x, y)
+#define EBUR128_V2_MAX(x, y)          _mm_max_pd(x, y)
+#define EBUR128_V2_ABS(x)             _mm_andnot_pd(_mm_set1_pd(-0.0), x)
+#else
+#define EBUR128_V2                    float64x2_t
+#define EBUR128_V2_SET1(x)            vdupq_n_f64(x)
+#define EBUR128_V2_SET(lo, hi)        vcombine_f64(vdup_n_f64(lo), vdup_n_f64(hi))
+#define EBUR128_V2_LOAD(p)            vld1q_f64(p)
+#define EBUR128_V2_STORE(p, x)        vst1q_f64(p, x)
+#define EBUR128_V2_ADD(x, y)          vaddq_f64(x, y)
+#define EBUR128_V2_SUB(x, y)          vsubq_f64(x, y)
+#define EBUR128_V2_MUL(x, y)          vmulq_f64(x, y)
+#define EBUR128_V2_DIV(x, y)          vdivq_f64(x, y)
+#define EBUR128_V2_MAX(x, y)          vmaxq_f64(x, y)
+#define EBUR128_V2_ABS(x)             vabsq_f64(x)
+#endif
+
+static void ebur128_filter_lanes_v2(ebur128_state* st, const double* src,
+                                    double* audio_data, size_t frames,
+                                    double scaling_factor, size_t c,
+                                    const int* ci) {
+  double (*v)[5] = st->d->v;
+  const size_t channels = st->channels;
+  const EBUR128_V2 scale = EBUR128_V2_SET1(scaling_factor);
+  const EBUR128_V2 a1 = EBUR128_V2_SET1(st->d->a[1]), a2 = EBUR128_V2_SET1(st->d->a[2]);
+  const EBUR128_V2 a3 = EBUR128_V2_SET1(st->d->a[3]), a4 = EBUR128_V2_SET1(st->d->a[4]);
+  const EBUR128_V2 b0 = EBUR128_V2_SET1(st->d->b[0]), b1 = EBUR128_V2_SET1(st->d->b[1]);
+  const EBUR128_V2 b2 = EBUR128_V2_SET1(st->d->b[2]), b3 = EBUR128_V2_SET1(st->d->b[3]);
+  const EBUR128_V2 b4 = EBUR128_V2_SET1(st->d->b[4]);
+  EBUR128_V2 v1 = EBUR128_V2_SET(v[ci[0]][1], v[ci[1]][1]);
+  EBUR128_V2 v2 = EBUR128_V2_SET(v[ci[0]][2], v[ci[1]][2]);
+  EBUR128_V2 v3 = EBUR128_V2_SET(v[ci[0]][3], v[ci[1]][3]);
+  EBUR128_V2 v4 = EBUR128_V2_SET(v[ci[0]][4], v[ci[1]][4]);
+  EBUR128_V2 v0 = v1;
+  size_t i;
+  int k;
+  double tmp[5][2];
+
+  for (i = 0; i < frames; ++i) {
+    EBUR128_V2 x = EBUR128_V2_DIV(EBUR128_V2_LOAD(src + i * channels + c), scale);
+    v0 = EBUR128_V2_SUB(EBUR128_V2_SUB(EBUR128_V2_SUB(EBUR128_V2_SUB(x,
+                        EBUR128_V2_MUL(a1, v1)), EBUR128_V2_MUL(a2, v2)),
+                        EBUR128_V2_MUL(a3, v3)), EBUR128_V2_MUL(a4, v4));
+    EBUR128_V2_STORE(audio_data + i * channels + c,
+        EBUR128_V2_ADD(EBUR128_V2_ADD(EBUR128_V2_ADD(EBUR128_V2_ADD(
+                       EBUR128_V2_MUL(b0, v0), EBUR128_V2_MUL(b1, v1)),
+                       EBUR128_V2_MUL(b2, v2)), EBUR128_V2_MUL(b3, v3)),
+                       EBUR128_V2_MUL(b4, v4)));
+    v4 = v3;
+    v3 = v2;
+    v2 = v1;
+    v1 = v0;
+  }
+
+  EBUR128_V2_STORE(tmp[0], v0);
+  EBUR128_V2_STORE(tmp[1], v1);
+  EBUR128_V2_STORE(tmp[2], v2);
+  EBUR128_V2_STORE(tmp[3], v3);
+  EBUR128_V2_STORE(tmp[4], v4);
+  for (k = 0; k < 2; ++k) {
+    v[ci[k]][0] = tmp[0][k];
+    v[ci[k]][1] = tmp[1][k];
+    v[ci[k]][2] = tmp[2][k];
+    v[ci[k]][3] = tmp[3][k];
+    v[ci[k]][4] = tmp[4][k];
+  }
+}
+#endif
+
+/* Lanes need channels that are mapped to distinct filter states */
+static int ebur128_lane_channels(ebur128_state* st, size_t c, int lanes,
+                                 int* ci) {
+  int k, j;
+  if (c + lanes > st->channels) return 0;
+  for (k = 0; k < lanes; ++k) {
+    ci[k] = st->d->channel_map[c + k] - 1;
+    if (ci[k] < 0 || ci[k] > 4) return 0;
+    for (j = 0; j < k; ++j) {
+      if (ci[j] == ci[k]) return 0;
+    }
+  }
+  return 1;
+}
+
+/* Returns how many channels starting at c got filtered, 0 means use scalar
+ * filter. Only double input is vectorized (that's what SWS feeds us) */
+template <typename T>
+static size_t ebur128_filter_lanes(ebur128_state*, const T*, double*, size_t,
+                                   double, size_t) {
+  return 0;
+}
+
+static size_t ebur128_filter_lanes(ebur128_state* st, const double* src,
+                                   double* audio_data, size_t frames,
+                                   double scaling_factor, size_t c) {
+  int ci[4];
+  if (!ebur128_simd) return 0;
+#ifdef EBUR128_AVX
+  if (ebur128_cpu_has_avx() && ebur128_lane_channels(st, c, 4, ci)) {
+    ebur128_filter_lanes_avx(st, src, audio_data, frames, scaling_factor, c, ci);
+    return 4;
+  }
+#endif
+#if defined(EBUR128_SSE2) || defined(EBUR128_NEON)
+  if (ebur128_lane_channels(st, c, 2, ci)) {
+    ebur128_filter_lanes_v2(st, src, audio_data, frames, scaling_factor, c, ci);
+    return 2;
+  }
+#endif
+  (void)st; (void)src; (void)audio_data; (void)frames; (void)scaling_factor;
+  (void)c; (void)ci;
+  return 0;
+}
+
+/* Max of absolute values for channel c (and c + 1 if there is one), returns
+ * how many channels got scanned */
+static size_t ebur128_max_abs(const ReaSample* buf, size_t frames,
+                              size_t channels, size_t c, double* max) {
+  size_t i = 0;
+#if (defined(EBUR128_SSE2) || defined(EBUR128_NEON)) && REASAMPLE_SIZE == 8
+  double tmp[2];
+  EBUR128_V2 m = EBUR128_V2_SET1(0.0);
+  if (channels == 1) {
+    for (; i + 2 <= frames; i += 2)
+      m = EBUR128_V2_MAX(m, EBUR128_V2_ABS(EBUR128_V2_LOAD(buf + i)));
+    EBUR128_V2_STORE(tmp, m);
+    max[0] = tmp[0] > tmp[1] ? tmp[0] : tmp[1];
+    for (; i < frames; ++i) {
+      if (fabs(buf[i]) > max[0]) max[0] = fabs(buf[i]);
+    }
+    return 1;
+  }
+  if (c + 1 < channels) {
+    for (; i < frames; ++i)
+      m = EBUR128_V2_MAX(m, EBUR128_V2_ABS(EBUR128_V2_LOAD(buf + i * channels + c)));
+    EBUR128_V2_STORE(max, m);
+    return 2;
+  }
+#endif
+  max[0] = 0.0;
+  for (; i < frames; ++i) {
+    if (fabs((double)buf[i * channels + c]) > max[0])
+      max[0] = fabs((double)buf[i * channels + c]);
+  }
+  return 1;
+}
+
+static void ebur128_check_true_peak(ebur128_state* st, size_t frames) {
+
+  size_t out_len = st->d->resampler->ResampleOut(st->d->resampler_buffer_output,
+                                                 frames,
+                                                 st->d->resampler_buffer_output_frames,
+                                                 st->channels);
+  const ReaSample* out = st->d->resampler_buffer_output;
+  size_t c = 0;
+  if (!ebur128_simd) {
+    for (c = 0; c < st->channels; ++c) {
+      size_t i;
+      for (i = 0; i < out_len; ++i) {
+        if (out[i * st->channels + c] > st->d->true_peak[c]) {
+          st->d->true_peak[c] = out[i * st->channels + c];
+          st->d->true_peak_frame[c] = st->d->true_peak_frame_count + i;
+        } else if (-out[i * st->channels + c] > st->d->true_peak[c]) {
+          st->d->true_peak[c] = -out[i * st->channels + c];
+          st->d->true_peak_frame[c] = st->d->true_peak_frame_count + i;
+        }
+      }
+    }
+    st->d->true_peak_frame_count += out_len;
+    return;
+  }
+  while (c < st->channels) {
+    /* SWS: find maximum first (vectorized) and only look for its position
+     * when it's a new peak - first frame holding the maximum is the same
+     * frame the sequential search would end up with */
+    double max[2];
+    size_t k, scanned = ebur128_max_abs(out, out_len, st->channels, c, max);
+    for (k = 0; k < scanned; ++k, ++c) {
+      if (max[k] > st->d->true_peak[c]) {
+        size_t i;
+        for (i = 0; i < out_len; ++i) {
+          if (fabs((double)out[i * st->channels + c]) == max[k]) break;
+        }
+        st->d->true_peak[c] = max[k];
+        st->d->true_peak_frame[c] = st->d->true_peak_frame_count + i;
+      }
+    }
+  }
+  st->d->true_peak_frame_count += out_len;
+}
+
 #define EBUR128_FILTER(type, min_scale, max_scale)                             \
 static void ebur128_filter_##type(ebur128_state* st, const type* src,          \
                                   size_t frames) {                             \
@@ -507,6 +792,19 @@ static void ebur128_filter_##type(ebur128_state* st, const type* src,          \
     int ci = st->d->channel_map[c] - 1;                                        \
     if (ci < 0) continue;                                                      \
     else if (ci > 4) ci = 0; /* dual mono */                                   \
+    {                                                                          \
+      size_t lanes = ebur128_filter_lanes(st, src, audio_data, frames,         \
+                                          scaling_factor, c);                  \
+      if (lanes) {                                                             \
+        size_t lane_end = c + lanes;                                           \
+        for (; c < lane_end; ++c) {                                            \
+          ci = st->d->channel_map[c] - 1;                                      \
+          FLUSH_MANUALLY                                                       \
+        }                                                                      \
+        --c;                                                                   \
+        continue;                                                              \
+      }                                                                        \
+    }                                                                          \
     for (i = 0; i < frames; ++i) {                                             \
       st->d->v[ci][0] = (double) (src[i * st->channels + c] / scaling_factor)  \
                    - st->d->a[1] * st->d->v[ci][1]                             \
@@ -594,7 +892,11 @@ static int ebur128_calc_gating_block(ebur128_state* st, size_t frames_per_block,
   if (optional_output) {
     *optional_output = sum;
     return EBUR128_SUCCESS;
-  } else if (sum >= histogram_energy_boundaries[0]) {
+  }
+  if (st->d->block_callback) {
+    st->d->block_callback(st->d->block_callback_data, EBUR128_BLOCK_GATING, sum);
+  }
+  if (sum >= histogram_energy_boundaries[0]) {
     if (st->d->use_histogram) {
       ++st->d->block_energy_histogram[find_histogram_index(sum)];
     } else {
@@ -727,6 +1029,10 @@ int ebur128_add_frames_##type(ebur128_state* st,                               \
           struct ebur128_dq_entry* block;                                      \
           double st_energy;                                                    \
           ebur128_energy_shortterm(st, &st_energy);                            \
+          if (st->d->block_callback) {                                         \
+            st->d->block_callback(st->d->block_callback_data,                  \
+                                  EBUR128_BLOCK_SHORT_TERM, st_energy);        \
+          }                                                                    \
           if (st_energy >= histogram_energy_boundaries[0]) {                   \
             if (st->d->use_histogram) {                                        \
               ++st->d->short_term_block_energy_histogram[                      \
@@ -765,6 +1071,46 @@ EBUR128_ADD_FRAMES(int)
 EBUR128_ADD_FRAMES(float)
 EBUR128_ADD_FRAMES(double)
 
+void ebur128_reset_measurements(ebur128_state* st) {
+  struct ebur128_dq_entry* entry;
+  unsigned int i;
+
+  while (!SLIST_EMPTY(&st->d->block_list)) {
+    entry = SLIST_FIRST(&st->d->block_list);
+    SLIST_REMOVE_HEAD(&st->d->block_list, entries);
+    free(entry);
+  }
+  while (!SLIST_EMPTY(&st->d->short_term_block_list)) {
+    entry = SLIST_FIRST(&st->d->short_term_block_list);
+    SLIST_REMOVE_HEAD(&st->d->short_term_block_list, entries);
+    free(entry);
+  }
+  if (st->d->use_histogram) {
+    for (i = 0; i < 1000; ++i) {
+      st->d->block_energy_histogram[i] = 0;
+      st->d->short_term_block_energy_histogram[i] = 0;
+    }
+  }
+  ebur128_reset_peaks(st);
+}
+
+void ebur128_reset_peaks(ebur128_state* st) {
+  unsigned int i;
+  for (i = 0; i < st->channels; ++i) {
+    st->d->sample_peak[i] = 0.0;
+    st->d->true_peak[i] = 0.0;
+    st->d->sample_peak_frame[i] = 0;
+    st->d->true_peak_frame[i] = 0;
+  }
+}
+
+void ebur128_set_block_callback(ebur128_state* st,
+                                ebur128_block_callback callback,
+                                void* userdata) {
+  st->d->block_callback = callback;
+  st->d->block_callback_data = userdata;
+}
+
 static int ebur128_gated_loudness(ebur128_state** sts, size_t size,
                                   double* out) {
   struct ebur128_dq_entry* it;
@@ -844,6 +1190,43 @@ int ebur128_loudness_global_multiple(ebur128_state** sts, size_t size,
   return ebur128_gated_loudness(sts, size, out);
 }
 
+/* SWS: list mode of ebur128_gated_loudness working on plain energies */
+int ebur128_loudness_global_energies(const double* energies, size_t size,
+                                     double* out) {
+  double relative_threshold = 0.0;
+  double gated_loudness = 0.0;
+  size_t above_thresh_counter = 0;
+  size_t i;
+
+  for (i = 0; i < size; ++i) {
+    if (energies[i] >= histogram_energy_boundaries[0]) {
+      ++above_thresh_counter;
+      relative_threshold += energies[i];
+    }
+  }
+  if (!above_thresh_counter) {
+    *out = -HUGE_VAL;
+    return EBUR128_SUCCESS;
+  }
+  relative_threshold /= (double) above_thresh_counter;
+  relative_threshold *= relative_gate_factor;
+  above_thresh_counter = 0;
+  for (i = 0; i < size; ++i) {
+    if (energies[i] >= histogram_energy_boundaries[0] &&
+        energies[i] >= relative_threshold) {
+      ++above_thresh_counter;
+      gated_loudness += energies[i];
+    }
+  }
+  if (!above_thresh_counter) {
+    *out = -HUGE_VAL;
+    return EBUR128_SUCCESS;
+  }
+  gated_loudness /= (double) above_thresh_counter;
+  *out = ebur128_energy_to_loudness(gated_loudness);
+  return EBUR128_SUCCESS;
+}
+
 static int ebur128_energy_in_interval(ebur128_state* st,
                                       size_t interval_frames,
                                       double* out) {
@@ -1031,6 +1414,59 @@ int ebur128_loudness_range(ebur128_state* st, double* out) {
   return ebur128_loudness_range_multiple(&st, 1, out);
 }
 
+/* SWS: list mode of ebur128_loudness_range_multiple working on plain energies */
+int ebur128_loudness_range_energies(const double* energies, size_t size,
+                                    double* out) {
+  double* stl_vector;
+  size_t stl_size;
+  double* stl_relgated;
+  size_t stl_relgated_size;
+  double stl_power, stl_integrated;
+  double h_en, l_en;
+  size_t i;
+
+  stl_vector = (double*) malloc((size ? size : 1) * sizeof(double));
+  if (!stl_vector)
+    return EBUR128_ERROR_NOMEM;
+
+  stl_size = 0;
+  for (i = 0; i < size; ++i) {
+    if (energies[i] >= histogram_energy_boundaries[0]) {
+      stl_vector[stl_size++] = energies[i];
+    }
+  }
+  if (!stl_size) {
+    free(stl_vector);
+    *out = 0.0;
+    return EBUR128_SUCCESS;
+  }
+
+  qsort(stl_vector, stl_size, sizeof(double), ebur128_double_cmp);
+  stl_power = 0.0;
+  for (i = 0; i < stl_size; ++i) {
+    stl_power += stl_vector[i];
+  }
+  stl_power /= (double) stl_size;
+  stl_integrated = minus_twenty_decibels * stl_power;
+
+  stl_relgated = stl_vector;
+  stl_relgated_size = stl_size;
+  while (stl_relgated_size > 0 && *stl_relgated < stl_integrated) {
+    ++stl_relgated;
+    --stl_relgated_size;
+  }
+
+  if (stl_relgated_size) {
+    h_en = stl_relgated[(size_t) ((stl_relgated_size - 1) * 0.95 + 0.5)];
+    l_en = stl_relgated[(size_t) ((stl_relgated_size - 1) * 0.1 + 0.5)];
+    *out = ebur128_energy_to_loudness(h_en) - ebur128_energy_to_loudness(l_en);
+  } else {
+    *out = 0.0;
+  }
+  free(stl_vector);
+  return EBUR128_SUCCESS;
+}
+
 int ebur128_sample_peak(ebur128_state* st,
                         unsigned int channel_number,
                         double* out, double* pos) {
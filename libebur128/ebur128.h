@@ -188,6 +188,62 @@ int ebur128_add_frames_double(ebur128_state* st,
                              const double* src,
                              size_t frames);
 
+/** SWS: Block types reported by ebur128_block_callback */
+enum {
+  EBUR128_BLOCK_GATING = 0,     /**< 400 ms gating block, reported every 100 ms */
+  EBUR128_BLOCK_SHORT_TERM      /**< 3 s block used for loudness range, reported every second */
+};
+
+/** SWS: Called with energy of every block (including blocks below absolute
+ *  gate) in the order they get calculated. */
+typedef void (*ebur128_block_callback)(void* userdata, int type, double energy);
+
+/** \brief Get notified about every calculated block energy.
+ *
+ *  SWS: Lets caller keep per-block summaries to recalculate integrated
+ *  loudness and loudness range later without analyzing everything again (see
+ *  ebur128_loudness_global_energies and ebur128_loudness_range_energies).
+ *
+ *  @param st library state.
+ *  @param callback function to call, NULL to disable.
+ *  @param userdata passed to callback.
+ */
+void ebur128_set_block_callback(ebur128_state* st,
+                                ebur128_block_callback callback,
+                                void* userdata);
+
+/** \brief Discard measurements gathered so far.
+ *
+ *  SWS: Removes all gating blocks, short-term blocks (LRA) and sample/true
+ *  peaks but keeps filter state, audio history and block timing intact. Used
+ *  to warm up a state on audio preceding the part that should be measured
+ *  (overlap-and-discard when analyzing chunks of a long file in parallel and
+ *  merging them with ebur128_loudness_global_multiple/range_multiple). Peak
+ *  positions stay relative to the first frame ever added.
+ *
+ *  @param st library state.
+ */
+void ebur128_reset_measurements(ebur128_state* st);
+
+/** \brief Discard sample/true peaks gathered so far.
+ *
+ *  SWS: Used to get peaks of consecutive parts of the audio. Peak positions
+ *  stay relative to the first frame ever added.
+ *
+ *  @param st library state.
+ */
+void ebur128_reset_peaks(ebur128_state* st);
+
+/** \brief Enable or disable SIMD filtering and true peak search.
+ *
+ *  SWS: Enabled by default. Disabling falls back to the original scalar code,
+ *  used by libebur128/test to compare both paths. Not thread safe, set it
+ *  before creating any state.
+ *
+ *  @param enable 0 to use scalar code only.
+ */
+void ebur128_set_simd(int enable);
+
 /** \brief Get global integrated loudness in LUFS.
  *
  *  @param st library state.
@@ -212,6 +268,23 @@ int ebur128_loudness_global_multiple(ebur128_state** sts,
                                      size_t size,
                                      double* out);
 
+/** \brief Get integrated loudness in LUFS from gating block energies.
+ *
+ *  SWS: Same as ebur128_loudness_global but works on energies reported by
+ *  ebur128_block_callback (EBUR128_BLOCK_GATING).
+ *
+ *  @param energies gating block energies (blocks below absolute gate are
+ *                  ignored).
+ *  @param size length of energies
+ *  @param out integrated loudness in LUFS. -HUGE_VAL if result is negative
+ *             infinity.
+ *  @return
+ *    - EBUR128_SUCCESS on success.
+ */
+int ebur128_loudness_global_energies(const double* energies,
+                                     size_t size,
+                                     double* out);
+
 /** \brief Get momentary loudness (last 400ms) in LUFS.
  *
  *  @param st library state.
@@ -264,6 +337,23 @@ int ebur128_loudness_range_multiple(ebur128_state** sts,
                                     size_t size,
                                     double* out);
 
+/** \brief Get loudness range (LRA) in LU from short-term block energies.
+ *
+ *  SWS: Same as ebur128_loudness_range but works on energies reported by
+ *  ebur128_block_callback (EBUR128_BLOCK_SHORT_TERM).
+ *
+ *  @param energies short-term block energies (blocks below absolute gate are
+ *                  ignored).
+ *  @param size length of energies
+ *  @param out loudness range (LRA) in LU.
+ *  @return
+ *    - EBUR128_SUCCESS on success.
+ *    - EBUR128_ERROR_NOMEM in case of memory allocation error.
+ */
+int ebur128_loudness_range_energies(const double* energies,
+                                    size_t size,
+                                    double* out);
+
 /** \brief Get maximum sample peak of selected channel in float format.
  *
  *  @param st library state
@@ -0,0 +1,236 @@
+/******************************************************************************
+/ ebur128_chunk_test.cpp
+/
+/ Checks the chunking scheme BR_LoudnessObject::AnalyzeData() uses against a
+/ serial analysis: long targets are split into chunks that each warm up on the
+/ audio preceding them and then get their per-block energies merged, and when
+/ only part of a target changes, just that range is reanalyzed and spliced into
+/ the stored per-block data. Both only work when chunk boundaries line up with
+/ ebur128's gating (100 ms) and loudness range (1 s) blocks, so for every
+/ sample rate this either expects merged results to match the serial ones or
+/ expects AnalyzeData() to fall back to serial analysis. Build and run with the
+/ CMakeLists.txt in this directory (see ebur128_simd_test.cpp).
+/
+/ Copyright (c) 2026 SWS contributors
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#include "../ebur128.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+typedef long long int64;
+
+const int CHUNK_WARM_UP_TIME = 6; // same as BR_Loudness.cpp
+
+struct Blocks
+{
+	vector<double> gating, shortTerm, momentaryValues, shortTermValues;
+};
+
+static vector<double> MakeSignal (int channels, int samplerate, double length, double gainStart, double gainEnd, double gain)
+{
+	const int64 frames = (int64)(samplerate * length);
+	vector<double> signal((size_t)(frames * channels));
+	unsigned int seed = 777;
+	for (int64 i = 0; i < frames; ++i)
+	{
+		const double t = (double)i / samplerate;
+		const double level = (0.02 + 0.8 * fabs(sin(t * 0.11)) * fabs(sin(t * 1.7))) * ((t >= gainStart && t < gainEnd) ? gain : 1);
+		for (int c = 0; c < channels; ++c)
+		{
+			seed = seed * 1664525 + 1013904223;
+			signal[(size_t)(i * channels + c)] = level * (((double)(seed >> 8) / (1 << 24)) * 2 - 1);
+		}
+	}
+	return signal;
+}
+
+// Mirrors BR_LoudnessObject::AnalyzeChunkData(): buffers of blockSampleCount starting at start - warmUp, measurements reset once warm-up is over
+static Blocks AnalyzeChunk (const vector<double>& signal, int channels, int samplerate, int blockSampleCount, int64 start, int64 end, int64 warmUp)
+{
+	struct Recorder { Blocks* blocks; bool record; } recorder;
+	Blocks blocks;
+	recorder.blocks = &blocks;
+	recorder.record = (warmUp == 0);
+
+	ebur128_state* st = ebur128_init(channels, samplerate, EBUR128_MODE_M | EBUR128_MODE_S | EBUR128_MODE_I | EBUR128_MODE_LRA);
+	ebur128_set_block_callback(st, [](void* userdata, int type, double energy)
+	{
+		Recorder* recorder = (Recorder*)userdata;
+		if (recorder->record)
+			(type == EBUR128_BLOCK_GATING ? recorder->blocks->gating : recorder->blocks->shortTerm).push_back(energy);
+	}, &recorder);
+
+	int i = 0;
+	bool momentaryFilled = true;
+	for (int64 pos = start - warmUp; pos < end; pos += blockSampleCount)
+	{
+		const int count = (int)min((int64)blockSampleCount, end - pos);
+		if (warmUp && pos == start)
+		{
+			ebur128_reset_measurements(st);
+			recorder.record = true;
+		}
+		ebur128_add_frames_double(st, &signal[(size_t)(pos * channels)], count);
+		if (pos >= start && count == blockSampleCount)
+		{
+			double value;
+			if ((i % 2 > 0) == momentaryFilled)
+			{
+				ebur128_loudness_momentary(st, &value);
+				blocks.momentaryValues.push_back(value);
+			}
+			if (i == 14)
+			{
+				ebur128_loudness_shortterm(st, &value);
+				blocks.shortTermValues.push_back(value);
+			}
+		}
+		if (++i == 15)
+		{
+			i = 0;
+			momentaryFilled = !momentaryFilled;
+		}
+	}
+	ebur128_destroy(&st);
+	return blocks;
+}
+
+static void Splice (vector<double>& values, size_t offset, const vector<double>& newValues, bool toEnd)
+{
+	if (toEnd || offset + newValues.size() > values.size())
+		values.resize(offset + newValues.size(), 0);
+	copy(newValues.begin(), newValues.end(), values.begin() + offset);
+}
+
+// Mirrors merging in BR_LoudnessObject::AnalyzeData(), range is reanalyzed in chunkCount chunks and spliced into blocks
+static void AnalyzeRange (const vector<double>& signal, int channels, int samplerate, int blockSampleCount, int64 periodSamples, int64 rangeStart, int64 rangeEnd, int64 totalSamples, int chunkCount, Blocks* blocks)
+{
+	const int64 gatingSamples = (samplerate + 5) / 10;
+	int64 chunkSamples = ((rangeEnd - rangeStart) / chunkCount / periodSamples + 1) * periodSamples;
+	chunkCount = (int)((rangeEnd - rangeStart + chunkSamples - 1) / chunkSamples);
+
+	size_t gatingOffset    = rangeStart ? (size_t)(rangeStart / gatingSamples - 3)        : 0;
+	size_t shortTermOffset = rangeStart ? (size_t)(rangeStart / (gatingSamples * 10) - 2) : 0;
+	size_t momentaryOffset = (size_t)(rangeStart / blockSampleCount / 2);
+	size_t intervalOffset  = (size_t)(rangeStart / blockSampleCount / 15);
+	for (int i = 0; i < chunkCount; ++i)
+	{
+		const int64 start = rangeStart + i * chunkSamples;
+		const int64 end   = min(start + chunkSamples, rangeEnd);
+		const bool  toEnd = (end >= totalSamples);
+		Blocks chunk = AnalyzeChunk(signal, channels, samplerate, blockSampleCount, start, end, start ? periodSamples : 0);
+		Splice(blocks->gating,          gatingOffset,    chunk.gating,          toEnd);
+		Splice(blocks->shortTerm,       shortTermOffset, chunk.shortTerm,       toEnd);
+		Splice(blocks->momentaryValues, momentaryOffset, chunk.momentaryValues, toEnd);
+		Splice(blocks->shortTermValues, intervalOffset,  chunk.shortTermValues, toEnd);
+		gatingOffset    += chunk.gating.size();
+		shortTermOffset += chunk.shortTerm.size();
+		momentaryOffset += chunk.momentaryValues.size();
+		intervalOffset  += chunk.shortTermValues.size();
+	}
+}
+
+static double MaxDiff (const vector<double>& a, const vector<double>& b)
+{
+	if (a.size() != b.size())
+		return HUGE_VAL;
+	double diff = 0;
+	for (size_t i = 0; i < a.size(); ++i)
+	{
+		if (a[i] == b[i]) continue; // -inf
+		diff = max(diff, fabs(a[i] - b[i]) / max(fabs(a[i]), 1e-300));
+	}
+	return diff;
+}
+
+static bool Compare (const char* what, int samplerate, int refreshRate, const Blocks& serial, const Blocks& merged, bool expectMatch)
+{
+	double serialI, mergedI, serialLRA, mergedLRA;
+	ebur128_loudness_global_energies(serial.gating.data(), serial.gating.size(), &serialI);
+	ebur128_loudness_global_energies(merged.gating.data(), merged.gating.size(), &mergedI);
+	ebur128_loudness_range_energies(serial.shortTerm.data(), serial.shortTerm.size(), &serialLRA);
+	ebur128_loudness_range_energies(merged.shortTerm.data(), merged.shortTerm.size(), &mergedLRA);
+
+	const double blockDiff = max(max(MaxDiff(serial.gating, merged.gating), MaxDiff(serial.shortTerm, merged.shortTerm)),
+	                             max(MaxDiff(serial.momentaryValues, merged.momentaryValues), MaxDiff(serial.shortTermValues, merged.shortTermValues)));
+	const bool match = blockDiff < 1e-9 && fabs(serialI - mergedI) < 1e-9 && fabs(serialLRA - mergedLRA) < 1e-9;
+	printf("%-12s %6d Hz %3d Hz refresh: I %+.12f LU, LRA %+.12f LU, max relative block difference %.3g%s\n",
+	       what, samplerate, refreshRate, mergedI - serialI, mergedLRA - serialLRA, blockDiff,
+	       match == expectMatch ? "" : (expectMatch ? "  <- FAIL" : "  <- unexpected match"));
+	return match == expectMatch;
+}
+
+int main ()
+{
+	const int samplerates[]  = {8000, 11025, 16000, 22050, 32000, 44100, 48000, 88200, 96000};
+	const int refreshRates[] = {5, 100};
+	const int channels = 2;
+	const double length = 200;
+	int failed = 0;
+
+	for (int samplerate : samplerates)
+	{
+		const vector<double> signal  = MakeSignal(channels, samplerate, length, -1, -1, 1);
+		const vector<double> changed = MakeSignal(channels, samplerate, length, 61.37, 83.91, 0.3);
+		for (int refreshRate : refreshRates)
+		{
+			const int   blockSampleCount = samplerate / refreshRate;
+			const int64 totalSamples     = (int64)(length * samplerate);
+			const int64 periodSamples    = (int64)blockSampleCount * CHUNK_WARM_UP_TIME * refreshRate;
+			const int64 gatingSamples    = (samplerate + 5) / 10;
+			const bool  aligned          = periodSamples % (gatingSamples * 10) == 0; // condition AnalyzeData() checks before splitting/splicing
+
+			// Whole target in 4 chunks
+			const Blocks serial = AnalyzeChunk(signal, channels, samplerate, blockSampleCount, 0, totalSamples, 0);
+			Blocks merged;
+			AnalyzeRange(signal, channels, samplerate, blockSampleCount, periodSamples, 0, totalSamples, totalSamples, 4, &merged);
+			if (!Compare("chunked", samplerate, refreshRate, serial, merged, aligned))
+				++failed;
+
+			// Only changed part of the target reanalyzed (same range rounding as AnalyzeData()) in 2 chunks and spliced into old blocks
+			if (aligned)
+			{
+				const double changedStart = 61.37, changedEnd = 83.91;
+				const int64 rangeStart = ((int64)(changedStart * samplerate) / periodSamples) * periodSamples;
+				int64 rangeEnd = ((int64)((changedEnd + 3) * samplerate) / periodSamples + 1) * periodSamples;
+				if (rangeEnd >= totalSamples)
+					rangeEnd = totalSamples;
+
+				Blocks spliced = serial;
+				AnalyzeRange(changed, channels, samplerate, blockSampleCount, periodSamples, rangeStart, rangeEnd, totalSamples, 2, &spliced);
+				const Blocks fresh = AnalyzeChunk(changed, channels, samplerate, blockSampleCount, 0, totalSamples, 0);
+				if (!Compare("incremental", samplerate, refreshRate, fresh, spliced, true))
+					++failed;
+			}
+		}
+	}
+
+	printf("%s\n", failed ? "FAILED" : "all chunked/incremental results match serial analysis where AnalyzeData() uses them");
+	return failed ? 1 : 0;
+}
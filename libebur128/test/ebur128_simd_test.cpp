@@ -0,0 +1,197 @@
+/******************************************************************************
+/ ebur128_simd_test.cpp
+/
+/ Runs the same audio through libebur128 with SIMD paths disabled (original
+/ scalar code) and enabled and checks that every measurement is bit-exact, then
+/ prints throughput of both. Build with the CMakeLists.txt in this directory:
+/
+/   cmake -S libebur128/test -B build_ebur128 -DCMAKE_BUILD_TYPE=Release
+/   cmake --build build_ebur128 && ctest --test-dir build_ebur128 -V
+/
+/ Copyright (c) 2026 SWS contributors
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#include "../ebur128.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+struct Results
+{
+	vector<double> momentary;            // after every added buffer
+	double integrated, range, shortTerm;
+	vector<double> samplePeak, samplePeakPos, truePeak, truePeakPos;
+	double seconds;
+};
+
+static vector<double> MakeSignal (unsigned int channels, unsigned long samplerate, double length)
+{
+	// Noise plus sines and a loudness ramp so gating, LRA and peaks all have something to do
+	const size_t frames = (size_t)(samplerate * length);
+	vector<double> signal(frames * channels);
+	unsigned int seed = 12345;
+	for (size_t i = 0; i < frames; ++i)
+	{
+		const double t = (double)i / samplerate;
+		const double level = 0.05 + 0.9 * fabs(sin(t * 0.37));
+		for (unsigned int c = 0; c < channels; ++c)
+		{
+			seed = seed * 1664525 + 1013904223;
+			const double noise = ((double)(seed >> 8) / (1 << 24)) * 2 - 1;
+			signal[i * channels + c] = level * (0.5 * sin(2 * M_PI * (220.0 * (c + 1)) * t) + 0.4 * noise);
+		}
+	}
+	return signal;
+}
+
+static bool Run (const vector<double>& signal, unsigned int channels, unsigned long samplerate, int mode, const int* channelMap, size_t bufferFrames, bool simd, Results* results)
+{
+	ebur128_set_simd(simd ? 1 : 0);
+	ebur128_state* st = ebur128_init(channels, samplerate, mode);
+	if (!st)
+		return false;
+	if (channelMap)
+	{
+		for (unsigned int c = 0; c < channels; ++c)
+			ebur128_set_channel(st, c, channelMap[c]);
+	}
+
+	const size_t frames = signal.size() / channels;
+	results->momentary.clear();
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (size_t i = 0; i < frames; i += bufferFrames)
+	{
+		const size_t count = (i + bufferFrames <= frames) ? bufferFrames : frames - i;
+		ebur128_add_frames_double(st, &signal[i * channels], count);
+		double momentary;
+		ebur128_loudness_momentary(st, &momentary);
+		results->momentary.push_back(momentary);
+	}
+	results->seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	results->integrated = results->range = results->shortTerm = 0;
+	if ((mode & EBUR128_MODE_I) == EBUR128_MODE_I)     ebur128_loudness_global(st, &results->integrated);
+	if ((mode & EBUR128_MODE_LRA) == EBUR128_MODE_LRA) ebur128_loudness_range(st, &results->range);
+	if ((mode & EBUR128_MODE_S) == EBUR128_MODE_S)     ebur128_loudness_shortterm(st, &results->shortTerm);
+
+	results->samplePeak.assign(channels, 0);
+	results->samplePeakPos.assign(channels, 0);
+	results->truePeak.assign(channels, 0);
+	results->truePeakPos.assign(channels, 0);
+	for (unsigned int c = 0; c < channels; ++c)
+	{
+		if ((mode & EBUR128_MODE_SAMPLE_PEAK) == EBUR128_MODE_SAMPLE_PEAK) ebur128_sample_peak(st, c, &results->samplePeak[c], &results->samplePeakPos[c]);
+		if ((mode & EBUR128_MODE_TRUE_PEAK) == EBUR128_MODE_TRUE_PEAK)     ebur128_true_peak(st, c, &results->truePeak[c], &results->truePeakPos[c]);
+	}
+
+	ebur128_destroy(&st);
+	return true;
+}
+
+static bool Same (const vector<double>& a, const vector<double>& b)
+{
+	return a.size() == b.size() && (a.empty() || !memcmp(&a[0], &b[0], a.size() * sizeof(double)));
+}
+
+static bool Same (double a, double b)
+{
+	return !memcmp(&a, &b, sizeof(double));
+}
+
+int main ()
+{
+	const unsigned long samplerates[] = {11025, 22050, 44100, 48000, 96000};
+	const unsigned int  channelCounts[] = {1, 2, 3, 4, 5, 6};
+	const size_t        bufferSizes[]   = {0, 441}; // 0 means 200 ms (what SWS uses)
+	const int           modes[]         = {EBUR128_MODE_I | EBUR128_MODE_LRA | EBUR128_MODE_TRUE_PEAK,
+	                                       EBUR128_MODE_I | EBUR128_MODE_LRA | EBUR128_MODE_TRUE_PEAK | EBUR128_MODE_HISTOGRAM};
+	const int           duplicateMap[]  = {EBUR128_LEFT, EBUR128_LEFT, EBUR128_RIGHT, EBUR128_UNUSED}; // lanes must fall back to scalar here
+	const double        length = 10;
+
+	int failed = 0, passed = 0;
+	for (unsigned long samplerate : samplerates)
+	{
+		for (unsigned int channels : channelCounts)
+		{
+			const vector<double> signal = MakeSignal(channels, samplerate, length);
+			for (size_t bufferSize : bufferSizes)
+			{
+				for (int mode : modes)
+				{
+					for (int useMap = 0; useMap < ((channels == 4) ? 2 : 1); ++useMap)
+					{
+						const size_t bufferFrames = bufferSize ? bufferSize : samplerate / 5;
+						Results scalar, simd;
+						if (!Run(signal, channels, samplerate, mode, useMap ? duplicateMap : NULL, bufferFrames, false, &scalar) ||
+						    !Run(signal, channels, samplerate, mode, useMap ? duplicateMap : NULL, bufferFrames, true,  &simd))
+						{
+							printf("FAIL init: %lu Hz, %u ch\n", samplerate, channels);
+							++failed;
+							continue;
+						}
+
+						const bool same = Same(scalar.momentary, simd.momentary) && Same(scalar.integrated, simd.integrated) &&
+						                  Same(scalar.range, simd.range) && Same(scalar.shortTerm, simd.shortTerm) &&
+						                  Same(scalar.samplePeak, simd.samplePeak) && Same(scalar.samplePeakPos, simd.samplePeakPos) &&
+						                  Same(scalar.truePeak, simd.truePeak) && Same(scalar.truePeakPos, simd.truePeakPos);
+						if (!same)
+						{
+							printf("FAIL: %lu Hz, %u ch, buffer %d, mode %d%s: integrated %.17g vs %.17g, range %.17g vs %.17g\n",
+							       samplerate, channels, (int)bufferFrames, mode, useMap ? ", duplicate channel map" : "",
+							       scalar.integrated, simd.integrated, scalar.range, simd.range);
+							++failed;
+						}
+						else
+						{
+							++passed;
+						}
+					}
+				}
+			}
+		}
+	}
+	printf("bit-exact: %d passed, %d failed\n", passed, failed);
+
+	// Throughput: filter only (integrated mode) and with true peak, 2 minutes at 48 kHz in 200 ms buffers
+	const unsigned int benchChannels[] = {2, 6};
+	for (unsigned int channels : benchChannels)
+	{
+		const vector<double> signal = MakeSignal(channels, 48000, 120);
+		const int benchModes[] = {EBUR128_MODE_I, EBUR128_MODE_I | EBUR128_MODE_TRUE_PEAK};
+		for (int mode : benchModes)
+		{
+			Results scalar, simd;
+			Run(signal, channels, 48000, mode, NULL, 9600, false, &scalar);
+			Run(signal, channels, 48000, mode, NULL, 9600, true,  &simd);
+			printf("%u ch, %-22s scalar %.3f s, simd %.3f s (%.2fx)\n", channels, (mode & EBUR128_MODE_TRUE_PEAK) == EBUR128_MODE_TRUE_PEAK ? "integrated+true peak:" : "integrated:",
+			       scalar.seconds, simd.seconds, scalar.seconds / simd.seconds);
+		}
+	}
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,3 @@
+#pragma once
+// Stand-in for WDL's localize.h, see ../../stdafx.h
+inline const char* __localizeFunc (const char* str, const char* subctx, int flags) { return str; }
@@ -0,0 +1,100 @@
+/******************************************************************************
+/ stdafx.h
+/
+/ Stand-in for the SWS precompiled header so libebur128 can be built on its own
+/ for the SIMD test. Provides just enough of REAPER's API: a linear
+/ interpolating resampler instead of REAPER's, which is fine since the test
+/ compares the scalar and SIMD paths against each other, not against REAPER.
+/
+/ Copyright (c) 2026 SWS contributors
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <float.h>
+#include <vector>
+
+#define REASAMPLE_SIZE 8
+typedef double ReaSample;
+typedef intptr_t INT_PTR;
+
+class REAPER_Resample_Interface
+{
+public:
+	virtual ~REAPER_Resample_Interface(){}
+	virtual void SetRates(double rate_in, double rate_out)=0;
+	virtual void Reset()=0;
+	virtual double GetCurrentLatency()=0;
+	virtual int ResamplePrepare(int out_samples, int nch, ReaSample **inbuffer)=0;
+	virtual int ResampleOut(ReaSample *out, int nsamples_in, int nsamples_out, int nch)=0;
+	virtual int Extended(int call, void *parm1, void *parm2, void *parm3) { return 0; }
+};
+#define RESAMPLE_EXT_SETRSMODE 0x1000
+#define RESAMPLE_EXT_SETFEEDMODE 0x1001
+
+class TestResampler : public REAPER_Resample_Interface
+{
+public:
+	TestResampler () : m_factor(1) {}
+	void SetRates (double rate_in, double rate_out) { m_factor = (int)(rate_out / rate_in + 0.5); }
+	void Reset () { m_last.clear(); }
+	double GetCurrentLatency () { return 0; }
+	int ResamplePrepare (int out_samples, int nch, ReaSample** inbuffer)
+	{
+		m_in.resize((size_t)out_samples * nch);
+		*inbuffer = m_in.data();
+		return out_samples;
+	}
+	int ResampleOut (ReaSample* out, int nsamples_in, int nsamples_out, int nch)
+	{
+		if (m_last.size() != (size_t)nch)
+			m_last.assign(nch, 0.0);
+		int frames = 0;
+		for (int i = 0; i < nsamples_in && frames + m_factor <= nsamples_out; ++i)
+		{
+			for (int k = 1; k <= m_factor; ++k, ++frames)
+			{
+				for (int c = 0; c < nch; ++c)
+				{
+					const double t = (double)k / m_factor;
+					out[frames * nch + c] = m_last[c] + (m_in[i * nch + c] - m_last[c]) * t;
+				}
+			}
+			for (int c = 0; c < nch; ++c)
+				m_last[c] = m_in[i * nch + c];
+		}
+		return frames;
+	}
+
+private:
+	int m_factor;
+	std::vector<ReaSample> m_in, m_last;
+};
+
+inline REAPER_Resample_Interface* Resampler_Create () { return new TestResampler(); }
+inline const char* Resample_EnumModes (int mode) { return mode == 0 ? "Good (64pt Sinc)" : NULL; }
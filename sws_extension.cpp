@@ -491,7 +491,6 @@ public:
 		if (m_bChanged)
 		{
 			m_bChanged = false;
-			ScheduleTracklistUpdate();
 			g_pMarkerList->Update();
 			UpdateSnapshotsDialog();
 			ProjectListUpdate();
@@ -510,9 +509,11 @@ public:
 	void SetTrackListChange()
 	{
 		m_bChanged = true;
+		InvalidateGuidToTrackIndex();
 		AutoColorTrack(false);
 		AutoColorMarkerRegion(false);
 		SNM_CSurfSetTrackListChange();
+		TracklistSetTrackListChange();
 		m_iACIgnore = GetNumTracks() + 1;
 	}
 	// For every SetTrackListChange we get NumTracks+1 SetTrackTitle calls, but we only
@@ -520,7 +521,7 @@ public:
 	// However, we still need to trap track name changes with no track list change.
 	void SetTrackTitle(MediaTrack *tr, const char *c)
 	{
-		ScheduleTracklistUpdate();
+		TracklistSetTrackTitle(tr);
 		if (!m_iACIgnore)
 		{
 			AutoColorTrack(false);
@@ -544,10 +545,10 @@ public:
 		BR_CSurf_OnTrackSelection(tr);
 	}
 
-	void SetSurfaceSelected(MediaTrack *tr, bool bSel)	{ ScheduleTracklistUpdate(); UpdateSnapshotsDialog(true); }
-	void SetSurfaceMute(MediaTrack *tr, bool mute)		{ ScheduleTracklistUpdate(); UpdateTrackMute(); }
-	void SetSurfaceSolo(MediaTrack *tr, bool solo)		{ ScheduleTracklistUpdate(); UpdateTrackSolo(); }
-	void SetSurfaceRecArm(MediaTrack *tr, bool arm)		{ ScheduleTracklistUpdate(); UpdateTrackArm(); }
+	void SetSurfaceSelected(MediaTrack *tr, bool bSel)	{ TracklistSetTrackState(tr); UpdateSnapshotsDialog(true); }
+	void SetSurfaceMute(MediaTrack *tr, bool mute)		{ TracklistSetTrackState(tr); UpdateTrackMute(); }
+	void SetSurfaceSolo(MediaTrack *tr, bool solo)		{ TracklistSetTrackState(tr); UpdateTrackSolo(); }
+	void SetSurfaceRecArm(MediaTrack *tr, bool arm)		{ TracklistSetTrackState(tr); UpdateTrackArm(); }
 	int Extended(int call, void *parm1, void *parm2, void *parm3)
 	{
 		BR_CSurf_Extended(call, parm1, parm2, parm3);
@@ -284,23 +284,113 @@ const GUID* TrackToGuid(ReaProject* proj, MediaTrack* tr)
 }
 
 
+// GuidToTrack() index: GUID -> track, one per project. Invalidated on track list change
+// (see InvalidateGuidToTrackIndex()) and when the track count differs. Hits are double-checked
+// against the project (track GUIDs can be changed with state chunks, for example) and misses
+// fall back to a linear scan of the project, the index gets rebuilt if that finds the track.
+struct TrackGuidIndexEntry
+{
+	MediaTrack* tr;
+	int id;
+};
+
+static int CompareGuids(GUID* g1, GUID* g2)
+{
+	return memcmp(g1, g2, sizeof(GUID));
+}
+
+class TrackGuidIndex
+{
+public:
+	TrackGuidIndex(ReaProject* proj) : m_proj(proj), m_tracks(CompareGuids), m_valid(false), m_trackCount(0) {}
+
+	ReaProject* GetProject() { return m_proj; }
+	void Invalidate() { m_valid = false; }
+
+	MediaTrack* Find(const GUID* guid)
+	{
+		if (!m_valid || m_trackCount != CountTracks(m_proj))
+			Build();
+
+		if (MediaTrack* tr = Lookup(guid))
+			return tr;
+
+		// Miss: the project state change count doesn't cover every way a track GUID can change, so don't trust it and
+		// do what GuidToTrack() always did. Rebuild only if the track is there after all, true misses cost no more than before.
+		for (int i = 0; i < m_trackCount; ++i)
+		{
+			MediaTrack* tr = GetTrack(m_proj, i);
+			if (tr && TrackMatchesGuid(m_proj, tr, guid))
+			{
+				Build();
+				return tr;
+			}
+		}
+		return nullptr;
+	}
+
+private:
+	void Build()
+	{
+		m_tracks.DeleteAll();
+		m_trackCount = CountTracks(m_proj);
+		for (int i = 0; i < m_trackCount; ++i)
+		{
+			TrackGuidIndexEntry entry = {GetTrack(m_proj, i), i};
+			if (const GUID* g = TrackToGuid(m_proj, entry.tr))
+				m_tracks.AddUnsorted(*g, entry);
+		}
+		m_tracks.Resort();
+		m_valid = true;
+	}
+
+	MediaTrack* Lookup(const GUID* guid)
+	{
+		const TrackGuidIndexEntry* entry = m_tracks.GetPtr(*guid);
+		if (entry && GetTrack(m_proj, entry->id) == entry->tr && GuidsEqual(static_cast<GUID*>(GetSetMediaTrackInfo(entry->tr, "GUID", nullptr)), guid))
+			return entry->tr;
+		return nullptr;
+	}
+
+	ReaProject* m_proj;
+	WDL_AssocArray<GUID, TrackGuidIndexEntry> m_tracks;
+	bool m_valid;
+	int m_trackCount;
+};
+
+static WDL_PtrList_DeleteOnDestroy<TrackGuidIndex> g_trackGuidIndexes;
+
+void InvalidateGuidToTrackIndex()
+{
+	// also called on project tab switch/close, forget indexes of closed projects
+	for (int i = g_trackGuidIndexes.GetSize() - 1; i >= 0; --i)
+	{
+		if (ValidatePtr(g_trackGuidIndexes.Get(i)->GetProject(), "ReaProject*"))
+			g_trackGuidIndexes.Get(i)->Invalidate();
+		else
+			g_trackGuidIndexes.Delete(i, true);
+	}
+}
+
 MediaTrack* GuidToTrack(ReaProject* project, const GUID* guid)
 {
 	if (!guid)
 		return nullptr;
 
-	MediaTrack* master = GetMasterTrack(project);
-	if (master && TrackMatchesGuid(project, master, guid))
-		return master;
+	if (GuidsEqual(guid, &GUID_NULL))
+		return GetMasterTrack(project);
 
-	const int trackCount = CountTracks(project);
-	for (int i = 0; i < trackCount; ++i) {
-		MediaTrack* tr = GetTrack(project, i);
-		if (tr && TrackMatchesGuid(project, tr, guid))
-			return tr;
-	}
+	if (!project)
+		project = EnumProjects(-1, nullptr, 0);
 
-	return nullptr;
+	TrackGuidIndex* index = nullptr;
+	for (int i = 0; !index && i < g_trackGuidIndexes.GetSize(); ++i)
+		if (g_trackGuidIndexes.Get(i)->GetProject() == project)
+			index = g_trackGuidIndexes.Get(i);
+	if (!index)
+		index = g_trackGuidIndexes.Add(new TrackGuidIndex(project));
+
+	return index->Find(guid);
 }
 
 bool GuidsEqual(const GUID* g1, const GUID* g2)
@@ -228,6 +228,7 @@ const GUID* TrackToGuid(ReaProject*, MediaTrack*);
 inline const GUID* TrackToGuid(MediaTrack* tr) { return TrackToGuid(nullptr, tr); }
 MediaTrack* GuidToTrack(ReaProject*, const GUID*);
 inline MediaTrack* GuidToTrack(const GUID* guid) { return GuidToTrack(nullptr, guid); }
+void InvalidateGuidToTrackIndex(); // call on track list change
 bool GuidsEqual(const GUID* g1, const GUID* g2);
 bool TrackMatchesGuid(ReaProject*, MediaTrack*, const GUID*);
 inline bool TrackMatchesGuid(MediaTrack* tr, const GUID* g) { return TrackMatchesGuid(nullptr, tr, g); }
@@ -713,6 +713,7 @@ void SWS_SetDockWndState(const char* _stateBuf, int _len, SWS_DockWnd_State* _st
 SWS_ListView::SWS_ListView(HWND hwndList, HWND hwndEdit, int iCols, SWS_LVColumn* pCols, const char* cINIKey, bool bTooltips, const char* cLocalizeSection, bool bDrawArrow)
 :m_hwndList(hwndList), m_hwndEdit(hwndEdit), m_hwndTooltip(NULL), m_iSortCol(1), m_iEditingItem(-1), m_iEditingCol(-1),
   m_iCols(iCols), m_pCols(NULL), m_pDefaultCols(NULL), m_bDisableUpdates(false), m_cINIKey(cINIKey), m_cLocalizeSection(cLocalizeSection),m_bDrawArrow(bDrawArrow),
+  m_bVirtual((GetWindowLongPtr(hwndList, GWL_STYLE) & LVS_OWNERDATA) != 0), m_iVirtualGen(-1), m_iSortKeyCol(-1),
 #ifndef _WIN32
   m_pClickedItem(NULL)
 #else
@@ -817,6 +818,12 @@ SWS_ListItem* SWS_ListView::GetListItem(int index, int* iState)
 {
 	if (index < 0)
 		return NULL;
+	if (m_bVirtual)
+	{
+		if (iState)
+			*iState = ListView_GetItemState(m_hwndList, index, LVIS_SELECTED | LVIS_FOCUSED);
+		return m_vItems.Get(index);
+	}
 	LVITEM li;
 	li.mask = LVIF_PARAM | (iState ? LVIF_STATE : 0);
 	li.stateMask = LVIS_SELECTED | LVIS_FOCUSED;
@@ -828,6 +835,26 @@ SWS_ListItem* SWS_ListView::GetListItem(int index, int* iState)
 	return (SWS_ListItem*)li.lParam;
 }
 
+int SWS_ListView::FindListItem(SWS_ListItem* item)
+{
+	if (!item)
+		return -1;
+	if (m_bVirtual)
+	{
+		if (!m_vIndex.GetSize() && m_vItems.GetSize())
+		{
+			for (int i = 0; i < m_vItems.GetSize(); i++)
+				m_vIndex.AddUnsorted(m_vItems.Get(i), i);
+			m_vIndex.Resort();
+		}
+		return m_vIndex.Get(item, -1);
+	}
+	for (int i = 0; i < GetListItemCount(); i++)
+		if (GetListItem(i) == item)
+			return i;
+	return -1;
+}
+
 bool SWS_ListView::IsSelected(int index)
 {
 	if (index < 0)
@@ -843,6 +870,23 @@ SWS_ListItem* SWS_ListView::EnumSelected(int* i, int iOffset)
 	int temp = 0;
 	if (!i)
 		i = &temp;
+
+	if (m_bVirtual)
+	{
+		const int n = m_vItems.GetSize();
+		while (*i < n)
+		{
+			if (ListView_GetItemState(m_hwndList, (*i)++, LVIS_SELECTED))
+			{
+				int iItem = *i - 1;
+				if (iOffset != 0 && iItem + iOffset >= 0 && iItem + iOffset < n)
+					iItem += iOffset;
+				return m_vItems.Get(iItem);
+			}
+		}
+		return NULL;
+	}
+
 	LVITEM li;
 	li.mask = LVIF_PARAM | LVIF_STATE;
 	li.stateMask = LVIS_SELECTED;
@@ -877,21 +921,15 @@ int SWS_ListView::CountSelected ()
 
 bool SWS_ListView::SelectByItem(SWS_ListItem* _item, bool bSelectOnly, bool bEnsureVisible)
 {
-	if (_item)
+	int i = FindListItem(_item);
+	if (i >= 0)
 	{
-		for (int i = 0; i < GetListItemCount(); i++)
-		{
-			SWS_ListItem* item = GetListItem(i);
-			if (item == _item)
-			{
-				if (bSelectOnly)
-					ListView_SetItemState(m_hwndList, -1, 0, LVIS_SELECTED);
-				ListView_SetItemState(m_hwndList, i, LVIS_SELECTED, LVIS_SELECTED);
-				if (bEnsureVisible)
-					ListView_EnsureVisible(m_hwndList, i, true);
-				return true;
-			}
-		}
+		if (bSelectOnly)
+			ListView_SetItemState(m_hwndList, -1, 0, LVIS_SELECTED);
+		ListView_SetItemState(m_hwndList, i, LVIS_SELECTED, LVIS_SELECTED);
+		if (bEnsureVisible)
+			ListView_EnsureVisible(m_hwndList, i, true);
+		return true;
 	}
 	return false;
 }
@@ -900,7 +938,53 @@ int SWS_ListView::OnNotify(WPARAM wParam, LPARAM lParam)
 {
 	NMLISTVIEW* s = (NMLISTVIEW*)lParam;
 
+	// Virtual lists: text is only pulled for the rows being displayed
+	if (m_bVirtual && s->hdr.code == LVN_GETDISPINFO)
+	{
+		NMLVDISPINFO* di = (NMLVDISPINFO*)lParam;
+		if ((di->item.mask & LVIF_TEXT) && di->item.pszText && di->item.cchTextMax > 0)
+		{
+			di->item.pszText[0] = 0;
+			int gen = GetItemListGeneration();
+			if (gen < 0 || gen == m_iVirtualGen) // do not touch deleted items
+				if (SWS_ListItem* item = m_vItems.Get(di->item.iItem))
+					GetItemText(item, DisplayToDataCol(di->item.iSubItem), di->item.pszText, di->item.cchTextMax);
+		}
+		return 0;
+	}
+
 #ifdef _WIN32
+	// Same as above, in unicode mode (see WDL_UTF8_HookListView() in the constructor)
+	if (m_bVirtual && s->hdr.code == LVN_GETDISPINFOW)
+	{
+		NMLVDISPINFOW* di = (NMLVDISPINFOW*)lParam;
+		if ((di->item.mask & LVIF_TEXT) && di->item.pszText && di->item.cchTextMax > 0)
+		{
+			char str[CELL_MAX_LEN]="";
+			int gen = GetItemListGeneration();
+			if (gen < 0 || gen == m_iVirtualGen)
+				if (SWS_ListItem* item = m_vItems.Get(di->item.iItem))
+					GetItemText(item, DisplayToDataCol(di->item.iSubItem), str, sizeof(str));
+			if (!MultiByteToWideChar(CP_UTF8, 0, str, -1, di->item.pszText, di->item.cchTextMax))
+				di->item.pszText[di->item.cchTextMax-1] = 0; // truncated
+		}
+		return 0;
+	}
+
+	// Virtual lists: ranges of items (shift+click, etc) are notified at once
+	if (m_bVirtual && !m_bDisableUpdates && s->hdr.code == LVN_ODSTATECHANGED)
+	{
+		NMLVODSTATECHANGE* od = (NMLVODSTATECHANGE*)lParam;
+		if ((od->uNewState ^ od->uOldState) & LVIS_SELECTED)
+			for (int i = od->iFrom; i <= od->iTo; i++)
+			{
+				int iState;
+				if (SWS_ListItem* item = GetListItem(i, &iState))
+					OnItemSelChanged(item, iState);
+			}
+		return 0;
+	}
+
 	if (!m_bDisableUpdates && s->hdr.code == LVN_ITEMCHANGING && s->iItem >= 0 && (s->uNewState ^ s->uOldState) & LVIS_SELECTED)
 	{
 		// These calls are made in big groups, save the cur state on the first call
@@ -919,12 +1003,25 @@ int SWS_ListView::OnNotify(WPARAM wParam, LPARAM lParam)
 		return iRet;
 	}
 
-	if (!m_bDisableUpdates && s->hdr.code == LVN_ITEMCHANGED && s->iItem >= 0)
+	if (!m_bDisableUpdates && s->hdr.code == LVN_ITEMCHANGED && (s->iItem >= 0 || m_bVirtual))
 #else
 	//JFB no test on s->iItem for OSX: needed to detect empty selections
 	if (!m_bDisableUpdates && s->hdr.code == LVN_ITEMCHANGED)
 #endif
 	{
+#ifdef _WIN32
+		if (s->iItem < 0) // virtual lists: all items (de)selected at once
+		{
+			if (s->uChanged & LVIF_STATE && (s->uNewState ^ s->uOldState) & LVIS_SELECTED)
+				for (int i = 0; i < m_vItems.GetSize(); i++)
+				{
+					int iState;
+					SWS_ListItem* item = GetListItem(i, &iState);
+					OnItemSelChanged(item, iState);
+				}
+			return 0;
+		}
+#endif
 		if (s->uChanged & LVIF_STATE && (s->uNewState ^ s->uOldState) & LVIS_SELECTED)
 			OnItemSelChanged(GetListItem(s->iItem), s->uNewState);
 
@@ -1172,6 +1269,13 @@ int SWS_ListView::LVKeyHandler(MSG* msg, int iKeyState)
 
 void SWS_ListView::Update()
 {
+	if (m_bVirtual)
+	{
+		if (m_iEditingItem == -1 && !m_bDisableUpdates)
+			UpdateVirtual();
+		return;
+	}
+
 	// Fill in the data by pulling it from the derived class
 	if (m_iEditingItem == -1 && !m_bDisableUpdates)
 	{
@@ -1400,6 +1504,13 @@ bool SWS_ListView::DoColumnMenu(int x, int y)
 			ListView_DeleteAllItems(m_hwndList);
 			while(ListView_DeleteColumn(m_hwndList, 0));
 			ShowColumns();
+			if (m_bVirtual)
+			{
+				m_vItems.Empty();
+				m_vIndex.DeleteAll();
+				m_iVirtualGen = -1;
+				m_iSortKeyCol = -1;
+			}
 			Update();
 		}
 		return true;
@@ -1460,26 +1571,33 @@ SWS_ListItem* SWS_ListView::GetHitItem(int x, int y, int* iCol)
 void SWS_ListView::EditListItem(SWS_ListItem* item, int iCol)
 {
 	// Convert to index and call edit
-#ifdef _WIN32
-	LVFINDINFO fi;
-	fi.flags = LVFI_PARAM;
-	fi.lParam = (LPARAM)item;
-	int iItem = ListView_FindItem(m_hwndList, -1, &fi);
-#else
 	int iItem = -1;
-	LVITEM li;
-	li.mask = LVIF_PARAM;
-	for (int i = 0; i < ListView_GetItemCount(m_hwndList); i++)
+	if (m_bVirtual)
 	{
-		li.iItem = i;
-		ListView_GetItem(m_hwndList, &li);
-		if ((SWS_ListItem*)li.lParam == item)
+		iItem = FindListItem(item);
+	}
+	else
+	{
+#ifdef _WIN32
+		LVFINDINFO fi;
+		fi.flags = LVFI_PARAM;
+		fi.lParam = (LPARAM)item;
+		iItem = ListView_FindItem(m_hwndList, -1, &fi);
+#else
+		LVITEM li;
+		li.mask = LVIF_PARAM;
+		for (int i = 0; i < ListView_GetItemCount(m_hwndList); i++)
 		{
-			iItem = i;
-			break;
+			li.iItem = i;
+			ListView_GetItem(m_hwndList, &li);
+			if ((SWS_ListItem*)li.lParam == item)
+			{
+				iItem = i;
+				break;
+			}
 		}
-	}
 #endif
+	}
 	if (iItem >= 0)
 		EditListItem(iItem, iCol);
 }
@@ -1550,12 +1668,26 @@ bool SWS_ListView::EditListItemEnd(bool bSave, bool bResort)
 			if (strcmp(curStr, newStr))
 			{
 				SetItemText(item, editedCol, newStr);
-				GetItemText(item, editedCol, newStr, sizeof(newStr));
-				ListView_SetItemText(m_hwndList, m_iEditingItem, DataToDisplayCol(editedCol), newStr);
+				if (m_bVirtual)
+				{
+					if (m_iSortKeyCol == editedCol)
+						m_iSortKeyCol = -1;
+					ListView_RedrawItems(m_hwndList, m_iEditingItem, m_iEditingItem);
+				}
+				else
+				{
+					GetItemText(item, editedCol, newStr, sizeof(newStr));
+					ListView_SetItemText(m_hwndList, m_iEditingItem, DataToDisplayCol(editedCol), newStr);
+				}
 				updated = true;
 			}
 			if (bResort)
-				ListView_SortItems(m_hwndList, sListCompare, (LPARAM)this);
+			{
+				if (m_bVirtual)
+					SortVirtual();
+				else
+					ListView_SortItems(m_hwndList, sListCompare, (LPARAM)this);
+			}
 			// TODO resort? Just call update?
 			// Update is likely called when SetItemText is called too...
 		}
@@ -1576,11 +1708,19 @@ int SWS_ListView::OnEditingTimer()
 
 int SWS_ListView::OnItemSort(SWS_ListItem* item1, SWS_ListItem* item2)
 {
-	char str1[CELL_MAX_LEN];
-	char str2[CELL_MAX_LEN];
-	GetItemText(item1, abs(m_iSortCol)-1, str1, sizeof(str1));
-	GetItemText(item2, abs(m_iSortCol)-1, str2, sizeof(str2));
-  int cmp=WDL_strcmp_logical(str1, str2, false);
+	int cmp;
+	if (m_bVirtual)
+	{
+		cmp = WDL_strcmp_logical(GetSortKey(item1), GetSortKey(item2), false);
+	}
+	else
+	{
+		char str1[CELL_MAX_LEN];
+		char str2[CELL_MAX_LEN];
+		GetItemText(item1, abs(m_iSortCol)-1, str1, sizeof(str1));
+		GetItemText(item2, abs(m_iSortCol)-1, str2, sizeof(str2));
+		cmp = WDL_strcmp_logical(str1, str2, false);
+	}
   return (m_iSortCol<0 ? -cmp : cmp);
 }
 
@@ -1617,7 +1757,10 @@ void SWS_ListView::ShowColumns()
 
 void SWS_ListView::Sort()
 {
-	ListView_SortItems(m_hwndList, sListCompare, (LPARAM)this);
+	if (m_bVirtual)
+		SortVirtual();
+	else
+		ListView_SortItems(m_hwndList, sListCompare, (LPARAM)this);
 	int iCol = abs(m_iSortCol) - 1;
 	iCol = DataToDisplayCol(iCol) + 1;
 	if (m_iSortCol < 0)
@@ -1672,6 +1815,154 @@ int SWS_ListView::sListCompare(LPARAM lParam1, LPARAM lParam2, LPARAM lSortParam
 	return 0;
 }
 
+// Virtual lists (LVS_OWNERDATA): the listview only knows the number of rows,
+// it pulls the text of visible rows through LVN_GETDISPINFO (see OnNotify())
+// so that an update does not depend on the number of items, except when the
+// item list is pulled again (i.e. when GetItemListGeneration() changes)
+void SWS_ListView::UpdateVirtual()
+{
+	int gen = GetItemListGeneration();
+	if (gen >= 0 && gen == m_iVirtualGen)
+	{
+		// same items, just repaint visible rows (text may have changed)
+		InvalidateRect(m_hwndList, NULL, FALSE);
+		return;
+	}
+
+	m_bDisableUpdates = true;
+	m_iVirtualGen = gen;
+	m_iSortKeyCol = -1;
+
+	// current states of selected/focused items, usually a few
+	WDL_PtrKeyedArray<int> oldStates;
+	int i = -1;
+	while ((i = ListView_GetNextItem(m_hwndList, i, LVNI_SELECTED)) >= 0)
+		if (SWS_ListItem* item = m_vItems.Get(i))
+			oldStates.AddUnsorted(item, LVIS_SELECTED);
+	oldStates.Resort();
+	if ((i = ListView_GetNextItem(m_hwndList, -1, LVNI_FOCUSED)) >= 0)
+		if (SWS_ListItem* item = m_vItems.Get(i))
+			oldStates.Insert(item, oldStates.Get(item, 0) | LVIS_FOCUSED);
+
+	SWS_ListItemList items;
+	GetItemList(&items);
+
+	WDL_TypedBuf<VirtualRow> rows;
+	VirtualRow* r = rows.Resize(items.GetSize(), false);
+	for (i = 0; i < rows.GetSize(); i++)
+	{
+		r[i].item = items.Get(i);
+		r[i].state = oldStates.Get(r[i].item, 0);
+		int iNewState = GetItemState(r[i].item);
+		if (iNewState > 0)
+			r[i].state |= LVIS_SELECTED;
+		else if (!iNewState)
+			r[i].state = 0;
+	}
+	SetVirtualRows(&rows);
+	Sort();
+
+#ifdef _WIN32
+	if (m_hwndTooltip)
+	{
+		char str[CELL_MAX_LEN]="";
+		TOOLINFO ti = { sizeof(TOOLINFO), };
+		ti.lpszText = str;
+		ti.hwnd = m_hwndList;
+		ti.uFlags = TTF_SUBCLASS;
+		ti.hinst  = g_hInst;
+
+		while (SendMessage(m_hwndTooltip, TTM_ENUMTOOLS, 0, (LPARAM)&ti))
+			SendMessage(m_hwndTooltip, TTM_DELTOOL, 0, (LPARAM)&ti);
+
+		for (i = 0; i < m_vItems.GetSize(); i++)
+		{
+			ListView_GetItemRect(m_hwndList, i, &ti.rect, LVIR_BOUNDS);
+			ti.uId = i;
+			GetItemTooltip(m_vItems.Get(i), str, sizeof(str));
+			SendMessage(m_hwndTooltip, TTM_ADDTOOL, 0, (LPARAM)&ti);
+		}
+	}
+#endif
+
+	m_bDisableUpdates = false;
+}
+
+void SWS_ListView::SortVirtual()
+{
+	WDL_TypedBuf<VirtualRow> rows;
+	GetVirtualRows(&rows);
+	std::stable_sort(rows.Get(), rows.Get() + rows.GetSize(),
+		[this](const VirtualRow& a, const VirtualRow& b) { return OnItemSort(a.item, b.item) < 0; });
+	SetVirtualRows(&rows);
+}
+
+void SWS_ListView::GetVirtualRows(WDL_TypedBuf<VirtualRow>* rows)
+{
+	VirtualRow* r = rows->Resize(m_vItems.GetSize(), false);
+	for (int i = 0; i < rows->GetSize(); i++)
+	{
+		r[i].item = m_vItems.Get(i);
+		r[i].state = 0;
+	}
+	int i = -1;
+	while ((i = ListView_GetNextItem(m_hwndList, i, LVNI_SELECTED)) >= 0 && i < rows->GetSize())
+		r[i].state |= LVIS_SELECTED;
+	if ((i = ListView_GetNextItem(m_hwndList, -1, LVNI_FOCUSED)) >= 0 && i < rows->GetSize())
+		r[i].state |= LVIS_FOCUSED;
+}
+
+// Rows are sets of {item, LVIS_SELECTED|LVIS_FOCUSED}, in display order
+void SWS_ListView::SetVirtualRows(WDL_TypedBuf<VirtualRow>* rows)
+{
+	bool bSaveDisableUpdates = m_bDisableUpdates;
+	m_bDisableUpdates = true; // selection changes below are not user interactions
+
+	const int n = rows->GetSize();
+	const VirtualRow* r = rows->Get();
+	m_vItems.Empty(); // no realloc, except when growing
+	for (int i = 0; i < n; i++)
+		m_vItems.Add(r[i].item);
+	m_vIndex.DeleteAll();
+
+#ifdef _WIN32
+	ListView_SetItemCountEx(m_hwndList, n, LVSICF_NOSCROLL | LVSICF_NOINVALIDATEALL);
+#else
+	ListView_SetItemCount(m_hwndList, n);
+#endif
+	ListView_SetItemState(m_hwndList, -1, 0, LVIS_SELECTED | LVIS_FOCUSED);
+	for (int i = 0; i < n; i++)
+		if (r[i].state)
+			ListView_SetItemState(m_hwndList, i, r[i].state, LVIS_SELECTED | LVIS_FOCUSED);
+	InvalidateRect(m_hwndList, NULL, FALSE);
+
+	m_bDisableUpdates = bSaveDisableUpdates;
+}
+
+// Sort keys of virtual lists are pulled once per item, not once per comparison
+const char* SWS_ListView::GetSortKey(SWS_ListItem* item)
+{
+	const int iCol = abs(m_iSortCol) - 1;
+	if (iCol != m_iSortKeyCol)
+	{
+		m_sortKeys.DeleteAll();
+		m_sortKeyBuf.Resize(0, false);
+		char str[CELL_MAX_LEN];
+		for (int i = 0; i < m_vItems.GetSize(); i++)
+		{
+			str[0] = 0;
+			GetItemText(m_vItems.Get(i), iCol, str, sizeof(str));
+			int len = (int)strlen(str) + 1, ofs = m_sortKeyBuf.GetSize();
+			memcpy(m_sortKeyBuf.Resize(ofs + len, false) + ofs, str, len);
+			m_sortKeys.AddUnsorted(m_vItems.Get(i), ofs);
+		}
+		m_sortKeys.Resort();
+		m_iSortKeyCol = iCol;
+	}
+	int ofs = m_sortKeys.Get(item, -1);
+	return ofs >= 0 ? m_sortKeyBuf.Get() + ofs : "";
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Code bits courtesy of Cockos. Thank you Cockos!
@@ -74,8 +74,10 @@ public:
 	SWS_ListView(HWND hwndList, HWND hwndEdit, int iCols, SWS_LVColumn* pCols, const char* cINIKey, bool bTooltips, const char* cLocalizeSection, bool bDrawArrow=true);
 	virtual ~SWS_ListView();
 	int GetColumnCount() { return m_iCols; }
-	int GetListItemCount() { return ListView_GetItemCount(m_hwndList); }
+	int GetListItemCount() { return m_bVirtual ? m_vItems.GetSize() : ListView_GetItemCount(m_hwndList); }
+	bool IsVirtual() { return m_bVirtual; }
 	SWS_ListItem* GetListItem(int iIndex, int* iState = NULL);
+	int FindListItem(SWS_ListItem* item); // returns the listview index, -1 if not found
 	bool IsSelected(int index);
 	SWS_ListItem* EnumSelected(int* i, int iOffset = 0);
 	int CountSelected ();
@@ -117,6 +119,9 @@ protected:
 	virtual void GetItemTooltip(SWS_ListItem* item, char* str, int iStrMax) {}
 	virtual void GetItemList(SWS_ListItemList* pList) { pList->Empty(); }
 	virtual int  GetItemState(SWS_ListItem* item) { return -1; } // Selection state: -1 == unchanged, 0 == false, 1 == selected
+	// Virtual lists (LVS_OWNERDATA) only: the item list is pulled again only when this changes, -1 == always pull.
+	// Must be bumped as soon as items get deleted: visible rows are not displayed until the next Update()
+	virtual int  GetItemListGeneration() { return -1; }
 	// These inform the derived class of user interaction
 	virtual bool OnItemSelChanging(SWS_ListItem* item, bool bSel) { return false; } // Returns TRUE to prevent the change, or FALSE to allow the change
 	virtual void OnItemSelChanged(SWS_ListItem* item, int iState) { }
@@ -148,8 +153,15 @@ protected:
 #endif
 
 private:
+	struct VirtualRow { SWS_ListItem* item; int state; };
+
 	void ShowColumns();
 	void Sort();
+	void UpdateVirtual();
+	void SortVirtual();
+	void GetVirtualRows(WDL_TypedBuf<VirtualRow>* rows);
+	void SetVirtualRows(WDL_TypedBuf<VirtualRow>* rows);
+	const char* GetSortKey(SWS_ListItem* item);
 
 #ifndef _WIN32
 	int m_iClickedCol;
@@ -162,6 +174,15 @@ private:
 	HWND m_hwndEdit;
 	SWS_LVColumn* m_pDefaultCols;
 	const char* m_cINIKey;
+
+	// Virtual lists: rows are owned by the derived class, the listview only asks for visible ones
+	bool m_bVirtual;
+	WDL_PtrList<SWS_ListItem> m_vItems; // display order
+	WDL_PtrKeyedArray<int> m_vIndex; // item -> index in m_vItems, lazily built by FindListItem()
+	int m_iVirtualGen;
+	int m_iSortKeyCol; // data column of the cached sort keys, -1 if invalid
+	WDL_PtrKeyedArray<int> m_sortKeys; // item -> offset in m_sortKeyBuf
+	WDL_TypedBuf<char> m_sortKeyBuf;
 };
 
 #pragma pack(push, 4)